@@ -0,0 +1,440 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <regex>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+using namespace std;
+
+/*
+    Generates one specialized AVX kernel per zkEVM chelpers step from its parser bytecode.
+
+    The parser functions (<step>_parser_first_avx) interpret the op/args arrays with a switch for every
+    batch of rows.  This generator walks the bytecode once and emits, in order, the body of the case
+    of every operation, so that the generated function has no dispatch.  The bytecode is mostly made of
+    short sequences of operations repeated with different arguments; every repeated sequence is emitted
+    once, as a loop over its arguments, and the rest of the operations get their arguments as literals,
+    which keeps the kernel compact instead of unrolling every operation.
+    The pols columns read by the kernel are prefetched for the next batch of rows.
+
+    Usage: chelpersGenerator, from the repository root; the generated files are written next to the
+    parser files and are compiled only when present (see Makefile).
+*/
+
+const string chelpersDirectory = "src/starkpil/zkevm/chelpers";
+const vector<string> stepNames = {"step2prev", "step3prev", "step3", "step42ns", "step52ns"};
+
+// Forward declaration
+string file2string (const string &fileName);
+void string2file (const string &s, const string &fileName);
+string generate (const string &stepName);
+
+int main(int argc, char **argv)
+{
+    cout << "Chelpers generator" << endl;
+
+    for (uint64_t i = 0; i < stepNames.size(); i++)
+    {
+        string code = generate(stepNames[i]);
+        string fileName = chelpersDirectory + "/zkevm.chelpers." + stepNames[i] + ".generated.cpp";
+        string2file(code, fileName);
+        cout << "Generated " << fileName << endl;
+    }
+
+    return 0;
+}
+
+string file2string (const string &fileName)
+{
+    ifstream inputFile(fileName);
+    if (!inputFile.good())
+    {
+        cerr << "Error: file2string() failed loading input file " << fileName << endl;
+        exit(-1);
+    }
+    stringstream buffer;
+    buffer << inputFile.rdbuf();
+    return buffer.str();
+}
+
+void string2file (const string &s, const string &fileName)
+{
+    ofstream outfile;
+    outfile.open(fileName);
+    if (!outfile.good())
+    {
+        cerr << "Error: string2file() failed creating output file " << fileName << endl;
+        exit(-1);
+    }
+    outfile << s;
+    outfile.close();
+}
+
+// Returns the position of the brace that closes the one at position open
+size_t matchBrace (const string &s, size_t open)
+{
+    int64_t depth = 0;
+    for (size_t p = open; p < s.size(); p++)
+    {
+        if (s[p] == '{') depth++;
+        else if (s[p] == '}')
+        {
+            depth--;
+            if (depth == 0) return p;
+        }
+    }
+    cerr << "Error: matchBrace() found no closing brace for position " << open << endl;
+    exit(-1);
+}
+
+// Parses "uint64_t <name>[<sizeName>] = { a, b, ... };" and returns the name and the values
+void parseArray (const string &header, const string &sizeName, string &name, vector<uint64_t> &values)
+{
+    smatch m;
+    regex declaration("uint64_t\\s+(\\w+)\\[" + sizeName + "\\]\\s*=\\s*\\{");
+    if (!regex_search(header, m, declaration))
+    {
+        cerr << "Error: parseArray() found no array of size " << sizeName << endl;
+        exit(-1);
+    }
+    name = m[1];
+    size_t p = m.position(0) + m.length(0);
+    size_t end = header.find('}', p);
+    while (p < end)
+    {
+        while (p < end && (header[p] < '0' || header[p] > '9')) p++;
+        if (p >= end) break;
+        char *pEnd;
+        values.push_back(strtoull(header.c_str() + p, &pEnd, 10));
+        p = pEnd - header.c_str();
+    }
+}
+
+string literal (uint64_t value)
+{
+    return (value < 0x80000000) ? to_string(value) : to_string(value) + "ULL";
+}
+
+string trim (const string &s)
+{
+    size_t b = s.find_first_not_of(" \t\r");
+    if (b == string::npos) return "";
+    size_t e = s.find_last_not_of(" \t\r");
+    return s.substr(b, e - b + 1);
+}
+
+// Keeps the lines of a prologue or epilogue that do not deal with the bytecode arguments index
+string removeArgsIndex (const string &s)
+{
+    stringstream in(s);
+    string line, out;
+    while (getline(in, line))
+    {
+        if (line.find("i_args") != string::npos || line.find("NARGS_") != string::npos) continue;
+        out += line + "\n";
+    }
+    return out;
+}
+
+// Returns the case body of the operation whose arguments start at args[base], with its arguments replaced by
+// literals or, if argsPointer is not empty, by argsPointer[base - pointerBase + k]; lines are prefixed with indent
+string specializeCase (const string &body, const string &argsName, const vector<uint64_t> &args, uint64_t base, const string &argsPointer, uint64_t pointerBase, const string &indent, uint64_t &nArgs)
+{
+    regex argRegex(argsName + "\\[i_args( \\+ (\\d+))?\\]");
+    regex incRegex("^\\s*i_args\\s*\\+=\\s*(\\d+)\\s*;\\s*$");
+    regex kkRegex("\\bkk\\b");
+    stringstream in(body);
+    string line, out;
+    uint64_t local = 0;
+
+    // Lines are re-indented relative to the least indented one
+    size_t minIndent = string::npos;
+    while (getline(in, line))
+    {
+        if (!trim(line).empty()) minIndent = min(minIndent, line.find_first_not_of(" \t"));
+    }
+    in.clear();
+    in.seekg(0);
+
+    while (getline(in, line))
+    {
+        string t = trim(line);
+        if (t.empty() || t == "break;" || t.rfind("//", 0) == 0) continue;
+        smatch m;
+        if (regex_match(line, m, incRegex))
+        {
+            local += stoull(m[1]);
+            continue;
+        }
+        string result;
+        auto it = sregex_iterator(line.begin(), line.end(), argRegex);
+        size_t last = 0;
+        for (; it != sregex_iterator(); ++it)
+        {
+            uint64_t k = (*it)[2].matched ? stoull((*it)[2]) : 0;
+            if (base + local + k >= args.size())
+            {
+                cerr << "Error: specializeCase() argument out of range base=" << base << " local=" << local << " k=" << k << endl;
+                exit(-1);
+            }
+            string argument = argsPointer.empty() ? literal(args[base + local + k]) : argsPointer + "[" + to_string(base - pointerBase + local + k) + "]";
+            result += line.substr(last, it->position(0) - last) + argument;
+            last = it->position(0) + it->length(0);
+        }
+        result += line.substr(last);
+        if (result.find("i_args") != string::npos || regex_search(result, kkRegex))
+        {
+            cerr << "Error: specializeCase() cannot specialize line: " << line << endl;
+            exit(-1);
+        }
+        size_t end = result.find_last_not_of(" \t\r");
+        out += indent + result.substr(minIndent, end + 1 - minIndent) + "\n";
+    }
+    nArgs = local;
+    return out;
+}
+
+// Adds to columns (stride -> offsets) the pols columns read by a case body specialized with literals, either
+// directly as &params.pols[A + i * S], or through the offsets of other rows as offsetsN[j] = A + (...) * S
+void collectColumns (const string &code, map<uint64_t, set<uint64_t>> &columns)
+{
+    regex colRegex("&params\\.pols\\[(\\d+)(ULL)? \\+ i \\* (\\d+)(ULL)?\\]");
+    regex offsetsRegex("offsets\\d\\[j\\] = (\\d+)(ULL)? \\+ .*\\* (\\d+)(ULL)?;");
+    for (auto it = sregex_iterator(code.begin(), code.end(), colRegex); it != sregex_iterator(); ++it)
+    {
+        columns[stoull((*it)[3])].insert(stoull((*it)[1]));
+    }
+    for (auto it = sregex_iterator(code.begin(), code.end(), offsetsRegex); it != sregex_iterator(); ++it)
+    {
+        columns[stoull((*it)[3])].insert(stoull((*it)[1]));
+    }
+}
+
+// Emits a static table with the values of an array
+string generateTable (const string &name, const vector<uint64_t> &values)
+{
+    string out = "static const uint64_t " + name + "[" + to_string(values.size()) + "] = { ";
+    for (uint64_t i = 0; i < values.size(); i++)
+    {
+        out += (i == 0 ? "" : ", ") + literal(values[i]);
+    }
+    out += " };\n";
+    return out;
+}
+
+// Emits the prefetch of the next batch of rows of the pols columns read by the kernel, listed in one
+// prefetchColumns<stride> table per stride
+string generatePrefetch (const map<uint64_t, set<uint64_t>> &columns)
+{
+    if (columns.empty()) return "";
+
+    string out;
+    out += "          // Prefetch the columns read by the kernel for the next batch of rows\n";
+    out += "          if (i + nrowsBatch < nrows)\n";
+    out += "          {\n";
+    out += "               for (uint64_t r = i + nrowsBatch; r < i + 2 * nrowsBatch; r++)\n";
+    out += "               {\n";
+    out += "                    uintptr_t lastLine = 0;\n";
+    for (auto &c : columns)
+    {
+        // Columns are sorted, so the ones sharing a cache line are consecutive and it is prefetched once
+        string table = "prefetchColumns" + to_string(c.first);
+        out += "                    for (uint64_t c = 0; c < " + to_string(c.second.size()) + "; c++)\n";
+        out += "                    {\n";
+        out += "                         const char *pColumn = (const char *)&params.pols[" + table + "[c] + r * " + literal(c.first) + "];\n";
+        out += "                         if (((uintptr_t)pColumn >> 6) != lastLine)\n";
+        out += "                         {\n";
+        out += "                              _mm_prefetch(pColumn, _MM_HINT_T0);\n";
+        out += "                              lastLine = (uintptr_t)pColumn >> 6;\n";
+        out += "                         }\n";
+        out += "                    }\n";
+    }
+    out += "               }\n";
+    out += "          }\n";
+    return out;
+}
+
+// Finds the repetition of a sequence of up to maxPatternLength operations starting at ops[p] that saves the most
+// operation bodies, if it saves at least minSavedBodies of them; returns the sequence length and its number of
+// repetitions, which is 1 if there is none
+const uint64_t maxPatternLength = 32;
+const uint64_t minSavedBodies = 4;
+void findRepetition (const vector<uint64_t> &ops, uint64_t p, uint64_t &length, uint64_t &repetitions)
+{
+    length = 1;
+    repetitions = 1;
+    uint64_t bestSaved = minSavedBodies - 1;
+    for (uint64_t L = 1; (L <= maxPatternLength) && (p + 2*L <= ops.size()); L++)
+    {
+        uint64_t k = 1;
+        while ((p + (k + 1)*L <= ops.size()) && equal(ops.begin() + p, ops.begin() + p + L, ops.begin() + p + k*L))
+        {
+            k++;
+        }
+        uint64_t saved = L*(k - 1);
+        if (saved > bestSaved)
+        {
+            bestSaved = saved;
+            length = L;
+            repetitions = k;
+        }
+    }
+}
+
+string generate (const string &stepName)
+{
+    string header = file2string(chelpersDirectory + "/zkevm.chelpers." + stepName + ".parser.hpp");
+    string source = file2string(chelpersDirectory + "/zkevm.chelpers." + stepName + ".parser.cpp");
+
+    string opsName, argsName;
+    vector<uint64_t> ops, args;
+    parseArray(header, "NOPS_", opsName, ops);
+    parseArray(header, "NARGS_", argsName, args);
+
+    // Locate the AVX parser function, its bytecode loop and its switch
+    string functionName = "ZkevmSteps::" + stepName + "_parser_first_avx(";
+    size_t fPos = source.find(functionName);
+    if (fPos == string::npos)
+    {
+        cerr << "Error: generate() found no function " << functionName << endl;
+        exit(-1);
+    }
+    size_t fOpen = source.find('{', fPos);
+    size_t fClose = matchBrace(source, fOpen);
+    size_t loopPos = source.find("for (int kk = 0; kk < NOPS_; ++kk)", fOpen);
+    if (loopPos == string::npos || loopPos > fClose)
+    {
+        cerr << "Error: generate() found no bytecode loop in " << functionName << endl;
+        exit(-1);
+    }
+    size_t loopLineStart = source.rfind('\n', loopPos) + 1;
+    size_t loopOpen = source.find('{', loopPos);
+    size_t loopClose = matchBrace(source, loopOpen);
+    size_t switchPos = source.find("switch (" + opsName + "[kk])", loopOpen);
+    size_t switchOpen = source.find('{', switchPos);
+    size_t switchClose = matchBrace(source, switchOpen);
+
+    // Collect the body of every case
+    map<uint64_t, string> cases;
+    regex caseRegex("case (\\d+):");
+    string switchBody = source.substr(switchOpen + 1, switchClose - switchOpen - 1);
+    size_t p = 0;
+    smatch m;
+    while (regex_search(switchBody.cbegin() + p, switchBody.cend(), m, caseRegex))
+    {
+        size_t casePos = p + m.position(0);
+        size_t caseOpen = switchBody.find('{', casePos);
+        size_t caseClose = matchBrace(switchBody, caseOpen);
+        cases[stoull(m[1])] = switchBody.substr(caseOpen + 1, caseClose - caseOpen - 1);
+        p = caseClose + 1;
+    }
+
+    // Specialize every operation of the bytecode with literals, to know where its arguments start and which
+    // columns it reads
+    vector<uint64_t> opBase(ops.size());
+    vector<string> opBody(ops.size());
+    map<uint64_t, set<uint64_t>> columns;
+    uint64_t iArgs = 0;
+    for (uint64_t kk = 0; kk < ops.size(); kk++)
+    {
+        if (cases.find(ops[kk]) == cases.end())
+        {
+            cerr << "Error: generate() found no case for operation " << ops[kk] << " at " << kk << " in " << stepName << endl;
+            exit(-1);
+        }
+        uint64_t nArgs;
+        opBase[kk] = iArgs;
+        opBody[kk] = specializeCase(cases[ops[kk]], argsName, args, iArgs, "", 0, "               ", nArgs);
+        collectColumns(opBody[kk], columns);
+        iArgs += nArgs;
+    }
+    if (iArgs != args.size())
+    {
+        cerr << "Error: generate() consumed " << iArgs << " arguments of " << args.size() << " in " << stepName << endl;
+        exit(-1);
+    }
+
+    // Emit every repeated sequence of operations as a loop over its arguments, and the rest with literals
+    string kernel;
+    uint64_t nLoops = 0;
+    uint64_t nBodies = 0;
+    for (uint64_t kk = 0; kk < ops.size(); )
+    {
+        uint64_t length, repetitions;
+        findRepetition(ops, kk, length, repetitions);
+        if (repetitions == 1)
+        {
+            kernel += "          {\n" + opBody[kk] + "          }\n";
+            nBodies++;
+            kk++;
+            continue;
+        }
+        uint64_t argsStride = opBase[kk + length] - opBase[kk];
+        kernel += "          // " + to_string(repetitions) + " repetitions of " + to_string(length) + " operations\n";
+        kernel += "          for (uint64_t rep = 0; rep < " + to_string(repetitions) + "; rep++)\n";
+        kernel += "          {\n";
+        kernel += "               const uint64_t *pArgs = &argsGenerated[" + to_string(opBase[kk]) + " + rep * " + to_string(argsStride) + "];\n";
+        for (uint64_t l = 0; l < length; l++)
+        {
+            uint64_t nArgs;
+            string body = specializeCase(cases[ops[kk + l]], argsName, args, opBase[kk + l], "pArgs", opBase[kk], "                    ", nArgs);
+            kernel += "               {\n" + body + "               }\n";
+        }
+        kernel += "          }\n";
+        nLoops++;
+        nBodies += length;
+        kk += length*repetitions;
+    }
+    cout << stepName << ": operations=" << ops.size() << " loops=" << nLoops << " bodies=" << nBodies << " columns=";
+    uint64_t nColumns = 0;
+    for (auto &c : columns) nColumns += c.second.size();
+    cout << nColumns << endl;
+
+    // Keep the includes and the defines of the parser, but not its bytecode
+    string code;
+    code += "// Generated by chelpersGenerator from zkevm.chelpers." + stepName + ".parser.cpp, do not edit\n";
+    code += "#ifdef __ZKEVM_CHELPERS_GENERATED__\n";
+    stringstream sourceLines(source.substr(0, fPos));
+    string line;
+    while (getline(sourceLines, line))
+    {
+        if (line.rfind("#include", 0) == 0 && line.find(".parser.hpp") == string::npos) code += line + "\n";
+        if (line.rfind("#define", 0) == 0) code += line + "\n";
+    }
+    stringstream headerLines(header);
+    while (getline(headerLines, line))
+    {
+        if (line.rfind("#define", 0) == 0 && line.find("NOPS_") == string::npos && line.find("NARGS_") == string::npos) code += line + "\n";
+    }
+    code += "\n";
+    if (nLoops > 0)
+    {
+        code += generateTable("argsGenerated", args);
+    }
+    for (auto &c : columns)
+    {
+        code += generateTable("prefetchColumns" + to_string(c.first), vector<uint64_t>(c.second.begin(), c.second.end()));
+    }
+    code += "\n";
+
+    string prologue = removeArgsIndex(source.substr(fOpen + 1, loopLineStart - fOpen - 1));
+    string epilogue = removeArgsIndex(source.substr(loopClose + 1, fClose - loopClose - 1));
+
+    code += "bool ZkevmSteps::" + stepName + "_generated_first_avx(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch)\n";
+    code += "{";
+    code += prologue;
+    code += generatePrefetch(columns);
+    code += kernel;
+    code += epilogue;
+    code += "     return true;\n";
+    code += "}\n";
+    code += "#endif\n";
+
+    return code;
+}
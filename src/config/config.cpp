@@ -143,14 +143,28 @@ void Config::load(json &config)
     ParseBool(config, "runECRecoverTest", "RUN_ECRECOVER_TEST", runECRecoverTest, false);
     ParseBool(config, "runDatabaseCacheTest", "RUN_DATABASE_CACHE_TEST", runDatabaseCacheTest, false);
     ParseBool(config, "runDatabaseAssociativeCacheTest", "RUN_DATABASE_ASSOCIATIVE_CACHE_TEST", runDatabaseAssociativeCacheTest, false);
+    ParseBool(config, "runDatabaseFileStoreTest", "RUN_DATABASE_FILE_STORE_TEST", runDatabaseFileStoreTest, false);
+    ParseBool(config, "runStateManagerTest", "RUN_STATE_MANAGER_TEST", runStateManagerTest, false);
+    ParseBool(config, "runSmtSetBatchTest", "RUN_SMT_SET_BATCH_TEST", runSmtSetBatchTest, false);
+    ParseBool(config, "runSmtHashManyTest", "RUN_SMT_HASH_MANY_TEST", runSmtHashManyTest, false);
     ParseBool(config, "runCheckTreeTest", "RUN_CHECK_TREE_TEST", runCheckTreeTest, false);
     ParseString(config, "checkTreeRoot", "CHECK_TREE_ROOT", checkTreeRoot, "auto");
+    ParseBool(config, "runMainExecGeneratedTest", "RUN_MAIN_EXEC_GENERATED_TEST", runMainExecGeneratedTest, false);
+    ParseBool(config, "runContextMemoryTest", "RUN_CONTEXT_MEMORY_TEST", runContextMemoryTest, false);
     ParseBool(config, "runDatabasePerformanceTest", "RUN_DATABASE_PERFORMANCE_TEST", runDatabasePerformanceTest, false);
     ParseBool(config, "runUnitTest", "RUN_UNIT_TEST", runUnitTest, false);
 
     // Main SM executor
     ParseBool(config, "useMainExecGenerated", "USE_MAIN_EXEC_GENERATED", useMainExecGenerated, true);
+#ifndef __MAIN_EXEC_GENERATED__
+    if (useMainExecGenerated)
+    {
+        zklog.warning("Config::load() useMainExecGenerated=true but the generated main executor is not compiled (run 'make main_exec_generated'); using the native one");
+        useMainExecGenerated = false;
+    }
+#endif
     ParseBool(config, "useMainExecC", "USE_MAIN_EXEC_C", useMainExecC, false);
+    ParseBool(config, "useBatchPrefetch", "USE_BATCH_PREFETCH", useBatchPrefetch, false);
     ParseBool(config, "executeInParallel", "EXECUTE_IN_PARALLEL", executeInParallel, true);
 
     // Save to file
@@ -167,6 +181,11 @@ void Config::load(json &config)
     ParseBool(config, "loadDBToMemCache", "LOAD_DB_TO_MEM_CACHE", loadDBToMemCache, false);
     ParseBool(config, "loadDBToMemCacheInParallel", "LOAD_DB_TO_MEM_CACHE_IN_PARALLEL", loadDBToMemCacheInParallel, false);
     ParseU64(config, "loadDBToMemTimeout", "LOAD_DB_TO_MEM_TIMEOUT", loadDBToMemTimeout, 30*1000*1000); // Default = 30 seconds
+    ParseU64(config, "loadDBToMemCacheThreads", "LOAD_DB_TO_MEM_CACHE_THREADS", loadDBToMemCacheThreads, 4);
+    ParseU64(config, "loadDBToMemCacheTopLevels", "LOAD_DB_TO_MEM_CACHE_TOP_LEVELS", loadDBToMemCacheTopLevels, 16);
+    ParseString(config, "dbCacheSnapshotFile", "DB_CACHE_SNAPSHOT_FILE", dbCacheSnapshotFile, "");
+    ParseU64(config, "dbCacheSnapshotPeriod", "DB_CACHE_SNAPSHOT_PERIOD", dbCacheSnapshotPeriod, 600); // Seconds, 0 = never save
+    ParseU64(config, "dbCacheSnapshotSize", "DB_CACHE_SNAPSHOT_SIZE", dbCacheSnapshotSize, 1024); // MB
 
     // Server and client ports, hosts, etc.
     ParseU16(config, "executorServerPort", "EXECUTOR_SERVER_PORT", executorServerPort, 50071);
@@ -249,6 +268,13 @@ void Config::load(json &config)
     ParseString(config, "recursive1CmPols", "RECURSIVE1_CM_POLS", recursive1CmPols, "");
     ParseBool(config, "mapConstPolsFile", "MAP_CONST_POLS_FILE", mapConstPolsFile, false);
     ParseBool(config, "mapConstantsTreeFile", "MAP_CONSTANTS_TREE_FILE", mapConstantsTreeFile, false);
+    ParseBool(config, "starkPipelineLdeMerkle", "STARK_PIPELINE_LDE_MERKLE", starkPipelineLdeMerkle, false);
+    ParseString(config, "starkDomainCacheDir", "STARK_DOMAIN_CACHE_DIR", starkDomainCacheDir, "");
+    ParseString(config, "polsHugePages", "POLS_HUGE_PAGES", polsHugePages, "none");
+    ParseBool(config, "prefaultPols", "PREFAULT_POLS", prefaultPols, false);
+    ParseBool(config, "lockPols", "LOCK_POLS", lockPols, false);
+    ParseBool(config, "useGeneratedSteps", "USE_GENERATED_STEPS", useGeneratedSteps, false);
+    ParseBool(config, "benchmarkGeneratedSteps", "BENCHMARK_GENERATED_STEPS", benchmarkGeneratedSteps, false);
     ParseString(config, "proofFile", "PROOF_FILE", proofFile, "proof.json");
     ParseString(config, "publicsOutput", "PUBLICS_OUTPUT", publicsOutput, "public.json");
     ParseString(config, "keccakPolsFile", "KECCAK_POLS_FILE", keccakPolsFile, "keccak_pols.json");
@@ -260,6 +286,7 @@ void Config::load(json &config)
     ParseString(config, "dbProgramTableName", "DB_PROGRAM_TABLE_NAME", dbProgramTableName, "state.program");
     ParseBool(config, "dbMultiWrite", "DB_MULTIWRITE", dbMultiWrite, true);
     ParseU64(config, "dbMultiWriteSingleQuerySize", "DB_MULTIWRITE_SINGLE_QUERY_SIZE", dbMultiWriteSingleQuerySize, 20*1024*1024);
+    ParseBool(config, "dbMultiWriteCopy", "DB_MULTIWRITE_COPY", dbMultiWriteCopy, false);
     ParseBool(config, "dbConnectionsPool", "DB_CONNECTIONS_POOL", dbConnectionsPool, true);
     ParseU64(config, "dbNumberOfPoolConnections", "DB_NUMBER_OF_POOL_CONNECTIONS", dbNumberOfPoolConnections, 30);
     ParseBool(config, "dbMetrics", "DB_METRICS", dbMetrics, true);
@@ -268,11 +295,13 @@ void Config::load(json &config)
     ParseBool(config, "dbReadOnly", "DB_READ_ONLY", dbReadOnly, false);
     ParseU64(config, "dbReadRetryCounter", "DB_READ_RETRY_COUNTER", dbReadRetryCounter, 10);
     ParseU64(config, "dbReadRetryDelay", "DB_READ_RETRY_DELAY", dbReadRetryDelay, 100*1000);
+    ParseU64(config, "dbFileCompactionThreshold", "DB_FILE_COMPACTION_THRESHOLD", dbFileCompactionThreshold, 50); // Percentage of dead bytes, 0 = never compact
 
     // State Manager
     ParseBool(config, "stateManager", "STATE_MANAGER", stateManager, true);
     ParseBool(config, "stateManagerPurge", "STATE_MANAGER_PURGE", stateManagerPurge, true);
     ParseBool(config, "stateManagerPurgeTxs", "STATE_MANAGER_PURGE_TXS", stateManagerPurgeTxs, true);
+    ParseBool(config, "stateManagerArena", "STATE_MANAGER_ARENA", stateManagerArena, true);
 
     // Threads
     ParseU64(config, "cleanerPollingPeriod", "CLEANER_POLLING_PERIOD", cleanerPollingPeriod, 600);
@@ -345,11 +374,23 @@ void Config::print(void)
         zklog.info("    runDatabaseCacheTest=true");
     if (runDatabaseAssociativeCacheTest)
         zklog.info("    runDatabaseAssociativeCacheTest=true");
+    if (runDatabaseFileStoreTest)
+        zklog.info("    runDatabaseFileStoreTest=true");
+    if (runStateManagerTest)
+        zklog.info("    runStateManagerTest=true");
+    if (runSmtSetBatchTest)
+        zklog.info("    runSmtSetBatchTest=true");
+    if (runSmtHashManyTest)
+        zklog.info("    runSmtHashManyTest=true");
     if (runCheckTreeTest)
     {
         zklog.info("    runCheckTreeTest=true");
         zklog.info("    checkTreeRoot=" + checkTreeRoot);
     }
+    if (runMainExecGeneratedTest)
+        zklog.info("    runMainExecGeneratedTest=true");
+    if (runContextMemoryTest)
+        zklog.info("    runContextMemoryTest=true");
     if (runDatabasePerformanceTest)
         zklog.info("    runDatabasePerformanceTest=true");
     if (runUnitTest)
@@ -358,6 +399,7 @@ void Config::print(void)
     zklog.info("    executeInParallel=" + to_string(executeInParallel));
     zklog.info("    useMainExecGenerated=" + to_string(useMainExecGenerated));
     zklog.info("    useMainExecC=" + to_string(useMainExecC));
+    zklog.info("    useBatchPrefetch=" + to_string(useBatchPrefetch));
 
     if (executorROMLineTraces)
         zklog.info("    executorROMLineTraces=true");
@@ -428,6 +470,13 @@ void Config::print(void)
     zklog.info("    zkevmConstantsTree=" + zkevmConstantsTree);
     zklog.info("    c12aConstantsTree=" + c12aConstantsTree);
     zklog.info("    mapConstantsTreeFile=" + to_string(mapConstantsTreeFile));
+    zklog.info("    starkPipelineLdeMerkle=" + to_string(starkPipelineLdeMerkle));
+    zklog.info("    starkDomainCacheDir=" + starkDomainCacheDir);
+    zklog.info("    polsHugePages=" + polsHugePages);
+    zklog.info("    prefaultPols=" + to_string(prefaultPols));
+    zklog.info("    lockPols=" + to_string(lockPols));
+    zklog.info("    useGeneratedSteps=" + to_string(useGeneratedSteps));
+    zklog.info("    benchmarkGeneratedSteps=" + to_string(benchmarkGeneratedSteps));
     zklog.info("    finalVerkey=" + finalVerkey);
     zklog.info("    zkevmVerifier=" + zkevmVerifier);
     zklog.info("    recursive1Verifier=" + recursive1Verifier);
@@ -449,6 +498,7 @@ void Config::print(void)
     zklog.info("    dbProgramTableName=" + dbProgramTableName);
     zklog.info("    dbMultiWrite=" + to_string(dbMultiWrite));
     zklog.info("    dbMultiWriteSingleQuerySize=" + to_string(dbMultiWriteSingleQuerySize));
+    zklog.info("    dbMultiWriteCopy=" + to_string(dbMultiWriteCopy));
     zklog.info("    dbConnectionsPool=" + to_string(dbConnectionsPool));
     zklog.info("    dbNumberOfPoolConnections=" + to_string(dbNumberOfPoolConnections));
     zklog.info("    dbMetrics=" + to_string(dbMetrics));
@@ -457,9 +507,11 @@ void Config::print(void)
     zklog.info("    dbReadOnly=" + to_string(dbReadOnly));
     zklog.info("    dbReadRetryCounter=" + to_string(dbReadRetryCounter));
     zklog.info("    dbReadRetryDelay=" + to_string(dbReadRetryDelay));
+    zklog.info("    dbFileCompactionThreshold=" + to_string(dbFileCompactionThreshold));
     zklog.info("    stateManager=" + to_string(stateManager));
     zklog.info("    stateManagerPurge=" + to_string(stateManagerPurge));
     zklog.info("    stateManagerPurgeTxs=" + to_string(stateManagerPurgeTxs));
+    zklog.info("    stateManagerArena=" + to_string(stateManagerArena));
     zklog.info("    cleanerPollingPeriod=" + to_string(cleanerPollingPeriod));
     zklog.info("    requestsPersistence=" + to_string(requestsPersistence));
     zklog.info("    maxExecutorThreads=" + to_string(maxExecutorThreads));
@@ -471,6 +523,11 @@ void Config::print(void)
     zklog.info("    log2DbMTAssociativeCacheIndexesSize=" + to_string(log2DbMTAssociativeCacheIndexesSize));
     zklog.info("    dbProgramCacheSize=" + to_string(dbProgramCacheSize));
     zklog.info("    loadDBToMemTimeout=" + to_string(loadDBToMemTimeout));
+    zklog.info("    loadDBToMemCacheThreads=" + to_string(loadDBToMemCacheThreads));
+    zklog.info("    loadDBToMemCacheTopLevels=" + to_string(loadDBToMemCacheTopLevels));
+    zklog.info("    dbCacheSnapshotFile=" + dbCacheSnapshotFile);
+    zklog.info("    dbCacheSnapshotPeriod=" + to_string(dbCacheSnapshotPeriod));
+    zklog.info("    dbCacheSnapshotSize=" + to_string(dbCacheSnapshotSize));
     zklog.info("    fullTracerTraceReserveSize=" + to_string(fullTracerTraceReserveSize));
     zklog.info("    ECRecoverPrecalc=" + to_string(ECRecoverPrecalc));
     zklog.info("    ECRecoverPrecalcNThreads=" + to_string(ECRecoverPrecalcNThreads));
@@ -40,7 +40,13 @@ public:
     bool runECRecoverTest;
     bool runDatabaseCacheTest;
     bool runDatabaseAssociativeCacheTest;
+    bool runDatabaseFileStoreTest;
+    bool runStateManagerTest;
+    bool runSmtSetBatchTest;
+    bool runSmtHashManyTest;
     bool runCheckTreeTest;
+    bool runMainExecGeneratedTest;
+    bool runContextMemoryTest;
     string checkTreeRoot;
     bool runDatabasePerformanceTest;
     bool runUnitTest;
@@ -48,6 +54,7 @@ public:
     bool executeInParallel;
     bool useMainExecGenerated;
     bool useMainExecC;
+    bool useBatchPrefetch;
 
     bool saveRequestToFile; // Saves the grpc service request, in text format
     bool saveInputToFile; // Saves the grpc input data, in json format
@@ -61,6 +68,11 @@ public:
     bool loadDBToMemCache;
     bool loadDBToMemCacheInParallel;
     uint64_t loadDBToMemTimeout;
+    uint64_t loadDBToMemCacheThreads; // Number of threads (and database connections) used to load the DB to the mem cache
+    uint64_t loadDBToMemCacheTopLevels; // Number of tree levels loaded before the hot set snapshot
+    string dbCacheSnapshotFile; // File to save the hot set of the MT cache to, and to load it from at start-up; empty = no snapshot
+    uint64_t dbCacheSnapshotPeriod; // Seconds between hot set snapshots; 0 = never save
+    uint64_t dbCacheSnapshotSize; // Maximum size in MBytes of the hot set snapshot
     int64_t dbMTCacheSize; // Size in MBytes for the cache to store MT records
     bool useAssociativeCache; // Use the associative cache for MT records?
     int64_t log2DbMTAssociativeCacheSize; // log2 of the size in entries of the DatabaseMTAssociativeCache. Note 1 cache entry = 97 bytes
@@ -117,6 +129,13 @@ public:
     string recursive2ConstantsTree;
     string recursivefConstantsTree;
     bool mapConstantsTreeFile;
+    bool starkPipelineLdeMerkle; // Overlap the LDE of every group of columns with the hashing of the previous one
+    string starkDomainCacheDir;  // Directory of the x_n/x_2ns/zhInv domain files; if empty, they are computed in memory
+    string polsHugePages;        // Backing of the committed and constant polynomials buffers: "none", "thp" (madvise) or "hugetlb" (MAP_HUGETLB)
+    bool prefaultPols;           // Fault in the pages of those buffers at startup, from all threads
+    bool lockPols;               // mlock() those buffers
+    bool useGeneratedSteps;      // Compute the zkEVM STARK expressions with the kernels of chelpersGenerator, when compiled in
+    bool benchmarkGeneratedSteps; // Run the parser before the generated kernels of every step and log both times
     string finalVerkey;
     string zkevmVerifier;
     string recursive1Verifier;
@@ -145,6 +164,7 @@ public:
     string dbProgramTableName;
     bool dbMultiWrite;
     uint64_t dbMultiWriteSingleQuerySize;
+    bool dbMultiWriteCopy;
     bool dbConnectionsPool;
     uint64_t dbNumberOfPoolConnections;
     bool dbMetrics;
@@ -153,9 +173,11 @@ public:
     bool dbReadOnly;
     uint64_t dbReadRetryCounter;
     uint64_t dbReadRetryDelay;
+    uint64_t dbFileCompactionThreshold;
     bool stateManager;
     bool stateManagerPurge;
     bool stateManagerPurgeTxs;
+    bool stateManagerArena;
     uint64_t cleanerPollingPeriod;
     uint64_t requestsPersistence;
     uint64_t maxExecutorThreads;
@@ -13,6 +13,9 @@
 #include "main_sm/fork_5/main_exec_c/main_exec_c.hpp"
 #include "timer.hpp"
 #include "zklog.hpp"
+#include "zkassert.hpp"
+#include <pthread.h>
+#include <sys/time.h>
 
 // Reduced version: only 1 evaluation is allocated, and some asserts are disabled
 void Executor::process_batch (ProverRequest &proverRequest)
@@ -109,12 +112,14 @@ void Executor::process_batch (ProverRequest &proverRequest)
         }
         case 4: // fork_4
         {
+#ifdef __MAIN_EXEC_GENERATED_FORK_4__
             if (config.useMainExecGenerated)
             {
                 zklog.info("Executor::process_batch() fork 4 generated");
                 fork_4::main_exec_generated_fast(mainExecutor_fork_4, proverRequest);
             }
             else
+#endif
             {
                 zklog.info("Executor::process_batch() fork 4 native");
 
@@ -144,11 +149,13 @@ void Executor::process_batch (ProverRequest &proverRequest)
                 zklog.info("Executor::process_batch() fork 5 C");
                 mainExecutorC_fork_5.execute(proverRequest);
             }
+#ifdef __MAIN_EXEC_GENERATED__
             else if (config.useMainExecGenerated)
             {
                 zklog.info("Executor::process_batch() fork 5 generated");
                 fork_5::main_exec_generated_fast(mainExecutor_fork_5, proverRequest);
             }
+#endif
             else
             {
                 zklog.info("Executor::process_batch() fork 5 native");
@@ -187,111 +194,218 @@ public:
     Executor * pExecutor;
     PROVER_FORK_NAMESPACE::MainExecRequired * pRequired;
     PROVER_FORK_NAMESPACE::CommitPols * pCommitPols;
+    vector<array<Goldilocks::Element, 17>> storagePoseidonG; // Storage SM hashes, appended after the Padding PG SM ones
 };
 
-void* BinaryThread (void* arg)
+void PaddingPGTask (ExecutorContext &ctx)
 {
-    // Get the context
-    ExecutorContext * pExecutorContext = (ExecutorContext *)arg;
-    
-    // Execute the Binary State Machine
-    TimerStart(BINARY_SM_EXECUTE_THREAD);
-    pExecutorContext->pExecutor->binaryExecutor.execute(pExecutorContext->pRequired->Binary, pExecutorContext->pCommitPols->Binary);
-    TimerStopAndLog(BINARY_SM_EXECUTE_THREAD);
+    ctx.pExecutor->paddingPGExecutor.execute(ctx.pRequired->PaddingPG, ctx.pCommitPols->PaddingPG, ctx.pRequired->PoseidonG);
+}
 
-    return NULL;
+void StorageTask (ExecutorContext &ctx)
+{
+    ctx.pExecutor->storageExecutor.execute(ctx.pRequired->Storage, ctx.pCommitPols->Storage, ctx.storagePoseidonG);
 }
 
-void* MemAlignThread (void* arg)
+void PoseidonGTask (ExecutorContext &ctx)
 {
-    // Get the context
-    ExecutorContext * pExecutorContext = (ExecutorContext *)arg;
-    
-    // Execute the MemAlign State Machine
-    TimerStart(MEM_ALIGN_SM_EXECUTE_THREAD);
-    pExecutorContext->pExecutor->memAlignExecutor.execute(pExecutorContext->pRequired->MemAlign, pExecutorContext->pCommitPols->MemAlign);
-    TimerStopAndLog(MEM_ALIGN_SM_EXECUTE_THREAD);
+    // Keep the same hashes order as when Padding PG and Storage SMs run sequentially
+    ctx.pRequired->PoseidonG.insert(ctx.pRequired->PoseidonG.end(), ctx.storagePoseidonG.begin(), ctx.storagePoseidonG.end());
+    ctx.pExecutor->poseidonGExecutor.execute(ctx.pRequired->PoseidonG, ctx.pCommitPols->PoseidonG);
+}
 
-    return NULL;
+void ArithTask (ExecutorContext &ctx)
+{
+    ctx.pExecutor->arithExecutor.execute(ctx.pRequired->Arith, ctx.pCommitPols->Arith);
 }
 
-void* MemoryThread (void* arg)
+void BinaryTask (ExecutorContext &ctx)
 {
-    // Get the context
-    ExecutorContext * pExecutorContext = (ExecutorContext *)arg;
-    
-    // Execute the Binary State Machine
-    TimerStart(MEMORY_SM_EXECUTE_THREAD);
-    pExecutorContext->pExecutor->memoryExecutor.execute(pExecutorContext->pRequired->Memory, pExecutorContext->pCommitPols->Mem);
-    TimerStopAndLog(MEMORY_SM_EXECUTE_THREAD);
+    ctx.pExecutor->binaryExecutor.execute(ctx.pRequired->Binary, ctx.pCommitPols->Binary);
+}
 
-    return NULL;
+void MemAlignTask (ExecutorContext &ctx)
+{
+    ctx.pExecutor->memAlignExecutor.execute(ctx.pRequired->MemAlign, ctx.pCommitPols->MemAlign);
 }
 
-void* ArithThread (void* arg)
+void MemoryTask (ExecutorContext &ctx)
 {
-    // Get the context
-    ExecutorContext * pExecutorContext = (ExecutorContext *)arg;
-    
-    // Execute the Binary State Machine
-    TimerStart(ARITH_SM_EXECUTE_THREAD);
-    pExecutorContext->pExecutor->arithExecutor.execute(pExecutorContext->pRequired->Arith, pExecutorContext->pCommitPols->Arith);
-    TimerStopAndLog(ARITH_SM_EXECUTE_THREAD);
+    ctx.pExecutor->memoryExecutor.execute(ctx.pRequired->Memory, ctx.pCommitPols->Mem);
+}
 
-    return NULL;
+void PaddingKKTask (ExecutorContext &ctx)
+{
+    ctx.pExecutor->paddingKKExecutor.execute(ctx.pRequired->PaddingKK, ctx.pCommitPols->PaddingKK, ctx.pRequired->PaddingKKBit);
 }
 
-void* PoseidonThread (void* arg)
+void PaddingKKBitTask (ExecutorContext &ctx)
 {
-    // Get the context
-    ExecutorContext * pExecutorContext = (ExecutorContext *)arg;
-    
-    // Execute the Padding PG State Machine
-    TimerStart(PADDING_PG_SM_EXECUTE_THREAD);
-    pExecutorContext->pExecutor->paddingPGExecutor.execute(pExecutorContext->pRequired->PaddingPG, pExecutorContext->pCommitPols->PaddingPG, pExecutorContext->pRequired->PoseidonG);
-    TimerStopAndLog(PADDING_PG_SM_EXECUTE_THREAD);
-    
-    // Execute the Storage State Machine
-    TimerStart(STORAGE_SM_EXECUTE_THREAD);
-    pExecutorContext->pExecutor->storageExecutor.execute(pExecutorContext->pRequired->Storage, pExecutorContext->pCommitPols->Storage, pExecutorContext->pRequired->PoseidonG);
-    TimerStopAndLog(STORAGE_SM_EXECUTE_THREAD);
-    
-    // Execute the Poseidon G State Machine
-    TimerStart(POSEIDON_G_SM_EXECUTE_THREAD);
-    pExecutorContext->pExecutor->poseidonGExecutor.execute(pExecutorContext->pRequired->PoseidonG, pExecutorContext->pCommitPols->PoseidonG);
-    TimerStopAndLog(POSEIDON_G_SM_EXECUTE_THREAD);
+    ctx.pExecutor->paddingKKBitExecutor.execute(ctx.pRequired->PaddingKKBit, ctx.pCommitPols->PaddingKKBit, ctx.pRequired->Bits2Field);
+}
 
-    return NULL;
+void Bits2FieldTask (ExecutorContext &ctx)
+{
+    ctx.pExecutor->bits2FieldExecutor.execute(ctx.pRequired->Bits2Field, ctx.pCommitPols->Bits2Field, ctx.pRequired->KeccakF);
+}
+
+void KeccakFTask (ExecutorContext &ctx)
+{
+    ctx.pExecutor->keccakFExecutor.execute(ctx.pRequired->KeccakF, ctx.pCommitPols->KeccakF);
 }
 
-void* KeccakThread (void* arg)
+// A secondary state machine execution, that can start when the ones producing its required data are done
+class ExecutorTask
 {
-    // Get the context
-    ExecutorContext * pExecutorContext = (ExecutorContext *)arg;
-    
-    // Execute the Padding KK State Machine
-    TimerStart(PADDING_KK_SM_EXECUTE_THREAD);
-    pExecutorContext->pExecutor->paddingKKExecutor.execute(pExecutorContext->pRequired->PaddingKK, pExecutorContext->pCommitPols->PaddingKK, pExecutorContext->pRequired->PaddingKKBit);
-    TimerStopAndLog(PADDING_KK_SM_EXECUTE_THREAD);
-    
-    // Execute the PaddingKKBit State Machine
-    TimerStart(PADDING_KK_BIT_SM_EXECUTE_THREAD);
-    pExecutorContext->pExecutor->paddingKKBitExecutor.execute(pExecutorContext->pRequired->PaddingKKBit, pExecutorContext->pCommitPols->PaddingKKBit, pExecutorContext->pRequired->Bits2Field);
-    TimerStopAndLog(PADDING_KK_BIT_SM_EXECUTE_THREAD);
-    
-    // Execute the Poseidon G State Machine
-    TimerStart(BITS2FIELD_SM_EXECUTE_THREAD);
-    pExecutorContext->pExecutor->bits2FieldExecutor.execute(pExecutorContext->pRequired->Bits2Field, pExecutorContext->pCommitPols->Bits2Field, pExecutorContext->pRequired->KeccakF);
-    TimerStopAndLog(BITS2FIELD_SM_EXECUTE_THREAD);
-    
-    // Execute the Keccak F State Machine
-    TimerStart(KECCAK_F_SM_EXECUTE_THREAD);
-    pExecutorContext->pExecutor->keccakFExecutor.execute(pExecutorContext->pRequired->KeccakF, pExecutorContext->pCommitPols->KeccakF);
-    TimerStopAndLog(KECCAK_F_SM_EXECUTE_THREAD);
+public:
+    string name;
+    void (*function)(ExecutorContext &ctx);
+    vector<uint64_t> predecessors;
+    vector<uint64_t> successors;
+    uint64_t pending; // Number of predecessors not done yet
+    uint64_t duration; // Execution time, in us
+};
+
+// Dependency graph of the secondary state machines, executed by a pool of threads that pick the
+// tasks as soon as they are ready; tasks must be added after their predecessors
+class ExecutorTaskGraph
+{
+public:
+    ExecutorContext &ctx;
+    vector<ExecutorTask> tasks;
+    vector<uint64_t> ready;
+    uint64_t done;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+
+    ExecutorTaskGraph(ExecutorContext &ctx) : ctx(ctx), done(0)
+    {
+        pthread_mutex_init(&mutex, NULL);
+        pthread_cond_init(&cond, NULL);
+    };
+    ~ExecutorTaskGraph()
+    {
+        pthread_mutex_destroy(&mutex);
+        pthread_cond_destroy(&cond);
+    };
+
+    uint64_t add (const string &name, void (*function)(ExecutorContext &ctx), const vector<uint64_t> &predecessors = {})
+    {
+        ExecutorTask task;
+        task.name = name;
+        task.function = function;
+        task.predecessors = predecessors;
+        task.pending = predecessors.size();
+        task.duration = 0;
+        uint64_t id = tasks.size();
+        for (uint64_t i = 0; i < predecessors.size(); i++)
+        {
+            zkassert(predecessors[i] < id);
+            tasks[predecessors[i]].successors.push_back(id);
+        }
+        tasks.push_back(task);
+        return id;
+    }
 
+    // Executes all tasks, and returns the critical path length, in us
+    uint64_t run (void);
+
+    void worker (void);
+};
+
+void * ExecutorTaskGraphWorker (void * arg)
+{
+    ((ExecutorTaskGraph *)arg)->worker();
     return NULL;
 }
 
+void ExecutorTaskGraph::worker (void)
+{
+    pthread_mutex_lock(&mutex);
+    while (true)
+    {
+        while (ready.empty() && (done < tasks.size()))
+        {
+            pthread_cond_wait(&cond, &mutex);
+        }
+        if (done == tasks.size())
+        {
+            break;
+        }
+        uint64_t id = ready.front();
+        ready.erase(ready.begin());
+        pthread_mutex_unlock(&mutex);
+
+        struct timeval t;
+        gettimeofday(&t, NULL);
+        tasks[id].function(ctx);
+        tasks[id].duration = TimeDiff(t);
+        zklog.info("ExecutorTaskGraph::worker() " + tasks[id].name + " done: " + to_string(double(tasks[id].duration)/1000000) + " s");
+
+        pthread_mutex_lock(&mutex);
+        done++;
+        for (uint64_t i = 0; i < tasks[id].successors.size(); i++)
+        {
+            uint64_t s = tasks[id].successors[i];
+            tasks[s].pending--;
+            if (tasks[s].pending == 0)
+            {
+                ready.push_back(s);
+            }
+        }
+        pthread_cond_broadcast(&cond);
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+uint64_t ExecutorTaskGraph::run (void)
+{
+    // Start with the tasks without predecessors, one thread each, since this is the maximum parallelism
+    for (uint64_t i = 0; i < tasks.size(); i++)
+    {
+        if (tasks[i].pending == 0)
+        {
+            ready.push_back(i);
+        }
+    }
+    vector<pthread_t> threads(ready.size());
+    for (uint64_t i = 0; i < threads.size(); i++)
+    {
+        pthread_create(&threads[i], NULL, ExecutorTaskGraphWorker, this);
+    }
+    for (uint64_t i = 0; i < threads.size(); i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    // The critical path is the longest chain of dependent tasks, using their actual duration
+    vector<uint64_t> finish(tasks.size(), 0);
+    vector<uint64_t> previous(tasks.size(), tasks.size());
+    uint64_t last = 0;
+    for (uint64_t i = 0; i < tasks.size(); i++)
+    {
+        for (uint64_t p = 0; p < tasks[i].predecessors.size(); p++)
+        {
+            uint64_t pred = tasks[i].predecessors[p];
+            if (finish[pred] > finish[i])
+            {
+                finish[i] = finish[pred];
+                previous[i] = pred;
+            }
+        }
+        finish[i] += tasks[i].duration;
+        if (finish[i] > finish[last]) last = i;
+    }
+    string path = tasks[last].name;
+    for (uint64_t i = previous[last]; i < tasks.size(); i = previous[i])
+    {
+        path = tasks[i].name + " -> " + path;
+    }
+    zklog.info("ExecutorTaskGraph::run() critical path: " + to_string(double(finish[last])/1000000) + " s " + path);
+
+    return finish[last];
+}
+
 // Full version: all polynomials are evaluated, in all evaluations
 void Executor::execute (ProverRequest &proverRequest, PROVER_FORK_NAMESPACE::CommitPols & commitPols)
 {
@@ -304,11 +418,13 @@ void Executor::execute (ProverRequest &proverRequest, PROVER_FORK_NAMESPACE::Com
         TimerStart(MAIN_EXECUTOR_EXECUTE);
         if (proverRequest.input.publicInputsExtended.publicInputs.forkID == PROVER_FORK_ID)
         {
+#ifdef __MAIN_EXEC_GENERATED__
             if (config.useMainExecGenerated)
             {
                 PROVER_FORK_NAMESPACE::main_exec_generated(mainExecutor_fork_5, proverRequest, commitPols.Main, required);
             }
             else
+#endif
             {
                 mainExecutor_fork_5.execute(proverRequest, commitPols.Main, required);
             }
@@ -399,11 +515,13 @@ void Executor::execute (ProverRequest &proverRequest, PROVER_FORK_NAMESPACE::Com
 
         // Execute the Main State Machine
         TimerStart(MAIN_EXECUTOR_EXECUTE);
+#ifdef __MAIN_EXEC_GENERATED__
         if (config.useMainExecGenerated)
         {
             PROVER_FORK_NAMESPACE::main_exec_generated(mainExecutor_fork_5, proverRequest, commitPols.Main, required);
         }
         else
+#endif
         {
             mainExecutor_fork_5.execute(proverRequest, commitPols.Main, required);
         }
@@ -424,36 +542,21 @@ void Executor::execute (ProverRequest &proverRequest, PROVER_FORK_NAMESPACE::Com
             return;
         }
 
-        // Execute the Padding PG, Storage and Poseidon G State Machines
-        pthread_t poseidonThread;
-        pthread_create(&poseidonThread, NULL, PoseidonThread, &executorContext);
-
-        // Execute the Arith State Machine, in parallel
-        pthread_t arithThread;
-        pthread_create(&arithThread, NULL, ArithThread, &executorContext);
-
-        // Execute the Binary State Machine, in parallel
-        pthread_t binaryThread;
-        pthread_create(&binaryThread, NULL, BinaryThread, &executorContext);
-
-        // Execute the Mem Align State Machine, in parallel
-        pthread_t memAlignThread;
-        pthread_create(&memAlignThread, NULL, MemAlignThread, &executorContext);
-        
-        // Execute the Memory State Machine, in parallel
-        pthread_t memoryThread;
-        pthread_create(&memoryThread, NULL, MemoryThread, &executorContext);
-
-        // Execute the PaddingKK, PaddingKKBit, Bits2Field, Keccak F and NormGate9 State Machines
-        pthread_t keccakThread;
-        pthread_create(&keccakThread, NULL, KeccakThread, &executorContext);
-
-        // Wait for the parallel SM threads
-        pthread_join(binaryThread, NULL);
-        pthread_join(memAlignThread, NULL);
-        pthread_join(memoryThread, NULL);
-        pthread_join(arithThread, NULL);
-        pthread_join(poseidonThread, NULL);
-        pthread_join(keccakThread, NULL);
+        // Execute the rest of State Machines as soon as their required data is complete
+        TimerStart(SECONDARY_SMS_EXECUTE);
+        ExecutorTaskGraph graph(executorContext);
+        uint64_t paddingPG = graph.add("PaddingPG", PaddingPGTask);
+        uint64_t storage = graph.add("Storage", StorageTask);
+        graph.add("Arith", ArithTask);
+        graph.add("Binary", BinaryTask);
+        graph.add("MemAlign", MemAlignTask);
+        graph.add("Memory", MemoryTask);
+        uint64_t paddingKK = graph.add("PaddingKK", PaddingKKTask);
+        uint64_t paddingKKBit = graph.add("PaddingKKBit", PaddingKKBitTask, {paddingKK});
+        uint64_t bits2Field = graph.add("Bits2Field", Bits2FieldTask, {paddingKKBit});
+        graph.add("KeccakF", KeccakFTask, {bits2Field});
+        graph.add("PoseidonG", PoseidonGTask, {paddingPG, storage});
+        graph.run();
+        TimerStopAndLog(SECONDARY_SMS_EXECUTE);
     }
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include <iostream>
 #include <thread>
+#include <functional>
+#include <algorithm>
 #include "database.hpp"
 #include "config.hpp"
 #include "scalar.hpp"
@@ -31,6 +33,14 @@ bool Database::useAssociativeCache = false;
 
 #endif
 
+DatabaseFileStore Database::dbFileStore;
+
+// Maximum number of keys requested in a single query by readManyRemote()
+#define DATABASE_READ_MANY_CHUNK_SIZE 1000
+
+// Maximum number of threads, and therefore of pool connections, used by a single readManyRemote() call
+#define DATABASE_READ_MANY_MAX_THREADS 8
+
 // Helper functions
 string removeBSXIfExists(string s) {return ((s.at(0) == '\\') && (s.at(1) == 'x')) ? s.substr(2) : s;}
 
@@ -42,14 +52,35 @@ Database::Database (Goldilocks &fr, const Config &config) :
 {
     // Init mutex
     pthread_mutex_init(&connMutex, NULL);
+    pthread_mutex_init(&readManyMutex, NULL);
 
     // Initialize semaphores
     sem_init(&senderSem, 0, 0);
     sem_init(&getFlushDataSem, 0, 0);
+    sem_init(&readManySem, 0, 0);
 };
 
 Database::~Database()
 {
+    // Stop the readManyRemote() worker threads before releasing their connections
+    if (readManyPthreads.size() > 0)
+    {
+        pthread_mutex_lock(&readManyMutex);
+        for (uint64_t i=0; i<readManyPthreads.size(); i++)
+        {
+            readManyRequests.push_back({NULL, NULL, NULL, NULL, NULL});
+        }
+        pthread_mutex_unlock(&readManyMutex);
+        for (uint64_t i=0; i<readManyPthreads.size(); i++)
+        {
+            sem_post(&readManySem);
+        }
+        for (uint64_t i=0; i<readManyPthreads.size(); i++)
+        {
+            pthread_join(readManyPthreads[i], NULL);
+        }
+    }
+
     if (config.dbConnectionsPool)
     {
         if (connectionsPool != NULL)
@@ -97,7 +128,16 @@ void Database::init(void)
 
         }
 
-        initRemote();
+        // Both the embedded file store and the remote database are persistent databases, accessed
+        // through the same read/write/multi-write paths
+        if (config.databaseURL.substr(0, 7) == "file://")
+        {
+            initFileStore();
+        }
+        else
+        {
+            initRemote();
+        }
         useRemoteDB = true;
     }
     else
@@ -134,7 +174,7 @@ zkresult Database::read(const string &_key, Goldilocks::Element (&vkey)[4], vect
         if (dbReadLog != NULL) dbReadLog->add(key, value, true, TimeDiff(t));
         r = ZKR_SUCCESS;
 
-    } else if( dbMTCache.enabled() && dbMTCache.find(key, value)){
+    } else if( dbMTCache.enabled() && dbMTCache.find(vkey, value)){
         
         if (dbReadLog != NULL) dbReadLog->add(key, value, true, TimeDiff(t));
         r = ZKR_SUCCESS;
@@ -153,13 +193,13 @@ zkresult Database::read(const string &_key, Goldilocks::Element (&vkey)[4], vect
             dbMTACache.addKeyValue(vkey, value, false);
         }
         else if(dbMTCache.enabled()){                
-            dbMTCache.add(key, value, false);
+            dbMTCache.add(vkey, value, false);
         }
 #endif
         r = ZKR_SUCCESS;
     }
     // If get tree is configured, read the tree from the branch (key hash) to the leaf (keys since level)
-    else if (config.dbGetTree && (keys != NULL))
+    else if (config.dbGetTree && !useFileStore && (keys != NULL))
     {
         // Get the tree
         uint64_t numberOfFields;
@@ -204,7 +244,7 @@ zkresult Database::read(const string &_key, Goldilocks::Element (&vkey)[4], vect
             if (usingAssociativeCache() && dbMTACache.findKey(vkey,value)){
                 if (dbReadLog != NULL) dbReadLog->add(key, value, true, TimeDiff(t));
                 r = ZKR_SUCCESS;
-            }else if(dbMTCache.enabled() && dbMTCache.find(key, value)){
+            }else if(dbMTCache.enabled() && dbMTCache.find(vkey, value)){
                 if (dbReadLog != NULL) dbReadLog->add(key, value, true, TimeDiff(t));
                 r = ZKR_SUCCESS;                
             }
@@ -253,7 +293,7 @@ zkresult Database::read(const string &_key, Goldilocks::Element (&vkey)[4], vect
             if(usingAssociativeCache()){
                 dbMTACache.addKeyValue(vkey, value, update);
             }else if (dbMTCache.enabled()){
-                dbMTCache.add(key, value, update);
+                dbMTCache.add(vkey, value, update);
             }
 #endif
 
@@ -285,6 +325,117 @@ zkresult Database::read(const string &_key, Goldilocks::Element (&vkey)[4], vect
     return r;
 }
 
+zkresult Database::readMany(const vector<string> &_keys, DatabaseMap::MTMap &values, DatabaseMap *dbReadLog)
+{
+    // Check that it has been initialized before
+    if (!bInitialized)
+    {
+        zklog.error("Database::readMany() called uninitialized");
+        exitProcess();
+    }
+
+    struct timeval t;
+    if (dbReadLog != NULL) gettimeofday(&t, NULL);
+
+    // Keys that could not be found in memory, to be read from the remote database
+    vector<string> remoteKeys;
+
+    for (uint64_t i=0; i<_keys.size(); i++)
+    {
+        // Normalize key format
+        string key = NormalizeToNFormat(_keys[i], 64);
+        key = stringToLower(key);
+
+        // Skip duplicated keys
+        if (values.find(key) != values.end())
+        {
+            continue;
+        }
+
+        vector<Goldilocks::Element> value;
+
+#ifdef DATABASE_USE_CACHE
+        Goldilocks::Element vkey[4];
+        string2key(fr, key, vkey);
+
+        // If the key is found in local database (cached) simply return it
+        if ( (usingAssociativeCache() && dbMTACache.findKey(vkey, value)) ||
+             (dbMTCache.enabled() && dbMTCache.find(vkey, value)) )
+        {
+            if (dbReadLog != NULL) dbReadLog->add(key, value, true, TimeDiff(t));
+            values[key] = value;
+            continue;
+        }
+#endif
+        // If the key is pending to be stored in database, but already deleted from cache
+        if (config.dbMultiWrite && multiWrite.findNode(key, value))
+        {
+            if (dbReadLog != NULL) dbReadLog->add(key, value, true, TimeDiff(t));
+#ifdef DATABASE_USE_CACHE
+            // Store it locally to avoid any future remote access for this key
+            if (usingAssociativeCache())
+            {
+                dbMTACache.addKeyValue(vkey, value, false);
+            }
+            else if (dbMTCache.enabled())
+            {
+                dbMTCache.add(vkey, value, false);
+            }
+#endif
+            values[key] = value;
+            continue;
+        }
+
+        remoteKeys.push_back(key);
+    }
+
+    if (!useRemoteDB || remoteKeys.empty())
+    {
+        return ZKR_SUCCESS;
+    }
+
+    // Read all the missing keys remotely, in as few queries as possible
+    unordered_map<string, string> remoteValues;
+    zkresult r = readManyRemote(remoteKeys, remoteValues);
+    if (r != ZKR_SUCCESS)
+    {
+        zklog.error("Database::readMany() failed calling readManyRemote() with error=" + zkresult2string(r) + " keys=" + to_string(remoteKeys.size()));
+        return r;
+    }
+
+    unordered_map<string, string>::const_iterator it;
+    for (it = remoteValues.begin(); it != remoteValues.end(); it++)
+    {
+        vector<Goldilocks::Element> value;
+        string2fea(fr, it->second, value);
+
+#ifdef DATABASE_USE_CACHE
+        // Store it locally to avoid any future remote access for this key
+        Goldilocks::Element vkey[4];
+        string2key(fr, it->first, vkey);
+        if (usingAssociativeCache())
+        {
+            dbMTACache.addKeyValue(vkey, value, false);
+        }
+        else if (dbMTCache.enabled())
+        {
+            dbMTCache.add(vkey, value, false);
+        }
+#endif
+
+        // Add to the read log
+        if (dbReadLog != NULL) dbReadLog->add(it->first, value, false, TimeDiff(t));
+
+        values[it->first] = value;
+    }
+
+#ifdef LOG_DB_READ
+    zklog.info("Database::readMany() keys=" + to_string(_keys.size()) + " remoteKeys=" + to_string(remoteKeys.size()) + " remoteValues=" + to_string(remoteValues.size()));
+#endif
+
+    return ZKR_SUCCESS;
+}
+
 zkresult Database::write(const string &_key, const Goldilocks::Element* vkey, const vector<Goldilocks::Element> &value, const bool persistent)
 {
     // Check that it has  been initialized before
@@ -330,19 +481,19 @@ zkresult Database::write(const string &_key, const Goldilocks::Element* vkey, co
 #ifdef DATABASE_USE_CACHE
     if ((r == ZKR_SUCCESS) && (dbMTCache.enabled() || dbMTACache.enabled()))
     {
+        Goldilocks::Element vkeyf[4];
+        if(vkey == NULL){
+            string2key(fr, key, vkeyf);
+        }else{
+            vkeyf[0] = vkey[0];
+            vkeyf[1] = vkey[1];
+            vkeyf[2] = vkey[2];
+            vkeyf[3] = vkey[3];
+        }
         if(usingAssociativeCache()){
-            Goldilocks::Element vkeyf[4];
-            if(vkey == NULL){
-                string2key(fr, _key, vkeyf);
-            }else{
-                vkeyf[0] = vkey[0];
-                vkeyf[1] = vkey[1];
-                vkeyf[2] = vkey[2];
-                vkeyf[3] = vkey[3];
-            }
             dbMTACache.addKeyValue(vkeyf, value, false);
         }else{
-            dbMTCache.add(key, value, false);
+            dbMTCache.add(vkeyf, value, false);
         }
     }
 #endif
@@ -400,6 +551,11 @@ void Database::initRemote(void)
                 zklog.error("Database::initRemote() found config.maxHashDBThreads + config.maxExecutorThreads + 1=" + to_string(config.maxHashDBThreads + config.maxExecutorThreads + 1) + " > config.dbNumberOfPoolConnections=" + to_string(config.dbNumberOfPoolConnections));
                 exitProcess();
             }
+            if ( config.loadDBToMemCache && (config.loadDBToMemCacheThreads + 1 > config.dbNumberOfPoolConnections) )
+            {
+                zklog.error("Database::initRemote() found config.loadDBToMemCacheThreads + 1=" + to_string(config.loadDBToMemCacheThreads + 1) + " > config.dbNumberOfPoolConnections=" + to_string(config.dbNumberOfPoolConnections));
+                exitProcess();
+            }
 
             // Allocate write connections pool
             connectionsPool = new DatabaseConnection[config.dbNumberOfPoolConnections];
@@ -438,6 +594,16 @@ void Database::initRemote(void)
         }
         
         connUnlock();
+
+        // Create the readManyRemote() worker threads, every one of them using its own pool connection when it is free
+        if (config.dbConnectionsPool)
+        {
+            readManyPthreads.resize(zkmin((uint64_t)DATABASE_READ_MANY_MAX_THREADS - 1, config.dbNumberOfPoolConnections/2));
+            for (uint64_t i=0; i<readManyPthreads.size(); i++)
+            {
+                pthread_create(&readManyPthreads[i], NULL, dbReadManyThread, this);
+            }
+        }
     }
     catch (const std::exception &e)
     {
@@ -460,42 +626,39 @@ void Database::initRemote(void)
     TimerStopAndLog(DB_INIT_REMOTE);
 }
 
+void Database::initFileStore(void)
+{
+    TimerStart(DB_INIT_FILE_STORE);
+
+    useFileStore = true;
+
+    zkresult zkr = dbFileStore.open(config.databaseURL.substr(7), config.dbFileCompactionThreshold, config.dbReadOnly);
+    if (zkr != ZKR_SUCCESS)
+    {
+        zklog.error("Database::initFileStore() failed calling dbFileStore.open() result=" + zkresult2string(zkr) + " databaseURL=" + config.databaseURL);
+        exitProcess();
+    }
+
+    // Create state root, only useful if database is empty
+    if (!config.dbReadOnly)
+    {
+        createStateRoot();
+    }
+
+    TimerStopAndLog(DB_INIT_FILE_STORE);
+}
+
 DatabaseConnection * Database::getConnection (void)
 {
     if (config.dbConnectionsPool)
     {
         connLock();
-        DatabaseConnection * pConnection = NULL;
-        uint64_t i=0;
-        for (i=0; i<config.dbNumberOfPoolConnections; i++)
-        {
-            if (!connectionsPool[nextConnection].bInUse) break;
-            nextConnection++;
-            if (nextConnection == config.dbNumberOfPoolConnections)
-            {
-                nextConnection = 0;
-            }
-        }
-        if (i==config.dbNumberOfPoolConnections)
+        DatabaseConnection * pConnection = reserveConnection();
+        if (pConnection == NULL)
         {
             zklog.error("Database::getWriteConnection() run out of free connections");
             exitProcess();
         }
-
-        pConnection = &connectionsPool[nextConnection];
-        zkassert(pConnection->bInUse == false);
-        pConnection->bInUse = true;
-        nextConnection++;
-        if (nextConnection == config.dbNumberOfPoolConnections)
-        {
-            nextConnection = 0;
-        }
-        usedConnections++;
-        if (pConnection->bDisconnect)
-        {
-            pConnection->pConnection->disconnect();
-            pConnection->bDisconnect = false;
-        }
         //zklog.info("Database::getWriteConnection() pConnection=" + to_string((uint64_t)pConnection) + " nextConnection=" + to_string(nextConnection) + " usedConnections=" + to_string(usedConnections));
         connUnlock();
         return pConnection;
@@ -511,6 +674,59 @@ DatabaseConnection * Database::getConnection (void)
     }
 }
 
+DatabaseConnection * Database::tryGetConnection (void)
+{
+    if (!config.dbConnectionsPool)
+    {
+        return NULL;
+    }
+
+    // Check and reserve under the same lock, so that concurrent callers cannot take more connections than allowed
+    connLock();
+    DatabaseConnection * pConnection = NULL;
+    if ((usedConnections + 1)*2 <= config.dbNumberOfPoolConnections)
+    {
+        pConnection = reserveConnection();
+    }
+    connUnlock();
+
+    return pConnection;
+}
+
+DatabaseConnection * Database::reserveConnection (void)
+{
+    uint64_t i=0;
+    for (i=0; i<config.dbNumberOfPoolConnections; i++)
+    {
+        if (!connectionsPool[nextConnection].bInUse) break;
+        nextConnection++;
+        if (nextConnection == config.dbNumberOfPoolConnections)
+        {
+            nextConnection = 0;
+        }
+    }
+    if (i==config.dbNumberOfPoolConnections)
+    {
+        return NULL;
+    }
+
+    DatabaseConnection * pConnection = &connectionsPool[nextConnection];
+    zkassert(pConnection->bInUse == false);
+    pConnection->bInUse = true;
+    nextConnection++;
+    if (nextConnection == config.dbNumberOfPoolConnections)
+    {
+        nextConnection = 0;
+    }
+    usedConnections++;
+    if (pConnection->bDisconnect)
+    {
+        pConnection->pConnection->disconnect();
+        pConnection->bDisconnect = false;
+    }
+    return pConnection;
+}
+
 void Database::disposeConnection (DatabaseConnection * pConnection)
 {
     if (config.dbConnectionsPool)
@@ -555,6 +771,11 @@ zkresult Database::readRemote(bool bProgram, const string &key, string &value)
         zklog.info("Database::readRemote() table=" + tableName + " key=" + key);
     }
 
+    if (useFileStore)
+    {
+        return dbFileStore.read(bProgram, key, value);
+    }
+
     // Get a free read db connection
     DatabaseConnection * pDatabaseConnection = getConnection();
 
@@ -609,6 +830,160 @@ zkresult Database::readRemote(bool bProgram, const string &key, string &value)
     return ZKR_SUCCESS;
 }
 
+zkresult Database::readManyRemote(const vector<string> &keys, unordered_map<string, string> &values)
+{
+    const string &tableName = config.dbNodesTableName;
+
+    if (config.logRemoteDbReads)
+    {
+        zklog.info("Database::readManyRemote() table=" + tableName + " keys=" + to_string(keys.size()));
+    }
+
+    if (useFileStore)
+    {
+        for (uint64_t i=0; i<keys.size(); i++)
+        {
+            string value;
+            zkresult zkr = dbFileStore.read(false, keys[i], value);
+            if (zkr == ZKR_SUCCESS)
+            {
+                values[keys[i]] = value;
+            }
+            else if (zkr != ZKR_DB_KEY_NOT_FOUND)
+            {
+                return zkr;
+            }
+        }
+        return ZKR_SUCCESS;
+    }
+
+    // Get a free read db connection
+    DatabaseConnection * pDatabaseConnection = getConnection();
+
+    // Read the chunks in parallel: this thread and the worker threads take the next chunk until they run out,
+    // every worker using its own connection of the pool while at least half of the pool remains free
+    uint64_t numberOfChunks = (keys.size() + DATABASE_READ_MANY_CHUNK_SIZE - 1) / DATABASE_READ_MANY_CHUNK_SIZE;
+    uint64_t numberOfRequests = (numberOfChunks > 1) ? zkmin(numberOfChunks - 1, (uint64_t)readManyPthreads.size()) : 0;
+    atomic<uint64_t> nextChunk(0);
+    vector<unordered_map<string, string>> requestsValues(numberOfRequests);
+    vector<zkresult> requestsResults(numberOfRequests, ZKR_SUCCESS);
+    sem_t doneSem;
+    sem_init(&doneSem, 0, 0);
+    if (numberOfRequests > 0)
+    {
+        pthread_mutex_lock(&readManyMutex);
+        for (uint64_t r=0; r<numberOfRequests; r++)
+        {
+            readManyRequests.push_back({&keys, &nextChunk, &requestsValues[r], &requestsResults[r], &doneSem});
+        }
+        pthread_mutex_unlock(&readManyMutex);
+        for (uint64_t r=0; r<numberOfRequests; r++)
+        {
+            sem_post(&readManySem);
+        }
+    }
+
+    zkresult zkr;
+    readManyRemoteChunks(pDatabaseConnection, keys, nextChunk, values, zkr);
+    for (uint64_t r=0; r<numberOfRequests; r++)
+    {
+        sem_wait(&doneSem);
+    }
+    sem_destroy(&doneSem);
+    for (uint64_t r=0; r<numberOfRequests; r++)
+    {
+        if (requestsResults[r] != ZKR_SUCCESS)
+        {
+            zkr = requestsResults[r];
+        }
+        values.insert(requestsValues[r].begin(), requestsValues[r].end());
+    }
+
+    return zkr;
+}
+
+void Database::readManyWorker (void)
+{
+    while (true)
+    {
+        // Wait for a request
+        sem_wait(&readManySem);
+        pthread_mutex_lock(&readManyMutex);
+        zkassert(readManyRequests.size() > 0);
+        ReadManyRequest request = readManyRequests.front();
+        readManyRequests.pop_front();
+        pthread_mutex_unlock(&readManyMutex);
+
+        if (request.pKeys == NULL)
+        {
+            return;
+        }
+
+        // If the pool is busy, the caller reads the remaining chunks itself
+        DatabaseConnection * pDatabaseConnection = tryGetConnection();
+        if (pDatabaseConnection != NULL)
+        {
+            readManyRemoteChunks(pDatabaseConnection, *request.pKeys, *request.pNextChunk, *request.pValues, *request.pResult);
+        }
+        sem_post(request.pDoneSem);
+    }
+}
+
+void Database::readManyRemoteChunks(DatabaseConnection * pDatabaseConnection, const vector<string> &keys, atomic<uint64_t> &nextChunk, unordered_map<string, string> &values, zkresult &zkr)
+{
+    const string &tableName = config.dbNodesTableName;
+
+    zkr = ZKR_SUCCESS;
+
+    try
+    {
+        for (uint64_t chunk = nextChunk++ * DATABASE_READ_MANY_CHUNK_SIZE; chunk<keys.size(); chunk = nextChunk++ * DATABASE_READ_MANY_CHUNK_SIZE)
+        {
+            // Prepare the query, requesting all the keys of this chunk at once
+            uint64_t chunkEnd = zkmin(chunk + DATABASE_READ_MANY_CHUNK_SIZE, keys.size());
+            string query = "SELECT hash, data FROM " + tableName + " WHERE hash IN (";
+            for (uint64_t i=chunk; i<chunkEnd; i++)
+            {
+                if (i != chunk) query += ", ";
+                query += "E\'\\\\x" + keys[i] + "\'";
+            }
+            query += ");";
+
+            pqxx::result rows;
+
+            // Start a transaction.
+            pqxx::nontransaction n(*(pDatabaseConnection->pConnection));
+
+            // Execute the query
+            rows = n.exec(query);
+
+            // Commit your transaction
+            n.commit();
+
+            // Process the result; keys that are not present are simply not returned
+            for (uint64_t i=0; i<rows.size(); i++)
+            {
+                pqxx::row const row = rows[i];
+                if (row.size() != 2)
+                {
+                    zklog.error("Database::readManyRemoteChunks() table=" + tableName + " got an invalid number of colums for the row: " + to_string(row.size()));
+                    exitProcess();
+                }
+                values[removeBSXIfExists(row[0].c_str())] = removeBSXIfExists(row[1].c_str());
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        zklog.error("Database::readManyRemoteChunks() table=" + tableName + " exception: " + string(e.what()) + " connection=" + to_string((uint64_t)pDatabaseConnection));
+        queryFailed();
+        zkr = ZKR_DB_ERROR;
+    }
+
+    // Dispose the read db conneciton
+    disposeConnection(pDatabaseConnection);
+}
+
 zkresult Database::readTreeRemote(const string &key, bool *keys, uint64_t level, uint64_t &numberOfFields)
 {
     zkassert(keys != NULL);
@@ -697,13 +1072,13 @@ zkresult Database::readTreeRemote(const string &key, bool *keys, uint64_t level,
             if (dbMTCache.enabled() || dbMTACache.enabled())
             {
                 //zklog.info("Database::readTreeRemote() adding hash=" + hash + " to dbMTCache");
+                Goldilocks::Element vhash[4];
+                string2key(fr, hash, vhash);
                 if(usingAssociativeCache()){
-                    Goldilocks::Element vhash[4];
-                    string2key(fr, hash, vhash);   
                     dbMTACache.addKeyValue(vhash, value, false);
                 }else{
-                    dbMTCache.add(hash, value, false);
-              }
+                    dbMTCache.add(vhash, value, false);
+                }
             }
 #endif
         }
@@ -750,6 +1125,10 @@ zkresult Database::writeRemote(bool bProgram, const string &key, const string &v
 
         multiWrite.Unlock();
     }
+    else if (useFileStore)
+    {
+        result = dbFileStore.write(bProgram, key, value, false);
+    }
     else
     {
         const string &tableName = (bProgram ? config.dbProgramTableName : config.dbNodesTableName);
@@ -807,7 +1186,11 @@ zkresult Database::createStateRoot(void)
 
     zkresult r = ZKR_SUCCESS;
 
-    if (!config.dbReadOnly)
+    if (!config.dbReadOnly && useFileStore)
+    {
+        r = dbFileStore.write(false, dbStateRootKey, valueString, false);
+    }
+    else if (!config.dbReadOnly)
     {
         // Prepare the query
         string query = "INSERT INTO " + config.dbNodesTableName + " ( hash, data ) VALUES ( E\'\\\\x" + dbStateRootKey + "\', E\'\\\\x" + valueString + "\' ) " +
@@ -893,6 +1276,10 @@ zkresult Database::updateStateRoot(const Goldilocks::Element (&stateRoot)[4])
             multiWrite.data[multiWrite.pendingToFlushDataIndex].nodesStateRoot = valueString;
             multiWrite.Unlock();    
         }
+        else if (useFileStore)
+        {
+            r = dbFileStore.write(false, dbStateRootKey, valueString, true);
+        }
         else
         {
             // Prepare the query
@@ -938,7 +1325,7 @@ zkresult Database::updateStateRoot(const Goldilocks::Element (&stateRoot)[4])
         if(usingAssociativeCache()){
                 dbMTACache.addKeyValue(dbStateRootvKey, value, true);
         }else{
-                dbMTCache.add(dbStateRootKey, value, true);
+                dbMTCache.add(dbStateRootvKey, value, true);
         }
     }
 #endif
@@ -1334,7 +1721,7 @@ void Database::semiFlush (void)
     multiWrite.Unlock();
 }
 
-zkresult Database::getFlushStatus(uint64_t &storedFlushId, uint64_t &storingFlushId, uint64_t &lastFlushId, uint64_t &pendingToFlushNodes, uint64_t &pendingToFlushProgram, uint64_t &storingNodes, uint64_t &storingProgram)
+zkresult Database::getFlushStatus(uint64_t &storedFlushId, uint64_t &storingFlushId, uint64_t &lastFlushId, uint64_t &pendingToFlushNodes, uint64_t &pendingToFlushProgram, uint64_t &storingNodes, uint64_t &storingProgram, uint64_t &storedBytesPerSecond, uint64_t &storedRowsPerSecond)
 {
     multiWrite.Lock();
     storedFlushId = multiWrite.storedFlushId;
@@ -1344,6 +1731,8 @@ zkresult Database::getFlushStatus(uint64_t &storedFlushId, uint64_t &storingFlus
     pendingToFlushProgram = multiWrite.data[multiWrite.pendingToFlushDataIndex].program.size();
     storingNodes = multiWrite.data[multiWrite.storingDataIndex].nodes.size();
     storingProgram = multiWrite.data[multiWrite.storingDataIndex].program.size();
+    storedBytesPerSecond = multiWrite.storedBytesPerSecond;
+    storedRowsPerSecond = multiWrite.storedRowsPerSecond;
     multiWrite.Unlock();
     return ZKR_SUCCESS;
 }
@@ -1356,6 +1745,7 @@ zkresult Database::sendData (void)
     struct timeval t;
     uint64_t timeDiff = 0;
     uint64_t fields = 0;
+    uint64_t bytes = 0;
 
     // Select proper data instance
     MultiWriteData &data = multiWrite.data[multiWrite.storingDataIndex];
@@ -1374,12 +1764,66 @@ zkresult Database::sendData (void)
         return ZKR_SUCCESS;
     }
 
+    // Measure the throughput of this flush
+    gettimeofday(&t, NULL);
+    fields = data.nodes.size() + data.program.size() + (data.nodesStateRoot.size() > 0 ? 1 : 0);
+
+    // Embedded file store: append all records and sync them as a single commit of this flush ID
+    if (useFileStore)
+    {
+        zkr = dbFileStore.writeBatch(data.nodes, data.program, dbStateRootKey, data.nodesStateRoot, multiWrite.storingFlushId, bytes);
+        if (zkr != ZKR_SUCCESS)
+        {
+            zklog.error("Database::sendData() failed calling dbFileStore.writeBatch() result=" + zkresult2string(zkr));
+            return zkr;
+        }
+
+        timeDiff = TimeDiff(t);
+        if (config.dbMetrics)
+        {
+            zklog.info("Database::sendData() dbMetrics fileStore nodes=" + to_string(data.nodes.size()) +
+                " program=" + to_string(data.program.size()) +
+                " nodesStateRootCounter=" + to_string(data.nodesStateRoot.size() > 0 ? 1 : 0) +
+                " written=" + to_string(bytes) + "B" +
+                " total=" + to_string(fields) + "fields=" + to_string(timeDiff) + "us=" + to_string(timeDiff/zkmax(fields,1)) + "us/field");
+        }
+
+        data.stored = true;
+        setStored(bytes, fields, timeDiff);
+
+        return ZKR_SUCCESS;
+    }
+
+    // COPY writer: stream all rows into staging tables and upsert them in a single transaction
+    if (config.dbMultiWriteCopy)
+    {
+        zkr = sendDataCopy(data, bytes);
+        if (zkr != ZKR_SUCCESS)
+        {
+            return zkr;
+        }
+
+        timeDiff = TimeDiff(t);
+        if (config.dbMetrics)
+        {
+            zklog.info("Database::sendData() dbMetrics copy nodes=" + to_string(data.nodes.size()) +
+                " program=" + to_string(data.program.size()) +
+                " nodesStateRootCounter=" + to_string(data.nodesStateRoot.size() > 0 ? 1 : 0) +
+                " copy.size=" + to_string(bytes) + "B=" + to_string(bytes/zkmax(fields,1)) + "B/field" +
+                " total=" + to_string(fields) + "fields=" + to_string(timeDiff) + "us=" + to_string(timeDiff/zkmax(fields,1)) + "us/field");
+        }
+
+        data.stored = true;
+        setStored(bytes, fields, timeDiff);
+
+        return ZKR_SUCCESS;
+    }
+
     // Get a free write db connection
     DatabaseConnection * pDatabaseConnection = getConnection();
 
     try
     {
-        if (config.dbMetrics) gettimeofday(&t, NULL);
         unordered_map<string, string>::const_iterator it;
         if (data.multiQuery.isEmpty())
         {
@@ -1491,9 +1935,9 @@ zkresult Database::sendData (void)
         }
         else
         {
+            bytes = data.multiQuery.size();
             if (config.dbMetrics)
             {
-                fields = data.nodes.size() + data.program.size() + (data.nodesStateRoot.size() > 0 ? 1 : 0);
                 zklog.info("Database::sendData() dbMetrics multiWrite nodes=" + to_string(data.nodes.size()) +
                     " program=" + to_string(data.program.size()) +
                     " nodesStateRootCounter=" + to_string(data.nodesStateRoot.size() > 0 ? 1 : 0) +
@@ -1525,9 +1969,9 @@ zkresult Database::sendData (void)
             }
 
             //zklog.info("Database::flush() sent query=" + query);
+            timeDiff = TimeDiff(t);
             if (config.dbMetrics)
             {
-                timeDiff = TimeDiff(t);
                 zklog.info("Database::sendData() dbMetrics multiWrite total=" + to_string(fields) + "fields=" + to_string(timeDiff) + "us=" + to_string(timeDiff/zkmax(fields,1)) + "us/field");
             }
 
@@ -1550,9 +1994,7 @@ zkresult Database::sendData (void)
         }
 
         // If we succeeded, update last sent batch
-        multiWrite.Lock();
-        multiWrite.storedFlushId = multiWrite.storingFlushId;
-        multiWrite.Unlock();
+        setStored(bytes, fields, timeDiff);
     }
     catch (const std::exception &e)
     {
@@ -1568,6 +2010,90 @@ zkresult Database::sendData (void)
     return zkr;
 }
 
+zkresult Database::sendDataCopy (MultiWriteData &data, uint64_t &bytes)
+{
+    zkresult zkr = ZKR_SUCCESS;
+    bytes = 0;
+
+    // Get a free write db connection
+    DatabaseConnection * pDatabaseConnection = getConnection();
+
+    try
+    {
+        // Start a transaction; if anything fails, nothing is stored and the whole data will be sent again
+        pqxx::work w(*(pDatabaseConnection->pConnection));
+
+        for (uint64_t t=0; t<2; t++)
+        {
+            const unordered_map<string, string> &records = (t == 0) ? data.nodes : data.program;
+            if (records.size() == 0)
+            {
+                continue;
+            }
+            const string &tableName = (t == 0) ? config.dbNodesTableName : config.dbProgramTableName;
+
+            // Temporary tables belong to the connection and cannot have a schema, e.g. state.nodes -> state_nodes_copy
+            string stagingTableName = tableName + "_copy";
+            replace(stagingTableName.begin(), stagingTableName.end(), '.', '_');
+            w.exec("CREATE TEMP TABLE IF NOT EXISTS " + stagingTableName + " ( hash BYTEA NOT NULL, data BYTEA NOT NULL ) ON COMMIT DELETE ROWS;");
+
+            // Stream the rows in COPY text format; values are already in hexa, so bytea hexa format
+            // is used, with the backslash escaped as required by COPY
+            {
+                pqxx::stream_to stream(w, stagingTableName, vector<string>{"hash", "data"});
+                string line;
+                unordered_map<string, string>::const_iterator it;
+                for (it = records.begin(); it != records.end(); it++)
+                {
+                    line = "\\\\x" + it->first + "\t\\\\x" + it->second;
+                    stream.write_raw_line(line);
+                    bytes += line.size() + 1;
+#ifdef LOG_DB_SEND_DATA
+                    zklog.info("Database::sendDataCopy() copying " + string(t == 0 ? "node" : "program") + " key=" + it->first + " value=" + it->second);
+#endif
+                }
+                stream.complete();
+            }
+
+            w.exec("INSERT INTO " + tableName + " ( hash, data ) SELECT hash, data FROM " + stagingTableName + " ON CONFLICT (hash) DO NOTHING;");
+        }
+
+        // Update the state root
+        if (data.nodesStateRoot.size() > 0)
+        {
+            string query = "UPDATE " + config.dbNodesTableName + " SET data = E\'\\\\x" + data.nodesStateRoot + "\' WHERE hash = E\'\\\\x" + dbStateRootKey + "\';";
+            w.exec(query);
+            bytes += query.size();
+#ifdef LOG_DB_SEND_DATA
+            zklog.info("Database::sendDataCopy() updating root=" + data.nodesStateRoot);
+#endif
+        }
+
+        // Commit the transaction
+        w.commit();
+    }
+    catch (const std::exception &e)
+    {
+        zklog.error("Database::sendDataCopy() exception: " + string(e.what()));
+        queryFailed();
+        zkr = ZKR_DB_ERROR;
+    }
+
+    // Dispose the write db connection
+    disposeConnection(pDatabaseConnection);
+
+    return zkr;
+}
+
+void Database::setStored (uint64_t bytes, uint64_t rows, uint64_t time)
+{
+    multiWrite.Lock();
+    multiWrite.storedFlushId = multiWrite.storingFlushId;
+    multiWrite.storedBytesPerSecond = (bytes * 1000000) / zkmax(time, 1);
+    multiWrite.storedRowsPerSecond = (rows * 1000000) / zkmax(time, 1);
+    multiWrite.Unlock();
+}
+
 // Get flush data, written to database by dbSenderThread; it blocks
 zkresult Database::getFlushData(uint64_t flushId, uint64_t &storedFlushId, unordered_map<string, string> (&nodes), unordered_map<string, string> (&program), string &nodesStateRoot)
 {
@@ -1649,7 +2175,7 @@ void Database::printTree(const string &root, string prefix)
     string key = root;
     vector<Goldilocks::Element> value;
     Goldilocks::Element vKey[4];
-    if(Database::useAssociativeCache) string2key(fr, key, vKey);  
+    string2key(fr, NormalizeToNFormat(key, 64), vKey);
     read(key,vKey,value, NULL);
 
     if (value.size() != 12)
@@ -1742,6 +2268,13 @@ void Database::clearCache (void)
     dbProgramCache.clear();
 }
 
+void *dbReadManyThread (void *arg)
+{
+    Database *pDatabase = (Database *)arg;
+    pDatabase->readManyWorker();
+    return NULL;
+}
+
 void *dbSenderThread (void *arg)
 {
     Database *pDatabase = (Database *)arg;
@@ -1766,8 +2299,10 @@ void *dbSenderThread (void *arg)
 
         bool bDataEmpty = false;
 
-        // If sending data is not empty (it failed before) then try to send it again
-        if (!multiWrite.data[multiWrite.storingDataIndex].multiQuery.isEmpty())
+        // If sending data is not empty (it failed before) then try to send it again; the file store
+        // and the COPY writer do not build queries, so check the stored flag as well
+        if (!multiWrite.data[multiWrite.storingDataIndex].multiQuery.isEmpty() ||
+            (!multiWrite.data[multiWrite.storingDataIndex].stored && !multiWrite.data[multiWrite.storingDataIndex].IsEmpty()))
         {
             zklog.warning("dbSenderThread() found sending data index not empty, probably because of a previous error; resuming...");
         }
@@ -1953,6 +2488,197 @@ void *dbCacheSynchThread (void *arg)
     return NULL;
 }
 
+#ifdef DATABASE_USE_CACHE
+
+// Returns true if the MT cache is too full to keep on loading it
+static bool loadDb2MemCacheFull(void)
+{
+    if (Database::dbMTCache.enabled())
+    {
+        double sizePercentage = double(Database::dbMTCache.getCurrentSize())*100.0/double(Database::dbMTCache.getMaxSize());
+        if ( sizePercentage > 90 )
+        {
+            zklog.info("loadDb2MemCache() stopping since size percentage=" + to_string(sizePercentage));
+            return true;
+        }
+    }
+    return false;
+}
+
+// Reads the nodes in hashes, appends the hashes of the children of the intermediate nodes to children, and reads
+// the value nodes of the leaf nodes, which have no children and therefore are never expanded
+static void loadDb2MemCacheNodes(Database &db, const vector<string> &hashes, vector<string> &children, uint64_t &counter, zkresult &zkr)
+{
+    Goldilocks &fr = db.fr;
+    DatabaseMap::MTMap values;
+    zkr = db.readMany(hashes, values, NULL);
+    if (zkr != ZKR_SUCCESS)
+    {
+        return;
+    }
+    if (values.size() != hashes.size())
+    {
+        zklog.warning("loadDb2MemCache() found only " + to_string(values.size()) + " of " + to_string(hashes.size()) + " requested nodes");
+    }
+    counter = values.size();
+
+    vector<string> valueHashes;
+    DatabaseMap::MTMap::const_iterator it;
+    for (it = values.begin(); it != values.end(); it++)
+    {
+        const vector<Goldilocks::Element> &dbValue = it->second;
+
+        // Intermediate and leaf nodes have 12 elements
+        if (dbValue.size() != 12)
+        {
+            continue;
+        }
+
+        // If capacity is X000
+        if (fr.isZero(dbValue[9]) && fr.isZero(dbValue[10]) && fr.isZero(dbValue[11]))
+        {
+            // If capacity is 0000, this is an intermediate node that contains left and right hashes of its children
+            if (fr.isZero(dbValue[8]))
+            {
+                string leftHash = fea2string(fr, dbValue[0], dbValue[1], dbValue[2], dbValue[3]);
+                if (leftHash != "0")
+                {
+                    children.push_back(leftHash);
+                }
+                string rightHash = fea2string(fr, dbValue[4], dbValue[5], dbValue[6], dbValue[7]);
+                if (rightHash != "0")
+                {
+                    children.push_back(rightHash);
+                }
+            }
+            // If capacity is 1000, this is a leaf node that contains right hash of the value node
+            else if (fr.isOne(dbValue[8]))
+            {
+                string rightHash = fea2string(fr, dbValue[4], dbValue[5], dbValue[6], dbValue[7]);
+                if (rightHash != "0")
+                {
+                    valueHashes.push_back(rightHash);
+                }
+            }
+        }
+    }
+
+    // Read the value nodes, which also have capacity 0000, so that they are not taken as intermediate nodes;
+    // leaves with the same value share the same value node
+    if (valueHashes.size() > 0)
+    {
+        sort(valueHashes.begin(), valueHashes.end());
+        valueHashes.erase(unique(valueHashes.begin(), valueHashes.end()), valueHashes.end());
+        DatabaseMap::MTMap valueNodes;
+        zkr = db.readMany(valueHashes, valueNodes, NULL);
+        if (zkr != ZKR_SUCCESS)
+        {
+            return;
+        }
+        if (valueNodes.size() != valueHashes.size())
+        {
+            zklog.warning("loadDb2MemCache() found only " + to_string(valueNodes.size()) + " of " + to_string(valueHashes.size()) + " requested value nodes");
+        }
+        counter += valueNodes.size();
+    }
+}
+
+// Loads the tree breadth-first, from the hashes of the current level up to maxLevel, splitting every level among
+// nThreads threads; on return, hashes and level contain the next level to load; returns false if loading must stop
+static bool loadDb2MemCacheLevels(const Config &config, Database &db, vector<string> &hashes, uint64_t &level, uint64_t maxLevel, uint64_t nThreads, struct timeval &startTime, uint64_t &counter)
+{
+    for (; (level < maxLevel) && (hashes.size() > 0); level++)
+    {
+        if (TimeDiff(startTime) > config.loadDBToMemTimeout)
+        {
+            zklog.info("loadDb2MemCache() stopping since timeout=" + to_string(config.loadDBToMemTimeout) + "us was reached at level=" + to_string(level));
+            return false;
+        }
+        if (loadDb2MemCacheFull())
+        {
+            return false;
+        }
+
+        // Split the level among the threads, every one of them using its own database connection
+        uint64_t threads = zkmin(nThreads, (uint64_t)hashes.size());
+        uint64_t chunkSize = (hashes.size() + threads - 1) / threads;
+        vector<vector<string>> chunks(threads);
+        vector<vector<string>> children(threads);
+        vector<uint64_t> counters(threads, 0);
+        vector<zkresult> results(threads, ZKR_SUCCESS);
+        vector<thread> workers;
+        for (uint64_t t=0; t<threads; t++)
+        {
+            uint64_t chunkStart = t*chunkSize;
+            uint64_t chunkEnd = zkmin(chunkStart + chunkSize, (uint64_t)hashes.size());
+            chunks[t].assign(hashes.begin() + chunkStart, hashes.begin() + chunkEnd);
+            workers.emplace_back(loadDb2MemCacheNodes, ref(db), cref(chunks[t]), ref(children[t]), ref(counters[t]), ref(results[t]));
+        }
+
+        hashes.clear();
+        for (uint64_t t=0; t<threads; t++)
+        {
+            workers[t].join();
+            if (results[t] != ZKR_SUCCESS)
+            {
+                zklog.error("loadDb2MemCache() failed calling db.readMany() at level=" + to_string(level) + " result=" + zkresult2string(results[t]));
+                return false;
+            }
+            counter += counters[t];
+            hashes.insert(hashes.end(), children[t].begin(), children[t].end());
+        }
+    }
+    return true;
+}
+
+// Adds the nodes of the hot set snapshot to the MT cache
+static void loadDb2MemCacheSnapshot(const Config &config, uint64_t &counter)
+{
+    vector<DatabaseCacheSnapshotRecord> records;
+    zkresult zkr = loadDbCacheSnapshot(config.dbCacheSnapshotFile, records);
+    if (zkr == ZKR_DB_KEY_NOT_FOUND)
+    {
+        zklog.info("loadDb2MemCache() found no snapshot file=" + config.dbCacheSnapshotFile);
+        return;
+    }
+    if (zkr != ZKR_SUCCESS)
+    {
+        zklog.warning("loadDb2MemCache() failed calling loadDbCacheSnapshot() result=" + zkresult2string(zkr) + "; the snapshot is ignored");
+        return;
+    }
+
+    vector<Goldilocks::Element> value;
+    for (uint64_t i=0; i<records.size(); i++)
+    {
+        if (((i & 0xFFFF) == 0) && loadDb2MemCacheFull())
+        {
+            break;
+        }
+        // The latest state root entry is mutable, so the snapshot copy may be stale; it is read from the database instead
+        if ((records[i].key[0].fe == Database::dbStateRootvKey[0].fe) &&
+            (records[i].key[1].fe == Database::dbStateRootvKey[1].fe) &&
+            (records[i].key[2].fe == Database::dbStateRootvKey[2].fe) &&
+            (records[i].key[3].fe == Database::dbStateRootvKey[3].fe))
+        {
+            continue;
+        }
+        value.assign(records[i].value, records[i].value + records[i].valueSize);
+        if (Database::useAssociativeCache)
+        {
+            Database::dbMTACache.addKeyValue(records[i].key, value, false);
+        }
+        else
+        {
+            Database::dbMTCache.add(records[i].key, value, false);
+        }
+        counter++;
+    }
+
+    zklog.info("loadDb2MemCache() loaded snapshot file=" + config.dbCacheSnapshotFile + " records=" + to_string(records.size()));
+}
+
+#endif
+
 void loadDb2MemCache(const Config &config)
 {
     if (config.databaseURL == "local")
@@ -1997,118 +2723,79 @@ void loadDb2MemCache(const Config &config)
     struct timeval loadCacheStartTime;
     gettimeofday(&loadCacheStartTime, NULL);
 
-    unordered_map<uint64_t, vector<string>> treeMap;
-    vector<string> emptyVector;
-    string hash, leftHash, rightHash;
+    // Every thread uses its own connection, so without a pool of connections there is no point in using more than one
+    uint64_t nThreads = config.dbConnectionsPool ? zkmax(config.loadDBToMemCacheThreads, (uint64_t)1) : 1;
+
+    vector<string> hashes;
+    hashes.push_back(stateRootKey);
+    uint64_t level = 0;
     uint64_t counter = 0;
 
-    treeMap[0] = emptyVector;
-    treeMap[0].push_back(stateRootKey);
-    unordered_map<uint64_t, std::vector<std::string>>::iterator treeMapIterator;
-    for (uint64_t level=0; level<256; level++)
+    // Load the top levels of the tree first, since they are used by every request
+    bool bContinue = loadDb2MemCacheLevels(config, pHashDB->db, hashes, level, config.loadDBToMemCacheTopLevels, nThreads, loadCacheStartTime, counter);
+
+    // Then load the hot set snapshot, if any
+    if (bContinue && (config.dbCacheSnapshotFile.size() > 0))
     {
-        // Spend only 10 seconds
-        if (TimeDiff(loadCacheStartTime) > config.loadDBToMemTimeout)
-        {
-            break;
-        }
+        loadDb2MemCacheSnapshot(config, counter);
+    }
 
-        treeMapIterator = treeMap.find(level);
-        if (treeMapIterator == treeMap.end())
-        {
-            break;
-        }
+    // Then keep on loading the rest of the tree; nodes already loaded from the snapshot are found in the cache
+    if (bContinue)
+    {
+        loadDb2MemCacheLevels(config, pHashDB->db, hashes, level, 256, nThreads, loadCacheStartTime, counter);
+    }
 
-        if (treeMapIterator->second.size()==0)
-        {
-            break;
-        }
+    if(Database::dbMTCache.enabled()){
+        zklog.info("loadDb2MemCache() done counter=" + to_string(counter) + " level=" + to_string(level) + " threads=" + to_string(nThreads) + " cache at " + to_string((double(Database::dbMTCache.getCurrentSize())/double(Database::dbMTCache.getMaxSize()))*100) + "%");
+    }
+    else
+    {
+        zklog.info("loadDb2MemCache() done counter=" + to_string(counter) + " level=" + to_string(level) + " threads=" + to_string(nThreads));
+    }
+    TimerStopAndLog(LOAD_DB_TO_CACHE);
 
-        treeMap[level+1] = emptyVector;
+#endif
+}
 
-        //zklog.info("loadDb2MemCache() searching at level=" + to_string(level) + " for elements=" + to_string(treeMapIterator->second.size()));
-        
-        for (uint64_t i=0; i<treeMapIterator->second.size(); i++)
-        {
-            // Spend only 10 seconds
-            if (TimeDiff(loadCacheStartTime) > config.loadDBToMemTimeout)
-            {
-                break;
-            }
+void saveDb2MemCacheSnapshot(const Config &config)
+{
+#ifdef DATABASE_USE_CACHE
 
-            hash = treeMapIterator->second[i];
-            dbValue.clear();
-            Goldilocks::Element vhash[4];
-            if(pHashDB->db.usingAssociativeCache()) string2key(fr, hash, vhash);
-            zkresult zkr = pHashDB->db.read(hash, vhash, dbValue, NULL, true);
+    TimerStart(SAVE_DB_CACHE_SNAPSHOT);
 
-            if (zkr != ZKR_SUCCESS)
-            {
-                zklog.error("loadDb2MemCache() failed calling db.read(" + hash + ") result=" + zkresult2string(zkr));
-                TimerStopAndLog(LOAD_DB_TO_CACHE);
-                return;
-            }
-            if (dbValue.size() != 12)
-            {
-                zklog.error("loadDb2MemCache() failed calling db.read(" + hash + ") dbValue.size()=" + to_string(dbValue.size()));
-                TimerStopAndLog(LOAD_DB_TO_CACHE);
-                return;
-            }
-            counter++;
-            if(Database::dbMTCache.enabled()){
-                double sizePercentage = double(Database::dbMTCache.getCurrentSize())*100.0/double(Database::dbMTCache.getMaxSize());
-                if ( sizePercentage > 90 )
-                {
-                    zklog.info("loadDb2MemCache() stopping since size percentage=" + to_string(sizePercentage));
-                    break;
-                }
-            }
-            // If capaxity is X000
-            if (fr.isZero(dbValue[9]) && fr.isZero(dbValue[10]) && fr.isZero(dbValue[11]))
-            {
-                // If capacity is 0000, this is an intermediate node that contains left and right hashes of its children
-                if (fr.isZero(dbValue[8]))
-                {
-                    leftHash = fea2string(fr, dbValue[0], dbValue[1], dbValue[2], dbValue[3]);
-                    if (leftHash != "0")
-                    {
-                        treeMap[level+1].push_back(leftHash);
-                        //zklog.info("loadDb2MemCache() level=" + to_string(level) + " found leftHash=" + leftHash);
-                    }
-                    rightHash = fea2string(fr, dbValue[4], dbValue[5], dbValue[6], dbValue[7]);
-                    if (rightHash != "0")
-                    {
-                        treeMap[level+1].push_back(rightHash);
-                        //zklog.info("loadDb2MemCache() level=" + to_string(level) + " found rightHash=" + rightHash);
-                    }
-                }
-                // If capacity is 1000, this is a leaf node that contains right hash of the value node
-                else if (fr.isOne(dbValue[8]))
-                {
-                    rightHash = fea2string(fr, dbValue[4], dbValue[5], dbValue[6], dbValue[7]);
-                    if (rightHash != "0")
-                    {
-                        //zklog.info("loadDb2MemCache() level=" + to_string(level) + " found value rightHash=" + rightHash);
-                        dbValue.clear();
-                        Goldilocks::Element vRightHash[4]={dbValue[4], dbValue[5], dbValue[6], dbValue[7]};
-                        zkresult zkr = pHashDB->db.read(rightHash, vRightHash, dbValue, NULL, true);
-                        if (zkr != ZKR_SUCCESS)
-                        {
-                            zklog.error("loadDb2MemCache() failed calling db.read(" + rightHash + ") result=" + zkresult2string(zkr));
-                            TimerStopAndLog(LOAD_DB_TO_CACHE);
-                            return;
-                        }
-                        counter++;
-                    }
-                }
-            }
-        }
+    uint64_t maxRecords = config.dbCacheSnapshotSize*1024*1024/sizeof(DatabaseCacheSnapshotRecord);
+    vector<DatabaseCacheSnapshotRecord> records;
+    if (Database::useAssociativeCache)
+    {
+        Database::dbMTACache.getHotSet(maxRecords, records);
+    }
+    else
+    {
+        Database::dbMTCache.getHotSet(maxRecords, records);
     }
 
-    if(Database::dbMTCache.enabled()){
-        zklog.info("loadDb2MemCache() done counter=" + to_string(counter) + " cache at " + to_string((double(Database::dbMTCache.getCurrentSize())/double(Database::dbMTCache.getMaxSize()))*100) + "%");
+    zkresult zkr = saveDbCacheSnapshot(config.dbCacheSnapshotFile, records);
+    if (zkr != ZKR_SUCCESS)
+    {
+        zklog.error("saveDb2MemCacheSnapshot() failed calling saveDbCacheSnapshot() result=" + zkresult2string(zkr));
+    }
+    else
+    {
+        zklog.info("saveDb2MemCacheSnapshot() saved file=" + config.dbCacheSnapshotFile + " records=" + to_string(records.size()));
     }
-    TimerStopAndLog(LOAD_DB_TO_CACHE);
+
+    TimerStopAndLog(SAVE_DB_CACHE_SNAPSHOT);
 
 #endif
+}
+
+void dbCacheSnapshotThread(const Config &config)
+{
+    zklog.info("dbCacheSnapshotThread() started");
+    while (true)
+    {
+        sleep(config.dbCacheSnapshotPeriod);
+        saveDb2MemCacheSnapshot(config);
+    }
 }
\ No newline at end of file
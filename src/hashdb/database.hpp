@@ -3,6 +3,9 @@
 
 #include <vector>
 #include <map>
+#include <deque>
+#include <unordered_map>
+#include <atomic>
 #include <pqxx/pqxx>
 #include "goldilocks_base_field.hpp"
 #include "compare_fe.hpp"
@@ -11,13 +14,26 @@
 #include "zkresult.hpp"
 #include "database_map.hpp"
 #include "database_cache.hpp"
+#include "database_mt_cache.hpp"
 #include "database_connection.hpp"
 #include "zkassert.hpp"
 #include "multi_write.hpp"
 #include "database_associative_cache.hpp"
+#include "database_file_store.hpp"
 
 using namespace std;
 
+// Request to a readManyRemote() worker thread: read chunks of keys with its own pool connection, and post pDoneSem
+class ReadManyRequest
+{
+public:
+    const vector<string> *pKeys; // NULL requests the worker thread to exit
+    atomic<uint64_t> *pNextChunk;
+    unordered_map<string, string> *pValues;
+    zkresult *pResult;
+    sem_t *pDoneSem;
+};
+
 class Database
 {
 public:
@@ -31,6 +47,7 @@ public:
     // Basic flags
     bool bInitialized = false;
     bool useRemoteDB = false;
+    bool useFileStore = false;
 
 #ifdef DATABASE_COMMIT
     pqxx::work* transaction = NULL;
@@ -45,8 +62,20 @@ public:
     uint64_t nextConnection;
     uint64_t usedConnections;
     DatabaseConnection * getConnection (void);
+    DatabaseConnection * tryGetConnection (void); // Returns NULL if there is no pool, or if taking a connection would leave less than half of it free
     void disposeConnection (DatabaseConnection * pConnection);
     void queryFailed (void);
+private:
+    DatabaseConnection * reserveConnection (void); // Called with connMutex locked; returns NULL if all connections are in use
+
+    // readManyRemote() worker threads, created with the connections pool
+    vector<pthread_t> readManyPthreads;
+    deque<ReadManyRequest> readManyRequests; // Protected by readManyMutex
+    pthread_mutex_t readManyMutex;
+    sem_t readManySem; // Number of queued requests
+public:
+    // Serves the readManyRemote() requests; called by dbReadManyThread
+    void readManyWorker (void);
 
     // Multi write attributes
 public:
@@ -61,11 +90,19 @@ private:
     // Remote database based on Postgres (PostgreSQL)
     void initRemote(void);
     zkresult readRemote(bool bProgram, const string &key, string &value);
+    zkresult readManyRemote(const vector<string> &keys, unordered_map<string, string> &values);
+    void readManyRemoteChunks(DatabaseConnection * pDatabaseConnection, const vector<string> &keys, atomic<uint64_t> &nextChunk, unordered_map<string, string> &values, zkresult &zkr);
     zkresult readTreeRemote(const string &key, bool *keys, uint64_t level, uint64_t &numberOfFields);
     zkresult writeRemote(bool bProgram, const string &key, const string &value);
     zkresult writeGetTreeFunction(void);
 
+    // Embedded database based on a local file, selected with databaseURL="file://<path>"
+    void initFileStore(void);
+
 public:
+    // File store static instance, shared by all the instances of Database class
+    static DatabaseFileStore dbFileStore;
+
 #ifdef DATABASE_USE_CACHE
     // Cache static instances
     static bool useAssociativeCache;
@@ -88,6 +125,8 @@ public:
     // Basic methods
     void init(void);
     zkresult read(const string &_key, Goldilocks::Element (&vkey)[4], vector<Goldilocks::Element> &value, DatabaseMap *dbReadLog, const bool update = false, bool *keys = NULL , uint64_t level=0);
+    // Reads a set of nodes, querying all the ones not found in memory at once; keys not found are not returned
+    zkresult readMany(const vector<string> &_keys, DatabaseMap::MTMap &values, DatabaseMap *dbReadLog);
     zkresult write(const string &_key, const Goldilocks::Element* vkey, const vector<Goldilocks::Element> &value, const bool persistent);
     zkresult getProgram(const string &_key, vector<uint8_t> &value, DatabaseMap *dbReadLog);
     zkresult setProgram(const string &_key, const vector<uint8_t> &value, const bool persistent);
@@ -106,10 +145,16 @@ public:
     // Flush multi write pending requests
     zkresult flush(uint64_t &flushId, uint64_t &lastSentFlushId);
     void semiFlush (void);
-    zkresult getFlushStatus(uint64_t &storedFlushId, uint64_t &storingFlushId, uint64_t &lastFlushId, uint64_t &pendingToFlushNodes, uint64_t &pendingToFlushProgram, uint64_t &storingNodes, uint64_t &storingProgram);
+    zkresult getFlushStatus(uint64_t &storedFlushId, uint64_t &storingFlushId, uint64_t &lastFlushId, uint64_t &pendingToFlushNodes, uint64_t &pendingToFlushProgram, uint64_t &storingNodes, uint64_t &storingProgram, uint64_t &storedBytesPerSecond, uint64_t &storedRowsPerSecond);
 
     // Send multi write data to remote database; called by dbSenderThread
     zkresult sendData(void);
+private:
+    // Send multi write data using COPY into staging tables, followed by an upsert
+    zkresult sendDataCopy(MultiWriteData &data, uint64_t &bytes);
+    // Mark the storing flush ID as stored and record the throughput of this flush
+    void setStored(uint64_t bytes, uint64_t rows, uint64_t time);
+public:
 
     // Get flush data, written to database by dbSenderThread; it blocks
     zkresult getFlushData(uint64_t flushId, uint64_t &lastSentFlushId, unordered_map<string, string> (&nodes), unordered_map<string, string> (&program), string &nodesStateRoot);
@@ -124,9 +169,19 @@ public:
 // Thread to send data to database
 void *dbSenderThread(void *arg);
 
+// Thread to read chunks of keys for readManyRemote()
+void *dbReadManyThread(void *arg);
+
 // Thread to synchronize cache from master hash DB server
 void *dbCacheSynchThread(void *arg);
 
+// Warms up the MT cache: top levels of the tree, then the hot set snapshot, if any, then the rest of the tree
 void loadDb2MemCache(const Config &config);
 
+// Saves the hot set of the MT cache into config.dbCacheSnapshotFile
+void saveDb2MemCacheSnapshot(const Config &config);
+
+// Thread to save the hot set snapshot every config.dbCacheSnapshotPeriod seconds
+void dbCacheSnapshotThread(const Config &config);
+
 #endif
\ No newline at end of file
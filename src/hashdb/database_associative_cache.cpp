@@ -3,13 +3,19 @@
 #include "goldilocks_base_field.hpp"
 #include <nlohmann/json.hpp>
 #include <mutex>
+#include <atomic>
 #include "zklog.hpp"
 #include "zkmax.hpp"
 #include "exit_process.hpp"
 #include "scalar.hpp"
 
+// Relaxed atomic accessors for the fields shared between the lock-free readers and the writers
+#define ACACHE_LOAD(a) __atomic_load_n(&(a), __ATOMIC_RELAXED)
+#define ACACHE_STORE(a, v) __atomic_store_n(&(a), (v), __ATOMIC_RELAXED)
 
-
+// Thread number, used to select the hit/attempt counters slot
+static atomic<uint64_t> nextThreadNumber(0);
+static thread_local uint64_t threadNumber = nextThreadNumber.fetch_add(1);
 
 DatabaseMTAssociativeCache::DatabaseMTAssociativeCache()
 {
@@ -21,14 +27,18 @@ DatabaseMTAssociativeCache::DatabaseMTAssociativeCache()
     keys = NULL;
     values = NULL;
     isLeaf = NULL;
+    versions = NULL;
     currentCacheIndex = 0;
-    attempts = 0;
-    hits = 0;
     name = "";
 };
 
 DatabaseMTAssociativeCache::DatabaseMTAssociativeCache(int nKeyBits_, int cacheSize_, string name_)
 {
+    indexes = NULL;
+    keys = NULL;
+    values = NULL;
+    isLeaf = NULL;
+    versions = NULL;
     postConstruct(nKeyBits_, cacheSize_, name_);
 };
 
@@ -42,11 +52,14 @@ DatabaseMTAssociativeCache::~DatabaseMTAssociativeCache()
         delete[] values;
     if (isLeaf != NULL)
         delete[] isLeaf;
+    if (versions != NULL)
+        delete[] versions;
 };
 
+// Must be called before any concurrent reader is active, since it reallocates the arrays
 void DatabaseMTAssociativeCache::postConstruct(int nKeyBits_, int log2CacheSize_, string name_)
 {
-    lock_guard<recursive_mutex> guard(mlock);
+    lock_guard<mutex> guard(mlock);
     nKeyBits = nKeyBits_;
     if (nKeyBits_ > 32)
     {
@@ -78,10 +91,15 @@ void DatabaseMTAssociativeCache::postConstruct(int nKeyBits_, int log2CacheSize_
     values = new Goldilocks::Element[12 * cacheSize];
     if(isLeaf != NULL) delete[] isLeaf;
     isLeaf = new bool[cacheSize];
+    if(versions != NULL) delete[] versions;
+    versions = new uint32_t[cacheSize]();
 
     currentCacheIndex = 0;
-    attempts = 0;
-    hits = 0;
+    for (int i = 0; i < DATABASE_MT_ASSOCIATIVE_CACHE_COUNTERS; i++)
+    {
+        counters[i].attempts = 0;
+        counters[i].hits = 0;
+    }
     name = name_;
 
     cacheMask = 0;
@@ -103,14 +121,7 @@ void DatabaseMTAssociativeCache::postConstruct(int nKeyBits_, int log2CacheSize_
 
 void DatabaseMTAssociativeCache::addKeyValue(Goldilocks::Element (&key)[4], const vector<Goldilocks::Element> &value, bool update)
 {
-    lock_guard<recursive_mutex> guard(mlock);
-    //
-    //  Statistics
-    //
-    if (attempts%1000000 == 0)
-    {
-        zklog.info("DatabaseMTAssociativeCache::addKeyValue() name=" + name + " indexesSize=" + to_string(indexesSize) + " cacheSize=" + to_string(cacheSize) + " attempts=" + to_string(attempts) + " hits=" + to_string(hits) + " hit ratio=" + to_string(double(hits) * 100.0 / double(zkmax(attempts, 1))) + "%");
-    }
+    lock_guard<mutex> guard(mlock);
 
     //
     // Try to add in one of my 4 slots
@@ -120,24 +131,23 @@ void DatabaseMTAssociativeCache::addKeyValue(Goldilocks::Element (&key)[4], cons
         uint32_t tableIndex = (uint32_t)(key[i].fe & indexesMask);
         uint32_t cacheIndexRaw = indexes[tableIndex];
         uint32_t cacheIndex = cacheIndexRaw & cacheMask;
-        uint32_t cacheIndexKey, cacheIndexValue;
+        uint32_t cacheIndexKey;
         bool write = false;
 
         if ((currentCacheIndex >= cacheIndexRaw &&  currentCacheIndex - cacheIndexRaw > cacheSize) ||
             (currentCacheIndex < cacheIndexRaw && UINT32_MAX - cacheIndexRaw + currentCacheIndex > cacheSize))
         {
-            write = true;
-            indexes[tableIndex] = currentCacheIndex;
             cacheIndex = currentCacheIndex & cacheMask;
 
-            cacheIndexKey = cacheIndex * 4;
-            cacheIndexValue = cacheIndex * 12;
-            currentCacheIndex = (currentCacheIndex == UINT32_MAX) ? 0 : (currentCacheIndex + 1); 
+            // Write the entry before publishing it through the index and the current cache index
+            writeEntry(cacheIndex, key, value);
+            ACACHE_STORE(indexes[tableIndex], currentCacheIndex);
+            __atomic_store_n(&currentCacheIndex, (currentCacheIndex == UINT32_MAX) ? 0 : (currentCacheIndex + 1), __ATOMIC_RELEASE);
+            return;
         }
         else
         {
             cacheIndexKey = cacheIndex * 4;
-            cacheIndexValue = cacheIndex * 12;
 
             if (keys[cacheIndexKey + 0].fe == key[0].fe &&
                 keys[cacheIndexKey + 1].fe == key[1].fe &&
@@ -151,70 +161,19 @@ void DatabaseMTAssociativeCache::addKeyValue(Goldilocks::Element (&key)[4], cons
                 continue;
             }
         }
-        if (write) // must be atomic operation!!
+        if (write)
         {
-            isLeaf[cacheIndex] = (value.size() > 8);
-            keys[cacheIndexKey + 0].fe = key[0].fe;
-            keys[cacheIndexKey + 1].fe = key[1].fe;
-            keys[cacheIndexKey + 2].fe = key[2].fe;
-            keys[cacheIndexKey + 3].fe = key[3].fe;
-            values[cacheIndexValue + 0] = value[0];
-            values[cacheIndexValue + 1] = value[1];
-            values[cacheIndexValue + 2] = value[2];
-            values[cacheIndexValue + 3] = value[3];
-            values[cacheIndexValue + 4] = value[4];
-            values[cacheIndexValue + 5] = value[5];
-            values[cacheIndexValue + 6] = value[6];
-            values[cacheIndexValue + 7] = value[7];
-            if (isLeaf[cacheIndex])
-            {
-                values[cacheIndexValue + 8] = value[8];
-                values[cacheIndexValue + 9] = value[9];
-                values[cacheIndexValue + 10] = value[10];
-                values[cacheIndexValue + 11] = value[11];
-            }else{
-                values[cacheIndexValue + 8] = Goldilocks::zero();
-                values[cacheIndexValue + 9] = Goldilocks::zero();
-                values[cacheIndexValue + 10] = Goldilocks::zero();
-                values[cacheIndexValue + 11] = Goldilocks::zero();
-            }
-            return;
-        }else{
-            return;
+            writeEntry(cacheIndex, key, value);
         }
+        return;
     }
     //
     // forced entry insertion
     //
     uint32_t cacheIndex = (uint32_t)(currentCacheIndex & cacheMask);
-    currentCacheIndex = (currentCacheIndex == UINT32_MAX) ? 0 : (currentCacheIndex + 1); // atomic!
-    uint32_t cacheIndexKey = cacheIndex * 4;
-    uint32_t cacheIndexValue = cacheIndex * 12;
-    isLeaf[cacheIndex] = (value.size() > 8);
-    keys[cacheIndexKey + 0].fe = key[0].fe;
-    keys[cacheIndexKey + 1].fe = key[1].fe;
-    keys[cacheIndexKey + 2].fe = key[2].fe;
-    keys[cacheIndexKey + 3].fe = key[3].fe;
-    values[cacheIndexValue + 0] = value[0];
-    values[cacheIndexValue + 1] = value[1];
-    values[cacheIndexValue + 2] = value[2];
-    values[cacheIndexValue + 3] = value[3];
-    values[cacheIndexValue + 4] = value[4];
-    values[cacheIndexValue + 5] = value[5];
-    values[cacheIndexValue + 6] = value[6];
-    values[cacheIndexValue + 7] = value[7];
-    if (isLeaf[cacheIndex])
-    {
-        values[cacheIndexValue + 8] = value[8];
-        values[cacheIndexValue + 9] = value[9];
-        values[cacheIndexValue + 10] = value[10];
-        values[cacheIndexValue + 11] = value[11];
-    }else{
-        values[cacheIndexValue + 8] = Goldilocks::zero();
-        values[cacheIndexValue + 9] = Goldilocks::zero();
-        values[cacheIndexValue + 10] = Goldilocks::zero();
-        values[cacheIndexValue + 11] = Goldilocks::zero();
-    }
+    writeEntry(cacheIndex, key, value);
+    __atomic_store_n(&currentCacheIndex, (currentCacheIndex == UINT32_MAX) ? 0 : (currentCacheIndex + 1), __ATOMIC_RELEASE);
+
     //
     // Forced index insertion
     //
@@ -225,6 +184,45 @@ void DatabaseMTAssociativeCache::addKeyValue(Goldilocks::Element (&key)[4], cons
 
 }
 
+// Writes an entry under its seqlock; must be called with mlock locked
+void DatabaseMTAssociativeCache::writeEntry(uint32_t cacheIndex, const Goldilocks::Element (&key)[4], const vector<Goldilocks::Element> &value)
+{
+    uint32_t cacheIndexKey = cacheIndex * 4;
+    uint32_t cacheIndexValue = cacheIndex * 12;
+    uint32_t version = versions[cacheIndex];
+
+    // Mark the entry as being written (odd version)
+    ACACHE_STORE(versions[cacheIndex], version + 1);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    isLeaf[cacheIndex] = (value.size() > 8);
+    for (int i = 0; i < 4; i++)
+    {
+        ACACHE_STORE(keys[cacheIndexKey + i].fe, key[i].fe);
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        ACACHE_STORE(values[cacheIndexValue + i].fe, value[i].fe);
+    }
+    if (isLeaf[cacheIndex])
+    {
+        for (int i = 8; i < 12; i++)
+        {
+            ACACHE_STORE(values[cacheIndexValue + i].fe, value[i].fe);
+        }
+    }
+    else
+    {
+        for (int i = 8; i < 12; i++)
+        {
+            ACACHE_STORE(values[cacheIndexValue + i].fe, Goldilocks::zero().fe);
+        }
+    }
+
+    // Mark the entry as stable (even version)
+    __atomic_store_n(&versions[cacheIndex], version + 2, __ATOMIC_RELEASE);
+}
+
 void DatabaseMTAssociativeCache::forcedInsertion(uint32_t (&rawCacheIndexes)[10], int &iters)
 {
     uint32_t rawCacheIndex = rawCacheIndexes[iters];
@@ -236,7 +234,7 @@ void DatabaseMTAssociativeCache::forcedInsertion(uint32_t (&rawCacheIndexes)[10]
     {
         zklog.error("forcedInsertion() more than 10 iterations required. Index: " + to_string(rawCacheIndex));
         exitProcess();
-    }    
+    }
 
     //
     // find a slot into my indexes
@@ -253,7 +251,7 @@ void DatabaseMTAssociativeCache::forcedInsertion(uint32_t (&rawCacheIndexes)[10]
         if ((currentCacheIndex >= rawCacheIndex_ &&  currentCacheIndex - rawCacheIndex_ > cacheSize) ||
             (currentCacheIndex < rawCacheIndex_ && UINT32_MAX - rawCacheIndex_ + currentCacheIndex > cacheSize))
         {
-            indexes[tableIndex_] = rawCacheIndex;
+            ACACHE_STORE(indexes[tableIndex_], rawCacheIndex);
             return;
         }
         else
@@ -277,51 +275,126 @@ void DatabaseMTAssociativeCache::forcedInsertion(uint32_t (&rawCacheIndexes)[10]
     {
         zklog.error("forcedInsertion() could not continue the recursion: " + to_string(rawCacheIndex));
         exitProcess();
-    }  
-    indexes[(uint32_t)(key[pos].fe & indexesMask)] = rawCacheIndex;
+    }
+    ACACHE_STORE(indexes[(uint32_t)(key[pos].fe & indexesMask)], rawCacheIndex);
     rawCacheIndexes[iters] = minRawCacheIndex;
     forcedInsertion(rawCacheIndexes, iters);
-    
+
 }
 
 bool DatabaseMTAssociativeCache::findKey(Goldilocks::Element (&key)[4], vector<Goldilocks::Element> &value)
 {
-    lock_guard<recursive_mutex> guard(mlock);
-    attempts++; 
+    //
+    //  Statistics
+    //
+    DatabaseMTAssociativeCacheCounters &threadCounters_ = threadCounters();
+    if (threadCounters_.attempts.fetch_add(1, memory_order_relaxed) % 1000000 == 0)
+    {
+        logStatistics();
+    }
+
+    uint32_t currentCacheIndex_ = __atomic_load_n(&currentCacheIndex, __ATOMIC_ACQUIRE);
     for (int i = 0; i < 4; i++)
     {
         uint32_t tableIndex = (uint32_t)(key[i].fe & indexesMask);
-        uint32_t cacheIndexRaw = (uint32_t)(indexes[tableIndex]);
+        uint32_t cacheIndexRaw = ACACHE_LOAD(indexes[tableIndex]);
         uint32_t cacheIndex = cacheIndexRaw  & cacheMask;
-        if ((currentCacheIndex >= cacheIndexRaw &&  currentCacheIndex - cacheIndexRaw > cacheSize) ||
-            (currentCacheIndex < cacheIndexRaw && UINT32_MAX - cacheIndexRaw + currentCacheIndex > cacheSize))
+        if ((currentCacheIndex_ >= cacheIndexRaw &&  currentCacheIndex_ - cacheIndexRaw > cacheSize) ||
+            (currentCacheIndex_ < cacheIndexRaw && UINT32_MAX - cacheIndexRaw + currentCacheIndex_ > cacheSize))
             continue;
-            
+
         uint32_t cacheIndexKey = cacheIndex * 4;
 
-        if (keys[cacheIndexKey + 0].fe == key[0].fe &&
-            keys[cacheIndexKey + 1].fe == key[1].fe &&
-            keys[cacheIndexKey + 2].fe == key[2].fe &&
-            keys[cacheIndexKey + 3].fe == key[3].fe)
+        // If the entry is being written, or it is overwritten while we read it, consider it a miss
+        uint32_t version = __atomic_load_n(&versions[cacheIndex], __ATOMIC_ACQUIRE);
+        if (version & 1)
+            continue;
+
+        if (ACACHE_LOAD(keys[cacheIndexKey + 0].fe) == key[0].fe &&
+            ACACHE_LOAD(keys[cacheIndexKey + 1].fe) == key[1].fe &&
+            ACACHE_LOAD(keys[cacheIndexKey + 2].fe) == key[2].fe &&
+            ACACHE_LOAD(keys[cacheIndexKey + 3].fe) == key[3].fe)
         {
             uint32_t cacheIndexValue = cacheIndex * 12;
-            ++hits; // must be atomic operation!! makes is sence?
+            Goldilocks::Element entryValue[12];
+            for (int j = 0; j < 12; j++)
+            {
+                entryValue[j].fe = ACACHE_LOAD(values[cacheIndexValue + j].fe);
+            }
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (ACACHE_LOAD(versions[cacheIndex]) != version)
+                continue;
+
+            threadCounters_.hits.fetch_add(1, memory_order_relaxed);
             value.resize(12);
-            value[0] = values[cacheIndexValue];
-            value[1] = values[cacheIndexValue + 1];
-            value[2] = values[cacheIndexValue + 2];
-            value[3] = values[cacheIndexValue + 3];
-            value[4] = values[cacheIndexValue + 4];
-            value[5] = values[cacheIndexValue + 5];
-            value[6] = values[cacheIndexValue + 6];
-            value[7] = values[cacheIndexValue + 7];
-
-            value[8] = values[cacheIndexValue + 8];
-            value[9] = values[cacheIndexValue + 9];
-            value[10] = values[cacheIndexValue + 10];
-            value[11] = values[cacheIndexValue + 11];
+            for (int j = 0; j < 12; j++)
+            {
+                value[j] = entryValue[j];
+            }
             return true;
         }
     }
     return false;
 }
+
+void DatabaseMTAssociativeCache::getHotSet(uint64_t maxRecords, vector<DatabaseCacheSnapshotRecord> &records)
+{
+    records.clear();
+    if (!enabled()) return;
+
+    // Lock the writers out, and walk the cache entries backwards from the last written one
+    lock_guard<mutex> guard(mlock);
+    uint64_t numberOfRecords = zkmin(maxRecords, (uint64_t)cacheSize);
+    records.reserve(numberOfRecords);
+    for (uint64_t i=1; i<=numberOfRecords; i++)
+    {
+        uint32_t cacheIndex = (uint32_t)(currentCacheIndex - i) & cacheMask;
+
+        // Skip entries that have never been written
+        if (versions[cacheIndex] == 0) continue;
+
+        DatabaseCacheSnapshotRecord record;
+        for (int j = 0; j < 4; j++)
+        {
+            record.key[j] = keys[cacheIndex * 4 + j];
+        }
+        for (int j = 0; j < 12; j++)
+        {
+            record.value[j] = values[cacheIndex * 12 + j];
+        }
+        record.valueSize = isLeaf[cacheIndex] ? 12 : 8;
+        records.push_back(record);
+    }
+}
+
+DatabaseMTAssociativeCacheCounters &DatabaseMTAssociativeCache::threadCounters(void)
+{
+    return counters[threadNumber % DATABASE_MT_ASSOCIATIVE_CACHE_COUNTERS];
+}
+
+uint64_t DatabaseMTAssociativeCache::getAttempts(void)
+{
+    uint64_t attempts = 0;
+    for (int i = 0; i < DATABASE_MT_ASSOCIATIVE_CACHE_COUNTERS; i++)
+    {
+        attempts += counters[i].attempts.load(memory_order_relaxed);
+    }
+    return attempts;
+}
+
+uint64_t DatabaseMTAssociativeCache::getHits(void)
+{
+    uint64_t hits = 0;
+    for (int i = 0; i < DATABASE_MT_ASSOCIATIVE_CACHE_COUNTERS; i++)
+    {
+        hits += counters[i].hits.load(memory_order_relaxed);
+    }
+    return hits;
+}
+
+void DatabaseMTAssociativeCache::logStatistics(void)
+{
+    uint64_t attempts = getAttempts();
+    uint64_t hits = getHits();
+    zklog.info("DatabaseMTAssociativeCache::findKey() name=" + name + " indexesSize=" + to_string(indexesSize) + " cacheSize=" + to_string(cacheSize) + " attempts=" + to_string(attempts) + " hits=" + to_string(hits) + " hit ratio=" + to_string(double(hits) * 100.0 / double(zkmax(attempts, 1))) + "%");
+}
@@ -4,15 +4,32 @@
 #include "goldilocks_base_field.hpp"
 #include <nlohmann/json.hpp>
 #include <mutex>
+#include <atomic>
 #include "zklog.hpp"
 #include "zkmax.hpp"
+#include "database_cache_snapshot.hpp"
 
 using namespace std;
 using json = nlohmann::json;
+
+// Number of hit/attempt counter slots; every thread updates the slot of its thread number modulo this value
+#define DATABASE_MT_ASSOCIATIVE_CACHE_COUNTERS 64
+
+struct alignas(64) DatabaseMTAssociativeCacheCounters
+{
+    atomic<uint64_t> attempts;
+    atomic<uint64_t> hits;
+    DatabaseMTAssociativeCacheCounters() : attempts(0), hits(0) {};
+};
+
+// Readers (findKey) are wait-free and never take the lock: every cache entry is protected by a
+// sequence number (seqlock) that writers make odd while they update the entry; a reader that
+// observes an odd or changed sequence number treats the lookup as a miss.
+// Writers (addKeyValue, forcedInsertion) are serialized by mlock.
 class DatabaseMTAssociativeCache
 {
     private:
-        recursive_mutex mlock;
+        mutex mlock;
 
         int nKeyBits;
         uint32_t indexesSize;
@@ -23,10 +40,10 @@ class DatabaseMTAssociativeCache
         Goldilocks::Element *keys;
         Goldilocks::Element *values;
         bool *isLeaf;
+        uint32_t *versions;
         uint32_t currentCacheIndex; 
 
-        uint64_t attempts;
-        uint64_t hits;
+        DatabaseMTAssociativeCacheCounters counters[DATABASE_MT_ASSOCIATIVE_CACHE_COUNTERS];
         string name;
 
         uint64_t indexesMask;
@@ -45,9 +62,15 @@ class DatabaseMTAssociativeCache
         inline bool enabled() const { return (nKeyBits > 0); };
         inline uint32_t getCacheSize()  const { return cacheSize; };
         inline uint32_t getIndexesSize() const { return indexesSize; };
+        uint64_t getAttempts(void);
+        uint64_t getHits(void);
+        void getHotSet(uint64_t maxRecords, vector<DatabaseCacheSnapshotRecord> &records); // Last written entries first
 
     private:
         void forcedInsertion(uint32_t (&rawCacheIndexes)[10], int &iters);
+        void writeEntry(uint32_t cacheIndex, const Goldilocks::Element (&key)[4], const vector<Goldilocks::Element> &value);
+        DatabaseMTAssociativeCacheCounters &threadCounters(void);
+        void logStatistics(void);
 };
 #endif
 
@@ -165,84 +165,6 @@ DatabaseCache::~DatabaseCache()
     TimerStopAndLog(DATABASE_CACHE_DESTRUCTOR);
 }
 
-// DatabaseMTCache class implementation
-
-
-DatabaseMTCache::~DatabaseMTCache()
-{
-    TimerStart(DATABASE_MT_CACHE_DESTRUCTOR);
-    clear();
-    TimerStopAndLog(DATABASE_MT_CACHE_DESTRUCTOR);
-}
-
-// Add a record in the head of the MT cache. Returns true if the cache is full (or no cache), false otherwise
-bool DatabaseMTCache::add(const string &key, const vector<Goldilocks::Element> &value, const bool update)
-{
-    lock_guard<recursive_mutex> guard(mlock);
-
-    if (maxSize == 0) return true;
-
-    return addKeyValue(key, (const void *)&value, update);
-}
-
-bool DatabaseMTCache::find(const string &key, vector<Goldilocks::Element> &value)
-{
-    lock_guard<recursive_mutex> guard(mlock);
-
-    if (maxSize == 0) return false;
-
-    DatabaseCacheRecord* record;
-    bool found = findKey(key, record);
-    if (found) 
-    {
-        value = *((vector<Goldilocks::Element>*) record->value);
-    }
-
-    return found;
-}
-
-DatabaseCacheRecord * DatabaseMTCache::allocRecord(const string key, const void * value)
-{
-    // Allocate memory
-    DatabaseCacheRecord * pRecord = new(DatabaseCacheRecord);
-    if (pRecord == NULL)
-    {
-        zklog.error("DatabaseMTCache::allocRecord() failed calling new(DatabaseCacheRecord)");
-        exitProcess();
-    }
-    vector<Goldilocks::Element>* pValue = new(vector<Goldilocks::Element>);
-    if (pValue == NULL)
-    {
-        zklog.error("DatabaseMTCache::allocRecord() failed calling new(vector<Goldilocks::Element>)");
-        exitProcess();
-    }
-
-    // Copy vector
-    *pValue = *(const vector<Goldilocks::Element> *)value;
-
-    // Assign values to record
-    pRecord->value = pValue;
-    pRecord->key = key;
-    pRecord->size = 2*(
-        sizeof(DatabaseCacheRecord)+
-        (pRecord->key.capacity()+1)+
-        sizeof(vector<Goldilocks::Element>)+
-        sizeof(Goldilocks::Element)*pValue->capacity() );
-        
-    return pRecord;
-}
-
-void DatabaseMTCache::freeRecord(DatabaseCacheRecord* record)
-{
-    delete (vector<Goldilocks::Element>*)(record->value);
-    delete record;
-}
-
-void DatabaseMTCache::updateRecord(DatabaseCacheRecord* record, const void * value)
-{
-    *(vector<Goldilocks::Element>*)(record->value) = *(vector<Goldilocks::Element>*)(value);
-}
-
 // DatabaseProgramCache class implementation
 
 DatabaseProgramCache::~DatabaseProgramCache()
@@ -58,17 +58,6 @@ public:
     void clear(void);
 };
 
-class DatabaseMTCache : public DatabaseCache
-{
-public:
-    ~DatabaseMTCache();
-    bool add(const string &key, const vector<Goldilocks::Element> &value, const bool update); // returns true if cache is full
-    bool find(const string &key, vector<Goldilocks::Element> &value);
-    DatabaseCacheRecord* allocRecord(const string key, const void * value) override;
-    void freeRecord(DatabaseCacheRecord* record) override;
-    void updateRecord(DatabaseCacheRecord* record, const void * value) override;
-};
-
 class DatabaseProgramCache : public DatabaseCache
 {
 public:  
@@ -0,0 +1,154 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
+#include "database_cache_snapshot.hpp"
+#include "zklog.hpp"
+
+static uint64_t snapshotChecksum(const vector<DatabaseCacheSnapshotRecord> &records)
+{
+    // FNV-1a, 64 bits
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    const uint64_t prime = 0x100000001b3ULL;
+    const uint8_t *pData = (const uint8_t *)records.data();
+    uint64_t size = records.size()*sizeof(DatabaseCacheSnapshotRecord);
+    for (uint64_t i=0; i<size; i++)
+    {
+        hash = (hash ^ pData[i]) * prime;
+    }
+    return hash;
+}
+
+// Writes or reads exactly size bytes, retrying on partial transfers
+static bool writeAll(int fd, const uint8_t *pData, uint64_t size)
+{
+    while (size > 0)
+    {
+        ssize_t n = ::write(fd, pData, size);
+        if (n <= 0)
+        {
+            if ((n < 0) && (errno == EINTR)) continue;
+            return false;
+        }
+        pData += n;
+        size -= n;
+    }
+    return true;
+}
+
+static bool readAll(int fd, uint8_t *pData, uint64_t size)
+{
+    while (size > 0)
+    {
+        ssize_t n = ::read(fd, pData, size);
+        if (n <= 0)
+        {
+            if ((n < 0) && (errno == EINTR)) continue;
+            return false;
+        }
+        pData += n;
+        size -= n;
+    }
+    return true;
+}
+
+zkresult saveDbCacheSnapshot(const string &fileName, const vector<DatabaseCacheSnapshotRecord> &records)
+{
+    // Write into a temporary file, and rename it once it is complete and synced
+    string tmpFileName = fileName + ".tmp";
+    int fd = ::open(tmpFileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        zklog.error("saveDbCacheSnapshot() failed calling open(" + tmpFileName + ") errno=" + to_string(errno) + "=" + strerror(errno));
+        return ZKR_DB_ERROR;
+    }
+
+    DatabaseCacheSnapshotHeader header;
+    memcpy(header.magic, DATABASE_CACHE_SNAPSHOT_MAGIC, 8);
+    header.version = DATABASE_CACHE_SNAPSHOT_VERSION;
+    header.numberOfRecords = records.size();
+    header.checksum = snapshotChecksum(records);
+
+    if ( !writeAll(fd, (const uint8_t *)&header, sizeof(header)) ||
+         !writeAll(fd, (const uint8_t *)records.data(), records.size()*sizeof(DatabaseCacheSnapshotRecord)) ||
+         (fdatasync(fd) != 0) )
+    {
+        zklog.error("saveDbCacheSnapshot() failed writing file=" + tmpFileName + " errno=" + to_string(errno) + "=" + strerror(errno));
+        ::close(fd);
+        unlink(tmpFileName.c_str());
+        return ZKR_DB_ERROR;
+    }
+    ::close(fd);
+
+    if (rename(tmpFileName.c_str(), fileName.c_str()) != 0)
+    {
+        zklog.error("saveDbCacheSnapshot() failed calling rename(" + tmpFileName + ", " + fileName + ") errno=" + to_string(errno) + "=" + strerror(errno));
+        unlink(tmpFileName.c_str());
+        return ZKR_DB_ERROR;
+    }
+
+    return ZKR_SUCCESS;
+}
+
+zkresult loadDbCacheSnapshot(const string &fileName, vector<DatabaseCacheSnapshotRecord> &records)
+{
+    records.clear();
+
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        if (errno == ENOENT)
+        {
+            return ZKR_DB_KEY_NOT_FOUND;
+        }
+        zklog.error("loadDbCacheSnapshot() failed calling open(" + fileName + ") errno=" + to_string(errno) + "=" + strerror(errno));
+        return ZKR_DB_ERROR;
+    }
+
+    struct stat st;
+    DatabaseCacheSnapshotHeader header;
+    if ( (fstat(fd, &st) != 0) || !readAll(fd, (uint8_t *)&header, sizeof(header)) )
+    {
+        zklog.error("loadDbCacheSnapshot() failed reading header of file=" + fileName);
+        ::close(fd);
+        return ZKR_DB_ERROR;
+    }
+    if ( (memcmp(header.magic, DATABASE_CACHE_SNAPSHOT_MAGIC, 8) != 0) ||
+         (header.version != DATABASE_CACHE_SNAPSHOT_VERSION) ||
+         ((uint64_t)st.st_size != sizeof(header) + header.numberOfRecords*sizeof(DatabaseCacheSnapshotRecord)) )
+    {
+        zklog.error("loadDbCacheSnapshot() found an invalid header in file=" + fileName + " version=" + to_string(header.version) + " numberOfRecords=" + to_string(header.numberOfRecords) + " size=" + to_string(st.st_size));
+        ::close(fd);
+        return ZKR_DB_ERROR;
+    }
+
+    records.resize(header.numberOfRecords);
+    if (!readAll(fd, (uint8_t *)records.data(), records.size()*sizeof(DatabaseCacheSnapshotRecord)))
+    {
+        zklog.error("loadDbCacheSnapshot() failed reading records of file=" + fileName);
+        ::close(fd);
+        records.clear();
+        return ZKR_DB_ERROR;
+    }
+    ::close(fd);
+
+    if (snapshotChecksum(records) != header.checksum)
+    {
+        zklog.error("loadDbCacheSnapshot() found an invalid checksum in file=" + fileName);
+        records.clear();
+        return ZKR_DB_ERROR;
+    }
+
+    for (uint64_t i=0; i<records.size(); i++)
+    {
+        if ((records[i].valueSize != 8) && (records[i].valueSize != 12))
+        {
+            zklog.error("loadDbCacheSnapshot() found an invalid value size=" + to_string(records[i].valueSize) + " in file=" + fileName);
+            records.clear();
+            return ZKR_DB_ERROR;
+        }
+    }
+
+    return ZKR_SUCCESS;
+}
@@ -0,0 +1,46 @@
+#ifndef DATABASE_CACHE_SNAPSHOT_HPP
+#define DATABASE_CACHE_SNAPSHOT_HPP
+
+#include <string>
+#include <vector>
+#include "goldilocks_base_field.hpp"
+#include "zkresult.hpp"
+
+using namespace std;
+
+/*
+    Snapshot of the hot set of the MT cache, i.e. its most recently used nodes, saved to a local file
+    so that the cache can be warmed up at start-up without reading them from the database.
+    Nodes are content-addressed (the key is the hash of the value), so their snapshot copies never get stale.
+    The only mutable entry, the latest state root (Database::dbStateRootKey), is skipped when loading.
+
+    File layout:
+        DatabaseCacheSnapshotHeader
+        DatabaseCacheSnapshotRecord x numberOfRecords, most recently used first
+*/
+
+#define DATABASE_CACHE_SNAPSHOT_MAGIC "ZKCACHES"
+#define DATABASE_CACHE_SNAPSHOT_VERSION 1
+
+struct DatabaseCacheSnapshotHeader
+{
+    char magic[8];
+    uint64_t version;
+    uint64_t numberOfRecords;
+    uint64_t checksum; // FNV-1a of all the records
+};
+
+struct DatabaseCacheSnapshotRecord
+{
+    Goldilocks::Element key[4];
+    Goldilocks::Element value[12];
+    uint64_t valueSize; // Number of used field elements in value: 8 or 12
+};
+
+// Saves the records into fileName, atomically replacing any previous snapshot
+zkresult saveDbCacheSnapshot(const string &fileName, const vector<DatabaseCacheSnapshotRecord> &records);
+
+// Loads the records of fileName; returns ZKR_DB_KEY_NOT_FOUND if the file does not exist
+zkresult loadDbCacheSnapshot(const string &fileName, vector<DatabaseCacheSnapshotRecord> &records);
+
+#endif
@@ -0,0 +1,597 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstddef>
+#include "database_file_store.hpp"
+#include "scalar.hpp"
+#include "zklog.hpp"
+#include "zkmax.hpp"
+#include "timer.hpp"
+#include "exit_process.hpp"
+
+DatabaseFileStore::~DatabaseFileStore()
+{
+    close();
+}
+
+uint64_t DatabaseFileStore::checksum(const DatabaseFileRecordHeader &header, const uint8_t *pValue)
+{
+    // FNV-1a, 64 bits
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    const uint64_t prime = 0x100000001b3ULL;
+    const uint8_t *pHeader = (const uint8_t *)&header;
+    for (uint64_t i=0; i<offsetof(DatabaseFileRecordHeader, checksum); i++)
+    {
+        hash = (hash ^ pHeader[i]) * prime;
+    }
+    for (uint64_t i=0; i<header.valueSize; i++)
+    {
+        hash = (hash ^ pValue[i]) * prime;
+    }
+    return hash;
+}
+
+bool DatabaseFileStore::hex2key(const string &key, DatabaseFileKey &fileKey)
+{
+    if (key.size() != 64)
+    {
+        zklog.error("DatabaseFileStore::hex2key() found invalid key size=" + to_string(key.size()) + " key=" + key);
+        return false;
+    }
+    uint64_t size = 32;
+    string2ba(key, fileKey.bytes, size);
+    return true;
+}
+
+void DatabaseFileStore::appendRecord(string &buffer, uint32_t type, const DatabaseFileKey &key, const uint8_t *pValue, uint32_t valueSize)
+{
+    DatabaseFileRecordHeader header;
+    header.type = type;
+    header.valueSize = valueSize;
+    memcpy(header.key, key.bytes, 32);
+    header.checksum = checksum(header, pValue);
+    buffer.append((const char *)&header, sizeof(header));
+    buffer.append((const char *)pValue, valueSize);
+    buffer.append(paddedSize(valueSize) - valueSize, 0);
+}
+
+void DatabaseFileStore::appendCommit(string &buffer, uint64_t flushId)
+{
+    DatabaseFileKey key;
+    memset(key.bytes, 0, 32);
+    memcpy(key.bytes, &flushId, 8);
+    appendRecord(buffer, DATABASE_FILE_RECORD_COMMIT, key, NULL, 0);
+}
+
+void DatabaseFileStore::addToIndex(uint32_t type, const DatabaseFileKey &key, const DatabaseFileLocation &location)
+{
+    DatabaseFileIndex &index = (type == DATABASE_FILE_RECORD_PROGRAM) ? programIndex : nodesIndex;
+    pair<DatabaseFileIndex::iterator, bool> result = index.emplace(key, location);
+    if (!result.second)
+    {
+        // The previous record of this key is superseded by the new one
+        deadBytes += sizeof(DatabaseFileRecordHeader) + paddedSize(result.first->second.size);
+        result.first->second = location;
+    }
+}
+
+zkresult DatabaseFileStore::mapFile(uint64_t size)
+{
+    if ((pMap != NULL) && (size <= mapSize))
+    {
+        return ZKR_SUCCESS;
+    }
+
+    // Reserve twice the required size, so that the file can grow without remapping it on every write;
+    // pages beyond the end of the file are never accessed
+    uint64_t newMapSize = zkmax(DATABASE_FILE_MIN_MAP_SIZE, 2*size);
+    uint8_t *pNewMap = (uint8_t *)mmap(NULL, newMapSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (pNewMap == MAP_FAILED)
+    {
+        zklog.error("DatabaseFileStore::mapFile() failed calling mmap() of size=" + to_string(newMapSize) + " errno=" + to_string(errno) + "=" + strerror(errno));
+        return ZKR_DB_ERROR;
+    }
+    if (pMap != NULL)
+    {
+        munmap(pMap, mapSize);
+    }
+    pMap = pNewMap;
+    mapSize = newMapSize;
+
+    return ZKR_SUCCESS;
+}
+
+zkresult DatabaseFileStore::append(const string &buffer)
+{
+    uint64_t written = 0;
+    while (written < buffer.size())
+    {
+        ssize_t result = pwrite(fd, buffer.data() + written, buffer.size() - written, fileSize + written);
+        if (result < 0)
+        {
+            if (errno == EINTR) continue;
+            zklog.error("DatabaseFileStore::append() failed calling pwrite() errno=" + to_string(errno) + "=" + strerror(errno));
+            break;
+        }
+        written += result;
+    }
+
+    if ((written == buffer.size()) && (fdatasync(fd) == 0))
+    {
+        return ZKR_SUCCESS;
+    }
+
+    zklog.error("DatabaseFileStore::append() failed writing " + to_string(buffer.size()) + " bytes, errno=" + to_string(errno) + "=" + strerror(errno));
+
+    // Discard the partially written data; if this fails, replay will discard it since there is no commit record
+    if (ftruncate(fd, fileSize) != 0)
+    {
+        zklog.error("DatabaseFileStore::append() failed calling ftruncate() errno=" + to_string(errno) + "=" + strerror(errno));
+    }
+
+    return ZKR_DB_ERROR;
+}
+
+zkresult DatabaseFileStore::open(const string &_fileName, uint64_t compactionThreshold, bool readOnly)
+{
+    {
+        lock_guard<mutex> writeLock(writeMutex);
+
+        // The store is shared by all Database instances, so only the first call opens it
+        if (bOpen)
+        {
+            if (_fileName != fileName)
+            {
+                zklog.error("DatabaseFileStore::open() called with fileName=" + _fileName + " but already open with fileName=" + fileName);
+                return ZKR_DB_ERROR;
+            }
+            return ZKR_SUCCESS;
+        }
+
+        TimerStart(DATABASE_FILE_STORE_OPEN);
+
+        fileName = _fileName;
+        bReadOnly = readOnly;
+
+        fd = ::open(fileName.c_str(), readOnly ? O_RDONLY : (O_RDWR | O_CREAT), 0644);
+        if (fd < 0)
+        {
+            zklog.error("DatabaseFileStore::open() failed calling open() fileName=" + fileName + " errno=" + to_string(errno) + "=" + strerror(errno));
+            return ZKR_DB_ERROR;
+        }
+
+        zkresult zkr = load();
+        if (zkr != ZKR_SUCCESS)
+        {
+            ::close(fd);
+            fd = -1;
+            return zkr;
+        }
+
+        bOpen = true;
+
+        TimerStopAndLog(DATABASE_FILE_STORE_OPEN);
+
+        print();
+
+        if (readOnly || (compactionThreshold == 0) || (deadBytes*100 <= fileSize*compactionThreshold))
+        {
+            return ZKR_SUCCESS;
+        }
+    }
+
+    zklog.info("DatabaseFileStore::open() dead bytes=" + to_string(deadBytes) + " exceed " + to_string(compactionThreshold) + "% of file size=" + to_string(fileSize) + "; compacting");
+    return compact();
+}
+
+zkresult DatabaseFileStore::load(void)
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        zklog.error("DatabaseFileStore::load() failed calling fstat() errno=" + to_string(errno) + "=" + strerror(errno));
+        return ZKR_DB_ERROR;
+    }
+    uint64_t size = st.st_size;
+
+    // If the file is new, write the header
+    if (size == 0)
+    {
+        if (bReadOnly)
+        {
+            zklog.error("DatabaseFileStore::load() found an empty file in read-only mode fileName=" + fileName);
+            return ZKR_DB_ERROR;
+        }
+        DatabaseFileHeader header;
+        memcpy(header.magic, DATABASE_FILE_MAGIC, 8);
+        header.version = DATABASE_FILE_VERSION;
+        fileSize = 0;
+        zkresult zkr = append(string((const char *)&header, sizeof(header)));
+        if (zkr != ZKR_SUCCESS)
+        {
+            return zkr;
+        }
+        size = sizeof(header);
+    }
+
+    zkresult zkr = mapFile(size);
+    if (zkr != ZKR_SUCCESS)
+    {
+        return zkr;
+    }
+
+    // Check the header
+    DatabaseFileHeader header;
+    if (size < sizeof(header))
+    {
+        zklog.error("DatabaseFileStore::load() found a too small file size=" + to_string(size) + " fileName=" + fileName);
+        return ZKR_DB_ERROR;
+    }
+    memcpy(&header, pMap, sizeof(header));
+    if ((memcmp(header.magic, DATABASE_FILE_MAGIC, 8) != 0) || (header.version != DATABASE_FILE_VERSION))
+    {
+        zklog.error("DatabaseFileStore::load() found an invalid header, version=" + to_string(header.version) + " fileName=" + fileName);
+        return ZKR_DB_ERROR;
+    }
+
+    // Replay the records; records are added to the indexes only when their commit record is found
+    struct Pending
+    {
+        uint32_t type;
+        DatabaseFileKey key;
+        DatabaseFileLocation location;
+    };
+    vector<Pending> pending;
+    uint64_t offset = sizeof(header);
+    uint64_t committedSize = offset;
+    DatabaseFileRecordHeader recordHeader;
+    while (offset + sizeof(recordHeader) <= size)
+    {
+        memcpy(&recordHeader, pMap + offset, sizeof(recordHeader));
+        if ((recordHeader.type < DATABASE_FILE_RECORD_NODE) ||
+            (recordHeader.type > DATABASE_FILE_RECORD_COMMIT) ||
+            (recordHeader.valueSize > DATABASE_FILE_MAX_VALUE_SIZE))
+        {
+            break;
+        }
+        uint64_t recordSize = sizeof(recordHeader) + paddedSize(recordHeader.valueSize);
+        if (offset + recordSize > size)
+        {
+            break;
+        }
+        if (checksum(recordHeader, pMap + offset + sizeof(recordHeader)) != recordHeader.checksum)
+        {
+            break;
+        }
+        if (recordHeader.type == DATABASE_FILE_RECORD_COMMIT)
+        {
+            for (uint64_t i=0; i<pending.size(); i++)
+            {
+                addToIndex(pending[i].type, pending[i].key, pending[i].location);
+            }
+            pending.clear();
+            memcpy(&lastFlushId, recordHeader.key, 8);
+            committedSize = offset + recordSize;
+        }
+        else
+        {
+            Pending p;
+            p.type = recordHeader.type;
+            memcpy(p.key.bytes, recordHeader.key, 32);
+            p.location.offset = offset + sizeof(recordHeader);
+            p.location.size = recordHeader.valueSize;
+            pending.emplace_back(p);
+        }
+        offset += recordSize;
+    }
+    fileSize = committedSize;
+
+    // Discard any uncommitted or corrupted tail, e.g. due to a crash in the middle of a flush
+    if (fileSize < size)
+    {
+        zklog.warning("DatabaseFileStore::load() discarding " + to_string(size - fileSize) + " uncommitted bytes at offset=" + to_string(fileSize) + " fileName=" + fileName);
+        if (!bReadOnly)
+        {
+            if ((ftruncate(fd, fileSize) != 0) || (fsync(fd) != 0))
+            {
+                zklog.error("DatabaseFileStore::load() failed truncating file errno=" + to_string(errno) + "=" + strerror(errno));
+                return ZKR_DB_ERROR;
+            }
+        }
+    }
+
+    return ZKR_SUCCESS;
+}
+
+void DatabaseFileStore::close(void)
+{
+    lock_guard<mutex> writeLock(writeMutex);
+    unique_lock<shared_mutex> indexLock(indexMutex);
+
+    if (pMap != NULL)
+    {
+        munmap(pMap, mapSize);
+        pMap = NULL;
+        mapSize = 0;
+    }
+    if (fd >= 0)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+    nodesIndex.clear();
+    programIndex.clear();
+    fileSize = 0;
+    deadBytes = 0;
+    lastFlushId = 0;
+    bOpen = false;
+}
+
+zkresult DatabaseFileStore::read(bool bProgram, const string &key, string &value)
+{
+    DatabaseFileKey fileKey;
+    if (!hex2key(key, fileKey))
+    {
+        return ZKR_DB_ERROR;
+    }
+
+    shared_lock<shared_mutex> indexLock(indexMutex);
+
+    const DatabaseFileIndex &index = bProgram ? programIndex : nodesIndex;
+    DatabaseFileIndex::const_iterator it = index.find(fileKey);
+    if (it == index.end())
+    {
+        return ZKR_DB_KEY_NOT_FOUND;
+    }
+
+    ba2string(value, pMap + it->second.offset, it->second.size);
+
+    return ZKR_SUCCESS;
+}
+
+zkresult DatabaseFileStore::write(bool bProgram, const string &key, const string &value, bool overwrite)
+{
+    unordered_map<string, string> empty;
+    uint64_t writtenBytes;
+
+    // Only the state root is overwritten
+    if (overwrite)
+    {
+        return writeBatch(empty, empty, key, value, lastFlushId, writtenBytes);
+    }
+
+    unordered_map<string, string> records;
+    records[key] = value;
+    return writeBatch(bProgram ? empty : records, bProgram ? records : empty, "", "", lastFlushId, writtenBytes);
+}
+
+zkresult DatabaseFileStore::writeBatch(const unordered_map<string, string> &nodes, const unordered_map<string, string> &program, const string &stateRootKey, const string &stateRootValue, uint64_t flushId, uint64_t &writtenBytes)
+{
+    writtenBytes = 0;
+
+    lock_guard<mutex> writeLock(writeMutex);
+
+    if (!bOpen || bReadOnly)
+    {
+        zklog.error("DatabaseFileStore::writeBatch() called with bOpen=" + to_string(bOpen) + " bReadOnly=" + to_string(bReadOnly));
+        return ZKR_DB_ERROR;
+    }
+
+    // Indexes are only modified by writers, so they can be read here without locking indexMutex
+    struct Pending
+    {
+        uint32_t type;
+        DatabaseFileKey key;
+        DatabaseFileLocation location;
+    };
+    vector<Pending> pending;
+    string buffer;
+    string binaryValue;
+    Pending p;
+
+    for (uint64_t t=0; t<2; t++)
+    {
+        const unordered_map<string, string> &records = (t == 0) ? nodes : program;
+        p.type = (t == 0) ? DATABASE_FILE_RECORD_NODE : DATABASE_FILE_RECORD_PROGRAM;
+        const DatabaseFileIndex &index = (t == 0) ? nodesIndex : programIndex;
+        unordered_map<string, string>::const_iterator it;
+        for (it = records.begin(); it != records.end(); it++)
+        {
+            if (!hex2key(it->first, p.key))
+            {
+                return ZKR_DB_ERROR;
+            }
+
+            // Same as ON CONFLICT DO NOTHING
+            if (index.find(p.key) != index.end())
+            {
+                continue;
+            }
+
+            string2ba(it->second, binaryValue);
+            p.location.offset = fileSize + buffer.size() + sizeof(DatabaseFileRecordHeader);
+            p.location.size = binaryValue.size();
+            appendRecord(buffer, p.type, p.key, (const uint8_t *)binaryValue.data(), binaryValue.size());
+            pending.emplace_back(p);
+        }
+    }
+
+    // The state root record always replaces the previous one
+    if (stateRootValue.size() > 0)
+    {
+        if (!hex2key(stateRootKey, p.key))
+        {
+            return ZKR_DB_ERROR;
+        }
+        string2ba(stateRootValue, binaryValue);
+        p.type = DATABASE_FILE_RECORD_NODE;
+        p.location.offset = fileSize + buffer.size() + sizeof(DatabaseFileRecordHeader);
+        p.location.size = binaryValue.size();
+        appendRecord(buffer, p.type, p.key, (const uint8_t *)binaryValue.data(), binaryValue.size());
+        pending.emplace_back(p);
+    }
+
+    if (pending.size() == 0)
+    {
+        return ZKR_SUCCESS;
+    }
+
+    // Append all records plus the commit record, and sync them at once
+    appendCommit(buffer, flushId);
+    zkresult zkr = append(buffer);
+    if (zkr != ZKR_SUCCESS)
+    {
+        return zkr;
+    }
+
+    // Make the new records visible to readers
+    unique_lock<shared_mutex> indexLock(indexMutex);
+    zkr = mapFile(fileSize + buffer.size());
+    if (zkr != ZKR_SUCCESS)
+    {
+        zklog.error("DatabaseFileStore::writeBatch() failed calling mapFile()");
+        exitProcess();
+    }
+    fileSize += buffer.size();
+    for (uint64_t i=0; i<pending.size(); i++)
+    {
+        addToIndex(pending[i].type, pending[i].key, pending[i].location);
+    }
+    lastFlushId = flushId;
+    writtenBytes = buffer.size();
+
+    return ZKR_SUCCESS;
+}
+
+zkresult DatabaseFileStore::compact(void)
+{
+    lock_guard<mutex> writeLock(writeMutex);
+
+    if (!bOpen || bReadOnly)
+    {
+        zklog.error("DatabaseFileStore::compact() called with bOpen=" + to_string(bOpen) + " bReadOnly=" + to_string(bReadOnly));
+        return ZKR_DB_ERROR;
+    }
+
+    TimerStart(DATABASE_FILE_STORE_COMPACT);
+
+    string tmpFileName = fileName + ".compact";
+    int tmpFd = ::open(tmpFileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (tmpFd < 0)
+    {
+        zklog.error("DatabaseFileStore::compact() failed calling open() fileName=" + tmpFileName + " errno=" + to_string(errno) + "=" + strerror(errno));
+        return ZKR_DB_ERROR;
+    }
+
+    // Copy the live records to the temporary file, in chunks, building the new indexes
+    DatabaseFileIndex newNodesIndex;
+    DatabaseFileIndex newProgramIndex;
+    DatabaseFileHeader header;
+    memcpy(header.magic, DATABASE_FILE_MAGIC, 8);
+    header.version = DATABASE_FILE_VERSION;
+    string buffer((const char *)&header, sizeof(header));
+    uint64_t newFileSize = 0;
+    bool bError = false;
+
+    for (uint64_t t=0; (t<3) && !bError; t++)
+    {
+        if (t < 2)
+        {
+            const DatabaseFileIndex &index = (t == 0) ? nodesIndex : programIndex;
+            DatabaseFileIndex &newIndex = (t == 0) ? newNodesIndex : newProgramIndex;
+            uint32_t type = (t == 0) ? DATABASE_FILE_RECORD_NODE : DATABASE_FILE_RECORD_PROGRAM;
+            newIndex.reserve(index.size());
+            DatabaseFileIndex::const_iterator it;
+            for (it = index.begin(); it != index.end(); it++)
+            {
+                DatabaseFileLocation location;
+                location.offset = newFileSize + buffer.size() + sizeof(DatabaseFileRecordHeader);
+                location.size = it->second.size;
+                appendRecord(buffer, type, it->first, pMap + it->second.offset, it->second.size);
+                newIndex.emplace(it->first, location);
+                if (buffer.size() >= 64*1024*1024)
+                {
+                    if (::write(tmpFd, buffer.data(), buffer.size()) != (ssize_t)buffer.size())
+                    {
+                        bError = true;
+                        break;
+                    }
+                    newFileSize += buffer.size();
+                    buffer.clear();
+                }
+            }
+        }
+        else
+        {
+            appendCommit(buffer, lastFlushId);
+            if (::write(tmpFd, buffer.data(), buffer.size()) != (ssize_t)buffer.size())
+            {
+                bError = true;
+                break;
+            }
+            newFileSize += buffer.size();
+        }
+    }
+
+    if (bError || (fsync(tmpFd) != 0))
+    {
+        zklog.error("DatabaseFileStore::compact() failed writing fileName=" + tmpFileName + " errno=" + to_string(errno) + "=" + strerror(errno));
+        ::close(tmpFd);
+        unlink(tmpFileName.c_str());
+        return ZKR_DB_ERROR;
+    }
+
+    // Atomically replace the file, and sync the directory to persist the rename
+    if (rename(tmpFileName.c_str(), fileName.c_str()) != 0)
+    {
+        zklog.error("DatabaseFileStore::compact() failed calling rename() errno=" + to_string(errno) + "=" + strerror(errno));
+        ::close(tmpFd);
+        unlink(tmpFileName.c_str());
+        return ZKR_DB_ERROR;
+    }
+    size_t slash = fileName.rfind('/');
+    string dirName = (slash == string::npos) ? "." : fileName.substr(0, zkmax(slash, (size_t)1));
+    int dirFd = ::open(dirName.c_str(), O_RDONLY);
+    if (dirFd >= 0)
+    {
+        fsync(dirFd);
+        ::close(dirFd);
+    }
+
+    // Switch to the new file
+    unique_lock<shared_mutex> indexLock(indexMutex);
+    uint64_t oldFileSize = fileSize;
+    munmap(pMap, mapSize);
+    pMap = NULL;
+    mapSize = 0;
+    ::close(fd);
+    fd = tmpFd;
+    if (mapFile(newFileSize) != ZKR_SUCCESS)
+    {
+        zklog.error("DatabaseFileStore::compact() failed calling mapFile()");
+        exitProcess();
+    }
+    nodesIndex.swap(newNodesIndex);
+    programIndex.swap(newProgramIndex);
+    fileSize = newFileSize;
+    deadBytes = 0;
+
+    TimerStopAndLog(DATABASE_FILE_STORE_COMPACT);
+
+    zklog.info("DatabaseFileStore::compact() reduced file size from " + to_string(oldFileSize) + " to " + to_string(newFileSize) + " bytes");
+
+    return ZKR_SUCCESS;
+}
+
+void DatabaseFileStore::print(void)
+{
+    zklog.info("DatabaseFileStore::print() fileName=" + fileName +
+        " fileSize=" + to_string(fileSize) +
+        " nodes=" + to_string(nodesIndex.size()) +
+        " program=" + to_string(programIndex.size()) +
+        " deadBytes=" + to_string(deadBytes) +
+        " lastFlushId=" + to_string(lastFlushId) +
+        " readOnly=" + to_string(bReadOnly));
+}
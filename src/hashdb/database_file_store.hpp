@@ -0,0 +1,139 @@
+#ifndef DATABASE_FILE_STORE_HPP
+#define DATABASE_FILE_STORE_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <shared_mutex>
+#include <cstring>
+#include "zkresult.hpp"
+
+using namespace std;
+
+/*
+    Embedded, append-only key-value file used as a local persistent backend of Database
+
+    File layout:
+        DatabaseFileHeader
+        Records: DatabaseFileRecordHeader + value bytes, padded to 8 bytes
+
+    Every flush appends the node and program records followed by a commit record containing
+    the MultiWrite flush ID, and syncs the file once.  At start-up, the file is replayed and
+    any record after the last commit record (e.g. a torn write) is discarded.
+    Records are read through a read-only shared memory map of the file.
+*/
+
+#define DATABASE_FILE_MAGIC "ZKDBFILE"
+#define DATABASE_FILE_VERSION 1
+
+#define DATABASE_FILE_RECORD_NODE    1
+#define DATABASE_FILE_RECORD_PROGRAM 2
+#define DATABASE_FILE_RECORD_COMMIT  3
+
+// Maximum size of a record value; larger sizes are considered a corrupted record
+#define DATABASE_FILE_MAX_VALUE_SIZE (64*1024*1024)
+
+// Minimum size of the memory map; it is reserved beyond the file size to avoid frequent remaps
+#define DATABASE_FILE_MIN_MAP_SIZE (1ULL << 30)
+
+struct DatabaseFileHeader
+{
+    char magic[8];
+    uint64_t version;
+};
+
+struct DatabaseFileRecordHeader
+{
+    uint32_t type;
+    uint32_t valueSize;
+    uint8_t key[32]; // Hash of the node or program; flush ID in the first 8 bytes for commit records
+    uint64_t checksum; // FNV-1a of type, valueSize, key and value
+};
+
+struct DatabaseFileKey
+{
+    uint8_t bytes[32];
+    bool operator==(const DatabaseFileKey &other) const { return memcmp(bytes, other.bytes, 32) == 0; };
+};
+
+struct DatabaseFileKeyHash
+{
+    // Keys are hashes, so any 8 bytes of them are uniformly distributed
+    size_t operator()(const DatabaseFileKey &key) const { uint64_t h; memcpy(&h, key.bytes, 8); return h; };
+};
+
+struct DatabaseFileLocation
+{
+    uint64_t offset; // Offset of the value in the file
+    uint32_t size; // Size of the value
+};
+
+typedef unordered_map<DatabaseFileKey, DatabaseFileLocation, DatabaseFileKeyHash> DatabaseFileIndex;
+
+class DatabaseFileStore
+{
+private:
+    string fileName;
+    int fd;
+    bool bOpen;
+    bool bReadOnly;
+
+    // Memory map of the file, covering at least the committed size
+    uint8_t *pMap;
+    uint64_t mapSize;
+
+    // Committed file size; records beyond it are not visible
+    uint64_t fileSize;
+
+    // Bytes of records that have been superseded by a newer record of the same key
+    uint64_t deadBytes;
+
+    // Last flush ID committed to the file
+    uint64_t lastFlushId;
+
+    // Hash indexes
+    DatabaseFileIndex nodesIndex;
+    DatabaseFileIndex programIndex;
+
+    shared_mutex indexMutex; // Protects the indexes and the memory map; readers share it
+    mutex writeMutex; // Serializes writers
+
+    // Helpers
+    static uint64_t checksum(const DatabaseFileRecordHeader &header, const uint8_t *pValue);
+    static uint64_t paddedSize(uint64_t valueSize) { return (valueSize + 7) & ~uint64_t(7); };
+    static bool hex2key(const string &key, DatabaseFileKey &fileKey);
+    static void appendRecord(string &buffer, uint32_t type, const DatabaseFileKey &key, const uint8_t *pValue, uint32_t valueSize);
+    static void appendCommit(string &buffer, uint64_t flushId);
+    zkresult load(void);
+    zkresult mapFile(uint64_t size);
+    zkresult append(const string &buffer);
+    void addToIndex(uint32_t type, const DatabaseFileKey &key, const DatabaseFileLocation &location);
+
+public:
+    DatabaseFileStore() : fd(-1), bOpen(false), bReadOnly(false), pMap(NULL), mapSize(0), fileSize(0), deadBytes(0), lastFlushId(0) {};
+    ~DatabaseFileStore();
+
+    // Opens the file, creating it if it does not exist, and replays it to build the indexes;
+    // if dead bytes exceed compactionThreshold percent of the file size, the file is compacted
+    zkresult open(const string &fileName, uint64_t compactionThreshold, bool readOnly);
+    void close(void);
+    bool isOpen(void) { return bOpen; };
+
+    // Keys and values are hexa strings, as used by the remote database
+    zkresult read(bool bProgram, const string &key, string &value);
+
+    // Writes and syncs a single record; if overwrite is false and the key exists, nothing is done
+    zkresult write(bool bProgram, const string &key, const string &value, bool overwrite);
+
+    // Writes all nodes and program records, plus the state root, if not empty, and syncs them as one commit
+    zkresult writeBatch(const unordered_map<string, string> &nodes, const unordered_map<string, string> &program, const string &stateRootKey, const string &stateRootValue, uint64_t flushId, uint64_t &writtenBytes);
+
+    // Rewrites the file keeping only the live records
+    zkresult compact(void);
+
+    uint64_t getLastFlushId(void) { return lastFlushId; };
+    void print(void);
+};
+
+#endif
@@ -0,0 +1,383 @@
+#include <cstring>
+#include "database_mt_cache.hpp"
+#include "zklog.hpp"
+#include "zkmax.hpp"
+#include "zkassert.hpp"
+#include "exit_process.hpp"
+#include "timer.hpp"
+
+// DatabaseMTCache class implementation
+
+DatabaseMTCache::~DatabaseMTCache()
+{
+    TimerStart(DATABASE_MT_CACHE_DESTRUCTOR);
+    clear();
+    TimerStopAndLog(DATABASE_MT_CACHE_DESTRUCTOR);
+}
+
+void DatabaseMTCache::setMaxSize(int64_t size)
+{
+    maxSize = (size > 0) ? size : 0;
+    for (uint64_t i=0; i<DATABASE_MT_CACHE_SHARDS; i++)
+    {
+        lock_guard<mutex> guard(shards[i].mlock);
+        shards[i].maxSize = maxSize / DATABASE_MT_CACHE_SHARDS;
+    }
+}
+
+// Add a record in the head of its shard. Returns true if the cache is full (or no cache), false otherwise
+bool DatabaseMTCache::add(const Goldilocks::Element (&key)[4], const vector<Goldilocks::Element> &value, const bool update)
+{
+    if (maxSize == 0) return true;
+
+    if (value.size() > 12)
+    {
+        zklog.error("DatabaseMTCache::add() name=" + name + " got invalid value.size()=" + to_string(value.size()));
+        return true;
+    }
+
+    DatabaseMTCacheShard &shard = shards[shardIndex(key)];
+
+    lock_guard<mutex> guard(shard.mlock);
+
+    // If key already exists in the cache, move it to the head and update it if requested
+    uint32_t index = findRecord(shard, key);
+    if (index != DATABASE_MT_CACHE_NULL)
+    {
+        moveToHead(shard, index);
+        if (update)
+        {
+            DatabaseMTCacheRecord &record = shard.record(index);
+            for (uint64_t i=0; i<value.size(); i++) record.value[i] = value[i];
+            record.valueSize = value.size();
+            return true;
+        }
+        return false;
+    }
+
+    // Keep the hash table load factor under 1
+    if (shard.count >= shard.buckets.size())
+    {
+        resizeBuckets(shard, zkmax(shard.buckets.size()*2, (uint64_t)1024));
+    }
+
+    // Fill a new record
+    index = allocRecord(shard);
+    DatabaseMTCacheRecord &record = shard.record(index);
+    record.key[0] = key[0];
+    record.key[1] = key[1];
+    record.key[2] = key[2];
+    record.key[3] = key[3];
+    for (uint64_t i=0; i<value.size(); i++) record.value[i] = value[i];
+    record.valueSize = value.size();
+
+    // Insert it into the hash table
+    uint64_t bucket = bucketHash(key) & shard.bucketsMask;
+    record.hashNext = shard.buckets[bucket];
+    shard.buckets[bucket] = index;
+
+    // Insert it at the head of the LRU list
+    record.prev = DATABASE_MT_CACHE_NULL;
+    record.next = shard.head;
+    if (shard.head == DATABASE_MT_CACHE_NULL)
+    {
+        shard.last = index;
+    }
+    else
+    {
+        shard.record(shard.head).prev = index;
+    }
+    shard.head = index;
+
+    shard.count++;
+    shard.currentSize += recordSize;
+    bool full = (shard.currentSize > shard.maxSize);
+
+    // Remove last records from the shard to be under its max size
+    while ((shard.currentSize > shard.maxSize) && (shard.last != shard.head))
+    {
+        uint32_t lastIndex = shard.last;
+        DatabaseMTCacheRecord &lastRecord = shard.record(lastIndex);
+        shard.last = lastRecord.prev;
+        shard.record(shard.last).next = DATABASE_MT_CACHE_NULL;
+
+        unlinkFromBucket(shard, lastIndex);
+
+        // Return the record to the free list
+        lastRecord.hashNext = shard.freeList;
+        shard.freeList = lastIndex;
+
+        zkassert(shard.currentSize >= recordSize);
+        shard.count--;
+        shard.currentSize -= recordSize;
+    }
+
+    return full;
+}
+
+bool DatabaseMTCache::find(const Goldilocks::Element (&key)[4], vector<Goldilocks::Element> &value)
+{
+    if (maxSize == 0) return false;
+
+    uint64_t index = shardIndex(key);
+    DatabaseMTCacheShard &shard = shards[index];
+
+    // Statistics; only shard 0 reports, roughly every 1M attempts of the whole cache
+    uint64_t attempts = shard.attempts.fetch_add(1, memory_order_relaxed) + 1;
+    if ((index == 0) && ((attempts % (1000000/DATABASE_MT_CACHE_SHARDS)) == 0))
+    {
+        logStatistics();
+    }
+
+    lock_guard<mutex> guard(shard.mlock);
+
+    uint32_t recordIndex = findRecord(shard, key);
+    if (recordIndex == DATABASE_MT_CACHE_NULL)
+    {
+        return false;
+    }
+
+    shard.hits.fetch_add(1, memory_order_relaxed);
+    moveToHead(shard, recordIndex);
+
+    DatabaseMTCacheRecord &record = shard.record(recordIndex);
+    value.assign(record.value, record.value + record.valueSize);
+
+    return true;
+}
+
+uint32_t DatabaseMTCache::findRecord(DatabaseMTCacheShard &shard, const Goldilocks::Element (&key)[4])
+{
+    if (shard.buckets.size() == 0)
+    {
+        return DATABASE_MT_CACHE_NULL;
+    }
+    uint32_t index = shard.buckets[bucketHash(key) & shard.bucketsMask];
+    while (index != DATABASE_MT_CACHE_NULL)
+    {
+        DatabaseMTCacheRecord &record = shard.record(index);
+        if (keyEqual(record.key, key))
+        {
+            return index;
+        }
+        index = record.hashNext;
+    }
+    return DATABASE_MT_CACHE_NULL;
+}
+
+uint32_t DatabaseMTCache::allocRecord(DatabaseMTCacheShard &shard)
+{
+    // Reuse a free record, if any
+    if (shard.freeList != DATABASE_MT_CACHE_NULL)
+    {
+        uint32_t index = shard.freeList;
+        shard.freeList = shard.record(index).hashNext;
+        return index;
+    }
+
+    if (shard.allocatedRecords == DATABASE_MT_CACHE_NULL)
+    {
+        zklog.error("DatabaseMTCache::allocRecord() name=" + name + " run out of record indexes");
+        exitProcess();
+    }
+
+    // Allocate a new slab if the current one is exhausted
+    if ((shard.allocatedRecords & (DATABASE_MT_CACHE_SLAB_SIZE - 1)) == 0)
+    {
+        DatabaseMTCacheRecord * pSlab = new DatabaseMTCacheRecord[DATABASE_MT_CACHE_SLAB_SIZE];
+        if (pSlab == NULL)
+        {
+            zklog.error("DatabaseMTCache::allocRecord() failed calling new DatabaseMTCacheRecord[" + to_string(DATABASE_MT_CACHE_SLAB_SIZE) + "]");
+            exitProcess();
+        }
+        shard.slabs.push_back(pSlab);
+    }
+
+    return shard.allocatedRecords++;
+}
+
+void DatabaseMTCache::moveToHead(DatabaseMTCacheShard &shard, uint32_t index)
+{
+    if (shard.head == index)
+    {
+        return;
+    }
+
+    DatabaseMTCacheRecord &record = shard.record(index);
+
+    // Remove record from the current position
+    shard.record(record.prev).next = record.next;
+
+    // If record is the last then set record->prev as the new last
+    if (shard.last == index) shard.last = record.prev;
+    else shard.record(record.next).prev = record.prev;
+
+    // Put record on top/head of the list
+    shard.record(shard.head).prev = index;
+    record.prev = DATABASE_MT_CACHE_NULL;
+    record.next = shard.head;
+    shard.head = index;
+}
+
+void DatabaseMTCache::unlinkFromBucket(DatabaseMTCacheShard &shard, uint32_t index)
+{
+    DatabaseMTCacheRecord &record = shard.record(index);
+    uint32_t * pIndex = &shard.buckets[bucketHash(record.key) & shard.bucketsMask];
+    while (*pIndex != index)
+    {
+        zkassert(*pIndex != DATABASE_MT_CACHE_NULL);
+        pIndex = &shard.record(*pIndex).hashNext;
+    }
+    *pIndex = record.hashNext;
+}
+
+void DatabaseMTCache::resizeBuckets(DatabaseMTCacheShard &shard, uint64_t newSize)
+{
+    zkassert((newSize & (newSize - 1)) == 0);
+
+    shard.buckets.assign(newSize, DATABASE_MT_CACHE_NULL);
+    shard.bucketsMask = newSize - 1;
+
+    // Re-insert all records, walking the LRU list
+    uint32_t index = shard.head;
+    while (index != DATABASE_MT_CACHE_NULL)
+    {
+        DatabaseMTCacheRecord &record = shard.record(index);
+        uint64_t bucket = bucketHash(record.key) & shard.bucketsMask;
+        record.hashNext = shard.buckets[bucket];
+        shard.buckets[bucket] = index;
+        index = record.next;
+    }
+}
+
+uint64_t DatabaseMTCache::getCurrentSize(void)
+{
+    uint64_t currentSize = 0;
+    for (uint64_t i=0; i<DATABASE_MT_CACHE_SHARDS; i++)
+    {
+        lock_guard<mutex> guard(shards[i].mlock);
+        currentSize += shards[i].currentSize;
+    }
+    return currentSize;
+}
+
+uint64_t DatabaseMTCache::getCount(void)
+{
+    uint64_t count = 0;
+    for (uint64_t i=0; i<DATABASE_MT_CACHE_SHARDS; i++)
+    {
+        lock_guard<mutex> guard(shards[i].mlock);
+        count += shards[i].count;
+    }
+    return count;
+}
+
+void DatabaseMTCache::getHotSet(uint64_t maxRecords, vector<DatabaseCacheSnapshotRecord> &records)
+{
+    records.clear();
+    if (maxSize == 0) return;
+
+    // Take the most recently used records of every shard, walking its LRU list from the head
+    uint64_t maxShardRecords = (maxRecords + DATABASE_MT_CACHE_SHARDS - 1) / DATABASE_MT_CACHE_SHARDS;
+    vector<DatabaseCacheSnapshotRecord> shardRecords[DATABASE_MT_CACHE_SHARDS];
+    for (uint64_t i=0; i<DATABASE_MT_CACHE_SHARDS; i++)
+    {
+        DatabaseMTCacheShard &shard = shards[i];
+        lock_guard<mutex> guard(shard.mlock);
+        shardRecords[i].reserve(zkmin(maxShardRecords, shard.count));
+        uint32_t index = shard.head;
+        while ((index != DATABASE_MT_CACHE_NULL) && (shardRecords[i].size() < maxShardRecords))
+        {
+            DatabaseMTCacheRecord &record = shard.record(index);
+            DatabaseCacheSnapshotRecord snapshotRecord;
+            memcpy(snapshotRecord.key, record.key, sizeof(snapshotRecord.key));
+            memset(snapshotRecord.value, 0, sizeof(snapshotRecord.value));
+            memcpy(snapshotRecord.value, record.value, record.valueSize*sizeof(Goldilocks::Element));
+            snapshotRecord.valueSize = record.valueSize;
+            shardRecords[i].push_back(snapshotRecord);
+            index = record.next;
+        }
+    }
+
+    // Interleave the shards, so that the result is globally ordered from most to least recently used
+    for (uint64_t r=0; (r<maxShardRecords) && (records.size()<maxRecords); r++)
+    {
+        for (uint64_t i=0; (i<DATABASE_MT_CACHE_SHARDS) && (records.size()<maxRecords); i++)
+        {
+            if (r < shardRecords[i].size())
+            {
+                records.push_back(shardRecords[i][r]);
+            }
+        }
+    }
+}
+
+void DatabaseMTCache::logStatistics(void)
+{
+    uint64_t attempts = 0;
+    uint64_t hits = 0;
+    for (uint64_t i=0; i<DATABASE_MT_CACHE_SHARDS; i++)
+    {
+        attempts += shards[i].attempts.load(memory_order_relaxed);
+        hits += shards[i].hits.load(memory_order_relaxed);
+    }
+    zklog.info("DatabaseMTCache::find() name=" + name + " count=" + to_string(getCount()) + " maxSize=" + to_string(maxSize) + " currentSize=" + to_string(getCurrentSize()) + " attempts=" + to_string(attempts) + " hits=" + to_string(hits) + " hit ratio=" + to_string(double(hits)*100.0/double(zkmax(attempts,1))) + "%");
+}
+
+void DatabaseMTCache::print(bool printContent)
+{
+    zklog.info("DatabaseMTCache::print() printContent=" + to_string(printContent) + " name=" + name);
+    zklog.info("Cache current size: " + to_string(getCurrentSize()));
+    zklog.info("Cache max size: " + to_string(maxSize));
+
+    uint64_t count = 0;
+    for (uint64_t i=0; i<DATABASE_MT_CACHE_SHARDS; i++)
+    {
+        DatabaseMTCacheShard &shard = shards[i];
+        lock_guard<mutex> guard(shard.mlock);
+        zklog.info("Shard " + to_string(i) + " count=" + to_string(shard.count) + " currentSize=" + to_string(shard.currentSize) + " slabs=" + to_string(shard.slabs.size()) + " buckets=" + to_string(shard.buckets.size()));
+        uint32_t index = shard.head;
+        while (index != DATABASE_MT_CACHE_NULL)
+        {
+            DatabaseMTCacheRecord &record = shard.record(index);
+            if (printContent)
+            {
+                zklog.info("key:" + Goldilocks::toString(record.key[3], 16) + ":" + Goldilocks::toString(record.key[2], 16) + ":" + Goldilocks::toString(record.key[1], 16) + ":" + Goldilocks::toString(record.key[0], 16) + " valueSize=" + to_string(record.valueSize) + " prev=" + to_string(record.prev) + " next=" + to_string(record.next));
+            }
+            count++;
+            index = record.next;
+        }
+    }
+    zklog.info("Cache count: " + to_string(count));
+    zklog.info("Cache calculated size: " + to_string(count*recordSize));
+}
+
+void DatabaseMTCache::clearShard(DatabaseMTCacheShard &shard)
+{
+    for (uint64_t i=0; i<shard.slabs.size(); i++)
+    {
+        delete[] shard.slabs[i];
+    }
+    shard.slabs.clear();
+    shard.slabs.shrink_to_fit();
+    shard.allocatedRecords = 0;
+    shard.freeList = DATABASE_MT_CACHE_NULL;
+    shard.buckets.clear();
+    shard.buckets.shrink_to_fit();
+    shard.bucketsMask = 0;
+    shard.head = DATABASE_MT_CACHE_NULL;
+    shard.last = DATABASE_MT_CACHE_NULL;
+    shard.count = 0;
+    shard.currentSize = 0;
+    shard.attempts = 0;
+    shard.hits = 0;
+}
+
+void DatabaseMTCache::clear(void)
+{
+    for (uint64_t i=0; i<DATABASE_MT_CACHE_SHARDS; i++)
+    {
+        lock_guard<mutex> guard(shards[i].mlock);
+        clearShard(shards[i]);
+    }
+}
@@ -0,0 +1,121 @@
+#ifndef DATABASE_MT_CACHE_HPP
+#define DATABASE_MT_CACHE_HPP
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include "goldilocks_base_field.hpp"
+#include "zklog.hpp"
+#include "database_cache_snapshot.hpp"
+
+using namespace std;
+
+// Number of independent shards; every shard has its own lock, LRU list, hash table and slab
+#define DATABASE_MT_CACHE_SHARDS_BITS 6
+#define DATABASE_MT_CACHE_SHARDS (1 << DATABASE_MT_CACHE_SHARDS_BITS)
+
+// Number of records allocated at once per slab
+#define DATABASE_MT_CACHE_SLAB_BITS 12
+#define DATABASE_MT_CACHE_SLAB_SIZE (1 << DATABASE_MT_CACHE_SLAB_BITS)
+
+// Null record index
+#define DATABASE_MT_CACHE_NULL UINT32_MAX
+
+// Fixed-size cache record, keyed by the raw 4-field-element hash, containing up to 12 field elements
+struct DatabaseMTCacheRecord
+{
+    Goldilocks::Element key[4];
+    Goldilocks::Element value[12];
+    uint32_t prev; // LRU list, towards head
+    uint32_t next; // LRU list, towards last
+    uint32_t hashNext; // Next record in the same hash table bucket
+    uint32_t valueSize; // Number of used field elements in value, up to 12
+};
+
+class DatabaseMTCacheShard
+{
+public:
+    mutex mlock;
+
+    // Slab-allocated records; record index i lives in slabs[i >> SLAB_BITS][i & (SLAB_SIZE-1)]
+    vector<DatabaseMTCacheRecord *> slabs;
+    uint32_t allocatedRecords; // Number of records ever handed out from slabs
+    uint32_t freeList; // Head of the list of free records, chained through hashNext
+
+    // Hash table of record indexes, chained through hashNext
+    vector<uint32_t> buckets;
+    uint64_t bucketsMask;
+
+    // LRU list
+    uint32_t head;
+    uint32_t last;
+    uint64_t count;
+
+    // Size in bytes
+    uint64_t maxSize;
+    uint64_t currentSize;
+
+    // Statistics
+    atomic<uint64_t> attempts;
+    atomic<uint64_t> hits;
+
+    DatabaseMTCacheShard() :
+        allocatedRecords(0),
+        freeList(DATABASE_MT_CACHE_NULL),
+        bucketsMask(0),
+        head(DATABASE_MT_CACHE_NULL),
+        last(DATABASE_MT_CACHE_NULL),
+        count(0),
+        maxSize(0),
+        currentSize(0),
+        attempts(0),
+        hits(0)
+        {};
+
+    inline DatabaseMTCacheRecord &record(uint32_t index) { return slabs[index >> DATABASE_MT_CACHE_SLAB_BITS][index & (DATABASE_MT_CACHE_SLAB_SIZE - 1)]; };
+};
+
+class DatabaseMTCache
+{
+private:
+    DatabaseMTCacheShard shards[DATABASE_MT_CACHE_SHARDS];
+    uint64_t maxSize;
+    string name;
+
+    // Shard and bucket selectors; keys are hashes, so their bits are uniformly distributed
+    static inline uint64_t shardIndex(const Goldilocks::Element (&key)[4]) { return key[0].fe & (DATABASE_MT_CACHE_SHARDS - 1); };
+    static inline uint64_t bucketHash(const Goldilocks::Element (&key)[4]) { return (key[0].fe >> DATABASE_MT_CACHE_SHARDS_BITS) ^ key[1].fe; };
+    static inline bool keyEqual(const Goldilocks::Element (&a)[4], const Goldilocks::Element (&b)[4]) { return (a[0].fe == b[0].fe) && (a[1].fe == b[1].fe) && (a[2].fe == b[2].fe) && (a[3].fe == b[3].fe); };
+
+    // Shard helpers; must be called with shard.mlock locked
+    uint32_t findRecord(DatabaseMTCacheShard &shard, const Goldilocks::Element (&key)[4]);
+    uint32_t allocRecord(DatabaseMTCacheShard &shard);
+    void moveToHead(DatabaseMTCacheShard &shard, uint32_t index);
+    void unlinkFromBucket(DatabaseMTCacheShard &shard, uint32_t index);
+    void resizeBuckets(DatabaseMTCacheShard &shard, uint64_t newSize);
+    void clearShard(DatabaseMTCacheShard &shard);
+    void logStatistics(void);
+
+public:
+    // Memory used by every cached record, including its hash table share
+    static const uint64_t recordSize = sizeof(DatabaseMTCacheRecord) + sizeof(uint32_t);
+
+    DatabaseMTCache() : maxSize(0) {};
+    ~DatabaseMTCache();
+
+    bool add(const Goldilocks::Element (&key)[4], const vector<Goldilocks::Element> &value, const bool update); // returns true if cache is full
+    bool find(const Goldilocks::Element (&key)[4], vector<Goldilocks::Element> &value);
+
+    uint64_t getMaxSize(void) { return maxSize; };
+    uint64_t getCurrentSize(void);
+    uint64_t getCount(void);
+    void getHotSet(uint64_t maxRecords, vector<DatabaseCacheSnapshotRecord> &records); // Most recently used records first
+    bool enabled() { return (maxSize > 0); };
+    void setMaxSize(int64_t size); // size is in bytes, 0 = no cache
+    void setName(const char * pChar) { name = pChar; };
+    void print(bool printContent);
+    void clear(void);
+};
+
+#endif
@@ -9,6 +9,8 @@ MultiWrite::MultiWrite(Goldilocks & fr) :
     lastFlushId(0),
     storedFlushId(0),
     storingFlushId(0),
+    storedBytesPerSecond(0),
+    storedRowsPerSecond(0),
     pendingToFlushDataIndex(0),
     storingDataIndex(2),
     synchronizingDataIndex(2)
@@ -27,6 +29,8 @@ string MultiWrite::print(void)
     return "lastFlushId=" + to_string(lastFlushId) +
         " storedFlushId=" + to_string(storedFlushId) +
         " storingFlushId=" + to_string(storingFlushId) +
+        " storedBytesPerSecond=" + to_string(storedBytesPerSecond) +
+        " storedRowsPerSecond=" + to_string(storedRowsPerSecond) +
         " pendingToFlushDataIndex=" + to_string(pendingToFlushDataIndex) +
         " storingDataIndex=" + to_string(storingDataIndex) +
         " synchronizingDataIndex=" + to_string(synchronizingDataIndex);
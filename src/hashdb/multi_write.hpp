@@ -15,6 +15,10 @@ public:
     uint64_t storedFlushId;
     uint64_t storingFlushId;
 
+    // Throughput of the last stored flush
+    uint64_t storedBytesPerSecond;
+    uint64_t storedRowsPerSecond;
+
     uint64_t pendingToFlushDataIndex; // Index of data to store data of batches being processed
     uint64_t storingDataIndex; // Index of data being sent to database
     uint64_t synchronizingDataIndex; // Index of data being synchronized to other database caches
@@ -4,10 +4,12 @@
 #include "zkresult.hpp"
 #include "zkmax.hpp"
 #include "zklog.hpp"
+#include "exit_process.hpp"
 #include <bitset>
+#include <unordered_set>
 #include "state_manager.hpp"
 
-zkresult Smt::set (const string &batchUUID, uint64_t tx, Database &db, const Goldilocks::Element (&oldRoot)[4], const Goldilocks::Element (&key)[4], const mpz_class &value, const Persistence persistence, SmtSetResult &result, DatabaseMap *dbReadLog)
+zkresult Smt::set (const string &batchUUID, uint64_t tx, Database &db, const Goldilocks::Element (&oldRoot)[4], const Goldilocks::Element (&key)[4], const mpz_class &value, const Persistence persistence, SmtSetResult &result, DatabaseMap *dbReadLog, const DatabaseMap::MTMap *pNodes)
 {
 #ifdef LOG_SMT
     zklog.info("Smt::set() called with oldRoot=" + fea2string(fr,oldRoot) + " key=" + fea2string(fr,key) + " value=" + value.get_str(16) + " persistent=" + to_string(persistent));
@@ -45,7 +47,6 @@ zkresult Smt::set (const string &batchUUID, uint64_t tx, Database &db, const Gol
 
     vector<string> nodesToDelete; // vector to store all nodes keys to delete because they are no longer part of the tree
     Goldilocks::Element nodeToDelete[4]; // key, in field element format, of a node to delete
-    string nodeToDeleteString; // key, in string format, of a node to delete
 
     mpz_class insValue = 0;
     mpz_class oldValue = 0;
@@ -67,9 +68,13 @@ zkresult Smt::set (const string &batchUUID, uint64_t tx, Database &db, const Gol
         string rootString = fea2string(fr, r);
 
         dbres = ZKR_UNSPECIFIED;
-        if (bUseStateManager)
+        if (pNodes != NULL)
+        {
+            dbres = findNode(*pNodes, rootString, dbValue);
+        }
+        if (bUseStateManager && (dbres != ZKR_SUCCESS))
         {
-            dbres = stateManager.read(batchUUID, rootString, dbValue, dbReadLog);
+            dbres = stateManager.read(batchUUID, r, dbValue, dbReadLog);
         }
         if (dbres != ZKR_SUCCESS)
         {
@@ -106,9 +111,13 @@ zkresult Smt::set (const string &batchUUID, uint64_t tx, Database &db, const Gol
             foundValueHash[3] = siblings[level][7];
             foundValueHashString = fea2string(fr, foundValueHash);
             dbres = ZKR_UNSPECIFIED;
-            if (bUseStateManager)
+            if (pNodes != NULL)
+            {
+                dbres = findNode(*pNodes, foundValueHashString, dbValue);
+            }
+            if (bUseStateManager && (dbres != ZKR_SUCCESS))
             {
-                dbres = stateManager.read(batchUUID, foundValueHashString, dbValue, dbReadLog);
+                dbres = stateManager.read(batchUUID, foundValueHash, dbValue, dbReadLog);
             }
             if (dbres != ZKR_SUCCESS)
             {
@@ -227,10 +236,9 @@ zkresult Smt::set (const string &batchUUID, uint64_t tx, Database &db, const Gol
                         }
                         if (!fr.equal(nodeToDelete[0], newLeafHash[0]) || !fr.equal(nodeToDelete[1], newLeafHash[1]) || !fr.equal(nodeToDelete[2], newLeafHash[2]) || !fr.equal(nodeToDelete[3], newLeafHash[3]))
                         {
-                            nodeToDeleteString = fea2string(fr, nodeToDelete);
-                            if (nodeToDeleteString != "0")
+                            if (!fr.isZero(nodeToDelete[0]) || !fr.isZero(nodeToDelete[1]) || !fr.isZero(nodeToDelete[2]) || !fr.isZero(nodeToDelete[3]))
                             {
-                                stateManager.deleteNode(batchUUID, tx, nodeToDeleteString, persistence);
+                                stateManager.deleteNode(batchUUID, tx, nodeToDelete, persistence);
                             }
                         }
                     }
@@ -459,10 +467,9 @@ zkresult Smt::set (const string &batchUUID, uint64_t tx, Database &db, const Gol
                     }
                     if (!fr.equal(nodeToDelete[0], newLeafHash[0]) || !fr.equal(nodeToDelete[1], newLeafHash[1]) || !fr.equal(nodeToDelete[2], newLeafHash[2]) || !fr.equal(nodeToDelete[3], newLeafHash[3]))
                     {
-                        nodeToDeleteString = fea2string(fr, nodeToDelete);
-                        if (nodeToDeleteString != "0")
+                        if (!fr.isZero(nodeToDelete[0]) || !fr.isZero(nodeToDelete[1]) || !fr.isZero(nodeToDelete[2]) || !fr.isZero(nodeToDelete[3]))
                         {
-                            stateManager.deleteNode(batchUUID, tx, nodeToDeleteString, persistence);
+                            stateManager.deleteNode(batchUUID, tx, nodeToDelete, persistence);
                         }
                     }
                 }
@@ -503,10 +510,9 @@ zkresult Smt::set (const string &batchUUID, uint64_t tx, Database &db, const Gol
                         nodeToDelete[j] = siblings[level][keys[level]*4 + j];
                         siblings[level][keys[level]*4 + j] = fr.zero();
                     }
-                    nodeToDeleteString = fea2string(fr, nodeToDelete);
-                    if (nodeToDeleteString != "0")
+                    if (!fr.isZero(nodeToDelete[0]) || !fr.isZero(nodeToDelete[1]) || !fr.isZero(nodeToDelete[2]) || !fr.isZero(nodeToDelete[3]))
                     {
-                        stateManager.deleteNode(batchUUID, tx, nodeToDeleteString, persistence);
+                        stateManager.deleteNode(batchUUID, tx, nodeToDelete, persistence);
                     }
                 }
                 else
@@ -534,9 +540,13 @@ zkresult Smt::set (const string &batchUUID, uint64_t tx, Database &db, const Gol
 
                     // Read its 2 siblings
                     dbres = ZKR_UNSPECIFIED;
-                    if (bUseStateManager)
+                    if (pNodes != NULL)
                     {
-                        dbres = stateManager.read(batchUUID, auxString, dbValue, dbReadLog);
+                        dbres = findNode(*pNodes, auxString, dbValue);
+                    }
+                    if (bUseStateManager && (dbres != ZKR_SUCCESS))
+                    {
+                        dbres = stateManager.read(batchUUID, auxFea, dbValue, dbReadLog);
                     }
                     if (dbres != ZKR_SUCCESS)
                     {
@@ -561,9 +571,13 @@ zkresult Smt::set (const string &batchUUID, uint64_t tx, Database &db, const Gol
 
                         // Read its siblings
                         dbres = ZKR_UNSPECIFIED;
-                        if (bUseStateManager)
+                        if (pNodes != NULL)
+                        {
+                            dbres = findNode(*pNodes, valHString, dbValue);
+                        }
+                        if (bUseStateManager && (dbres != ZKR_SUCCESS))
                         {
-                            dbres = stateManager.read(batchUUID, valHString, dbValue, dbReadLog);
+                            dbres = stateManager.read(batchUUID, valH, dbValue, dbReadLog);
                         }
                         if (dbres != ZKR_SUCCESS)
                         {
@@ -731,10 +745,9 @@ zkresult Smt::set (const string &batchUUID, uint64_t tx, Database &db, const Gol
                 }
                 if (!fr.equal(nodeToDelete[0], newRoot[0]) || !fr.equal(nodeToDelete[1], newRoot[1]) || !fr.equal(nodeToDelete[2], newRoot[2]) || !fr.equal(nodeToDelete[3], newRoot[3]))
                 {
-                    nodeToDeleteString = fea2string(fr, nodeToDelete);
-                    if (nodeToDeleteString != "0")
+                    if (!fr.isZero(nodeToDelete[0]) || !fr.isZero(nodeToDelete[1]) || !fr.isZero(nodeToDelete[2]) || !fr.isZero(nodeToDelete[3]))
                     {
-                        stateManager.deleteNode(batchUUID, tx, nodeToDeleteString, persistence);
+                        stateManager.deleteNode(batchUUID, tx, nodeToDelete, persistence);
                     }
                 }
             }
@@ -801,7 +814,7 @@ zkresult Smt::set (const string &batchUUID, uint64_t tx, Database &db, const Gol
     return ZKR_SUCCESS;
 }
 
-zkresult Smt::get (const string &batchUUID, Database &db, const Goldilocks::Element (&root)[4], const Goldilocks::Element (&key)[4], SmtGetResult &result, DatabaseMap *dbReadLog)
+zkresult Smt::get (const string &batchUUID, Database &db, const Goldilocks::Element (&root)[4], const Goldilocks::Element (&key)[4], SmtGetResult &result, DatabaseMap *dbReadLog, const DatabaseMap::MTMap *pNodes)
 {
 #ifdef LOG_SMT
     zklog.info("Smt::get() called with root=" + fea2string(fr,root) + " and key=" + fea2string(fr,key));
@@ -849,9 +862,13 @@ zkresult Smt::get (const string &batchUUID, Database &db, const Goldilocks::Elem
         // Read the content of db for entry r: siblings[level] = db.read(r)
         string rString = fea2string(fr, r);
         dbres = ZKR_UNSPECIFIED;
-        if (bUseStateManager)
+        if (pNodes != NULL)
         {
-            dbres = stateManager.read(batchUUID, rString, dbValue, dbReadLog);
+            dbres = findNode(*pNodes, rString, dbValue);
+        }
+        if (bUseStateManager && (dbres != ZKR_SUCCESS))
+        {
+            dbres = stateManager.read(batchUUID, r, dbValue, dbReadLog);
         }
         if (dbres != ZKR_SUCCESS)
         {
@@ -877,9 +894,13 @@ zkresult Smt::get (const string &batchUUID, Database &db, const Goldilocks::Elem
             valueHashFea[3] = siblings[level][7];
             string foundValueHashString = fea2string(fr, valueHashFea);
             dbres = ZKR_UNSPECIFIED;
-            if (bUseStateManager)
+            if (pNodes != NULL)
+            {
+                dbres = findNode(*pNodes, foundValueHashString, dbValue);
+            }
+            if (bUseStateManager && (dbres != ZKR_SUCCESS))
             {
-                dbres = stateManager.read(batchUUID, foundValueHashString, dbValue, dbReadLog);
+                dbres = stateManager.read(batchUUID, valueHashFea, dbValue, dbReadLog);
             }
             if (dbres != ZKR_SUCCESS)
             {
@@ -998,6 +1019,677 @@ zkresult Smt::get (const string &batchUUID, Database &db, const Goldilocks::Elem
     return ZKR_SUCCESS;
 }
 
+zkresult Smt::getMany (const string &batchUUID, Database &db, const Goldilocks::Element (&root)[4], const vector<Goldilocks::Element> &keys, vector<SmtGetResult> &results, DatabaseMap *dbReadLog)
+{
+    if ((keys.size() % 4) != 0)
+    {
+        zklog.error("Smt::getMany() called with an invalid keys size=" + to_string(keys.size()));
+        return ZKR_INTERNAL_ERROR;
+    }
+    uint64_t numberOfKeys = keys.size() / 4;
+
+#ifdef LOG_SMT
+    zklog.info("Smt::getMany() called with root=" + fea2string(fr,root) + " and keys=" + to_string(numberOfKeys));
+#endif
+
+    // Nodes read, shared by all the keys, since they share the upper levels of the tree
+    DatabaseMap::MTMap nodes;
+    zkresult zkr = readPaths(batchUUID, db, root, keys, true, nodes, dbReadLog);
+    if (zkr != ZKR_SUCCESS)
+    {
+        return zkr;
+    }
+
+    // Now that all the nodes are available, build the result of every key
+    results.resize(numberOfKeys);
+    for (uint64_t k=0; k<numberOfKeys; k++)
+    {
+        Goldilocks::Element key[4];
+        for (uint64_t i=0; i<4; i++) key[i] = keys[k*4 + i];
+        zkr = get(batchUUID, db, root, key, results[k], NULL, &nodes);
+        if (zkr != ZKR_SUCCESS)
+        {
+            zklog.error("Smt::getMany() failed calling get() result=" + zkresult2string(zkr) + " key=" + fea2string(fr, key));
+            return zkr;
+        }
+    }
+
+#ifdef LOG_SMT
+    zklog.info("Smt::getMany() returns keys=" + to_string(numberOfKeys) + " nodes=" + to_string(nodes.size()));
+#endif
+
+    return ZKR_SUCCESS;
+}
+
+zkresult Smt::readPaths (const string &batchUUID, Database &db, const Goldilocks::Element (&root)[4], const vector<Goldilocks::Element> &keys, bool bReadValues, DatabaseMap::MTMap &nodes, DatabaseMap *dbReadLog)
+{
+    uint64_t numberOfKeys = keys.size() / 4;
+    bool bUseStateManager = db.config.stateManager && (batchUUID.size() > 0);
+
+    // Navigation state of every key: current hash, level, and whether it reached a leaf, an empty branch, or a missing node
+    vector<SmtGetManyState> states(numberOfKeys);
+    for (uint64_t k=0; k<numberOfKeys; k++)
+    {
+        SmtGetManyState &state = states[k];
+        for (uint64_t i=0; i<4; i++)
+        {
+            state.r[i] = root[i];
+            state.key[i] = keys[k*4 + i];
+        }
+        splitKey(state.key, state.keys);
+    }
+
+    // Go down all the keys at the same time, level by level, reading all the nodes of a level at once
+    vector<string> pendingNodes;
+    unordered_set<string> pendingNodesSet;
+    vector<Goldilocks::Element> dbValue;
+    while (true)
+    {
+        pendingNodes.clear();
+        pendingNodesSet.clear();
+
+        for (uint64_t k=0; k<numberOfKeys; k++)
+        {
+            SmtGetManyState &state = states[k];
+
+            // Go down as long as the nodes are already available
+            while (!state.bDone)
+            {
+                // If we reached an empty branch, or read the value of a leaf, we are done
+                if ( fr.isZero(state.r[0]) && fr.isZero(state.r[1]) && fr.isZero(state.r[2]) && fr.isZero(state.r[3]) )
+                {
+                    state.bDone = true;
+                    break;
+                }
+                string rString = NormalizeToNFormat(fea2string(fr, state.r), 64);
+                DatabaseMap::MTMap::const_iterator it = nodes.find(rString);
+                if (it == nodes.end())
+                {
+                    // If it was already requested and not found, let the caller report the error
+                    if (state.lastRequested == rString)
+                    {
+                        state.bDone = true;
+                    }
+                    else
+                    {
+                        state.lastRequested = rString;
+                        if (pendingNodesSet.insert(rString).second)
+                        {
+                            pendingNodes.push_back(rString);
+                        }
+                    }
+                    break;
+                }
+                const vector<Goldilocks::Element> &value = it->second;
+
+                // If we were reading the value of a leaf, we are done
+                if (state.bLeaf)
+                {
+                    state.bDone = true;
+                    break;
+                }
+
+                // If this is a leaf, the second 4 elements are the hash of the value
+                if (value.size()>8 && fr.equal(value[8], fr.one()))
+                {
+                    if (!bReadValues)
+                    {
+                        state.bDone = true;
+                        break;
+                    }
+                    state.r[0] = value[4];
+                    state.r[1] = value[5];
+                    state.r[2] = value[6];
+                    state.r[3] = value[7];
+                    state.bLeaf = true;
+                }
+                // If this is an intermediate node, take the child hash corresponding to this level key bit
+                else if (value.size() >= 8)
+                {
+                    state.r[0] = value[state.keys[state.level]*4];
+                    state.r[1] = value[state.keys[state.level]*4 + 1];
+                    state.r[2] = value[state.keys[state.level]*4 + 2];
+                    state.r[3] = value[state.keys[state.level]*4 + 3];
+                    state.level++;
+                    if (state.level >= 256)
+                    {
+                        state.bDone = true;
+                    }
+                }
+                // Invalid node; let the caller report the error
+                else
+                {
+                    state.bDone = true;
+                }
+            }
+        }
+
+        // When no key needs any more nodes, we are done
+        if (pendingNodes.empty())
+        {
+            break;
+        }
+
+        // Read all the pending nodes of this level, first from the state manager, then from the database at once
+        vector<string> dbPendingNodes;
+        if (bUseStateManager)
+        {
+            for (uint64_t i=0; i<pendingNodes.size(); i++)
+            {
+                if (stateManager.read(batchUUID, pendingNodes[i], dbValue, dbReadLog) == ZKR_SUCCESS)
+                {
+                    nodes[pendingNodes[i]] = dbValue;
+                }
+                else
+                {
+                    dbPendingNodes.push_back(pendingNodes[i]);
+                }
+            }
+        }
+        else
+        {
+            dbPendingNodes.swap(pendingNodes);
+        }
+        if (!dbPendingNodes.empty())
+        {
+            zkresult zkr = db.readMany(dbPendingNodes, nodes, dbReadLog);
+            if (zkr != ZKR_SUCCESS)
+            {
+                zklog.error("Smt::readPaths() failed calling db.readMany() result=" + zkresult2string(zkr));
+                return zkr;
+            }
+        }
+    }
+
+    return ZKR_SUCCESS;
+}
+
+zkresult Smt::setBatch (const string &batchUUID, uint64_t tx, Database &db, const Goldilocks::Element (&oldRoot)[4], const vector<Goldilocks::Element> &keys, const vector<mpz_class> &values, const Persistence persistence, Goldilocks::Element (&newRoot)[4], vector<SmtSetResult> *pResults, DatabaseMap *dbReadLog)
+{
+    if (((keys.size() % 4) != 0) || ((keys.size() / 4) != values.size()))
+    {
+        zklog.error("Smt::setBatch() called with an invalid keys size=" + to_string(keys.size()) + " values size=" + to_string(values.size()));
+        return ZKR_INTERNAL_ERROR;
+    }
+    uint64_t numberOfKeys = values.size();
+
+#ifdef LOG_SMT
+    zklog.info("Smt::setBatch() called with oldRoot=" + fea2string(fr,oldRoot) + " and keys=" + to_string(numberOfKeys));
+#endif
+
+    zkresult zkr;
+    Goldilocks::Element key[4];
+
+    // Read the paths of all the keys at once; the leaf values are only needed to build the per-key results
+    DatabaseMap::MTMap nodes;
+    zkr = readPaths(batchUUID, db, oldRoot, keys, pResults != NULL, nodes, dbReadLog);
+    if (zkr != ZKR_SUCCESS)
+    {
+        return zkr;
+    }
+
+    // If the per-key results are requested, set the keys one by one, since every result depends on the previous one
+    if (pResults != NULL)
+    {
+        pResults->resize(numberOfKeys);
+        Goldilocks::Element root[4];
+        for (uint64_t i=0; i<4; i++) root[i] = oldRoot[i];
+        for (uint64_t k=0; k<numberOfKeys; k++)
+        {
+            for (uint64_t i=0; i<4; i++) key[i] = keys[k*4 + i];
+            zkr = set(batchUUID, tx, db, root, key, values[k], persistence, (*pResults)[k], dbReadLog, &nodes);
+            if (zkr != ZKR_SUCCESS)
+            {
+                zklog.error("Smt::setBatch() failed calling set() result=" + zkresult2string(zkr) + " key=" + fea2string(fr, key));
+                return zkr;
+            }
+            for (uint64_t i=0; i<4; i++) root[i] = (*pResults)[k].newRoot[i];
+        }
+        for (uint64_t i=0; i<4; i++) newRoot[i] = root[i];
+        return ZKR_SUCCESS;
+    }
+
+    bool bUseStateManager = db.config.stateManager && (batchUUID.size() > 0);
+
+    SmtContext ctx(db, bUseStateManager, batchUUID, tx, persistence);
+
+    if (bUseStateManager)
+    {
+        stateManager.setOldStateRoot(batchUUID, tx, fea2string(fr, oldRoot), persistence);
+    }
+
+    // Build the affected subtree in memory, setting all the keys in order
+    deque<SmtBatchNode> tree;
+    SmtBatchNode *pRoot = batchNewNode(tree, oldRoot);
+    vector<uint64_t> accKey;
+    vector<Goldilocks::Element> nodesToDelete; // Keys of the nodes that are no longer part of the tree, 4 field elements each
+    bool keyBits[256];
+    bool bChanged;
+    for (uint64_t k=0; k<numberOfKeys; k++)
+    {
+        for (uint64_t i=0; i<4; i++) key[i] = keys[k*4 + i];
+        splitKey(key, keyBits);
+        accKey.clear();
+        zkr = batchSet(ctx, nodes, tree, *pRoot, 0, accKey, key, keyBits, values[k], nodesToDelete, bChanged, dbReadLog);
+        if (zkr != ZKR_SUCCESS)
+        {
+            zklog.error("Smt::setBatch() failed calling batchSet() result=" + zkresult2string(zkr) + " key=" + fea2string(fr, key));
+            return zkr;
+        }
+    }
+
+    // Move up the leaves that were left alone in their branch
+    accKey.clear();
+    zkr = batchNormalize(ctx, nodes, tree, *pRoot, accKey, nodesToDelete, dbReadLog);
+    if (zkr != ZKR_SUCCESS)
+    {
+        zklog.error("Smt::setBatch() failed calling batchNormalize() result=" + zkresult2string(zkr));
+        return zkr;
+    }
+
+    // Hash and save the dirty nodes level by level, from the bottom up to the root, all the nodes of a level at once
+    vector<vector<SmtBatchNode *>> levels;
+    batchGetLevels(*pRoot, 0, levels);
+    zkr = batchHashSave(ctx, levels);
+    if (zkr != ZKR_SUCCESS)
+    {
+        zklog.error("Smt::setBatch() failed calling batchHashSave() result=" + zkresult2string(zkr));
+        return zkr;
+    }
+
+    // Delete the nodes that are no longer part of the tree
+    if (bUseStateManager)
+    {
+        Goldilocks::Element nodeToDelete[4];
+        for (uint64_t i=0; i<nodesToDelete.size(); i+=4)
+        {
+            for (uint64_t j=0; j<4; j++) nodeToDelete[j] = nodesToDelete[i + j];
+            stateManager.deleteNode(batchUUID, tx, nodeToDelete, persistence);
+        }
+    }
+
+    for (uint64_t i=0; i<4; i++) newRoot[i] = pRoot->hash[i];
+
+    if (bUseStateManager)
+    {
+        stateManager.setNewStateRoot(batchUUID, tx, fea2string(fr, newRoot), persistence);
+    }
+
+#ifdef LOG_SMT
+    zklog.info("Smt::setBatch() returns newRoot=" + fea2string(fr,newRoot) + " keys=" + to_string(numberOfKeys) + " nodes=" + to_string(tree.size()) + " levels=" + to_string(levels.size()));
+#endif
+
+    return ZKR_SUCCESS;
+}
+
+SmtBatchNode * Smt::batchNewNode (deque<SmtBatchNode> &tree, const Goldilocks::Element (&hash)[4])
+{
+    tree.emplace_back();
+    SmtBatchNode &node = tree.back();
+    bool bZero = fr.isZero(hash[0]) && fr.isZero(hash[1]) && fr.isZero(hash[2]) && fr.isZero(hash[3]);
+    node.type = bZero ? SMT_BATCH_NODE_EMPTY : SMT_BATCH_NODE_UNREAD;
+    for (uint64_t i=0; i<4; i++)
+    {
+        node.hash[i] = hash[i];
+        node.oldHash[i] = hash[i];
+    }
+    return &node;
+}
+
+void Smt::batchRetire (SmtBatchNode &node, vector<Goldilocks::Element> &nodesToDelete)
+{
+    // A node read from the tree is retired only once, the first time it changes
+    if (!fr.isZero(node.oldHash[0]) || !fr.isZero(node.oldHash[1]) || !fr.isZero(node.oldHash[2]) || !fr.isZero(node.oldHash[3]))
+    {
+        for (uint64_t i=0; i<4; i++)
+        {
+            nodesToDelete.push_back(node.oldHash[i]);
+            node.oldHash[i] = fr.zero();
+        }
+    }
+}
+
+zkresult Smt::batchRead (const SmtContext &ctx, const DatabaseMap::MTMap &nodes, deque<SmtBatchNode> &tree, SmtBatchNode &node, const vector<uint64_t> &accKey, DatabaseMap *dbReadLog)
+{
+    // Read the node content, normally already read by readPaths()
+    string hashString = fea2string(fr, node.hash);
+    vector<Goldilocks::Element> dbValue;
+    zkresult dbres = findNode(nodes, hashString, dbValue);
+    if (ctx.bUseStateManager && (dbres != ZKR_SUCCESS))
+    {
+        dbres = stateManager.read(ctx.batchUUID, node.hash, dbValue, dbReadLog);
+    }
+    if (dbres != ZKR_SUCCESS)
+    {
+        dbres = ctx.db.read(hashString, node.hash, dbValue, dbReadLog);
+    }
+    if (dbres != ZKR_SUCCESS)
+    {
+        zklog.error("Smt::batchRead() db.read error: " + to_string(dbres) + " (" + zkresult2string(dbres) + ") root:" + hashString);
+        return dbres;
+    }
+    if (dbValue.size() < 12)
+    {
+        zklog.error("Smt::batchRead() dbValue.size()<12 root:" + hashString);
+        return ZKR_SMT_INVALID_DATA_SIZE;
+    }
+
+    // If this is a leaf node, the first 4 elements are the remaining key, and the second 4 elements are the value hash
+    if (fr.equal(dbValue[8], fr.one()))
+    {
+        Goldilocks::Element rKey[4];
+        for (uint64_t i=0; i<4; i++)
+        {
+            rKey[i] = dbValue[i];
+            node.valueHash[i] = dbValue[4 + i];
+        }
+        joinKey(accKey, rKey, node.key);
+        node.type = SMT_BATCH_NODE_LEAF;
+    }
+    // This is an intermediate node, with the hashes of its 2 children
+    else
+    {
+        Goldilocks::Element childHash[4];
+        for (uint64_t c=0; c<2; c++)
+        {
+            for (uint64_t i=0; i<4; i++) childHash[i] = dbValue[c*4 + i];
+            node.child[c] = batchNewNode(tree, childHash);
+        }
+        node.type = SMT_BATCH_NODE_INTERMEDIATE;
+    }
+
+    return ZKR_SUCCESS;
+}
+
+zkresult Smt::batchSet (const SmtContext &ctx, const DatabaseMap::MTMap &nodes, deque<SmtBatchNode> &tree, SmtBatchNode &node, uint64_t level, vector<uint64_t> &accKey, const Goldilocks::Element (&key)[4], const bool (&keys)[256], const mpz_class &value, vector<Goldilocks::Element> &nodesToDelete, bool &bChanged, DatabaseMap *dbReadLog)
+{
+    bChanged = false;
+    zkresult zkr;
+
+    if (level >= 256)
+    {
+        zklog.error("Smt::batchSet() reached level=" + to_string(level) + " key=" + fea2string(fr, key));
+        return ZKR_SMT_INVALID_DATA_SIZE;
+    }
+
+    if (node.type == SMT_BATCH_NODE_UNREAD)
+    {
+        zkr = batchRead(ctx, nodes, tree, node, accKey, dbReadLog);
+        if (zkr != ZKR_SUCCESS)
+        {
+            return zkr;
+        }
+    }
+
+    // Empty branch: insert a new leaf, if value is not zero
+    if (node.type == SMT_BATCH_NODE_EMPTY)
+    {
+        if (value == 0)
+        {
+            return ZKR_SUCCESS;
+        }
+        for (uint64_t i=0; i<4; i++) node.key[i] = key[i];
+        node.value = value;
+        node.bValueDirty = true;
+        node.bDirty = true;
+        node.type = SMT_BATCH_NODE_LEAF;
+        bChanged = true;
+        return ZKR_SUCCESS;
+    }
+
+    if (node.type == SMT_BATCH_NODE_LEAF)
+    {
+        // Same key: update its value, or delete the leaf if value is zero
+        if (fr.equal(key[0], node.key[0]) && fr.equal(key[1], node.key[1]) && fr.equal(key[2], node.key[2]) && fr.equal(key[3], node.key[3]))
+        {
+            batchRetire(node, nodesToDelete);
+            if (value == 0)
+            {
+                node.type = SMT_BATCH_NODE_EMPTY;
+                node.bValueDirty = false;
+            }
+            else
+            {
+                node.value = value;
+                node.bValueDirty = true;
+            }
+            node.bDirty = true;
+            bChanged = true;
+            return ZKR_SUCCESS;
+        }
+
+        // Different key and value zero: nothing to delete
+        if (value == 0)
+        {
+            return ZKR_SUCCESS;
+        }
+
+        // Different key: move the found leaf one level down, and set the key on the new intermediate node
+        batchRetire(node, nodesToDelete);
+        tree.push_back(node);
+        SmtBatchNode *pLeaf = &tree.back();
+        pLeaf->bDirty = true;
+        bool leafKeys[256];
+        splitKey(pLeaf->key, leafKeys);
+        Goldilocks::Element zeroHash[4] = {fr.zero(), fr.zero(), fr.zero(), fr.zero()};
+        node.child[leafKeys[level]] = pLeaf;
+        node.child[!leafKeys[level]] = batchNewNode(tree, zeroHash);
+        node.type = SMT_BATCH_NODE_INTERMEDIATE;
+        node.bValueDirty = false;
+        node.bDirty = true;
+        bChanged = true;
+    }
+
+    // Intermediate node: go down through the child of this level key bit
+    bool bChildChanged;
+    accKey.push_back(keys[level]);
+    zkr = batchSet(ctx, nodes, tree, *node.child[keys[level]], level + 1, accKey, key, keys, value, nodesToDelete, bChildChanged, dbReadLog);
+    accKey.pop_back();
+    if (zkr != ZKR_SUCCESS)
+    {
+        return zkr;
+    }
+    if (bChildChanged)
+    {
+        batchRetire(node, nodesToDelete);
+        node.bDirty = true;
+        bChanged = true;
+    }
+
+    return ZKR_SUCCESS;
+}
+
+zkresult Smt::batchNormalize (const SmtContext &ctx, const DatabaseMap::MTMap &nodes, deque<SmtBatchNode> &tree, SmtBatchNode &node, vector<uint64_t> &accKey, vector<Goldilocks::Element> &nodesToDelete, DatabaseMap *dbReadLog)
+{
+    // Only changed intermediate nodes can be left with less than 2 leaves below them
+    if ((node.type != SMT_BATCH_NODE_INTERMEDIATE) || !node.bDirty)
+    {
+        return ZKR_SUCCESS;
+    }
+
+    zkresult zkr;
+    for (uint64_t c=0; c<2; c++)
+    {
+        accKey.push_back(c);
+        zkr = batchNormalize(ctx, nodes, tree, *node.child[c], accKey, nodesToDelete, dbReadLog);
+        accKey.pop_back();
+        if (zkr != ZKR_SUCCESS)
+        {
+            return zkr;
+        }
+    }
+
+    // If both children are empty, this branch is empty
+    if ((node.child[0]->type == SMT_BATCH_NODE_EMPTY) && (node.child[1]->type == SMT_BATCH_NODE_EMPTY))
+    {
+        node.type = SMT_BATCH_NODE_EMPTY;
+        return ZKR_SUCCESS;
+    }
+
+    // If only one child is not empty, and it is a leaf, move it up to this level
+    for (uint64_t c=0; c<2; c++)
+    {
+        if (node.child[1-c]->type != SMT_BATCH_NODE_EMPTY)
+        {
+            continue;
+        }
+        SmtBatchNode &child = *node.child[c];
+        if (child.type == SMT_BATCH_NODE_UNREAD)
+        {
+            accKey.push_back(c);
+            zkr = batchRead(ctx, nodes, tree, child, accKey, dbReadLog);
+            accKey.pop_back();
+            if (zkr != ZKR_SUCCESS)
+            {
+                return zkr;
+            }
+        }
+        if (child.type == SMT_BATCH_NODE_LEAF)
+        {
+            batchRetire(child, nodesToDelete);
+            for (uint64_t i=0; i<4; i++)
+            {
+                node.key[i] = child.key[i];
+                node.valueHash[i] = child.valueHash[i];
+            }
+            node.value = child.value;
+            node.bValueDirty = child.bValueDirty;
+            node.child[0] = NULL;
+            node.child[1] = NULL;
+            node.type = SMT_BATCH_NODE_LEAF;
+        }
+        break;
+    }
+
+    return ZKR_SUCCESS;
+}
+
+void Smt::batchGetLevels (SmtBatchNode &node, uint64_t level, vector<vector<SmtBatchNode *>> &levels)
+{
+    if (!node.bDirty)
+    {
+        return;
+    }
+    if (levels.size() <= level)
+    {
+        levels.resize(level + 1);
+    }
+    levels[level].push_back(&node);
+    if (node.type == SMT_BATCH_NODE_INTERMEDIATE)
+    {
+        batchGetLevels(*node.child[0], level + 1, levels);
+        batchGetLevels(*node.child[1], level + 1, levels);
+    }
+}
+
+zkresult Smt::batchHashSave (const SmtContext &ctx, vector<vector<SmtBatchNode *>> &levels)
+{
+    zkresult zkr;
+    vector<SmtBatchNode *> pendingNodes;
+    vector<Goldilocks::Element> inputs;
+    vector<Goldilocks::Element> hashes;
+    Goldilocks::Element valueFea[8];
+    Goldilocks::Element rKey[4];
+
+    for (int64_t level = levels.size() - 1; level >= 0; level--)
+    {
+        // Value hash = H(value | capacity zero), for the leaves with a new value
+        pendingNodes.clear();
+        inputs.clear();
+        for (uint64_t n=0; n<levels[level].size(); n++)
+        {
+            SmtBatchNode &node = *levels[level][n];
+            if ((node.type != SMT_BATCH_NODE_LEAF) || !node.bValueDirty)
+            {
+                continue;
+            }
+            scalar2fea(fr, node.value, valueFea);
+            for (uint64_t i=0; i<8; i++) node.valueV[i] = valueFea[i];
+            for (uint64_t i=0; i<4; i++) node.valueV[8+i] = capacityZero[i];
+            inputs.insert(inputs.end(), node.valueV, node.valueV + 12);
+            pendingNodes.push_back(&node);
+        }
+        hashes.resize(pendingNodes.size()*4);
+        zkr = hashSaveMany(ctx, inputs.data(), hashes.data(), pendingNodes.size());
+        if (zkr != ZKR_SUCCESS)
+        {
+            return zkr;
+        }
+        for (uint64_t n=0; n<pendingNodes.size(); n++)
+        {
+            for (uint64_t i=0; i<4; i++) pendingNodes[n]->valueHash[i] = hashes[n*4 + i];
+        }
+
+        // Leaf hash = H(remaining key at this level | value hash | capacity one)
+        // Intermediate hash = H(left child hash | right child hash | capacity zero), children being already hashed
+        pendingNodes.clear();
+        inputs.clear();
+        for (uint64_t n=0; n<levels[level].size(); n++)
+        {
+            SmtBatchNode &node = *levels[level][n];
+            switch (node.type)
+            {
+                case SMT_BATCH_NODE_EMPTY:
+                {
+                    for (uint64_t i=0; i<4; i++) node.hash[i] = fr.zero();
+                    continue;
+                }
+                case SMT_BATCH_NODE_LEAF:
+                {
+                    removeKeyBits(node.key, level, rKey);
+                    for (uint64_t i=0; i<4; i++)
+                    {
+                        node.v[i] = rKey[i];
+                        node.v[4+i] = node.valueHash[i];
+                        node.v[8+i] = capacityOne[i];
+                    }
+                    break;
+                }
+                case SMT_BATCH_NODE_INTERMEDIATE:
+                {
+                    for (uint64_t i=0; i<4; i++)
+                    {
+                        node.v[i] = node.child[0]->hash[i];
+                        node.v[4+i] = node.child[1]->hash[i];
+                        node.v[8+i] = capacityZero[i];
+                    }
+                    break;
+                }
+                default:
+                {
+                    zklog.error("Smt::batchHashSave() found a dirty node of invalid type=" + to_string(node.type));
+                    exitProcess();
+                }
+            }
+            inputs.insert(inputs.end(), node.v, node.v + 12);
+            pendingNodes.push_back(&node);
+        }
+        hashes.resize(pendingNodes.size()*4);
+        zkr = hashSaveMany(ctx, inputs.data(), hashes.data(), pendingNodes.size());
+        if (zkr != ZKR_SUCCESS)
+        {
+            return zkr;
+        }
+        for (uint64_t n=0; n<pendingNodes.size(); n++)
+        {
+            for (uint64_t i=0; i<4; i++) pendingNodes[n]->hash[i] = hashes[n*4 + i];
+        }
+    }
+
+    return ZKR_SUCCESS;
+}
+
+zkresult Smt::findNode (const DatabaseMap::MTMap &nodes, const string &key, vector<Goldilocks::Element> &value)
+{
+    DatabaseMap::MTMap::const_iterator it = nodes.find(NormalizeToNFormat(key, 64));
+    if (it == nodes.end())
+    {
+        return ZKR_DB_KEY_NOT_FOUND;
+    }
+    value = it->second;
+    return ZKR_SUCCESS;
+}
+
 // Split the fe key into 4-bits chuncks, e.g. 0x123456EF -> { 1, 2, 3, 4, 5, 6, E, F }
 void Smt::splitKey( const Goldilocks::Element (&key)[4], bool (&result)[256])
 {
@@ -1079,35 +1771,98 @@ zkresult Smt::hashSave ( const SmtContext &ctx, const Goldilocks::Element (&v)[1
     // Calculate the poseidon hash of the vector of field elements: v = a | c
     poseidon.hash(hash, v);
 
-    // Fill a database value with the field elements
-    string hashString = fea2string(fr, hash);
+    return save(ctx, v, hash);
+}
 
-    // Add the key:value pair to the database, using the hash as a key
-    vector<Goldilocks::Element> dbValue;
-    for (uint64_t i=0; i<12; i++) dbValue.push_back(v[i]);
+void Smt::hashMany (const Goldilocks::Element *pInputs, Goldilocks::Element *pHashes, uint64_t n)
+{
+#ifdef __AVX512__
+    // The AVX-512 permutation hashes 2 nodes per call, with their inputs and outputs interleaved in blocks of 4 elements
+    uint64_t nPairs = n / 2;
+#pragma omp parallel for if (n >= SMT_HASH_MANY_PARALLEL_THRESHOLD)
+    for (uint64_t i=0; i<nPairs; i++)
+    {
+        Goldilocks::Element input[24];
+        Goldilocks::Element state[8];
+        const Goldilocks::Element *pA = &pInputs[(2*i)*12];
+        const Goldilocks::Element *pB = &pInputs[(2*i + 1)*12];
+        for (uint64_t block=0; block<3; block++)
+        {
+            for (uint64_t j=0; j<4; j++)
+            {
+                input[block*8 + j] = pA[block*4 + j];
+                input[block*8 + 4 + j] = pB[block*4 + j];
+            }
+        }
+        PoseidonGoldilocks::hash_avx512(state, input);
+        for (uint64_t j=0; j<8; j++)
+        {
+            pHashes[i*8 + j] = state[j];
+        }
+    }
+    if (n % 2 != 0)
+    {
+        poseidon.hash(*(Goldilocks::Element (*)[4])&pHashes[(n-1)*4], *(const Goldilocks::Element (*)[12])&pInputs[(n-1)*12]);
+    }
+#else
+    // The AVX2 permutation hashes 1 node per call, so spread the nodes among the threads
+#pragma omp parallel for if (n >= SMT_HASH_MANY_PARALLEL_THRESHOLD)
+    for (uint64_t i=0; i<n; i++)
+    {
+        poseidon.hash(*(Goldilocks::Element (*)[4])&pHashes[i*4], *(const Goldilocks::Element (*)[12])&pInputs[i*12]);
+    }
+#endif
+}
+
+zkresult Smt::hashSaveMany (const SmtContext &ctx, const Goldilocks::Element *pInputs, Goldilocks::Element *pHashes, uint64_t n)
+{
+    hashMany(pInputs, pHashes, n);
+
+    zkresult zkr;
+    for (uint64_t i=0; i<n; i++)
+    {
+        zkr = save(ctx, *(const Goldilocks::Element (*)[12])&pInputs[i*12], *(const Goldilocks::Element (*)[4])&pHashes[i*4]);
+        if (zkr != ZKR_SUCCESS)
+        {
+            return zkr;
+        }
+    }
+    return ZKR_SUCCESS;
+}
+
+zkresult Smt::save ( const SmtContext &ctx, const Goldilocks::Element (&v)[12], const Goldilocks::Element (&hash)[4])
+{
     zkresult zkr;
 
     if (ctx.bUseStateManager)
     {
-        zkr = stateManager.write(ctx.batchUUID, ctx.tx, hashString, dbValue, ctx.persistence);
+        // The state manager stores binary keys and values, so no string or vector is built here
+        zkr = stateManager.write(ctx.batchUUID, ctx.tx, hash, v, 12, ctx.persistence);
         if (zkr != ZKR_SUCCESS)
         {
-            zklog.error("Smt::hashSave() failed calling stateManager.write() key=" + hashString + " result=" + to_string(zkr) + "=" + zkresult2string(zkr));
+            zklog.error("Smt::save() failed calling stateManager.write() key=" + fea2string(fr, hash) + " result=" + to_string(zkr) + "=" + zkresult2string(zkr));
         }
     }
     else
     {
+        // Fill a database value with the field elements
+        string hashString = fea2string(fr, hash);
+
+        // Add the key:value pair to the database, using the hash as a key
+        vector<Goldilocks::Element> dbValue;
+        for (uint64_t i=0; i<12; i++) dbValue.push_back(v[i]);
+
         zkr = ctx.db.write(hashString, hash, dbValue, ctx.persistence == PERSISTENCE_DATABASE ? 1 : 0);
         if (zkr != ZKR_SUCCESS)
         {
-            zklog.error("Smt::hashSave() failed calling db.write() key=" + hashString + " result=" + to_string(zkr) + "=" + zkresult2string(zkr));
+            zklog.error("Smt::save() failed calling db.write() key=" + hashString + " result=" + to_string(zkr) + "=" + zkresult2string(zkr));
         }
     }
     
 #ifdef LOG_SMT
     {
-        string s = "Smt::hashSave() key=" + hashString + " value=";
-        for (uint64_t i=0; i<12; i++) s += fr.toString(dbValue[i],16) + ":";
+        string s = "Smt::save() key=" + fea2string(fr, hash) + " value=";
+        for (uint64_t i=0; i<12; i++) s += fr.toString(v[i],16) + ":";
         s += " zkr=" + zkresult2string(zkr);
         zklog.info(s);
     }
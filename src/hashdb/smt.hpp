@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <map>
+#include <deque>
 #include <gmpxx.h>
 
 #include "poseidon_goldilocks.hpp"
@@ -31,6 +32,46 @@ public:
         persistence(persistence) {};
 };
 
+// Navigation state of a key in Smt::getMany()
+class SmtGetManyState
+{
+public:
+    Goldilocks::Element key[4];
+    bool keys[256];
+    Goldilocks::Element r[4]; // Hash of the next node to read
+    uint64_t level;
+    bool bLeaf; // The leaf was found, and r is the hash of its value
+    bool bDone;
+    string lastRequested; // Last node requested to the database, to detect missing nodes
+    SmtGetManyState() : level(0), bLeaf(false), bDone(false) {};
+};
+
+// Node of the in-memory subtree built by Smt::setBatch()
+#define SMT_BATCH_NODE_EMPTY 0 // Empty branch, hash is zero
+#define SMT_BATCH_NODE_LEAF 1 // Leaf node, with its complete key and its value hash
+#define SMT_BATCH_NODE_INTERMEDIATE 2 // Intermediate node, with its 2 children
+#define SMT_BATCH_NODE_UNREAD 3 // Node not read from the tree, only its hash is known
+
+// Minimum number of nodes for Smt::hashMany() to split the hashes among several threads
+#define SMT_HASH_MANY_PARALLEL_THRESHOLD 64
+
+class SmtBatchNode
+{
+public:
+    uint64_t type;
+    bool bDirty; // Content changed, so its hash must be calculated and the node saved
+    bool bValueDirty; // Leaf value changed, so the value hash must be calculated and the value saved
+    Goldilocks::Element hash[4]; // Hash of the node; calculated by Smt::setBatch() if dirty
+    Goldilocks::Element oldHash[4]; // Hash of the node as read from the tree, still to be deleted if the node changes
+    Goldilocks::Element key[4]; // Leaf: complete key
+    Goldilocks::Element valueHash[4]; // Leaf: hash of the value
+    mpz_class value; // Leaf: value, only valid if bValueDirty
+    SmtBatchNode *child[2]; // Intermediate: children
+    Goldilocks::Element v[12]; // Node content, calculated together with the hash
+    Goldilocks::Element valueV[12]; // Leaf value content, calculated together with the value hash
+    SmtBatchNode() : type(SMT_BATCH_NODE_EMPTY), bDirty(false), bValueDirty(false), child{NULL, NULL} {};
+};
+
 // SMT class
 class Smt
 {
@@ -51,13 +92,46 @@ public:
         capacityOne[2] = fr.zero();
         capacityOne[3] = fr.zero();
     }
-    zkresult set(const string &batchUUID, uint64_t tx, Database &db, const Goldilocks::Element (&oldRoot)[4], const Goldilocks::Element (&key)[4], const mpz_class &value, const Persistence persistence, SmtSetResult &result, DatabaseMap *dbReadLog = NULL);
-    zkresult get(const string &batchUUID, Database &db, const Goldilocks::Element (&root)[4], const Goldilocks::Element (&key)[4], SmtGetResult &result, DatabaseMap *dbReadLog = NULL);
+    zkresult set(const string &batchUUID, uint64_t tx, Database &db, const Goldilocks::Element (&oldRoot)[4], const Goldilocks::Element (&key)[4], const mpz_class &value, const Persistence persistence, SmtSetResult &result, DatabaseMap *dbReadLog = NULL, const DatabaseMap::MTMap *pNodes = NULL);
+    zkresult get(const string &batchUUID, Database &db, const Goldilocks::Element (&root)[4], const Goldilocks::Element (&key)[4], SmtGetResult &result, DatabaseMap *dbReadLog = NULL, const DatabaseMap::MTMap *pNodes = NULL);
+
+    // Gets the values of many keys (4 field elements each) at once, reading the tree nodes of all keys level by level
+    zkresult getMany(const string &batchUUID, Database &db, const Goldilocks::Element (&root)[4], const vector<Goldilocks::Element> &keys, vector<SmtGetResult> &results, DatabaseMap *dbReadLog = NULL);
+
+    // Sets the values of many keys (4 field elements each) at once, in order, starting from oldRoot.
+    // The affected subtree is built in memory and every dirty node is hashed and saved only once.
+    // The per-key results, if requested, depend on the intermediate roots, so in that case the keys are set one by one,
+    // over the nodes already read
+    zkresult setBatch(const string &batchUUID, uint64_t tx, Database &db, const Goldilocks::Element (&oldRoot)[4], const vector<Goldilocks::Element> &keys, const vector<mpz_class> &values, const Persistence persistence, Goldilocks::Element (&newRoot)[4], vector<SmtSetResult> *pResults = NULL, DatabaseMap *dbReadLog = NULL);
+private:
+    zkresult findNode(const DatabaseMap::MTMap &nodes, const string &key, vector<Goldilocks::Element> &value);
+
+    // Reads the nodes of the paths of all the keys, level by level, optionally including the leaf values
+    zkresult readPaths(const string &batchUUID, Database &db, const Goldilocks::Element (&root)[4], const vector<Goldilocks::Element> &keys, bool bReadValues, DatabaseMap::MTMap &nodes, DatabaseMap *dbReadLog);
+
+    // Smt::setBatch() helpers
+    SmtBatchNode * batchNewNode(deque<SmtBatchNode> &tree, const Goldilocks::Element (&hash)[4]);
+    void batchRetire(SmtBatchNode &node, vector<Goldilocks::Element> &nodesToDelete);
+    zkresult batchRead(const SmtContext &ctx, const DatabaseMap::MTMap &nodes, deque<SmtBatchNode> &tree, SmtBatchNode &node, const vector<uint64_t> &accKey, DatabaseMap *dbReadLog);
+    zkresult batchSet(const SmtContext &ctx, const DatabaseMap::MTMap &nodes, deque<SmtBatchNode> &tree, SmtBatchNode &node, uint64_t level, vector<uint64_t> &accKey, const Goldilocks::Element (&key)[4], const bool (&keys)[256], const mpz_class &value, vector<Goldilocks::Element> &nodesToDelete, bool &bChanged, DatabaseMap *dbReadLog);
+    zkresult batchNormalize(const SmtContext &ctx, const DatabaseMap::MTMap &nodes, deque<SmtBatchNode> &tree, SmtBatchNode &node, vector<uint64_t> &accKey, vector<Goldilocks::Element> &nodesToDelete, DatabaseMap *dbReadLog);
+    void batchGetLevels(SmtBatchNode &node, uint64_t level, vector<vector<SmtBatchNode *>> &levels);
+    zkresult batchHashSave(const SmtContext &ctx, vector<vector<SmtBatchNode *>> &levels);
+public:
     void splitKey(const Goldilocks::Element (&key)[4], bool (&result)[256]);
     void joinKey(const vector<uint64_t> &bits, const Goldilocks::Element (&rkey)[4], Goldilocks::Element (&key)[4]);
     void removeKeyBits(const Goldilocks::Element (&key)[4], uint64_t nBits, Goldilocks::Element (&rkey)[4]);
     zkresult hashSave(const SmtContext &ctx, const Goldilocks::Element (&v)[12], Goldilocks::Element (&hash)[4]);
 
+    // Calculates the poseidon hashes of n nodes at once: pInputs contains n*12 field elements, and pHashes receives n*4
+    void hashMany(const Goldilocks::Element *pInputs, Goldilocks::Element *pHashes, uint64_t n);
+
+    // Calculates the poseidon hashes of n nodes at once, and saves them
+    zkresult hashSaveMany(const SmtContext &ctx, const Goldilocks::Element *pInputs, Goldilocks::Element *pHashes, uint64_t n);
+
+    // Saves an already hashed node
+    zkresult save(const SmtContext &ctx, const Goldilocks::Element (&v)[12], const Goldilocks::Element (&hash)[4]);
+
     // Consolidate value and capacity
     zkresult hashSave(const SmtContext &ctx, const Goldilocks::Element (&a)[8], const Goldilocks::Element (&c)[4], Goldilocks::Element (&hash)[4])
     {
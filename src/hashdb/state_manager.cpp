@@ -5,9 +5,106 @@
 #include "timer.hpp"
 #include "persistence.hpp"
 #include "definitions.hpp"
+#include "zkmax.hpp"
+#include "exit_process.hpp"
 
 StateManager stateManager;
 
+void StateManagerArena::release(void)
+{
+    for (uint64_t i=0; i<chunks.size(); i++)
+    {
+        free(chunks[i]);
+    }
+    chunks.clear();
+    pCurrent = NULL;
+    available = 0;
+}
+
+void *StateManagerArena::do_allocate(size_t bytes, size_t alignment)
+{
+    allocations++;
+    allocatedBytes += bytes;
+
+    if (!bEnabled)
+    {
+        heapAllocations++;
+        return ::operator new(bytes, std::align_val_t(alignment));
+    }
+
+    // Align the current position
+    uint64_t padding = (alignment - ((uint64_t)pCurrent & (alignment - 1))) & (alignment - 1);
+
+    // If it does not fit in the current chunk, get a new one, big enough for this allocation
+    if ((pCurrent == NULL) || (padding + bytes > available))
+    {
+        uint64_t chunkSize = zkmax((uint64_t)STATE_MANAGER_ARENA_CHUNK_SIZE, bytes + alignment);
+        uint8_t *pChunk = (uint8_t *)malloc(chunkSize);
+        if (pChunk == NULL)
+        {
+            zklog.error("StateManagerArena::do_allocate() failed calling malloc() of size=" + to_string(chunkSize));
+            exitProcess();
+        }
+        heapAllocations++;
+        chunks.push_back(pChunk);
+        pCurrent = pChunk;
+        available = chunkSize;
+        padding = (alignment - ((uint64_t)pCurrent & (alignment - 1))) & (alignment - 1);
+    }
+
+    void *p = pCurrent + padding;
+    pCurrent += padding + bytes;
+    available -= padding + bytes;
+    return p;
+}
+
+void StateManagerArena::do_deallocate(void *p, size_t bytes, size_t alignment)
+{
+    if (!bEnabled)
+    {
+        ::operator delete(p, bytes, std::align_val_t(alignment));
+    }
+}
+
+void StateManager::string2key (const string &_key, StateManagerKey &binaryKey)
+{
+    // Normalize key format
+    string key = NormalizeToNFormat(_key, 64);
+    Goldilocks::Element fea[4];
+    ::string2key(fr, key, fea);
+    for (uint64_t i=0; i<4; i++)
+    {
+        binaryKey.key[i] = fr.toU64(fea[i]);
+    }
+}
+
+string StateManager::key2string (const StateManagerKey &binaryKey)
+{
+    Goldilocks::Element fea[4];
+    for (uint64_t i=0; i<4; i++)
+    {
+        fea[i] = fr.fromU64(binaryKey.key[i]);
+    }
+    return NormalizeToNFormat(fea2string(fr, fea), 64);
+}
+
+shared_ptr<BatchState> StateManager::getBatchState (const string &batchUUID)
+{
+    shared_lock<shared_mutex> guard(stateMutex);
+    unordered_map<string, shared_ptr<BatchState>>::iterator it = state.find(batchUUID);
+    if (it == state.end())
+    {
+        return shared_ptr<BatchState>();
+    }
+    return it->second;
+}
+
+void StateManager::deleteBatchState (const string &batchUUID)
+{
+    unique_lock<shared_mutex> guard(stateMutex);
+    state.erase(batchUUID);
+}
+
 zkresult StateManager::setStateRoot (const string &batchUUID, uint64_t tx, const string &_stateRoot, bool bIsOldStateRoot, const Persistence persistence)
 {
 #ifdef LOG_TIME_STATISTICS_STATE_MANAGER
@@ -30,27 +127,26 @@ zkresult StateManager::setStateRoot (const string &batchUUID, uint64_t tx, const
     zklog.info("StateManager::setStateRoot() batchUUID=" + batchUUID + " tx=" + to_string(tx) + " stateRoot=" + stateRoot + " bIsOldStateRoot=" + to_string(bIsOldStateRoot) + " persistence=" + persistence2string(persistence));
 #endif
 
-    Lock();
-
-    unordered_map<string, BatchState>::iterator it;
-
     // Find batch state for this uuid, or create it if it does not exist
-    it = state.find(batchUUID);
-    if (it == state.end())
+    shared_ptr<BatchState> pBatchState = getBatchState(batchUUID);
+    if (pBatchState == NULL)
     {
         if (!bIsOldStateRoot)
         {
             zklog.error("StateManager::setStateRoot() called with bIsOldStateRoot=false, but batchUUID=" + batchUUID + " does not previously exist");
-            Unlock();
             return ZKR_STATE_MANAGER;
         }
-        BatchState batchState;
-        batchState.oldStateRoot = stateRoot;
-        state[batchUUID] = batchState;
-        it = state.find(batchUUID);
-        zkassert(it != state.end());
+        unique_lock<shared_mutex> stateGuard(stateMutex);
+        shared_ptr<BatchState> &pNewBatchState = state[batchUUID];
+        if (pNewBatchState == NULL)
+        {
+            pNewBatchState = make_shared<BatchState>(config.stateManagerArena);
+            pNewBatchState->oldStateRoot = stateRoot;
+        }
+        pBatchState = pNewBatchState;
     }
-    BatchState &batchState = it->second;
+    BatchState &batchState = *pBatchState;
+    lock_guard<mutex> guard(batchState.mlock);
 
     // Set the current state root
     batchState.currentStateRoot = stateRoot;
@@ -62,20 +158,16 @@ zkresult StateManager::setStateRoot (const string &batchUUID, uint64_t tx, const
         if (!bIsOldStateRoot)
         {
             zklog.error("StateManager::setStateRoot() called with bIsOldStateRoot=false, but tx=" + to_string(tx) + " does not previously exist");
-            Unlock();
             return ZKR_STATE_MANAGER;
         }
 
         // Calculate the number of tx slots to create
         uint64_t txsToCreate = tx - batchState.txState.size() + 1;
 
-        // Create TX state to insert
-        TxState txState;
-        
-        // Insert TX state
+        // Insert TX states
         for (uint64_t i=0; i<txsToCreate; i++)
         {
-            batchState.txState.emplace_back(txState);
+            batchState.txState.emplace_back();
         }
 
         // Set current TX
@@ -98,7 +190,6 @@ zkresult StateManager::setStateRoot (const string &batchUUID, uint64_t tx, const
             if (txState.persistence[persistence].currentSubState != 0)
             {
                 zklog.error("StateManager::setStateRoot() currentSubState=" + to_string(txState.persistence[persistence].currentSubState) + "!=0 batchUUID=" + batchUUID + " tx=" + to_string(tx) + " stateRoot=" + stateRoot + " bIsOldStateRoot=" + to_string(bIsOldStateRoot) + " persistence=" + persistence2string(persistence));
-                Unlock();
                 return ZKR_STATE_MANAGER;
             }
 
@@ -113,7 +204,6 @@ zkresult StateManager::setStateRoot (const string &batchUUID, uint64_t tx, const
             if (txState.persistence[persistence].currentSubState >= currentSubStateSize)
             {
                 zklog.error("StateManager::setStateRoot() currentSubState=" + to_string(txState.persistence[persistence].currentSubState) + " > currentSubStateSize=" + to_string(currentSubStateSize) + " batchUUID=" + batchUUID + " tx=" + to_string(tx) + " stateRoot=" + stateRoot + " bIsOldStateRoot=" + to_string(bIsOldStateRoot) + " persistence=" + persistence2string(persistence));
-                Unlock();
                 return ZKR_STATE_MANAGER;
             }
 
@@ -121,19 +211,16 @@ zkresult StateManager::setStateRoot (const string &batchUUID, uint64_t tx, const
             if (txState.persistence[persistence].subState[currentSubStateSize-1].newStateRoot.size() == 0)
             {
                 zklog.error("StateManager::setStateRoot() oldStateRoot found previous newStateRoot empty");
-                Unlock();
                 return ZKR_STATE_MANAGER;
             }
         }
 
-        // Create TX sub-state
-        TxSubState txSubState;
+        // Create TX sub-state, and insert it
+        txState.persistence[persistence].subState.emplace_back(&batchState.arena);
+        TxSubState &txSubState = txState.persistence[persistence].subState.back();
         txSubState.oldStateRoot = stateRoot;
         txSubState.previousSubState = txState.persistence[persistence].currentSubState;
 
-        // Insert it
-        txState.persistence[persistence].subState.emplace_back(txSubState);
-
         // Record the current state
         txState.persistence[persistence].currentSubState = txState.persistence[persistence].subState.size() - 1;
     }
@@ -144,7 +231,6 @@ zkresult StateManager::setStateRoot (const string &batchUUID, uint64_t tx, const
         if (txState.persistence[persistence].currentSubState >= currentSubStateSize)
         {
             zklog.error("StateManager::setStateRoot() currentSubState=" + to_string(txState.persistence[persistence].currentSubState) + " > currentSubStateSize=" + to_string(currentSubStateSize) + " batchUUID=" + batchUUID + " tx=" + to_string(tx) + " stateRoot=" + stateRoot + " bIsOldStateRoot=" + to_string(bIsOldStateRoot) + " persistence=" + persistence2string(persistence));
-            Unlock();
             return ZKR_STATE_MANAGER;
         }
 
@@ -152,7 +238,6 @@ zkresult StateManager::setStateRoot (const string &batchUUID, uint64_t tx, const
         if (txState.persistence[persistence].subState[txState.persistence[persistence].currentSubState].newStateRoot.size() != 0)
         {
             zklog.error("StateManager::setStateRoot() found nesStateRoot busy");
-            Unlock();
             return ZKR_STATE_MANAGER;
         }
 
@@ -165,130 +250,144 @@ zkresult StateManager::setStateRoot (const string &batchUUID, uint64_t tx, const
     batchState.timeMetricStorage.add("setStateRoot", TimeDiff(t));
 #endif
 
-    Unlock();
-
     return ZKR_SUCCESS;
 
 }
 
-zkresult StateManager::write (const string &batchUUID, uint64_t tx, const string &_key, const vector<Goldilocks::Element> &value, const Persistence persistence)
+zkresult StateManager::write (const string &batchUUID, uint64_t tx, const Goldilocks::Element (&_key)[4], const Goldilocks::Element *value, uint64_t valueSize, const Persistence persistence)
 {
 #ifdef LOG_TIME_STATISTICS_STATE_MANAGER
     struct timeval t;
     gettimeofday(&t, NULL);
 #endif
 
-    // Normalize key format
-    string key = NormalizeToNFormat(_key, 64);
-    key = stringToLower(key);
+    StateManagerKey key;
+    for (uint64_t i=0; i<4; i++)
+    {
+        key.key[i] = fr.toU64(_key[i]);
+    }
 
 #ifdef LOG_STATE_MANAGER
-    zklog.info("StateManager::write() batchUUID=" + batchUUID + " tx=" + to_string(tx) + " key=" + key + " persistence=" + persistence2string(persistence));
+    zklog.info("StateManager::write() batchUUID=" + batchUUID + " tx=" + to_string(tx) + " key=" + key2string(key) + " persistence=" + persistence2string(persistence));
 #endif
 
     // Check persistence range
     if (persistence >= PERSISTENCE_SIZE)
     {
-        zklog.error("StateManager::write() wrong persistence batchUUID=" + batchUUID + " tx=" + to_string(tx) + " key=" + key + " persistence=" + persistence2string(persistence));
+        zklog.error("StateManager::write() wrong persistence batchUUID=" + batchUUID + " tx=" + to_string(tx) + " key=" + key2string(key) + " persistence=" + persistence2string(persistence));
         return ZKR_STATE_MANAGER;
     }
 
-    Lock();
+    // Check value size
+    if (valueSize > 12)
+    {
+        zklog.error("StateManager::write() wrong value size=" + to_string(valueSize) + " batchUUID=" + batchUUID + " tx=" + to_string(tx) + " key=" + key2string(key));
+        return ZKR_STATE_MANAGER;
+    }
 
     // Find batch state for this uuid
-    unordered_map<string, BatchState>::iterator it;
-    it = state.find(batchUUID);
-    if (it == state.end())
+    shared_ptr<BatchState> pBatchState = getBatchState(batchUUID);
+    if (pBatchState == NULL)
     {
         zklog.error("StateManager::write() found no batch state for batch UUID=" + batchUUID);
-        Unlock();
         return ZKR_STATE_MANAGER;
     }
-    BatchState &batchState = it->second;
+    BatchState &batchState = *pBatchState;
+    lock_guard<mutex> guard(batchState.mlock);
 
     // Check tx range
     if (tx > batchState.txState.size())
     {
-        zklog.error("StateManager::write() got tx=" + to_string(tx) + " bigger than txState size=" + to_string(it->second.txState.size()));
-        Unlock();
+        zklog.error("StateManager::write() got tx=" + to_string(tx) + " bigger than txState size=" + to_string(batchState.txState.size()));
         return ZKR_STATE_MANAGER;
     }
 
     // Create TxState, if not existing
     if (tx == batchState.txState.size())
     {
-        TxState aux;
-        aux.persistence[persistence].oldStateRoot = it->second.currentStateRoot;
-        it->second.txState.emplace_back(aux);
+        batchState.txState.emplace_back();
+        batchState.txState.back().persistence[persistence].oldStateRoot = batchState.currentStateRoot;
     }
     TxState &txState = batchState.txState[tx];
 
     // Create TxSubState, if not existing
     if (txState.persistence[persistence].subState.size() == 0)
     {
-        TxSubState subState;
+        txState.persistence[persistence].subState.emplace_back(&batchState.arena);
+        TxSubState &subState = txState.persistence[persistence].subState.back();
         subState.previousSubState = 0;
         subState.oldStateRoot = batchState.currentStateRoot;
-        txState.persistence[persistence].subState.emplace_back(subState);
         txState.persistence[persistence].currentSubState = 0;
     }
 
     // Add to sub-state
-    txState.persistence[persistence].subState[txState.persistence[persistence].currentSubState].dbWrite[key] = value;
-    
+    StateManagerValue &subStateValue = txState.persistence[persistence].subState[txState.persistence[persistence].currentSubState].dbWrite[key];
+    for (uint64_t i=0; i<valueSize; i++)
+    {
+        subStateValue.value[i] = value[i];
+    }
+    subStateValue.size = valueSize;
+
     // Add to common write pool to speed up read
-    batchState.dbWrite[key] = value;
+    batchState.dbWrite[key] = subStateValue;
 
 #ifdef LOG_TIME_STATISTICS_STATE_MANAGER
     batchState.timeMetricStorage.add("write", TimeDiff(t));
 #endif
 
-    Unlock();
-
     return ZKR_SUCCESS;
 }
 
-zkresult StateManager::deleteNode (const string &batchUUID, uint64_t tx, const string &_key, const Persistence persistence)
+zkresult StateManager::write (const string &batchUUID, uint64_t tx, const string &_key, const vector<Goldilocks::Element> &value, const Persistence persistence)
+{
+    StateManagerKey binaryKey;
+    string2key(_key, binaryKey);
+    Goldilocks::Element key[4];
+    for (uint64_t i=0; i<4; i++)
+    {
+        key[i] = fr.fromU64(binaryKey.key[i]);
+    }
+    return write(batchUUID, tx, key, value.data(), value.size(), persistence);
+}
+
+zkresult StateManager::deleteNode (const string &batchUUID, uint64_t tx, const Goldilocks::Element (&_key)[4], const Persistence persistence)
 {
 #ifdef LOG_TIME_STATISTICS_STATE_MANAGER
     struct timeval t;
     gettimeofday(&t, NULL);
 #endif
 
-    // Normalize key format
-    string key = NormalizeToNFormat(_key, 64);
-    key = stringToLower(key);
+    StateManagerKey key;
+    for (uint64_t i=0; i<4; i++)
+    {
+        key.key[i] = fr.toU64(_key[i]);
+    }
 
 #ifdef LOG_STATE_MANAGER
-    zklog.info("StateManager::deleteNode() batchUUID=" + batchUUID + " tx=" + to_string(tx) + " key=" + key + " persistence=" + persistence2string(persistence));
+    zklog.info("StateManager::deleteNode() batchUUID=" + batchUUID + " tx=" + to_string(tx) + " key=" + key2string(key) + " persistence=" + persistence2string(persistence));
 #endif
 
     // Check persistence range
     if (persistence >= PERSISTENCE_SIZE)
     {
-        zklog.error("StateManager::deleteNode() invalid persistence batchUUID=" + batchUUID + " tx=" + to_string(tx) + " key=" + key + " persistence=" + persistence2string(persistence));
+        zklog.error("StateManager::deleteNode() invalid persistence batchUUID=" + batchUUID + " tx=" + to_string(tx) + " key=" + key2string(key) + " persistence=" + persistence2string(persistence));
         return ZKR_STATE_MANAGER;
     }
 
-    Lock();
-
-    unordered_map<string, BatchState>::iterator it;
-
     // Find batch state for this batch uuid
-    it = state.find(batchUUID);
-    if (it == state.end())
+    shared_ptr<BatchState> pBatchState = getBatchState(batchUUID);
+    if (pBatchState == NULL)
     {
         zklog.error("StateManager::deleteNode() found no batch state for batch UUID=" + batchUUID);
-        Unlock();
         return ZKR_STATE_MANAGER;
     }
-    BatchState &batchState = it->second;
+    BatchState &batchState = *pBatchState;
+    lock_guard<mutex> guard(batchState.mlock);
 
     // Check tx range
     if (tx >= batchState.txState.size())
     {
-        zklog.error("StateManager::deleteNode() got tx=" + to_string(tx) + " bigger than txState size=" + to_string(it->second.txState.size()));
-        Unlock();
+        zklog.error("StateManager::deleteNode() got tx=" + to_string(tx) + " bigger than txState size=" + to_string(batchState.txState.size()));
         return ZKR_STATE_MANAGER;
     }
 
@@ -299,77 +398,74 @@ zkresult StateManager::deleteNode (const string &batchUUID, uint64_t tx, const s
     if (txState.persistence[persistence].subState.size() == 0)
     {
         zklog.error("StateManager::deleteNode() found subState.size=0 tx=" + to_string(tx) + " batchUUIDe=" + batchUUID);
-        Unlock();
         return ZKR_STATE_MANAGER;
     }
     if (txState.persistence[persistence].currentSubState >= txState.persistence[persistence].subState.size())
     {
         zklog.error("StateManager::deleteNode() found currentSubState=" + to_string(txState.persistence[persistence].currentSubState) + " >= subState.size=" + to_string(txState.persistence[persistence].subState.size()) + " tx=" + to_string(tx) + " batchUUIDe=" + batchUUID);
-        Unlock();
         return ZKR_STATE_MANAGER;
     }
     TxSubState &txSubState = txState.persistence[persistence].subState[txState.persistence[persistence].currentSubState];
 
-    // Delete this key in the surrent TX sub-state
-    /*unordered_map<string, vector<Goldilocks::Element>>::iterator dbIt;
-    dbIt = txSubState.dbWrite.find(key);
-    if (dbIt != txSubState.dbWrite.end())
-    {
-        txSubState.dbWrite.erase(dbIt);
-        zklog.info("StateManager::deleteNode() batchUUID=" + batchUUID + " tx=" + to_string(tx) + " key=" + key);
-    }*/
-
     txSubState.dbDelete.emplace_back(key);
 
 #ifdef LOG_TIME_STATISTICS_STATE_MANAGER
     batchState.timeMetricStorage.add("deleteNodes", TimeDiff(t));
 #endif
 
-    Unlock();
-
     return ZKR_SUCCESS;
 }
 
-zkresult StateManager::read (const string &batchUUID, const string &_key, vector<Goldilocks::Element> &value, DatabaseMap *dbReadLog)
+zkresult StateManager::deleteNode (const string &batchUUID, uint64_t tx, const string &_key, const Persistence persistence)
+{
+    StateManagerKey binaryKey;
+    string2key(_key, binaryKey);
+    Goldilocks::Element key[4];
+    for (uint64_t i=0; i<4; i++)
+    {
+        key[i] = fr.fromU64(binaryKey.key[i]);
+    }
+    return deleteNode(batchUUID, tx, key, persistence);
+}
+
+zkresult StateManager::read (const string &batchUUID, const Goldilocks::Element (&_key)[4], vector<Goldilocks::Element> &value, DatabaseMap *dbReadLog)
 {
     struct timeval t;
     gettimeofday(&t, NULL);
 
-    // Normalize key format
-    string key = NormalizeToNFormat(_key, 64);
-    key = stringToLower(key);
-
-    Lock();
+    StateManagerKey key;
+    for (uint64_t i=0; i<4; i++)
+    {
+        key.key[i] = fr.toU64(_key[i]);
+    }
 
     // Find batch state for this uuid
-    unordered_map<string, BatchState>::iterator it;
-    it = state.find(batchUUID);
-    if (it == state.end())
+    shared_ptr<BatchState> pBatchState = getBatchState(batchUUID);
+    if (pBatchState == NULL)
     {
         //zklog.error("StateManager::read() found no batch state for batch UUID=" + batchUUID);
-        Unlock();
         return ZKR_DB_KEY_NOT_FOUND;
     }
-    BatchState &batchState = it->second;
+    BatchState &batchState = *pBatchState;
+    lock_guard<mutex> guard(batchState.mlock);
 
     // Search in the common write list
-    unordered_map<string, vector<Goldilocks::Element>>::iterator dbIt;
+    StateManagerNodeMap::const_iterator dbIt;
     dbIt = batchState.dbWrite.find(key);
     if (dbIt != batchState.dbWrite.end())
     {
-        value = dbIt->second;
+        value.assign(dbIt->second.value, dbIt->second.value + dbIt->second.size);
                         
         // Add to the read log
-        if (dbReadLog != NULL) dbReadLog->add(key, value, true, TimeDiff(t));
+        if (dbReadLog != NULL) dbReadLog->add(key2string(key), value, true, TimeDiff(t));
 
 #ifdef LOG_STATE_MANAGER
-        zklog.info("StateManager::read() batchUUID=" + batchUUID + " key=" + key);
+        zklog.info("StateManager::read() batchUUID=" + batchUUID + " key=" + key2string(key));
 #endif
 
 #ifdef LOG_TIME_STATISTICS_STATE_MANAGER
         batchState.timeMetricStorage.add("read success", TimeDiff(t));
 #endif
-        Unlock();
 
         return ZKR_SUCCESS;
     }
@@ -378,11 +474,21 @@ zkresult StateManager::read (const string &batchUUID, const string &_key, vector
     batchState.timeMetricStorage.add("read not found", TimeDiff(t));
 #endif
 
-    Unlock();
-
     return ZKR_DB_KEY_NOT_FOUND;
 }
 
+zkresult StateManager::read (const string &batchUUID, const string &_key, vector<Goldilocks::Element> &value, DatabaseMap *dbReadLog)
+{
+    StateManagerKey binaryKey;
+    string2key(_key, binaryKey);
+    Goldilocks::Element key[4];
+    for (uint64_t i=0; i<4; i++)
+    {
+        key[i] = fr.fromU64(binaryKey.key[i]);
+    }
+    return read(batchUUID, key, value, dbReadLog);
+}
+
 bool IsInvalid(TxSubState &txSubState)
 {
     return !txSubState.bValid;
@@ -410,13 +516,9 @@ zkresult StateManager::semiFlush (const string &batchUUID, const string &_stateR
     zklog.info("StateManager::semiFlush() batchUUID=" + batchUUID + " stateRoot=" + stateRoot + " persistence=" + persistence2string(persistence));
 #endif
 
-    Lock();
-
-    unordered_map<string, BatchState>::iterator it;
-
     // Find batch state for this uuid
-    it = state.find(batchUUID);
-    if (it == state.end())
+    shared_ptr<BatchState> pBatchState = getBatchState(batchUUID);
+    if (pBatchState == NULL)
     {
         zklog.warning("StateManager::semiFlush() found no batch state for batch UUID=" + batchUUID + "; normal if no SMT activity happened");
  
@@ -424,16 +526,15 @@ zkresult StateManager::semiFlush (const string &batchUUID, const string &_stateR
         //batchState.timeMetricStorage.add("semiFlush UUID not found", TimeDiff(t));
         //batchState.timeMetricStorage.print("State Manager calls");
 #endif
-        Unlock();
         return ZKR_SUCCESS;
     }
-    BatchState &batchState = it->second;
+    BatchState &batchState = *pBatchState;
+    lock_guard<mutex> guard(batchState.mlock);
 
     // Check currentTx range
     if (batchState.currentTx >= batchState.txState.size())
     {
         zklog.error("StateManager::semiFlush() found batchState.currentTx=" + to_string(batchState.currentTx) + " >= batchState.txState.size=" + to_string(batchState.txState.size()) + " batchUUID=" + batchUUID + " stateRoot=" + stateRoot + " persistence=" + persistence2string(persistence));
-        Unlock();
         return ZKR_STATE_MANAGER;
     }
 
@@ -487,8 +588,6 @@ zkresult StateManager::semiFlush (const string &batchUUID, const string &_stateR
     batchState.timeMetricStorage.add("semi flush", TimeDiff(t));
 #endif
 
-    Unlock();
-
     return ZKR_SUCCESS;
 }
 
@@ -507,14 +606,11 @@ zkresult StateManager::flush (const string &batchUUID, const string &_newStateRo
 
     // For every TX, track backwards from newStateRoot to oldStateRoot, marking sub-states as valid
 
-    Lock();
-
     zkresult zkr;
 
     // Find batch state for this uuid
-    unordered_map<string, BatchState>::iterator it;
-    it = state.find(batchUUID);
-    if (it == state.end())
+    shared_ptr<BatchState> pBatchState = getBatchState(batchUUID);
+    if (pBatchState == NULL)
     {
         //zklog.warning("StateManager::flush() found no batch state for batch UUID=" + batchUUID + "; normal if no SMT activity happened");
  
@@ -530,10 +626,10 @@ zkresult StateManager::flush (const string &batchUUID, const string &_newStateRo
         //timeMetricStorage.add("flush UUID not found", TimeDiff(t));
         //timeMetricStorage.print("State Manager calls");
 #endif
-        Unlock();
         return zkr;
     }
-    BatchState &batchState = it->second;
+    BatchState &batchState = *pBatchState;
+    unique_lock<mutex> guard(batchState.mlock);
 
     // For all txs, delete the ones that are not part of the final state root chain
     if (config.stateManagerPurgeTxs && (_newStateRoot.size() > 0) && (_persistence == PERSISTENCE_DATABASE))
@@ -594,7 +690,6 @@ zkresult StateManager::flush (const string &batchUUID, const string &_newStateRo
                 batchState.timeMetricStorage.add("flush UUID inconsistent new state roots", TimeDiff(t));
                 batchState.timeMetricStorage.print("State Manager calls");
 #endif
-                Unlock();
                 return ZKR_STATE_MANAGER;
             }
 
@@ -615,7 +710,6 @@ zkresult StateManager::flush (const string &batchUUID, const string &_newStateRo
                         batchState.timeMetricStorage.add("flush UUID inconsistent old state roots", TimeDiff(t));
                         batchState.timeMetricStorage.print("State Manager calls");
 #endif
-                        Unlock();
                         return ZKR_STATE_MANAGER;
                     }
                     break;
@@ -648,7 +742,6 @@ zkresult StateManager::flush (const string &batchUUID, const string &_newStateRo
                     batchState.timeMetricStorage.add("flush UUID cannot find previous tx sub-state", TimeDiff(t));
                     batchState.timeMetricStorage.print("State Manager calls");
 #endif
-                    Unlock();
                     return ZKR_STATE_MANAGER;
                 }
                 currentSubState = previousSubState;
@@ -691,16 +784,24 @@ zkresult StateManager::flush (const string &batchUUID, const string &_newStateRo
             for (uint64_t ss = 0; ss < txState.persistence[persistence].subState.size(); ss++)
             {
                 // For all keys to write
-                unordered_map<string, vector<Goldilocks::Element>>::const_iterator writeIt;
+                StateManagerNodeMap::const_iterator writeIt;
+                vector<Goldilocks::Element> value;
                 for ( writeIt = txState.persistence[persistence].subState[ss].dbWrite.begin();
                       writeIt != txState.persistence[persistence].subState[ss].dbWrite.end();
                       writeIt++ )
                 {
-                    zkr = db.write(writeIt->first, NULL, writeIt->second, persistence == PERSISTENCE_DATABASE ? 1 : 0);
+                    Goldilocks::Element key[4];
+                    for (uint64_t i=0; i<4; i++)
+                    {
+                        key[i] = fr.fromU64(writeIt->first.key[i]);
+                    }
+                    value.assign(writeIt->second.value, writeIt->second.value + writeIt->second.size);
+                    zkr = db.write(key2string(writeIt->first), key, value, persistence == PERSISTENCE_DATABASE ? 1 : 0);
                     if (zkr != ZKR_SUCCESS)
                     {
                         zklog.error("StateManager::flush() failed calling db.write() result=" + zkresult2string(zkr));
-                        state.erase(it);
+                        guard.unlock();
+                        deleteBatchState(batchUUID);
 
                         TimerStopAndLog(STATE_MANAGER_FLUSH);
 
@@ -708,7 +809,6 @@ zkresult StateManager::flush (const string &batchUUID, const string &_newStateRo
                         batchState.timeMetricStorage.add("flush error db.write", TimeDiff(t));
                         batchState.timeMetricStorage.print("State Manager calls");
 #endif
-                        Unlock();
                         return zkr;
                     }
                 }
@@ -721,7 +821,8 @@ zkresult StateManager::flush (const string &batchUUID, const string &_newStateRo
                 if (fea.size() != 4)
                 {
                     zklog.error("StateManager::flush() failed calling string2fea() fea.size=" + to_string(fea.size()));
-                    state.erase(it);
+                    guard.unlock();
+                    deleteBatchState(batchUUID);
 
                     TimerStopAndLog(STATE_MANAGER_FLUSH);
 
@@ -729,7 +830,6 @@ zkresult StateManager::flush (const string &batchUUID, const string &_newStateRo
                     batchState.timeMetricStorage.add("flush error string2fea", TimeDiff(t));
                     batchState.timeMetricStorage.print("State Manager calls");
 #endif
-                    Unlock();
                     return zkr;
 
                 }
@@ -743,7 +843,8 @@ zkresult StateManager::flush (const string &batchUUID, const string &_newStateRo
                 if (zkr != ZKR_SUCCESS)
                 {
                     zklog.error("StateManager::flush() failed calling db.updateStateRoot() result=" + zkresult2string(zkr));
-                    state.erase(it);
+                    guard.unlock();
+                    deleteBatchState(batchUUID);
 
                     TimerStopAndLog(STATE_MANAGER_FLUSH);
 
@@ -751,7 +852,6 @@ zkresult StateManager::flush (const string &batchUUID, const string &_newStateRo
                     batchState.timeMetricStorage.add("flush error db.updateStateRoot", TimeDiff(t));
                     batchState.timeMetricStorage.print("State Manager calls");
 #endif
-                    Unlock();
                     return zkr;
                 }
             }
@@ -769,10 +869,10 @@ zkresult StateManager::flush (const string &batchUUID, const string &_newStateRo
     batchState.timeMetricStorage.print("State Manager calls");
 #endif
     
-    // Delete this batch UUID state
-    state.erase(it);
-
-    Unlock();
+    // Delete this batch UUID state; its arena is released when the last reference to it is gone
+    // Release the batch lock first, since print() locks stateMutex before the batch locks
+    guard.unlock();
+    deleteBatchState(batchUUID);
 
     TimerStopAndLog(STATE_MANAGER_FLUSH);
 
@@ -783,13 +883,15 @@ void StateManager::print (bool bDbContent)
 {
     uint64_t totalDbWrites[PERSISTENCE_SIZE] = {0, 0, 0};
     uint64_t totalDbDeletes[PERSISTENCE_SIZE] = {0, 0, 0};
+    shared_lock<shared_mutex> stateGuard(stateMutex);
     zklog.info("StateManager::print():");
     zklog.info("state.size=" + to_string(state.size()));
-    unordered_map<string, BatchState>::const_iterator stateIt;
+    unordered_map<string, shared_ptr<BatchState>>::const_iterator stateIt;
     uint64_t batchStateCounter = 0;
     for (stateIt = state.begin(); stateIt != state.end(); stateIt++)
     {
-        const BatchState &batchState = stateIt->second;
+        BatchState &batchState = *stateIt->second;
+        lock_guard<mutex> guard(batchState.mlock);
         zklog.info("  batchState=" + to_string(batchStateCounter));
         batchStateCounter++;
         zklog.info("  BatchUUID=" + stateIt->first);
@@ -823,10 +925,10 @@ void StateManager::print (bool bDbContent)
                     totalDbWrites[persistence] += txSubState.dbWrite.size();
                     if (bDbContent)
                     {
-                        unordered_map<string, vector<Goldilocks::Element>>::const_iterator dbIt;
+                        StateManagerNodeMap::const_iterator dbIt;
                         for (dbIt = txSubState.dbWrite.begin(); dbIt != txSubState.dbWrite.end(); dbIt++)
                         {
-                            zklog.info("              " + dbIt->first);
+                            zklog.info("              " + key2string(dbIt->first));
                         }
                     }
                     zklog.info("            dbDelete.size=" + to_string(txSubState.dbDelete.size()));
@@ -835,7 +937,7 @@ void StateManager::print (bool bDbContent)
                     {
                         for (uint64_t j=0; j<txSubState.dbDelete.size(); j++)
                         {
-                            zklog.info("              " + txSubState.dbDelete[j]);
+                            zklog.info("              " + key2string(txSubState.dbDelete[j]));
                         }
                     }
                 }
@@ -854,4 +956,18 @@ void StateManager::print (bool bDbContent)
     }
     zklog.info("total writes=" + to_string(totalWrites));
     zklog.info("total deletes=" + to_string(totalDeletes));
-}
\ No newline at end of file
+}
+
+zkresult StateManager::getArenaStatistics (const string &batchUUID, uint64_t &allocations, uint64_t &allocatedBytes, uint64_t &heapAllocations)
+{
+    shared_ptr<BatchState> pBatchState = getBatchState(batchUUID);
+    if (pBatchState == NULL)
+    {
+        return ZKR_DB_KEY_NOT_FOUND;
+    }
+    lock_guard<mutex> guard(pBatchState->mlock);
+    allocations = pBatchState->arena.allocations;
+    allocatedBytes = pBatchState->arena.allocatedBytes;
+    heapAllocations = pBatchState->arena.heapAllocations;
+    return ZKR_SUCCESS;
+}
@@ -4,6 +4,10 @@
 #include <unordered_map>
 #include <vector>
 #include <string>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <memory_resource>
 #include "goldilocks_base_field.hpp"
 #include "zkresult.hpp"
 #include "database_map.hpp"
@@ -13,6 +17,61 @@
 
 using namespace std;
 
+// Size of the memory chunks requested to the heap by the batch arena
+#define STATE_MANAGER_ARENA_CHUNK_SIZE (1024*1024)
+
+// Per-batch arena: memory is handed out sequentially from big chunks, deallocation is a no-op,
+// and all chunks are returned to the heap at once when the batch state is destroyed; if disabled,
+// every allocation goes to the heap, as with the default allocator
+class StateManagerArena : public std::pmr::memory_resource
+{
+private:
+    bool bEnabled;
+    vector<uint8_t *> chunks;
+    uint8_t *pCurrent;
+    uint64_t available;
+public:
+    // Statistics
+    uint64_t allocations; // Number of allocations served by the arena
+    uint64_t allocatedBytes; // Number of bytes served by the arena
+    uint64_t heapAllocations; // Number of allocations requested to the heap
+
+    StateManagerArena(bool bEnabled) : bEnabled(bEnabled), pCurrent(NULL), available(0), allocations(0), allocatedBytes(0), heapAllocations(0) {};
+    ~StateManagerArena() { release(); };
+    StateManagerArena(const StateManagerArena &) = delete;
+    StateManagerArena &operator=(const StateManagerArena &) = delete;
+    void release(void);
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; };
+};
+
+// Binary key of a node, i.e. its hash, in canonical form
+class StateManagerKey
+{
+public:
+    uint64_t key[4];
+    bool operator==(const StateManagerKey &other) const { return (key[0] == other.key[0]) && (key[1] == other.key[1]) && (key[2] == other.key[2]) && (key[3] == other.key[3]); };
+};
+
+struct StateManagerKeyHash
+{
+    // Keys are hashes, so their bits are uniformly distributed
+    size_t operator()(const StateManagerKey &key) const { return key.key[0] ^ key.key[1]; };
+};
+
+// Value of a node, stored inline
+class StateManagerValue
+{
+public:
+    Goldilocks::Element value[12];
+    uint64_t size;
+};
+
+typedef std::pmr::unordered_map<StateManagerKey, StateManagerValue, StateManagerKeyHash> StateManagerNodeMap;
+typedef std::pmr::vector<StateManagerKey> StateManagerKeyList;
+
 class TxSubState
 {
 public:
@@ -20,13 +79,19 @@ public:
     string newStateRoot;
     uint64_t previousSubState;
     bool bValid;
-    unordered_map<string, vector<Goldilocks::Element>> dbWrite;
-    vector<string> dbDelete;
-    TxSubState() : previousSubState(0), bValid(false)
+    StateManagerNodeMap dbWrite;
+    StateManagerKeyList dbDelete;
+    TxSubState(std::pmr::memory_resource *pArena) : previousSubState(0), bValid(false), dbWrite(pArena), dbDelete(pArena)
     {
         dbWrite.reserve(128);
         dbDelete.reserve(128);
     };
+
+    // Sub-states are only moved, so that their containers keep on using the batch arena
+    TxSubState(const TxSubState &) = delete;
+    TxSubState &operator=(const TxSubState &) = delete;
+    TxSubState(TxSubState &&) = default;
+    TxSubState &operator=(TxSubState &&) = default;
 };
 
 class TxPersistenceState
@@ -51,15 +116,17 @@ public:
 class BatchState
 {
 public:
+    mutex mlock; // Protects this batch state
+    StateManagerArena arena; // Must be declared before the containers that use it
     string oldStateRoot;
     string currentStateRoot;
     uint64_t currentTx;
     vector<TxState> txState;
-    unordered_map<string, vector<Goldilocks::Element>> dbWrite;
+    StateManagerNodeMap dbWrite;
 #ifdef LOG_TIME_STATISTICS_STATE_MANAGER
     TimeMetricStorage timeMetricStorage;
 #endif
-    BatchState() : currentTx(0)
+    BatchState(bool bArena) : arena(bArena), currentTx(0), dbWrite(&arena)
     {
         txState.reserve(32);
         dbWrite.reserve(1024);
@@ -69,18 +136,19 @@ public:
 class StateManager
 {
 private:
-    unordered_map<string, BatchState> state;
+    unordered_map<string, shared_ptr<BatchState>> state;
     Config config;
-    pthread_mutex_t mutex; // Mutex to protect the multi write queues
+    Goldilocks fr;
+    shared_mutex stateMutex; // Protects the batch states map; every batch state is protected by its own mutex
 
 public:
-    StateManager ()
-    {        
-        // Init mutex
-        pthread_mutex_init(&mutex, NULL);
-    };
+    StateManager () {};
 private:
     zkresult setStateRoot (const string &batchUUID, uint64_t tx, const string &stateRoot, bool bIsOldStateRoot, const Persistence persistence);
+    shared_ptr<BatchState> getBatchState (const string &batchUUID);
+    void deleteBatchState (const string &batchUUID);
+    void string2key (const string &key, StateManagerKey &binaryKey);
+    string key2string (const StateManagerKey &binaryKey);
 public:
     void init (const Config &_config)
     {
@@ -94,18 +162,25 @@ public:
     {
         return setStateRoot(batchUUID, tx, stateRoot, false, persistence);
     }
+
+    // Binary key versions, used by the SMT to avoid converting every hash into a string
+    zkresult write (const string &batchUUID, uint64_t tx, const Goldilocks::Element (&key)[4], const Goldilocks::Element *value, uint64_t valueSize, const Persistence persistence);
+    zkresult deleteNode (const string &batchUUID, uint64_t tx, const Goldilocks::Element (&key)[4], const Persistence persistence);
+    zkresult read (const string &batchUUID, const Goldilocks::Element (&key)[4], vector<Goldilocks::Element> &value, DatabaseMap *dbReadLog);
+
+    // String key versions
     zkresult write (const string &batchUUID, uint64_t tx, const string &_key, const vector<Goldilocks::Element> &value, const Persistence persistence);
     zkresult deleteNode (const string &batchUUID, uint64_t tx, const string &_key, const Persistence persistence);
     zkresult read (const string &batchUUID, const string &_key, vector<Goldilocks::Element> &value, DatabaseMap *dbReadLog);
+
     zkresult semiFlush (const string &batchUUID, const string &newStateRoot, const Persistence persistence);
     zkresult flush (const string &batchUUID, const string &newStateRoot, const Persistence persistence, Database &db, uint64_t &flushId, uint64_t &lastSentFlushId);
     void print (bool bDbContent = false);
 
-    // Lock/Unlock
-    void Lock(void) { pthread_mutex_lock(&mutex); };
-    void Unlock(void) { pthread_mutex_unlock(&mutex); };
+    // Gets the arena statistics of a batch; returns ZKR_DB_KEY_NOT_FOUND if the batch does not exist
+    zkresult getArenaStatistics (const string &batchUUID, uint64_t &allocations, uint64_t &allocatedBytes, uint64_t &heapAllocations);
 };
 
 extern StateManager stateManager;
 
-#endif
\ No newline at end of file
+#endif
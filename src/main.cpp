@@ -38,10 +38,16 @@
 #include "unit_test.hpp"
 #include "database_cache_test.hpp"
 #include "database_associative_cache_test.hpp"
+#include "database_file_store_test.hpp"
+#include "state_manager_test.hpp"
+#include "smt_set_batch_test.hpp"
+#include "smt_hash_many_test.hpp"
 #include "main_sm/fork_5/main_exec_c/account.hpp"
 #include "state_manager.hpp"
 #include "state_manager_64.hpp"
 #include "check_tree_test.hpp"
+#include "main_exec_generated_test.hpp"
+#include "context_memory_test.hpp"
 #include "database_performance_test.hpp"
 
 using namespace std;
@@ -578,11 +584,47 @@ int main(int argc, char **argv)
         DatabaseAssociativeCacheTest();
     }
 
+    // Test Database file store
+    if (config.runDatabaseFileStoreTest)
+    {
+        DatabaseFileStoreTest();
+    }
+
+    // Test state manager
+    if (config.runStateManagerTest)
+    {
+        StateManagerTest(config);
+    }
+
+    // Test SMT set batch
+    if (config.runSmtSetBatchTest)
+    {
+        SmtSetBatchTest(config);
+    }
+
+    // Test SMT batched hashing
+    if (config.runSmtHashManyTest)
+    {
+        SmtHashManyTest();
+    }
+
     // Test check tree
     if (config.runCheckTreeTest)
     {
         CheckTreeTest(config);
     }
+
+    // Test the generated main executor against the native one
+    if (config.runMainExecGeneratedTest)
+    {
+        MainExecGeneratedTest(fr, poseidon, config);
+    }
+
+    // Test the main executor context memory
+    if (config.runContextMemoryTest)
+    {
+        ContextMemoryTest(fr, poseidon, config);
+    }
     
     // Test Database performance
     if (config.runDatabasePerformanceTest)
@@ -656,6 +698,13 @@ int main(int argc, char **argv)
                 }
             }
             TimerStopAndLog(DB_CACHE_LOAD);
+
+            // Save the hot set of the cache periodically, so that it can be loaded at start-up
+            if ((config.dbCacheSnapshotFile.size() > 0) && (config.dbCacheSnapshotPeriod > 0))
+            {
+                std::thread snapshotThread (dbCacheSnapshotThread, config);
+                snapshotThread.detach();
+            }
         }
     }
     
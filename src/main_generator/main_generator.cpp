@@ -184,6 +184,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
         if (!bFastMode)
             code += "#include \"goldilocks_precomputed.hpp\"\n";
         code += "#include \"ecrecover.hpp\"\n";
+        code += "#include \"main_sm/" + forkNamespace + "/main_exec_c/batch_prefetch.hpp\"\n";
 
     }
     code += "\n";
@@ -209,8 +210,11 @@ string generate(const json &rom, const string &functionName, const string &fileN
 
         code += "vector<void *> " + functionName + "_labels;\n\n";
 
+        // Compiling the generated code with optimizations takes long; it is enabled with MAIN_EXEC_GENERATED_OPTIMIZE
         code += "#pragma GCC push_options\n";
-        code += "#pragma GCC optimize (\"O0\")\n\n";
+        code += "#ifndef MAIN_EXEC_GENERATED_OPTIMIZE\n";
+        code += "#pragma GCC optimize (\"O0\")\n";
+        code += "#endif\n\n";
     }
 
     if (bFastMode)
@@ -308,6 +312,14 @@ string generate(const json &rom, const string &functionName, const string &fileN
     code += "        }\n";
     code += "    }\n\n";
 
+    code += "    // Read the state of the batch accounts in parallel with the execution\n";
+    code += "    BatchPrefetch batchPrefetch(mainExecutor.fr, mainExecutor.poseidon, proverRequest, *pHashDB);\n";
+    code += "    if (mainExecutor.config.useBatchPrefetch)\n";
+    code += "    {\n";
+    code += "        batchPrefetch.start();\n";
+    code += "        ctx.pBatchPrefetch = &batchPrefetch;\n";
+    code += "    }\n\n";
+
     code += "    // opN are local, uncommitted polynomials\n";
     code += "    Goldilocks::Element op0, op1, op2, op3, op4, op5, op6, op7;\n";
 
@@ -388,7 +400,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
         code += "    MemoryAccess memoryAccess;\n";
 
     code += "    std::ofstream outfile;\n";
-    code += "    std::unordered_map<uint64_t, Fea>::iterator memIterator;\n";
+    code += "    Fea * pMemValue;\n";
     code += "\n";
 
     code += "    uint64_t zkPC = 0; // Zero-knowledge program counter\n";
@@ -432,6 +444,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
     code += "        {\n";
     code += "            proverRequest.result = ZKR_SM_MAIN_INVALID_NO_COUNTERS;;\n";
     code += "            mainExecutor.logError(ctx, \"" + functionName + "()) found proverRequest.bNoCounters=true and bProcessBatch=false\");\n";
+    code += "            batchPrefetch.wait();\n";
     code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
     code += "            return;\n";
     code += "        }\n";
@@ -538,6 +551,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        {\n";
             code += "            proverRequest.result = cr.zkResult;\n";
             code += "            mainExecutor.logError(ctx, string(\"Failed calling evalCommand() before result=\") + zkresult2string(proverRequest.result));\n";
+            code += "            batchPrefetch.wait();\n";
             code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "            return;\n";
             code += "        }\n";
@@ -781,6 +795,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_TOS32;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fr.toS32() with pols.E0[i]=\" + fr.toString(pols.E0[" + string(bFastMode?"0":"i") + "], 16));\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -793,6 +808,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_TOS32;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fr.toS32() with pols.RR[i]=\" + fr.toString(pols.RR[" + string(bFastMode?"0":"i") + "], 16));\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -813,6 +829,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_TOS32;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fr.toS32() with pols.SP[i]=\" + fr.toString(pols.SP[" + string(bFastMode?"0":"i") + "], 16));\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -836,6 +853,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "           proverRequest.result = ZKR_SM_MAIN_ADDRESS_OUT_OF_RANGE;\n";
                     code += "           zkPC=" + to_string(zkPC) +";\n";
                     code += "           mainExecutor.logError(ctx, \"addrRel too big addrRel=\" + to_string(addrRel));\n";
+                    code += "           batchPrefetch.wait();\n";
                     code += "           HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "           return;\n";
                     code += "       }\n";
@@ -847,6 +865,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "           proverRequest.result = ZKR_SM_MAIN_ADDRESS_OUT_OF_RANGE;\n";
                     code += "           zkPC=" + to_string(zkPC) +";\n";
                     code += "           mainExecutor.logError(ctx, \"addrRel too big addrRel=\" + to_string(addrRel));\n";
+                    code += "           batchPrefetch.wait();\n";
                     code += "           HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "           return;\n";
                     code += "       }\n";
@@ -859,6 +878,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "        proverRequest.result = ZKR_SM_MAIN_ADDRESS_OUT_OF_RANGE;\n";
                     code += "        zkPC=" + to_string(zkPC) +";\n";
                     code += "        mainExecutor.logError(ctx, \"addrRel too big addrRel=\" + to_string(addrRel));\n";
+                    code += "        batchPrefetch.wait();\n";
                     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "        return;\n";
                     code += "    }\n";
@@ -870,6 +890,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_ADDRESS_NEGATIVE;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"addrRel<0 addrRel=\" + to_string(addrRel));\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -985,16 +1006,16 @@ string generate(const json &rom, const string &functionName, const string &fileN
                      (!rom["program"][zkPC].contains("mWR") || (rom["program"][zkPC]["mWR"]==0)) )
                 {
                     code += "    // Memory read free in: get fi=mem[addr], if it exists\n";
-                    code += "    memIterator = ctx.mem.find(addr);\n";
-                    code += "    if (memIterator != ctx.mem.end()) {\n";
-                    code += "        fi0 = memIterator->second.fe0;\n";
-                    code += "        fi1 = memIterator->second.fe1;\n";
-                    code += "        fi2 = memIterator->second.fe2;\n";
-                    code += "        fi3 = memIterator->second.fe3;\n";
-                    code += "        fi4 = memIterator->second.fe4;\n";
-                    code += "        fi5 = memIterator->second.fe5;\n";
-                    code += "        fi6 = memIterator->second.fe6;\n";
-                    code += "        fi7 = memIterator->second.fe7;\n";
+                    code += "    pMemValue = ctx.mem.find(addr);\n";
+                    code += "    if (pMemValue != NULL) {\n";
+                    code += "        fi0 = pMemValue->fe0;\n";
+                    code += "        fi1 = pMemValue->fe1;\n";
+                    code += "        fi2 = pMemValue->fe2;\n";
+                    code += "        fi3 = pMemValue->fe3;\n";
+                    code += "        fi4 = pMemValue->fe4;\n";
+                    code += "        fi5 = pMemValue->fe5;\n";
+                    code += "        fi6 = pMemValue->fe6;\n";
+                    code += "        fi7 = pMemValue->fe7;\n";
                     code += "    } else {\n";
                     code += "        fi0 = fr.zero();\n";
                     code += "        fi1 = fr.zero();\n";
@@ -1039,6 +1060,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "        proverRequest.result = ZKR_SM_MAIN_STORAGE_INVALID_KEY;\n";
                     code += "        zkPC=" + to_string(zkPC) +";\n";
                     code += "        mainExecutor.logError(ctx, \"Storage read free in found non-zero A-B storage registers\");\n";
+                    code += "        batchPrefetch.wait();\n";
                     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "        return;\n";
                     code += "    }\n\n";
@@ -1080,6 +1102,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "        proverRequest.result = zkResult;\n";
                     code += "        zkPC=" + to_string(zkPC) +";\n";
                     code += "        mainExecutor.logError(ctx, string(\"Failed calling pHashDB->get() result=\") + zkresult2string(zkResult));\n";
+                    code += "        batchPrefetch.wait();\n";
                     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "        return;\n";
                     code += "    }\n";
@@ -1093,6 +1116,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = zkResult;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, string(\"Failed calling eval_addReadWriteAddress() 1 result=\") + zkresult2string(zkResult));\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n";
@@ -1146,6 +1170,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "        proverRequest.result = ZKR_SM_MAIN_STORAGE_INVALID_KEY;\n";
                     code += "        zkPC=" + to_string(zkPC) +";\n";
                     code += "        mainExecutor.logError(ctx, \"Storage write free in found non-zero A-B registers\");\n";
+                    code += "        batchPrefetch.wait();\n";
                     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "        return;\n";
                     code += "    }\n\n";
@@ -1200,6 +1225,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                     code += "        zkPC=" + to_string(zkPC) +";\n";
                     code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar()\");\n";
+                    code += "        batchPrefetch.wait();\n";
                     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "        return;\n";
                     code += "    }\n";
@@ -1214,6 +1240,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "        proverRequest.result = zkResult;\n";
                     code += "        zkPC=" + to_string(zkPC) +";\n";
                     code += "        mainExecutor.logError(ctx, string(\"Failed calling pHashDB->set() result=\") + zkresult2string(zkResult));\n";
+                    code += "        batchPrefetch.wait();\n";
                     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "        return;\n";
                     code += "    }\n";
@@ -1227,6 +1254,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = zkResult;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, string(\"Failed calling eval_addReadWriteAddress() 2 result=\") + zkresult2string(zkResult));\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n";
@@ -1273,6 +1301,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = ZKR_SM_MAIN_HASHK_SIZE_OUT_OF_RANGE;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, \"Invalid size>32 for hashK 1: pols.D0[" + string(bFastMode?"0":"i") + "]=\" + fr.toString(pols.D0[" + string(bFastMode?"0":"i") + "], 16) + \" size=\" + to_string(size));\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n\n";
@@ -1289,6 +1318,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "        proverRequest.result = ZKR_SM_MAIN_HASHK_POSITION_NEGATIVE;\n";
                     code += "        zkPC=" + to_string(zkPC) +";\n";
                     code += "        mainExecutor.logError(ctx, \"Invalid pos<0 for HashK 1: pols.HASHPOS[" + string(bFastMode?"0":"i") + "]=\" + fr.toString(pols.HASHPOS[" + string(bFastMode?"0":"i") + "], 16) + \" pos=\" + to_string(iPos));\n";
+                    code += "        batchPrefetch.wait();\n";
                     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "        return;\n";
                     code += "    }\n";
@@ -1300,6 +1330,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "        proverRequest.result = ZKR_SM_MAIN_HASHK_POSITION_PLUS_SIZE_OUT_OF_RANGE;\n";
                     code += "        zkPC=" + to_string(zkPC) +";\n";
                     code += "        mainExecutor.logError(ctx, \"HashK 1 invalid size of hash: pos=\" + to_string(pos) + \" + size=\" + to_string(size) + \" > data.size=\" + to_string(hashIterator->second.data.size()));\n";
+                    code += "        batchPrefetch.wait();\n";
                     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "        return;\n";
                     code += "    }\n";
@@ -1331,6 +1362,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "        proverRequest.result = ZKR_SM_MAIN_HASHKDIGEST_ADDRESS_NOT_FOUND;\n";
                     code += "        zkPC=" + to_string(zkPC) +";\n";
                     code += "        mainExecutor.logError(ctx, \"HashKDigest 1: digest not defined for addr=\" + to_string(addr));\n";
+                    code += "        batchPrefetch.wait();\n";
                     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "        return;\n";
                     code += "    }\n";
@@ -1341,6 +1373,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "        proverRequest.result = ZKR_SM_MAIN_HASHKDIGEST_NOT_COMPLETED;\n";
                     code += "        zkPC=" + to_string(zkPC) +";\n";
                     code += "        mainExecutor.logError(ctx, \"HashKDigest 1: digest not calculated for addr=\" + to_string(addr) + \".  Call hashKLen to finish digest.\");\n";
+                    code += "        batchPrefetch.wait();\n";
                     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "        return;\n";
                     code += "    }\n";
@@ -1378,6 +1411,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = ZKR_SM_MAIN_HASHP_SIZE_OUT_OF_RANGE;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, \"Invalid size>32 for hashP 1: pols.D0[" + string(bFastMode?"0":"i") + "]=\" + fr.toString(pols.D0[" + string(bFastMode?"0":"i") + "], 16) + \" size=\" + to_string(size));\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n\n";
@@ -1394,6 +1428,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "        proverRequest.result = ZKR_SM_MAIN_HASHP_POSITION_NEGATIVE;\n";
                     code += "        zkPC=" + to_string(zkPC) +";\n";
                     code += "        mainExecutor.logError(ctx, \"Invalid pos<0 for HashP 1: pols.HASHPOS[" + string(bFastMode?"0":"i") + "]=\" + fr.toString(pols.HASHPOS[" + string(bFastMode?"0":"i") + "], 16) + \" pos=\" + to_string(iPos));\n";
+                    code += "        batchPrefetch.wait();\n";
                     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "        return;\n";
                     code += "    }\n";
@@ -1405,6 +1440,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "        proverRequest.result = ZKR_SM_MAIN_HASHP_POSITION_PLUS_SIZE_OUT_OF_RANGE;\n";
                     code += "        zkPC=" + to_string(zkPC) +";\n";
                     code += "        mainExecutor.logError(ctx, \"HashP 1 invalid size of hash: pos=\" + to_string(pos) + \" size=\" + to_string(size) + \" data.size=\" + to_string(ctx.hashP[addr].data.size()));\n";
+                    code += "        batchPrefetch.wait();\n";
                     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "        return;\n";
                     code += "    }\n";
@@ -1432,6 +1468,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "        proverRequest.result = ZKR_SM_MAIN_HASHPDIGEST_ADDRESS_NOT_FOUND;\n";
                     code += "        zkPC=" + to_string(zkPC) +";\n";
                     code += "        mainExecutor.logError(ctx, \"HashPDigest 1: digest not defined addr=\" + to_string(addr));\n";
+                    code += "        batchPrefetch.wait();\n";
                     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "        return;\n";
                     code += "    }\n";
@@ -1441,6 +1478,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "        proverRequest.result = ZKR_SM_MAIN_HASHPDIGEST_NOT_COMPLETED;\n";
                     code += "        zkPC=" + to_string(zkPC) +";\n";
                     code += "        mainExecutor.logError(ctx, \"HashPDigest 1: digest not calculated.  Call hashPLen to finish digest.\");\n";
+                    code += "        batchPrefetch.wait();\n";
                     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "        return;\n";
                     code += "    }\n";
@@ -1460,6 +1498,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n";
@@ -1468,6 +1507,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n";
@@ -1483,6 +1523,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n";
@@ -1491,6 +1532,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n";
@@ -1506,6 +1548,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n";
@@ -1514,6 +1557,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n";
@@ -1529,6 +1573,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n";
@@ -1537,6 +1582,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n";
@@ -1554,6 +1600,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n";
@@ -1562,6 +1609,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n";
@@ -1577,6 +1625,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n";
@@ -1585,6 +1634,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n";
@@ -1600,6 +1650,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n";
@@ -1608,6 +1659,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n";
@@ -1623,6 +1675,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n";
@@ -1631,6 +1684,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                         code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                         code += "        zkPC=" + to_string(zkPC) +";\n";
                         code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+                        code += "        batchPrefetch.wait();\n";
                         code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                         code += "        return;\n";
                         code += "    }\n";
@@ -1655,6 +1709,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                     code += "        zkPC=" + to_string(zkPC) +";\n";
                     code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+                    code += "        batchPrefetch.wait();\n";
                     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "        return;\n";
                     code += "    }\n";
@@ -1663,6 +1718,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                     code += "        zkPC=" + to_string(zkPC) +";\n";
                     code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+                    code += "        batchPrefetch.wait();\n";
                     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "        return;\n";
                     code += "    }\n";
@@ -1671,6 +1727,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                     code += "        zkPC=" + to_string(zkPC) +";\n";
                     code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.C)\");\n";
+                    code += "        batchPrefetch.wait();\n";
                     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "        return;\n";
                     code += "    }\n";
@@ -1678,6 +1735,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "    {\n";
                     code += "        proverRequest.result = ZKR_SM_MAIN_MEMALIGN_OFFSET_OUT_OF_RANGE;\n";
                     code += "        mainExecutor.logError(ctx, \"MemAlign out of range offset=\" + offsetScalar.get_str());\n";
+                    code += "        batchPrefetch.wait();\n";
                     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "        return;\n";
                     code += "    }\n";
@@ -1778,6 +1836,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "        proverRequest.result = cr.zkResult;\n";
                     code += "        zkPC=" + to_string(zkPC) +";\n";
                     code += "        mainExecutor.logError(ctx, string(\"Main exec failed calling evalCommand() result=\") + zkresult2string(proverRequest.result));\n";
+                    code += "        batchPrefetch.wait();\n";
                     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                     code += "        return;\n";
                     code += "    }\n\n";
@@ -1973,6 +2032,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        mainExecutor.logError(ctx, string(\"ROM assert failed: AN!=opN\") + ";
             code += "\" A:\" + fr.toString(pols.A7[" + string(bFastMode?"0":"i") + "], 16) + \":\" + fr.toString(pols.A6[" + string(bFastMode?"0":"i") + "], 16) + \":\" + fr.toString(pols.A5[" + string(bFastMode?"0":"i") + "], 16) + \":\" + fr.toString(pols.A4[" + string(bFastMode?"0":"i") + "], 16) + \":\" + fr.toString(pols.A3[" + string(bFastMode?"0":"i") + "], 16) + \":\" + fr.toString(pols.A2[" + string(bFastMode?"0":"i") + "], 16) + \":\" + fr.toString(pols.A1[" + string(bFastMode?"0":"i") + "], 16) + \":\" + fr.toString(pols.A0[" + string(bFastMode?"0":"i") + "], 16) + ";
             code += "\" OP:\" + fr.toString(op7, 16) + \":\" + fr.toString(op6, 16) + \":\" + fr.toString(op5, 16) + \":\" + fr.toString(op4,16) + \":\" + fr.toString(op3, 16) + \":\" + fr.toString(op2, 16) + \":\" + fr.toString(op1, 16) + \":\" + fr.toString(op0, 16));\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -1995,23 +2055,15 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 if (!bFastMode)
                     code += "    pols.mWR[i] = fr.one();\n\n";
 
-                code += "    memIterator = ctx.mem.find(addr);\n";
-                code += "    if (memIterator == ctx.mem.end())\n";
-                code += "    {\n";
-                code += "        ctx.mem[addr].fe0 = op0;\n";
-                code += "        memIterator = ctx.mem.find(addr);\n";
-                code += "    }\n";
-                code += "    else\n";
-                code += "    {\n";
-                code += "        memIterator->second.fe0 = op0;\n";
-                code += "    }\n";
-                code += "    memIterator->second.fe1 = op1;\n";
-                code += "    memIterator->second.fe2 = op2;\n";
-                code += "    memIterator->second.fe3 = op3;\n";
-                code += "    memIterator->second.fe4 = op4;\n";
-                code += "    memIterator->second.fe5 = op5;\n";
-                code += "    memIterator->second.fe6 = op6;\n";
-                code += "    memIterator->second.fe7 = op7;\n\n";
+                code += "    pMemValue = &ctx.mem[addr];\n";
+                code += "    pMemValue->fe0 = op0;\n";
+                code += "    pMemValue->fe1 = op1;\n";
+                code += "    pMemValue->fe2 = op2;\n";
+                code += "    pMemValue->fe3 = op3;\n";
+                code += "    pMemValue->fe4 = op4;\n";
+                code += "    pMemValue->fe5 = op5;\n";
+                code += "    pMemValue->fe6 = op6;\n";
+                code += "    pMemValue->fe7 = op7;\n\n";
 
                 if (!bFastMode)
                 {
@@ -2047,21 +2099,22 @@ string generate(const json &rom, const string &functionName, const string &fileN
                     code += "    required.Memory.push_back(memoryAccess);\n\n";
                 }
 
-                code += "    memIterator = ctx.mem.find(addr);\n";
-                code += "    if (memIterator != ctx.mem.end()) \n";
+                code += "    pMemValue = ctx.mem.find(addr);\n";
+                code += "    if (pMemValue != NULL) \n";
                 code += "    {\n";
-                code += "        if ( (!fr.equal(memIterator->second.fe0, op0)) ||\n";
-                code += "             (!fr.equal(memIterator->second.fe1, op1)) ||\n";
-                code += "             (!fr.equal(memIterator->second.fe2, op2)) ||\n";
-                code += "             (!fr.equal(memIterator->second.fe3, op3)) ||\n";
-                code += "             (!fr.equal(memIterator->second.fe4, op4)) ||\n";
-                code += "             (!fr.equal(memIterator->second.fe5, op5)) ||\n";
-                code += "             (!fr.equal(memIterator->second.fe6, op6)) ||\n";
-                code += "             (!fr.equal(memIterator->second.fe7, op7)) )\n";
+                code += "        if ( (!fr.equal(pMemValue->fe0, op0)) ||\n";
+                code += "             (!fr.equal(pMemValue->fe1, op1)) ||\n";
+                code += "             (!fr.equal(pMemValue->fe2, op2)) ||\n";
+                code += "             (!fr.equal(pMemValue->fe3, op3)) ||\n";
+                code += "             (!fr.equal(pMemValue->fe4, op4)) ||\n";
+                code += "             (!fr.equal(pMemValue->fe5, op5)) ||\n";
+                code += "             (!fr.equal(pMemValue->fe6, op6)) ||\n";
+                code += "             (!fr.equal(pMemValue->fe7, op7)) )\n";
                 code += "        {\n";
                 code += "            proverRequest.result = ZKR_SM_MAIN_MEMORY;\n";
                 code += "            zkPC=" + to_string(zkPC) +";\n";
                 code += "            mainExecutor.logError(ctx, \"Memory Read does not match\");\n";
+                code += "            batchPrefetch.wait();\n";
                 code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "            return;\n";
                 code += "        }\n";
@@ -2080,6 +2133,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "            proverRequest.result = ZKR_SM_MAIN_MEMORY;\n";
                 code += "            zkPC=" + to_string(zkPC) +";\n";
                 code += "            mainExecutor.logError(ctx, \"Memory Read does not match (op!=0)\");\n";
+                code += "            batchPrefetch.wait();\n";
                 code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "            return;\n";
                 code += "        }\n";
@@ -2123,6 +2177,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_STORAGE_INVALID_KEY;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"Storage read instruction found non-zero A-B registers\");\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n\n";
@@ -2184,12 +2239,17 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "#ifdef LOG_TIME_STATISTICS_MAIN_EXECUTOR\n";
             code += "    gettimeofday(&t, NULL);\n";
             code += "#endif\n";
+            code += "    if (ctx.pBatchPrefetch != NULL)\n";
+            code += "    {\n";
+            code += "        ctx.pBatchPrefetch->onRead(key);\n";
+            code += "    }\n";
             code += "    zkResult = pHashDB->get(proverRequest.uuid, oldRoot, key, value, &smtGetResult, proverRequest.dbReadLog);\n";
             code += "    if (zkResult != ZKR_SUCCESS)\n";
             code += "    {\n";
             code += "        proverRequest.result = zkResult;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, string(\"Failed calling pHashDB->get() result=\") + zkresult2string(zkResult));\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -2203,6 +2263,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = zkResult;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, string(\"Failed calling eval_addReadWriteAddress() 3 result=\") + zkresult2string(zkResult));\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -2227,6 +2288,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(op)\");\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -2235,6 +2297,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_STORAGE_READ_MISMATCH;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"Storage read does not match: smtGetResult.value=\" + smtGetResult.value.get_str() + \" opScalar=\" + opScalar.get_str());\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -2295,6 +2358,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "            proverRequest.result = ZKR_SM_MAIN_STORAGE_INVALID_KEY;\n";
             code += "            zkPC=" + to_string(zkPC) +";\n";
             code += "            mainExecutor.logError(ctx, \"Storage write instruction found non-zero A-B registers\");\n";
+            code += "            batchPrefetch.wait();\n";
             code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "            return;\n";
             code += "        }\n\n";
@@ -2346,6 +2410,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "            proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
             code += "            zkPC=" + to_string(zkPC) +";\n";
             code += "            mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.D)\");\n";
+            code += "            batchPrefetch.wait();\n";
             code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "            return;\n";
             code += "        }\n";
@@ -2361,6 +2426,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "            proverRequest.result = zkResult;\n";
             code += "            zkPC=" + to_string(zkPC) +";\n";
             code += "            mainExecutor.logError(ctx, string(\"Failed calling pHashDB->set() result=\") + zkresult2string(zkResult));\n";
+            code += "            batchPrefetch.wait();\n";
             code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "            return;\n";
             code += "        }\n";
@@ -2374,6 +2440,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "            proverRequest.result = zkResult;\n";
                 code += "            zkPC=" + to_string(zkPC) +";\n";
                 code += "            mainExecutor.logError(ctx, string(\"Failed calling eval_addReadWriteAddress() 4 result=\") + zkresult2string(zkResult));\n";
+                code += "            batchPrefetch.wait();\n";
                 code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "            return;\n";
                 code += "        }\n";
@@ -2427,6 +2494,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_STORAGE_WRITE_MISMATCH;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"Storage write does not match: ctx.lastSWrite.newRoot: \" + fr.toString(ctx.lastSWrite.newRoot[3], 16) + \":\" + fr.toString(ctx.lastSWrite.newRoot[2], 16) + \":\" + fr.toString(ctx.lastSWrite.newRoot[1], 16) + \":\" + fr.toString(ctx.lastSWrite.newRoot[0], 16) + \" oldRoot: \" + fr.toString(oldRoot[3], 16) + \":\" + fr.toString(oldRoot[2], 16) + \":\" + fr.toString(oldRoot[1], 16) + \":\" + fr.toString(oldRoot[0], 16));\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -2440,6 +2508,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_STORAGE_WRITE_MISMATCH;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"Storage write does not match: ctx.lastSWrite.newRoot=\" + fea2string(fr, ctx.lastSWrite.newRoot) + \" op=\" + fea2string(fr, fea));\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -2489,6 +2558,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_HASHK_SIZE_OUT_OF_RANGE;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Invalid size>32 for hashK 2: pols.D0[" + string(bFastMode?"0":"i") + "]=\" + fr.toString(pols.D0[" + string(bFastMode?"0":"i") + "], 16));\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n\n";
@@ -2505,6 +2575,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_HASHK_POSITION_NEGATIVE;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"Invalid pos<0 for HashK 2: pols.HASHPOS[" + string(bFastMode?"0":"i") + "]=\" + fr.toString(pols.HASHPOS[" + string(bFastMode?"0":"i") + "], 16) + \" pos=\" + to_string(iPos));\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -2516,6 +2587,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(op)\");\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n\n";
@@ -2534,6 +2606,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "            proverRequest.result = ZKR_SM_MAIN_HASHK_POSITION_PLUS_SIZE_OUT_OF_RANGE;\n";
             code += "            zkPC=" + to_string(zkPC) +";\n";
             code += "            mainExecutor.logError(ctx, \"HashK 2: trying to insert data in a position:\" + to_string(pos+j) + \" higher than current data size:\" + to_string(ctx.hashK[addr].data.size()));\n";
+            code += "            batchPrefetch.wait();\n";
             code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "            return;\n";
             code += "        }\n";
@@ -2546,6 +2619,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "                proverRequest.result = ZKR_SM_MAIN_HASHK_VALUE_MISMATCH;\n";
             code += "                zkPC=" + to_string(zkPC) +";\n";
             code += "                mainExecutor.logError(ctx, \"HashK 2 bytes do not match: addr=\" + to_string(addr) + \" pos+j=\" + to_string(pos+j) + \" is bm=\" + to_string(bm) + \" and it should be bh=\" + to_string(bh));\n";
+            code += "                batchPrefetch.wait();\n";
             code += "                HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "                return;\n";
             code += "            }\n";
@@ -2559,6 +2633,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_HASHK_PADDING_MISMATCH;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"HashK 2 incoherent size=\" + to_string(size) + \" a=\" + a.get_str(16) + \" paddingA=\" + paddingA.get_str(16));\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n\n";
@@ -2572,6 +2647,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "            proverRequest.result = ZKR_SM_MAIN_HASHK_SIZE_MISMATCH;\n";
             code += "            zkPC=" + to_string(zkPC) +";\n";
             code += "            mainExecutor.logError(ctx, \"HashK 2 different read sizes in the same position addr=\" + to_string(addr) + \" pos=\" + to_string(pos) + \" ctx.hashK[addr].reads[pos]=\" + to_string(ctx.hashK[addr].reads[pos]) + \" size=\" + to_string(size));\n";
+            code += "            batchPrefetch.wait();\n";
             code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "            return;\n";
             code += "        }\n";
@@ -2613,6 +2689,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "            proverRequest.result = ZKR_SM_MAIN_HASHKLEN_LENGTH_MISMATCH;\n";
             code += "            zkPC=" + to_string(zkPC) +";\n";
             code += "            mainExecutor.logError(ctx, \"HashKLen 2 hashK[addr] is empty but lm is not 0 addr=\" + to_string(addr) + \" lm=\" + to_string(lm));\n";
+            code += "            batchPrefetch.wait();\n";
             code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "            return;\n";
             code += "        }\n\n";
@@ -2628,6 +2705,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_HASHKLEN_CALLED_TWICE;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"HashKLen 2 called more than once addr=\" + to_string(addr));\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -2639,6 +2717,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_HASHKLEN_LENGTH_MISMATCH;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"HashKLen 2 length does not match addr=\" + to_string(addr) + \" is lm=\" + to_string(lm) + \" and it should be lh=\" + to_string(lh));\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -2681,6 +2760,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_HASHKDIGEST_NOT_FOUND;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"HashKDigest 2 could not find entry for addr=\" + to_string(addr));\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -2691,6 +2771,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(op)\");\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -2700,6 +2781,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_HASHKDIGEST_DIGEST_MISMATCH;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"HashKDigest 2: Digest does not match op\");\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -2709,6 +2791,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_HASHKDIGEST_CALLED_TWICE;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"HashKDigest 2 called more than once addr=\" + to_string(addr));\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -2757,6 +2840,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_HASHP_SIZE_OUT_OF_RANGE;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Invalid size>32 for hashP 2: pols.D0[" + string(bFastMode?"0":"i") + "]=\" + fr.toString(pols.D0[" + string(bFastMode?"0":"i") + "], 16) + \" size=\" + to_string(size));\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n\n";
@@ -2773,6 +2857,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_HASHP_POSITION_NEGATIVE;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"Invalid pos<0 for HashP 2: pols.HASHPOS[" + string(bFastMode?"0":"i") + "]=\" + fr.toString(pols.HASHPOS[" + string(bFastMode?"0":"i") + "], 16) + \" pos=\" + to_string(iPos));\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -2784,6 +2869,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(op)\");\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -2801,6 +2887,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "            proverRequest.result = ZKR_SM_MAIN_HASHP_POSITION_PLUS_SIZE_OUT_OF_RANGE;\n";
             code += "            zkPC=" + to_string(zkPC) +";\n";
             code += "            mainExecutor.logError(ctx, \"HashP 2: trying to insert data in a position:\" + to_string(pos+j) + \" higher than current data size:\" + to_string(ctx.hashP[addr].data.size()));\n";
+            code += "            batchPrefetch.wait();\n";
             code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "            return;\n";
             code += "        }\n";
@@ -2813,6 +2900,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "                proverRequest.result = ZKR_SM_MAIN_HASHP_VALUE_MISMATCH;\n";
             code += "                zkPC=" + to_string(zkPC) +";\n";
             code += "                mainExecutor.logError(ctx, \"HashP 2 bytes do not match: addr=\" + to_string(addr) + \" pos+j=\" + to_string(pos+j) + \" is bm=\" + to_string(bm) + \" and it should be bh=\" + to_string(bh));\n";
+            code += "                batchPrefetch.wait();\n";
             code += "                HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "                return;\n";
             code += "            }\n";
@@ -2826,6 +2914,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_HASHP_PADDING_MISMATCH;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"HashP2 incoherent size=\" + to_string(size) + \" a=\" + a.get_str(16) + \" paddingA=\" + paddingA.get_str(16));\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n\n";
@@ -2839,6 +2928,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "            proverRequest.result = ZKR_SM_MAIN_HASHP_SIZE_MISMATCH;\n";
             code += "            zkPC=" + to_string(zkPC) +";\n";
             code += "            mainExecutor.logError(ctx, \"HashP 2 diferent read sizes in the same position addr=\" + to_string(addr) + \" pos=\" + to_string(pos));\n";
+            code += "            batchPrefetch.wait();\n";
             code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "            return;\n";
             code += "        }\n";
@@ -2876,6 +2966,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "            proverRequest.result = ZKR_SM_MAIN_HASHPLEN_LENGTH_MISMATCH;\n";
             code += "            zkPC=" + to_string(zkPC) +";\n";
             code += "            mainExecutor.logError(ctx, \"HashPLen 2 hashP[addr] is empty but lm is not 0 addr=\" + to_string(addr) + \" lm=\" + to_string(lm));\n";
+            code += "            batchPrefetch.wait();\n";
             code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "            return;\n";
             code += "        }\n\n";
@@ -2891,6 +2982,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_HASHPLEN_CALLED_TWICE;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"HashPLen 2 called more than once addr=\" + to_string(addr));\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -2902,6 +2994,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_HASHPLEN_LENGTH_MISMATCH;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"HashPLen 2 does not match match addr=\" + to_string(addr) + \" is lm=\" + to_string(lm) + \" and it should be lh=\" + to_string(lh));\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -2954,6 +3047,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "            proverRequest.result = zkResult;\n";
             code += "            zkPC=" + to_string(zkPC) +";\n";
             code += "            mainExecutor.logError(ctx, string(\"Failed calling pHashDB->setProgram() result=\") + zkresult2string(zkResult));\n";
+            code += "            batchPrefetch.wait();\n";
             code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "            return;\n";
             code += "        }\n";
@@ -2984,6 +3078,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(op)\");\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -3004,6 +3099,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "            proverRequest.result = zkResult;\n";
             code += "            zkPC=" + to_string(zkPC) +";\n";
             code += "            mainExecutor.logError(ctx, string(\"Failed calling pHashDB->getProgram() result=\") + zkresult2string(zkResult));\n";
+            code += "            batchPrefetch.wait();\n";
             code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "            return;\n";
             code += "        }\n";
@@ -3020,6 +3116,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_HASHPDIGEST_CALLED_TWICE;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"HashPDigest 2 called more than once addr=\" + to_string(addr));\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -3033,6 +3130,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_HASHPDIGEST_DIGEST_MISMATCH;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"HashPDigest 2: ctx.hashP[addr].digest=\" + ctx.hashP[addr].digest.get_str(16) + \" does not match op=\" + dg.get_str(16));\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -3048,6 +3146,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(op)\");\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -3078,6 +3177,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3086,6 +3186,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3094,6 +3195,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.C)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3102,6 +3204,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.D)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3110,6 +3213,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(op)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3122,6 +3226,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        left = (A*B) + C;\n";
                 code += "        right = (D<<256) + op;\n";
                 code += "        mainExecutor.logError(ctx, \"Arithmetic does not match: (A*B) + C = \" + left.get_str(16) + \", (D<<256) + op = \" + right.get_str(16));;\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3155,6 +3260,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3163,6 +3269,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3171,6 +3278,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.C)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3179,6 +3287,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.D)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3187,6 +3296,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.E)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3195,6 +3305,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(op)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3238,6 +3349,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = zkResult;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling AddPointEc() in arith operation\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3254,6 +3366,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_ARITH_ECRECOVER_MISMATCH;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, string(\"Arithmetic curve " + string(dbl?"dbl":"add") + " point does not match x1=\") + x1.get_str() + \" y1=\" + y1.get_str() + \" x2=\" + x2.get_str() + \" y2=\" + y2.get_str() + \" x3=\" + x3.get_str() + \" y3=\" + y3.get_str() + \"_x3=\" + _x3.get_str() + \"_y3=\" + _y3.get_str());\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3292,6 +3405,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3300,6 +3414,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3308,6 +3423,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(op)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3318,6 +3434,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_BINARY_ADD_MISMATCH;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Binary ADD operation does not match c=op=\" + c.get_str(16) + \" expectedC=(a + b) & ScalarMask256=\" + expectedC.get_str(16));\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3346,6 +3463,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3354,6 +3472,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3362,6 +3481,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(op)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3372,6 +3492,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_BINARY_SUB_MISMATCH;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Binary SUB operation does not match c=op=\" + c.get_str(16) + \" expectedC=(a - b + ScalarTwoTo256) & ScalarMask256=\" + expectedC.get_str(16));\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3400,6 +3521,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3408,6 +3530,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3416,6 +3539,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(op)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3426,6 +3550,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_BINARY_LT_MISMATCH;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Binary LT operation does not match c=op=\" + c.get_str(16) + \" expectedC=(a < b)=\" + expectedC.get_str(16));\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3454,6 +3579,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3462,6 +3588,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3470,6 +3597,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(op)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3484,6 +3612,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_BINARY_SLT_MISMATCH;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Binary SLT operation does not match a=\" + a.get_str(16) + \" b=\" + b.get_str(16) + \" c=\" + c.get_str(16) + \" _a=\" + _a.get_str(16) + \" _b=\" + _b.get_str(16) + \" expectedC=\" + expectedC.get_str(16));\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3512,6 +3641,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3520,6 +3650,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3528,6 +3659,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(op)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3538,6 +3670,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_BINARY_EQ_MISMATCH;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError( ctx, \"Binary EQ operation does not match c=op=\" + c.get_str(16) + \" expectedC=(a==b)=\" + expectedC.get_str(16));\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3566,6 +3699,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3574,6 +3708,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3582,6 +3717,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(op)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3592,6 +3728,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_BINARY_AND_MISMATCH;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Binary AND operation does not match c=op=\" + c.get_str(16) + \" expectedC=(a&b)=\" + expectedC.get_str(16));\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3621,6 +3758,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3629,6 +3767,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3637,6 +3776,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(op)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3647,6 +3787,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_BINARY_OR_MISMATCH;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Binary OR operation does not match c=op=\" + c.get_str(16) + \" expectedC=(a|b)=\" + expectedC.get_str(16));\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3673,6 +3814,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3681,6 +3823,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3689,6 +3832,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(op)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3699,6 +3843,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_BINARY_XOR_MISMATCH;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Binary XOR operation does not match c=op=\" + c.get_str(16) + \" expectedC=(a^b)=\" + expectedC.get_str(16));\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3739,6 +3884,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.A)\");\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -3747,6 +3893,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.B)\");\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -3755,6 +3902,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(op)\");\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -3763,6 +3911,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.C)\");\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -3771,6 +3920,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_MEMALIGN_OFFSET_OUT_OF_RANGE;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"MemAlign out of range offset=\" + offsetScalar.get_str());\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -3788,6 +3938,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.D)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3796,6 +3947,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.E)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3806,6 +3958,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_MEMALIGN_WRITE_MISMATCH;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"MemAlign w0, w1 invalid: w0=\" + w0.get_str(16) + \" w1=\" + w1.get_str(16) + \" _W0=\" + _W0.get_str(16) + \" _W1=\" + _W1.get_str(16) + \" m0=\" + m0.get_str(16) + \" m1=\" + m1.get_str(16) + \" offset=\" + to_string(offset) + \" v=\" + v.get_str(16));\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3835,6 +3988,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Failed calling fea2scalar(pols.D)\");\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3844,6 +3998,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_MEMALIGN_WRITE8_MISMATCH;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"Error: MemAlign w0 invalid: w0=\" + w0.get_str(16) + \" _W0=\" + _W0.get_str(16) + \" m0=\" + m0.get_str(16) + \" offset=\" + to_string(offset) + \" v=\" + v.get_str(16));\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3875,6 +4030,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
                 code += "        proverRequest.result = ZKR_SM_MAIN_MEMALIGN_READ_MISMATCH;\n";
                 code += "        zkPC=" + to_string(zkPC) +";\n";
                 code += "        mainExecutor.logError(ctx, \"MemAlign v invalid: v=\" + v.get_str(16) + \" _V=\" + _V.get_str(16) + \" m0=\" + m0.get_str(16) + \" m1=\" + m1.get_str(16) + \" offset=\" + to_string(offset));\n";
+                code += "        batchPrefetch.wait();\n";
                 code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
                 code += "        return;\n";
                 code += "    }\n";
@@ -3998,6 +4154,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             if (bFastMode)
             {
             code += "            proverRequest.result = ZKR_SM_MAIN_OOC_ARITH;\n";
+            code += "            batchPrefetch.wait();\n";
             code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "            return;\n";
             }
@@ -4030,6 +4187,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             if (bFastMode)
             {
             code += "            proverRequest.result = ZKR_SM_MAIN_OOC_BINARY;\n";
+            code += "            batchPrefetch.wait();\n";
             code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "            return;\n";
             }
@@ -4062,6 +4220,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             if (bFastMode)
             {
             code += "            proverRequest.result = ZKR_SM_MAIN_OOC_MEM_ALIGN;\n";
+            code += "            batchPrefetch.wait();\n";
             code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "            return;\n";
             }
@@ -4185,6 +4344,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "        proverRequest.result = ZKR_SM_MAIN_S33;\n";
             code += "        zkPC=" + to_string(zkPC) +";\n";
             code += "        mainExecutor.logError(ctx, \"JMPN invalid S33 value op0=\" + to_string(jmpnCondValue));\n";
+            code += "        batchPrefetch.wait();\n";
             code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "        return;\n";
             code += "    }\n";
@@ -4369,6 +4529,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             if (bFastMode)
             {
             code += "            proverRequest.result = ZKR_SM_MAIN_OOC_KECCAK_F;\n";
+            code += "            batchPrefetch.wait();\n";
             code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "            return;\n";
             }
@@ -4398,6 +4559,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             if (bFastMode)
             {
             code += "            proverRequest.result = ZKR_SM_MAIN_OOC_PADDING_PG;\n";
+            code += "            batchPrefetch.wait();\n";
             code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "            return;\n";
             }
@@ -4429,6 +4591,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             if (bFastMode)
             {
             code += "            proverRequest.result = ZKR_SM_MAIN_OOC_POSEIDON_G;\n";
+            code += "            batchPrefetch.wait();\n";
             code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "            return;\n";
             }
@@ -4473,6 +4636,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
             code += "                proverRequest.result = cr.zkResult;\n";
             code += "                zkPC=" + to_string(zkPC) +";\n";
             code += "                mainExecutor.logError(ctx, string(\"Failed calling evalCommand() after result=\") + zkresult2string(proverRequest.result));\n";
+            code += "                batchPrefetch.wait();\n";
             code += "                HashDBClientFactory::freeHashDBClient(pHashDB);\n";
             code += "                return;\n";
             code += "            }\n";
@@ -4703,6 +4867,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
         code += "        {\n";
         code += "            proverRequest.result = ZKR_SM_MAIN_HASHK_READ_OUT_OF_RANGE;\n";
         code += "            mainExecutor.logError(ctx, \"Reading hashK out of limits: i=\" + to_string(i) + \" p=\" + to_string(p) + \" ctx.hashK[i].data.size()=\" + to_string(ctx.hashK[i].data.size()));\n";
+        code += "            batchPrefetch.wait();\n";
         code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
         code += "            return;\n";
         code += "        }\n";
@@ -4734,6 +4899,7 @@ string generate(const json &rom, const string &functionName, const string &fileN
         code += "        {\n";
         code += "            proverRequest.result = ZKR_SM_MAIN_HASHP_READ_OUT_OF_RANGE;\n";
         code += "            mainExecutor.logError(ctx, \"Reading hashP out of limits: i=\" + to_string(i) + \" p=\" + to_string(p) + \" ctx.hashP[i].data.size()=\" + to_string(ctx.hashP[i].data.size()));\n";
+        code += "            batchPrefetch.wait();\n";
         code += "            HashDBClientFactory::freeHashDBClient(pHashDB);\n";
         code += "            return;\n";
         code += "        }\n";
@@ -4743,6 +4909,11 @@ string generate(const json &rom, const string &functionName, const string &fileN
         code += "    }\n";
     }
 
+    code += "    if (ctx.pBatchPrefetch != NULL)\n";
+    code += "    {\n";
+    code += "        ctx.pBatchPrefetch->printStats();\n";
+    code += "    }\n\n";
+
     code += "#ifdef LOG_TIME_STATISTICS_MAIN_EXECUTOR\n";
     code += "    gettimeofday(&t, NULL);\n";
     code += "#endif\n";
@@ -4752,9 +4923,11 @@ string generate(const json &rom, const string &functionName, const string &fileN
     code += "    {\n";
     code += "        proverRequest.result = zkr;\n";
     code += "        mainExecutor.logError(ctx, string(\"Failed calling pHashDB->flush() result=\") + zkresult2string(zkr));\n";
+    code += "        batchPrefetch.wait();\n";
     code += "        HashDBClientFactory::freeHashDBClient(pHashDB);\n";
     code += "        return;\n";
     code += "    }\n";
+    code += "    batchPrefetch.wait();\n";
     code += "    HashDBClientFactory::freeHashDBClient(pHashDB);\n\n";
 
     code += "#ifdef LOG_TIME_STATISTICS_MAIN_EXECUTOR\n";
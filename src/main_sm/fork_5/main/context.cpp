@@ -52,12 +52,12 @@ string Context::printFea(Fea &fea)
 void Context::printMem()
 {
     zklog.info("Memory:");
-    uint64_t i = 0;
-    for (unordered_map<uint64_t, Fea>::iterator it = mem.begin(); it != mem.end(); it++)
+    vector<uint64_t> addresses;
+    mem.getAddresses(addresses);
+    for (uint64_t i = 0; i < addresses.size(); i++)
     {
-        mpz_class addr(it->first);
-        zklog.info("i: " + to_string(i) + " address:" + addr.get_str(16) + " " + printFea(it->second));
-        i++;
+        mpz_class addr(addresses[i]);
+        zklog.info("i: " + to_string(i) + " address:" + addr.get_str(16) + " " + printFea(mem[addresses[i]]));
     }
 }
 
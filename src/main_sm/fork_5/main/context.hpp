@@ -26,6 +26,8 @@ using json = nlohmann::json;
 namespace fork_5
 {
 
+class BatchPrefetch;
+
 class HashValue
 {
 public:
@@ -89,6 +91,107 @@ public:
     Goldilocks::Element fe7;
 };
 
+// zkEVM memory, addressed by absolute address (CTX*0x40000 + offset), stored as per-context segments
+// of pages of Fea slots; pages are allocated at their first write and a bitmap keeps the written slots
+class ContextMemory
+{
+private:
+    static const uint64_t pageBits = 8; // 256 slots per page
+    static const uint64_t pageSize = 1 << pageBits;
+    static const uint64_t segmentBits = 18; // 0x40000 slots per context
+    static const uint64_t pagesPerSegment = 1 << (segmentBits - pageBits);
+
+    class Page
+    {
+    public:
+        Fea slot[pageSize];
+        uint64_t written[pageSize/64];
+    };
+
+    class Segment
+    {
+    public:
+        Page * page[pagesPerSegment];
+    };
+
+    vector<Segment *> segments; // Page table, indexed by context
+    uint64_t nSlots; // Number of written slots
+
+public:
+    ContextMemory() : nSlots(0) {};
+    ~ContextMemory() { clear(); };
+    ContextMemory(const ContextMemory &) = delete;
+    ContextMemory & operator= (const ContextMemory &) = delete;
+
+    // Returns the slot at this address, or NULL if it has never been written
+    inline Fea * find (uint64_t addr)
+    {
+        uint64_t s = addr >> segmentBits;
+        if ((s >= segments.size()) || (segments[s] == NULL)) return NULL;
+        Page * pPage = segments[s]->page[(addr >> pageBits) & (pagesPerSegment - 1)];
+        if (pPage == NULL) return NULL;
+        uint64_t o = addr & (pageSize - 1);
+        if ((pPage->written[o >> 6] & (1ULL << (o & 63))) == 0) return NULL;
+        return &pPage->slot[o];
+    }
+
+    // Returns the slot at this address, creating it with a zero value if it has never been written
+    inline Fea & operator[] (uint64_t addr)
+    {
+        uint64_t s = addr >> segmentBits;
+        if (s >= segments.size()) segments.resize(s + 1, NULL);
+        if (segments[s] == NULL) segments[s] = new Segment(); // Value-initialized, i.e. all pages NULL
+        Page * &pPage = segments[s]->page[(addr >> pageBits) & (pagesPerSegment - 1)];
+        if (pPage == NULL) pPage = new Page(); // Value-initialized, i.e. all slots zero and not written
+        uint64_t o = addr & (pageSize - 1);
+        if ((pPage->written[o >> 6] & (1ULL << (o & 63))) == 0)
+        {
+            pPage->written[o >> 6] |= 1ULL << (o & 63);
+            nSlots++;
+        }
+        return pPage->slot[o];
+    }
+
+    inline uint64_t size (void) const { return nSlots; };
+
+    // Returns the written addresses, in ascending order
+    void getAddresses (vector<uint64_t> &addresses) const
+    {
+        addresses.clear();
+        for (uint64_t s = 0; s < segments.size(); s++)
+        {
+            if (segments[s] == NULL) continue;
+            for (uint64_t p = 0; p < pagesPerSegment; p++)
+            {
+                Page * pPage = segments[s]->page[p];
+                if (pPage == NULL) continue;
+                for (uint64_t o = 0; o < pageSize; o++)
+                {
+                    if (pPage->written[o >> 6] & (1ULL << (o & 63)))
+                    {
+                        addresses.push_back((s << segmentBits) + (p << pageBits) + o);
+                    }
+                }
+            }
+        }
+    }
+
+    void clear (void)
+    {
+        for (uint64_t s = 0; s < segments.size(); s++)
+        {
+            if (segments[s] == NULL) continue;
+            for (uint64_t p = 0; p < pagesPerSegment; p++)
+            {
+                delete segments[s]->page[p];
+            }
+            delete segments[s];
+        }
+        segments.clear();
+        nSlots = 0;
+    }
+};
+
 class OutLog
 {
 public:
@@ -150,6 +253,7 @@ public:
     LastSWrite lastSWrite; // Keep track of the last storage write
     ProverRequest &proverRequest;
     HashDBInterface *pHashDB;
+    BatchPrefetch *pBatchPrefetch; // Batch prefetch, to record the storage reads, or NULL
     uint64_t lastStep;
     mpz_class totalTransferredBalance; // Total transferred balance of all accounts, which should be 0 after any transfer
     EllipticCurveAddition lastECAdd; // Micro-cache of the last couple of added points, and the result
@@ -182,6 +286,7 @@ public:
         lastSWrite(fr),
         proverRequest(proverRequest),
         pHashDB(pHashDB),
+        pBatchPrefetch(NULL),
         lastStep(0),
         lastECAdd(fec),
         ecRecoverPrecalcBuffer(),
@@ -199,8 +304,8 @@ public:
     // Variables database, used in evalCommand() declareVar/setVar/getVar
     unordered_map< string, mpz_class > vars;
     
-    // Memory map, using absolute address as key, and field element array as value
-    unordered_map< uint64_t, Fea > mem; // TODO: Use array<Goldilocks::Element,8> instead of Fea, or declare Fea8, Fea4 at a higher level
+    // Memory, using absolute address as key, and field element array as value
+    ContextMemory mem;
 
     // A vector of maps of accessed Ethereum address to sets of keys
     // Every position of the vector represents a context
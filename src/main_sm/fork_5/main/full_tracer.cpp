@@ -95,10 +95,10 @@ inline zkresult getFromMemory(Context &ctx, mpz_class &offset, mpz_class &length
     if (init != double(initCeil))
     {
         mpz_class memScalarStart = 0;
-        std::unordered_map<uint64_t, Fea>::iterator it = ctx.mem.find(initFloor);
-        if (it != ctx.mem.end())
+        Fea * pValue = ctx.mem.find(initFloor);
+        if (pValue != NULL)
         {
-            if (!fea2scalar(ctx.fr, memScalarStart, it->second.fe0, it->second.fe1, it->second.fe2, it->second.fe3, it->second.fe4, it->second.fe5, it->second.fe6, it->second.fe7))
+            if (!fea2scalar(ctx.fr, memScalarStart, pValue->fe0, pValue->fe1, pValue->fe2, pValue->fe3, pValue->fe4, pValue->fe5, pValue->fe6, pValue->fe7))
             {
                 zklog.error("getFromMemory() failed calling fea2scalar() 1");
                 return ZKR_SM_MAIN_FEA2SCALAR;
@@ -112,9 +112,10 @@ inline zkresult getFromMemory(Context &ctx, mpz_class &offset, mpz_class &length
     for (uint64_t i = initCeil; i < endFloor; i++)
     {
         mpz_class memScalar = 0;
-        if (ctx.mem.find(i) != ctx.mem.end())
+        Fea * pValue = ctx.mem.find(i);
+        if (pValue != NULL)
         {
-            Fea memValue = ctx.mem[i];
+            Fea memValue = *pValue;
             if (!fea2scalar(ctx.fr, memScalar, memValue.fe0, memValue.fe1, memValue.fe2, memValue.fe3, memValue.fe4, memValue.fe5, memValue.fe6, memValue.fe7))
             {
                 zklog.error("getFromMemory() failed calling fea2scalar() 2");
@@ -127,10 +128,10 @@ inline zkresult getFromMemory(Context &ctx, mpz_class &offset, mpz_class &length
     if (end != double(endFloor))
     {
         mpz_class memScalarEnd = 0;
-        std::unordered_map<uint64_t, Fea>::iterator it = ctx.mem.find(endFloor);
-        if (it != ctx.mem.end())
+        Fea * pValue = ctx.mem.find(endFloor);
+        if (pValue != NULL)
         {
-            if (!fea2scalar(ctx.fr, memScalarEnd, it->second.fe0, it->second.fe1, it->second.fe2, it->second.fe3, it->second.fe4, it->second.fe5, it->second.fe6, it->second.fe7))
+            if (!fea2scalar(ctx.fr, memScalarEnd, pValue->fe0, pValue->fe1, pValue->fe2, pValue->fe3, pValue->fe4, pValue->fe5, pValue->fe6, pValue->fe7))
             {
                 zklog.error("getFromMemory() failed calling fea2scalar() 2");
                 return ZKR_SM_MAIN_FEA2SCALAR;
@@ -155,16 +156,15 @@ inline zkresult getVarFromCtx(Context &ctx, bool global, uint64_t varOffset, mpz
 
     uint64_t offsetCtx = global ? 0 : (pContext != NULL) ? *pContext*0x40000 : ctx.fr.toU64(ctx.pols.CTX[*ctx.pStep])*0x40000;
     uint64_t addressMem = offsetCtx + varOffset;
-    unordered_map<uint64_t, Fea>::iterator memIterator;
-    memIterator = ctx.mem.find(addressMem);
-    if (memIterator == ctx.mem.end())
+    Fea * pValue = ctx.mem.find(addressMem);
+    if (pValue == NULL)
     {
         //cout << "FullTracer::getVarFromCtx() could not find in ctx.mem address with offset=" << varOffset << endl;
         result = 0;
     }
     else
     {
-        Fea value = memIterator->second;
+        Fea value = *pValue;
         if (!fea2scalar(ctx.fr, result, value.fe0, value.fe1, value.fe2, value.fe3, value.fe4, value.fe5, value.fe6, value.fe7))
         {
             zklog.error("getVarFromCtx() failed calling fea2scalar()");
@@ -184,16 +184,16 @@ inline zkresult getCalldataFromStack(Context &ctx, uint64_t offset, uint64_t len
     mpz_class auxScalar;
     result = "0x";
     
-    unordered_map<uint64_t, Fea>::iterator memIterator;
+    Fea * pValue;
     uint64_t consumedLength = 0;
     for (uint64_t i = firstAddr; i < lastAddr; i++)
     {
-        memIterator = ctx.mem.find(i);
-        if (memIterator == ctx.mem.end())
+        pValue = ctx.mem.find(i);
+        if (pValue == NULL)
         {
             break;
         }
-        Fea memVal = memIterator->second;
+        Fea memVal = *pValue;
         if (!fea2scalar(ctx.fr, auxScalar, memVal.fe0, memVal.fe1, memVal.fe2, memVal.fe3, memVal.fe4, memVal.fe5, memVal.fe6, memVal.fe7))
         {
             zklog.error("getCalldataFromStack() failed calling fea2scalar()");
@@ -1832,11 +1832,11 @@ zkresult FullTracer::onOpcode(Context &ctx, const RomCommand &cmd)
 
         uint64_t lengthMemOffset = ctx.rom.memLengthOffset;
         uint64_t lenMemValueFinal = 0;
-        unordered_map< uint64_t, Fea >::iterator it;
-        it = ctx.mem.find(offsetCtx + lengthMemOffset);
-        if (it != ctx.mem.end())
+        Fea * pValue;
+        pValue = ctx.mem.find(offsetCtx + lengthMemOffset);
+        if (pValue != NULL)
         {
-            Fea lenMemValue = it->second;
+            Fea lenMemValue = *pValue;
             if (!fea2scalar(ctx.fr, auxScalar, lenMemValue.fe0, lenMemValue.fe1, lenMemValue.fe2, lenMemValue.fe3, lenMemValue.fe4, lenMemValue.fe5, lenMemValue.fe6, lenMemValue.fe7))
             {
                 zklog.error("FullTracer::onOpcode() failed calling fea2scalar(lenMemValue)");
@@ -1847,13 +1847,13 @@ zkresult FullTracer::onOpcode(Context &ctx, const RomCommand &cmd)
 
         for (uint64_t i = 0; i < lenMemValueFinal; i++)
         {
-            it = ctx.mem.find(addrMem + i);
-            if (it == ctx.mem.end())
+            pValue = ctx.mem.find(addrMem + i);
+            if (pValue == NULL)
             {
                 finalMemory += "0000000000000000000000000000000000000000000000000000000000000000";
                 continue;
             }
-            Fea memValue = it->second;
+            Fea memValue = *pValue;
             if (!fea2scalar(ctx.fr, auxScalar, memValue.fe0, memValue.fe1, memValue.fe2, memValue.fe3, memValue.fe4, memValue.fe5, memValue.fe6, memValue.fe7))
             {
                 zklog.error("FullTracer::onOpcode() failed calling fea2scalar(memValue)");
@@ -1903,13 +1903,13 @@ zkresult FullTracer::onOpcode(Context &ctx, const RomCommand &cmd)
         uint64_t addr = offsetCtx + 0x10000;
 
         uint16_t sp = fr.toU64(ctx.pols.SP[*ctx.pStep]);
-        unordered_map<uint64_t, Fea>::iterator it;
+        Fea * pValue;
         for (uint16_t i = 0; i < sp; i++)
         {
-            it = ctx.mem.find(addr + i);
-            if (it == ctx.mem.end())
+            pValue = ctx.mem.find(addr + i);
+            if (pValue == NULL)
                 continue;
-            Fea stack = it->second;
+            Fea stack = *pValue;
             mpz_class stackScalar;
             if (!fea2scalar(ctx.fr, stackScalar, stack.fe0, stack.fe1, stack.fe2, stack.fe3, stack.fe4, stack.fe5, stack.fe6, stack.fe7))
             {
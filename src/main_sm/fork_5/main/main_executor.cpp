@@ -34,6 +34,7 @@
 #include "goldilocks_precomputed.hpp"
 #include "zklog.hpp"
 #include "ecrecover.hpp"
+#include "main_sm/fork_5/main_exec_c/batch_prefetch.hpp"
 
 
 using namespace std;
@@ -167,6 +168,14 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
         }
     }
 
+    // Read the state of the batch accounts in parallel with the execution
+    BatchPrefetch batchPrefetch(fr, poseidon, proverRequest, *pHashDB);
+    if (config.useBatchPrefetch)
+    {
+        batchPrefetch.start();
+        ctx.pBatchPrefetch = &batchPrefetch;
+    }
+
     // opN are local, uncommitted polynomials
     Goldilocks::Element op0, op1, op2, op3, op4, op5, op6, op7;
 
@@ -187,6 +196,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
         {
             proverRequest.result = ZKR_SM_MAIN_INVALID_NO_COUNTERS;
             logError(ctx, "MainExecutor::execute() found proverRequest.bNoCounters=true and bProcessBatch=false");
+            batchPrefetch.wait();
             HashDBClientFactory::freeHashDBClient(pHashDB);
             return;
         }
@@ -289,6 +299,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = cr.zkResult;
                 logError(ctx, string("Failed calling evalCommand() before, result=") + zkresult2string(proverRequest.result));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -633,6 +644,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_TOS32;
                     logError(ctx, "Failed calling fr.toS32() with pols.E0[i]=" + fr.toString(pols.E0[i], 16));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -643,6 +655,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_TOS32;
                     logError(ctx, "Failed calling fr.toS32() with pols.RR[i]=" + fr.toString(pols.RR[i], 16));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -658,6 +671,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_TOS32;
                     logError(ctx, "failed calling fr.toS32(sp, pols.SP[i])=" + fr.toString(pols.SP[i], 16));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -669,6 +683,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_ADDRESS_OUT_OF_RANGE;
                 logError(ctx, "addrRel too big addrRel=" + to_string(addrRel));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -677,6 +692,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_ADDRESS_NEGATIVE;
                 logError(ctx, "addrRel<0 addrRel=" + to_string(addrRel));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -761,20 +777,19 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 // Memory read free in: get fi=mem[addr], if it exists
                 if ( (rom.line[zkPC].mOp==1) && (rom.line[zkPC].mWR==0) )
                 {
-                    std::unordered_map<uint64_t, Fea>::iterator memIterator;
-                    memIterator = ctx.mem.find(addr);
-                    if (memIterator != ctx.mem.end()) {
+                    Fea * pMemValue = ctx.mem.find(addr);
+                    if (pMemValue != NULL) {
 #ifdef LOG_MEMORY
                         zklog.info("Memory read mRD: addr:" + to_string(addr) + " " + fea2string(fr, ctx.mem[addr].fe0, ctx.mem[addr].fe1, ctx.mem[addr].fe2, ctx.mem[addr].fe3, ctx.mem[addr].fe4, ctx.mem[addr].fe5, ctx.mem[addr].fe6, ctx.mem[addr].fe7));
 #endif
-                        fi0 = memIterator->second.fe0;
-                        fi1 = memIterator->second.fe1;
-                        fi2 = memIterator->second.fe2;
-                        fi3 = memIterator->second.fe3;
-                        fi4 = memIterator->second.fe4;
-                        fi5 = memIterator->second.fe5;
-                        fi6 = memIterator->second.fe6;
-                        fi7 = memIterator->second.fe7;
+                        fi0 = pMemValue->fe0;
+                        fi1 = pMemValue->fe1;
+                        fi2 = pMemValue->fe2;
+                        fi3 = pMemValue->fe3;
+                        fi4 = pMemValue->fe4;
+                        fi5 = pMemValue->fe5;
+                        fi6 = pMemValue->fe6;
+                        fi7 = pMemValue->fe7;
 
                     } else {
                         fi0 = fr.zero();
@@ -820,6 +835,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = ZKR_SM_MAIN_STORAGE_INVALID_KEY;
                         logError(ctx, "Storage read free in found non-zero A-B storage registers");
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -866,6 +882,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = zkResult;
                         logError(ctx, string("Failed calling pHashDB->get() result=") + zkresult2string(zkResult));
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -889,6 +906,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = zkResult;
                             logError(ctx, string("Failed calling eval_addReadWriteAddress() 1 result=") + zkresult2string(zkResult));
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -942,6 +960,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = ZKR_SM_MAIN_STORAGE_INVALID_KEY;
                         logError(ctx, "Storage write free in found non-zero A-B registers");
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -996,6 +1015,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                         logError(ctx, "Failed calling fea2scalar()");
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -1010,6 +1030,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = zkResult;
                         logError(ctx, string("Failed calling pHashDB->set() result=") + zkresult2string(zkResult));
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -1032,6 +1053,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = zkResult;
                             logError(ctx, string("Failed calling eval_addReadWriteAddress() 2 result=") + zkresult2string(zkResult));
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -1084,6 +1106,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = ZKR_SM_MAIN_HASHK_SIZE_OUT_OF_RANGE;
                             logError(ctx, "Invalid size>32 for hashK 1: pols.D0[i]=" + fr.toString(pols.D0[i], 16) + " size=" + to_string(size));
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -1096,6 +1119,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = ZKR_SM_MAIN_HASHK_POSITION_NEGATIVE;
                         logError(ctx, "Invalid pos<0 for HashK 1: pols.HASHPOS[i]=" + fr.toString(pols.HASHPOS[i], 16) + " pos=" + to_string(iPos));
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -1106,6 +1130,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = ZKR_SM_MAIN_HASHK_POSITION_PLUS_SIZE_OUT_OF_RANGE;
                         logError(ctx, "HashK 1 invalid size of hash: pos=" + to_string(pos) + " + size=" + to_string(size) + " > data.size=" + to_string(hashKIterator->second.data.size()));
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -1137,6 +1162,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = ZKR_SM_MAIN_HASHKDIGEST_ADDRESS_NOT_FOUND;
                         logError(ctx, "HashKDigest 1: digest not defined for addr=" + to_string(addr));
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -1146,6 +1172,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = ZKR_SM_MAIN_HASHKDIGEST_NOT_COMPLETED;
                         logError(ctx, "HashKDigest 1: digest not calculated for addr=" + to_string(addr) + ".  Call hashKLen to finish digest.");
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -1184,6 +1211,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = ZKR_SM_MAIN_HASHP_SIZE_OUT_OF_RANGE;
                             logError(ctx, "Invalid size>32 for hashP 1: pols.D0[i]=" + fr.toString(pols.D0[i], 16) + " size=" + to_string(size));
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -1196,6 +1224,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = ZKR_SM_MAIN_HASHP_POSITION_NEGATIVE;
                         logError(ctx, "Invalid pos<0 for HashP 1: pols.HASHPOS[i]=" + fr.toString(pols.HASHPOS[i], 16) + " pos=" + to_string(iPos));
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -1206,6 +1235,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = ZKR_SM_MAIN_HASHP_POSITION_PLUS_SIZE_OUT_OF_RANGE;
                         logError(ctx, "HashP 1 invalid size of hash: pos=" + to_string(pos) + " size=" + to_string(size) + " data.size=" + to_string(ctx.hashP[addr].data.size()));
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -1233,6 +1263,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = ZKR_SM_MAIN_HASHPDIGEST_ADDRESS_NOT_FOUND;
                         logError(ctx, "HashPDigest 1: digest not defined addr=" + to_string(addr));
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -1242,6 +1273,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = ZKR_SM_MAIN_HASHPDIGEST_NOT_COMPLETED;
                         logError(ctx, "HashPDigest 1: digest not calculated.  Call hashPLen to finish digest.");
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -1262,6 +1294,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                             logError(ctx, "Failed calling fea2scalar(pols.A)");
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -1269,6 +1302,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                             logError(ctx, "Failed calling fea2scalar(pols.B)");
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -1283,6 +1317,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                             logError(ctx, "Failed calling fea2scalar(pols.A)");
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -1290,6 +1325,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                             logError(ctx, "Failed calling fea2scalar(pols.B)");
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -1304,6 +1340,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                             logError(ctx, "Failed calling fea2scalar(pols.A)");
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -1311,6 +1348,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                             logError(ctx, "Failed calling fea2scalar(pols.B)");
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -1325,6 +1363,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                             logError(ctx, "Failed calling fea2scalar(pols.A)");
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -1332,6 +1371,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                             logError(ctx, "Failed calling fea2scalar(pols.B)");
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -1348,6 +1388,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                             logError(ctx, "Failed calling fea2scalar(pols.A)");
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -1355,6 +1396,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                             logError(ctx, "Failed calling fea2scalar(pols.B)");
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -1369,6 +1411,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                             logError(ctx, "Failed calling fea2scalar(pols.A)");
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -1376,6 +1419,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                             logError(ctx, "Failed calling fea2scalar(pols.B)");
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -1390,6 +1434,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                             logError(ctx, "Failed calling fea2scalar(pols.A)");
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -1397,6 +1442,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                             logError(ctx, "Failed calling fea2scalar(pols.B)");
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -1411,6 +1457,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                             logError(ctx, "Failed calling fea2scalar(pols.A)");
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -1418,6 +1465,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         {
                             proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                             logError(ctx, "Failed calling fea2scalar(pols.B)");
+                            batchPrefetch.wait();
                             HashDBClientFactory::freeHashDBClient(pHashDB);
                             return;
                         }
@@ -1440,6 +1488,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                         logError(ctx, "Failed calling fea2scalar(pols.A)");
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -1448,6 +1497,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                         logError(ctx, "Failed calling fea2scalar(pols.B)");
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -1456,6 +1506,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                         logError(ctx, "Failed calling fea2scalar(pols.C)");
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -1463,6 +1514,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = ZKR_SM_MAIN_MEMALIGN_OFFSET_OUT_OF_RANGE;
                         logError(ctx, "MemAlign out of range offset=" + offsetScalar.get_str());
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -1482,6 +1534,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_MULTIPLE_FREEIN;
                     logError(ctx, "Empty freeIn without just one instruction: nHits=" + to_string(nHits));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -1505,6 +1558,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = cr.zkResult;
                     logError(ctx, string("Main exec failed calling evalCommand() result=") + zkresult2string(proverRequest.result));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -1625,6 +1679,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 logError(ctx, string("ROM assert failed: AN!=opN") +
                 " A:" + fr.toString(pols.A7[i], 16) + ":" + fr.toString(pols.A6[i], 16) + ":" + fr.toString(pols.A5[i], 16) + ":" + fr.toString(pols.A4[i], 16) + ":" + fr.toString(pols.A3[i], 16) + ":" + fr.toString(pols.A2[i], 16) + ":" + fr.toString(pols.A1[i], 16) + ":" + fr.toString(pols.A0[i], 16) +
                 " OP:" + fr.toString(op7, 16) + ":" + fr.toString(op6, 16) + ":" + fr.toString(op5, 16) + ":" + fr.toString(op4,16) + ":" + fr.toString(op3, 16) + ":" + fr.toString(op2, 16) + ":" + fr.toString(op1, 16) + ":" + fr.toString(op0,16));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -1644,14 +1699,15 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 pols.mWR[i] = fr.one();
 
-                ctx.mem[addr].fe0 = op0;
-                ctx.mem[addr].fe1 = op1;
-                ctx.mem[addr].fe2 = op2;
-                ctx.mem[addr].fe3 = op3;
-                ctx.mem[addr].fe4 = op4;
-                ctx.mem[addr].fe5 = op5;
-                ctx.mem[addr].fe6 = op6;
-                ctx.mem[addr].fe7 = op7;
+                Fea &memValue = ctx.mem[addr];
+                memValue.fe0 = op0;
+                memValue.fe1 = op1;
+                memValue.fe2 = op2;
+                memValue.fe3 = op3;
+                memValue.fe4 = op4;
+                memValue.fe5 = op5;
+                memValue.fe6 = op6;
+                memValue.fe7 = op7;
 
                 if (!bProcessBatch)
                 {
@@ -1693,19 +1749,21 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     required.Memory.push_back(memoryAccess);
                 }
 
-                if (ctx.mem.find(addr) != ctx.mem.end())
+                Fea * pMemValue = ctx.mem.find(addr);
+                if (pMemValue != NULL)
                 {
-                    if ( (!fr.equal(ctx.mem[addr].fe0, op0)) ||
-                         (!fr.equal(ctx.mem[addr].fe1, op1)) ||
-                         (!fr.equal(ctx.mem[addr].fe2, op2)) ||
-                         (!fr.equal(ctx.mem[addr].fe3, op3)) ||
-                         (!fr.equal(ctx.mem[addr].fe4, op4)) ||
-                         (!fr.equal(ctx.mem[addr].fe5, op5)) ||
-                         (!fr.equal(ctx.mem[addr].fe6, op6)) ||
-                         (!fr.equal(ctx.mem[addr].fe7, op7)) )
+                    if ( (!fr.equal(pMemValue->fe0, op0)) ||
+                         (!fr.equal(pMemValue->fe1, op1)) ||
+                         (!fr.equal(pMemValue->fe2, op2)) ||
+                         (!fr.equal(pMemValue->fe3, op3)) ||
+                         (!fr.equal(pMemValue->fe4, op4)) ||
+                         (!fr.equal(pMemValue->fe5, op5)) ||
+                         (!fr.equal(pMemValue->fe6, op6)) ||
+                         (!fr.equal(pMemValue->fe7, op7)) )
                     {
                         proverRequest.result = ZKR_SM_MAIN_MEMORY;
                         logError(ctx, "Memory Read does not match");
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -1723,6 +1781,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = ZKR_SM_MAIN_MEMORY;
                         logError(ctx, "Memory Read does not match (op!=0)");
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -1763,6 +1822,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_STORAGE_INVALID_KEY;
                 logError(ctx, "Storage read instruction found non-zero A-B registers");
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -1838,6 +1898,10 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
 #ifdef LOG_TIME_STATISTICS_MAIN_EXECUTOR
             gettimeofday(&t, NULL);
 #endif
+            if (ctx.pBatchPrefetch != NULL)
+            {
+                ctx.pBatchPrefetch->onRead(key);
+            }
             SmtGetResult smtGetResult;
             mpz_class value;
             zkresult zkResult = pHashDB->get(proverRequest.uuid, oldRoot, key, value, &smtGetResult, proverRequest.dbReadLog);
@@ -1845,6 +1909,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = zkResult;
                 logError(ctx, string("Failed calling pHashDB->get() result=") + zkresult2string(zkResult));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -1858,6 +1923,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = zkResult;
                     logError(ctx, string("Failed calling eval_addReadWriteAddress() 3 result=") + zkresult2string(zkResult));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -1882,6 +1948,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                 logError(ctx, "Failed calling fea2scalar(op)");
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -1889,6 +1956,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_STORAGE_READ_MISMATCH;
                 logError(ctx, "Storage read does not match: smtGetResult.value=" + smtGetResult.value.get_str() + " opScalar=" + opScalar.get_str());
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -1942,6 +2010,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_STORAGE_INVALID_KEY;
                     logError(ctx, "Storage write instruction found non-zero A-B registers");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -1991,6 +2060,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.D)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2005,6 +2075,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = zkResult;
                     logError(ctx, string("Failed calling pHashDB->set() result=") + zkresult2string(zkResult));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2018,6 +2089,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = zkResult;
                         logError(ctx, string("Failed calling eval_addReadWriteAddress() 4 result=") + zkresult2string(zkResult));
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -2087,6 +2159,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 proverRequest.result = ZKR_SM_MAIN_STORAGE_WRITE_MISMATCH;
                 logError(ctx, "Storage write does not match: ctx.lastSWrite.newRoot: " + fr.toString(ctx.lastSWrite.newRoot[3], 16) + ":" + fr.toString(ctx.lastSWrite.newRoot[2], 16) + ":" + fr.toString(ctx.lastSWrite.newRoot[1], 16) + ":" + fr.toString(ctx.lastSWrite.newRoot[0], 16) +
                     " oldRoot: " + fr.toString(oldRoot[3], 16) + ":" + fr.toString(oldRoot[2], 16) + ":" + fr.toString(oldRoot[1], 16) + ":" + fr.toString(oldRoot[0], 16));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2100,6 +2173,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_STORAGE_WRITE_MISMATCH;
                 logError(ctx, "Storage write does not match: ctx.lastSWrite.newRoot=" + fea2string(fr, ctx.lastSWrite.newRoot) + " op=" + fea2string(fr, fea));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2147,6 +2221,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_HASHK_SIZE_OUT_OF_RANGE;
                     logError(ctx, "Invalid size>32 for hashK 2: pols.D0[i]=" + fr.toString(pols.D0[i], 16));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2159,6 +2234,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_HASHK_POSITION_NEGATIVE;
                 logError(ctx, string("Invalid pos<0 for HashK 2: pols.HASHPOS[i]=") + fr.toString(pols.HASHPOS[i], 16) + " pos=" + to_string(iPos));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2170,6 +2246,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                 logError(ctx, "Failed calling fea2scalar(op)");
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2188,6 +2265,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_HASHK_POSITION_PLUS_SIZE_OUT_OF_RANGE;
                     logError(ctx, "HashK 2: trying to insert data in a position:" + to_string(pos+j) + " higher than current data size:" + to_string(ctx.hashK[addr].data.size()));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2199,6 +2277,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = ZKR_SM_MAIN_HASHK_VALUE_MISMATCH;
                         logError(ctx, "HashK 2 bytes do not match: addr=" + to_string(addr) + " pos+j=" + to_string(pos+j) + " is bm=" + to_string(bm) + " and it should be bh=" + to_string(bh));
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -2211,6 +2290,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_HASHK_PADDING_MISMATCH;
                 logError(ctx, "HashK 2 incoherent size=" + to_string(size) + " a=" + a.get_str(16) + " paddingA=" + paddingA.get_str(16));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2224,6 +2304,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_HASHK_SIZE_MISMATCH;
                     logError(ctx, "HashK 2 different read sizes in the same position addr=" + to_string(addr) + " pos=" + to_string(pos) + " ctx.hashK[addr].reads[pos]=" + to_string(ctx.hashK[addr].reads[pos]) + " size=" + to_string(size));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2262,6 +2343,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_HASHKLEN_LENGTH_MISMATCH;
                     logError(ctx, "HashKLen 2 hashK[addr] is empty but lm is not 0 addr=" + to_string(addr) + " lm=" + to_string(lm));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2277,6 +2359,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_HASHKLEN_CALLED_TWICE;
                 logError(ctx, "HashKLen 2 called more than once addr=" + to_string(addr));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2287,6 +2370,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_HASHKLEN_LENGTH_MISMATCH;
                 logError(ctx, "HashKLen 2 length does not match addr=" + to_string(addr) + " is lm=" + to_string(lm) + " and it should be lh=" + to_string(lh));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2327,6 +2411,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_HASHKDIGEST_NOT_FOUND;
                 logError(ctx, "HashKDigest 2 could not find entry for addr=" + to_string(addr));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2337,6 +2422,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                 logError(ctx, "Failed calling fea2scalar(op)");
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2345,6 +2431,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_HASHKDIGEST_DIGEST_MISMATCH;
                 logError(ctx, "HashKDigest 2: Digest does not match op");
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2353,6 +2440,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_HASHKDIGEST_CALLED_TWICE;
                 logError(ctx, "HashKDigest 2 called more than once addr=" + to_string(addr));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2401,6 +2489,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_HASHP_SIZE_OUT_OF_RANGE;
                     logError(ctx, "Invalid size>32 for hashP 2: pols.D0[i]=" + fr.toString(pols.D0[i], 16) + " size=" + to_string(size));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2413,6 +2502,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_HASHP_POSITION_NEGATIVE;
                 logError(ctx, "Invalid pos<0 for HashP 2: pols.HASHPOS[i]=" + fr.toString(pols.HASHPOS[i], 16) + " pos=" + to_string(iPos));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2424,6 +2514,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                 logError(ctx, "Failed calling fea2scalar(op)");
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2441,6 +2532,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_HASHP_POSITION_PLUS_SIZE_OUT_OF_RANGE;
                     logError(ctx, "HashP 2: trying to insert data in a position:" + to_string(pos+j) + " higher than current data size:" + to_string(ctx.hashP[addr].data.size()));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2452,6 +2544,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     {
                         proverRequest.result = ZKR_SM_MAIN_HASHP_VALUE_MISMATCH;
                         logError(ctx, "HashP 2 bytes do not match: addr=" + to_string(addr) + " pos+j=" + to_string(pos+j) + " is bm=" + to_string(bm) + " and it should be bh=" + to_string(bh));
+                        batchPrefetch.wait();
                         HashDBClientFactory::freeHashDBClient(pHashDB);
                         return;
                     }
@@ -2464,6 +2557,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_HASHP_PADDING_MISMATCH;
                 logError(ctx, "HashP2 incoherent size=" + to_string(size) + " a=" + a.get_str(16) + " paddingA=" + paddingA.get_str(16));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2477,6 +2571,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_HASHP_SIZE_MISMATCH;
                     logError(ctx, "HashP 2 diferent read sizes in the same position addr=" + to_string(addr) + " pos=" + to_string(pos));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2511,6 +2606,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_HASHPLEN_LENGTH_MISMATCH;
                     logError(ctx, "HashPLen 2 hashP[addr] is empty but lm is not 0 addr=" + to_string(addr) + " lm=" + to_string(lm));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2526,6 +2622,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_HASHPLEN_CALLED_TWICE;
                 logError(ctx, "HashPLen 2 called more than once addr=" + to_string(addr));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2536,6 +2633,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_HASHPLEN_LENGTH_MISMATCH;
                 logError(ctx, "HashPLen 2 does not match match addr=" + to_string(addr) + " is lm=" + to_string(lm) + " and it should be lh=" + to_string(lh));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2589,6 +2687,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = zkResult;
                     logError(ctx, string("Failed calling pHashDB->setProgram() result=") + zkresult2string(zkResult));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2618,6 +2717,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                 logError(ctx, "Failed calling fea2scalar(op)");
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2638,6 +2738,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = zkResult;
                     logError(ctx, string("Failed calling pHashDB->getProgram() result=") + zkresult2string(zkResult));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2654,6 +2755,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_HASHPDIGEST_CALLED_TWICE;
                 logError(ctx, "HashPDigest 2 called more than once addr=" + to_string(addr));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2666,6 +2768,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_HASHPDIGEST_DIGEST_MISMATCH;
                 logError(ctx, "HashPDigest 2: ctx.hashP[addr].digest=" + ctx.hashP[addr].digest.get_str(16) + " does not match op=" + dg.get_str(16));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2679,6 +2782,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                 logError(ctx, "Failed calling fea2scalar(op)");
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -2705,6 +2809,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.A)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2712,6 +2817,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.B)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2719,6 +2825,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.C)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2726,6 +2833,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.D)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2733,6 +2841,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(op)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2744,6 +2853,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                     mpz_class left = (A*B) + C;
                     mpz_class right = (D<<256) + op;
                     logError(ctx, "Arithmetic does not match: (A*B) + C = " + left.get_str(16) + ", (D<<256) + op = " + right.get_str(16));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2777,6 +2887,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.A)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2784,6 +2895,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.B)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2791,6 +2903,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.C)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2798,6 +2911,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.D)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2805,6 +2919,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.E)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2812,6 +2927,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(op)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2846,6 +2962,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = r;
                     logError(ctx, "Failed calling AddPointEc() in arith operation");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2871,6 +2988,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                         " y3=" + y3.get_str() +
                         "_x3=" + _x3.get_str() +
                         "_y3=" + _y3.get_str());
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2909,6 +3027,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.A)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2916,6 +3035,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.B)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2923,6 +3043,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(op)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2933,6 +3054,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_BINARY_ADD_MISMATCH;
                     logError(ctx, "Binary ADD operation does not match c=op=" + c.get_str(16) + " expectedC=(a + b) & ScalarMask256=" + expectedC.get_str(16));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2960,6 +3082,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.A)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2967,6 +3090,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.B)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2974,6 +3098,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(op)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -2984,6 +3109,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_BINARY_SUB_MISMATCH;
                     logError(ctx, "Binary SUB operation does not match c=op=" + c.get_str(16) + " expectedC=(a - b + ScalarTwoTo256) & ScalarMask256=" + expectedC.get_str(16));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3011,6 +3137,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.A)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3018,6 +3145,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.B)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3025,6 +3153,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(op)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3035,6 +3164,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_BINARY_LT_MISMATCH;
                     logError(ctx, "Binary LY operation does not match c=op=" + c.get_str(16) + " expectedC=(a < b)=" + expectedC.get_str(16));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3062,6 +3192,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.A)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3069,6 +3200,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.B)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3076,6 +3208,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(op)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3092,6 +3225,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_BINARY_SLT_MISMATCH;
                     logError(ctx, "Binary SLT operation does not match a=" + a.get_str(16) + " b=" + b.get_str(16) + " c=" + c.get_str(16) + " _a=" + _a.get_str(16) + " _b=" + _b.get_str(16) + " expectedC=" + expectedC.get_str(16));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3119,6 +3253,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.A)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3126,6 +3261,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.B)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3133,6 +3269,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(op)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3143,6 +3280,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_BINARY_EQ_MISMATCH;
                     logError( ctx, "Binary EQ operation does not match c=op=" + c.get_str(16) + " expectedC=(a==b)=" + expectedC.get_str(16));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3170,6 +3308,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.A)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3177,6 +3316,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.B)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3184,6 +3324,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(op)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3194,6 +3335,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_BINARY_AND_MISMATCH;
                     logError(ctx, "Binary AND operation does not match c=op=" + c.get_str(16) + " expectedC=(a&b)=" + expectedC.get_str(16));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3224,6 +3366,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.A)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3231,6 +3374,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.B)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3238,6 +3382,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(op)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3248,6 +3393,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_BINARY_OR_MISMATCH;
                     logError(ctx, "Binary OR operation does not match c=op=" + c.get_str(16) + " expectedC=(a|b)=" + expectedC.get_str(16));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3273,6 +3419,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.A)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3280,6 +3427,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.B)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3287,6 +3435,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(op)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3297,6 +3446,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_BINARY_XOR_MISMATCH;
                     logError(ctx, "Binary XOR operation does not match c=op=" + c.get_str(16) + " expectedC=(a^b)=" + expectedC.get_str(16));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3331,6 +3481,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                 logError(ctx, "Failed calling fea2scalar(pols.A)");
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -3339,6 +3490,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                 logError(ctx, "Failed calling fea2scalar(pols.B)");
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -3347,6 +3499,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                 logError(ctx, "Failed calling fea2scalar(op)");
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -3355,6 +3508,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                 logError(ctx, "Failed calling fea2scalar(pols.C)");
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -3362,6 +3516,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_MEMALIGN_OFFSET_OUT_OF_RANGE;
                 logError(ctx, "MemAlign out of range offset=" + offsetScalar.get_str());
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -3376,6 +3531,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.D)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3384,6 +3540,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.E)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3395,6 +3552,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_MEMALIGN_WRITE_MISMATCH;
                     logError(ctx, "MemAlign w0, w1 invalid: w0=" + w0.get_str(16) + " w1=" + w1.get_str(16) + " _W0=" + _W0.get_str(16) + " _W1=" + _W1.get_str(16) + " m0=" + m0.get_str(16) + " m1=" + m1.get_str(16) + " offset=" + to_string(offset) + " v=" + v.get_str(16));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3422,6 +3580,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_FEA2SCALAR;
                     logError(ctx, "Failed calling fea2scalar(pols.D)");
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3432,6 +3591,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_MEMALIGN_WRITE8_MISMATCH;
                     logError(ctx, "MemAlign w0 invalid: w0=" + w0.get_str(16) + " _W0=" + _W0.get_str(16) + " m0=" + m0.get_str(16) + " offset=" + to_string(offset) + " v=" + v.get_str(16));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3464,6 +3624,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = ZKR_SM_MAIN_MEMALIGN_READ_MISMATCH;
                     logError(ctx, "MemAlign v invalid: v=" + v.get_str(16) + " _V=" + _V.get_str(16) + " m0=" + m0.get_str(16) + " m1=" + m1.get_str(16) + " offset=" + to_string(offset));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3713,6 +3874,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 if (bProcessBatch)
                 {
                     proverRequest.result = ZKR_SM_MAIN_OOC_ARITH;
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3733,6 +3895,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 if (bProcessBatch)
                 {
                     proverRequest.result = ZKR_SM_MAIN_OOC_BINARY;
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3753,6 +3916,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 if (bProcessBatch)
                 {
                     proverRequest.result = ZKR_SM_MAIN_OOC_MEM_ALIGN;
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -3865,6 +4029,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_S33;
                 logError(ctx, "JMPN invalid S33 value op0=" + to_string(jmpnCondValue));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -4020,6 +4185,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 if (bProcessBatch)
                 {
                     proverRequest.result = ZKR_SM_MAIN_OOC_KECCAK_F;
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -4042,6 +4208,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 if (bProcessBatch)
                 {
                     proverRequest.result = ZKR_SM_MAIN_OOC_PADDING_PG;
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -4064,6 +4231,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 if (bProcessBatch)
                 {
                     proverRequest.result = ZKR_SM_MAIN_OOC_POSEIDON_G;
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -4098,6 +4266,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
                 {
                     proverRequest.result = cr.zkResult;
                     logError(ctx, string("Failed calling evalCommand() after result=") + zkresult2string(proverRequest.result));
+                    batchPrefetch.wait();
                     HashDBClientFactory::freeHashDBClient(pHashDB);
                     return;
                 }
@@ -4271,6 +4440,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_HASHK_READ_OUT_OF_RANGE;
                 logError(ctx, "Reading hashK out of limits: i=" + to_string(i) + " p=" + to_string(p) + " ctx.hashK[i].data.size()=" + to_string(ctx.hashK[i].data.size()));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -4302,6 +4472,7 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
             {
                 proverRequest.result = ZKR_SM_MAIN_HASHP_READ_OUT_OF_RANGE;
                 logError(ctx, "Reading hashP out of limits: i=" + to_string(i) + " p=" + to_string(p) + " ctx.hashP[i].data.size()=" + to_string(ctx.hashP[i].data.size()));
+                batchPrefetch.wait();
                 HashDBClientFactory::freeHashDBClient(pHashDB);
                 return;
             }
@@ -4311,6 +4482,11 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
         }
     }
 
+    if (ctx.pBatchPrefetch != NULL)
+    {
+        ctx.pBatchPrefetch->printStats();
+    }
+
 #ifdef LOG_TIME_STATISTICS_MAIN_EXECUTOR
     gettimeofday(&t, NULL);
 #endif
@@ -4320,9 +4496,11 @@ void MainExecutor::execute (ProverRequest &proverRequest, MainCommitPols &pols,
     {
         proverRequest.result = zkr;
         logError(ctx, string("Failed calling pHashDB->flush() result=") + zkresult2string(zkr));
+        batchPrefetch.wait();
         HashDBClientFactory::freeHashDBClient(pHashDB);
         return;
     }
+    batchPrefetch.wait();
     HashDBClientFactory::freeHashDBClient(pHashDB);
         
 #ifdef LOG_TIME_STATISTICS_MAIN_EXECUTOR
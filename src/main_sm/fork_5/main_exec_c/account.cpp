@@ -11,13 +11,6 @@ namespace fork_5
 #define BATCH_DIFFICULTY 0
 #define STATE_ROOT_STORAGE_POS 1
 
-// SMT STATE-TREE CONSTANT KEYS
-#define SMT_KEY_BALANCE 0
-#define SMT_KEY_NONCE 1
-#define SMT_KEY_SC_CODE 2
-#define SMT_KEY_SC_STORAGE 3
-#define SMT_KEY_SC_LENGTH 4
-
 // TODO: init from main
 bool Account::bZeroKeyGenerated = false;
 Goldilocks::Element Account::zeroKey[4];
@@ -70,22 +63,7 @@ void Account::GenerateZeroKey (Goldilocks &fr, PoseidonGoldilocks &poseidon)
 
 void Account::GenerateBalanceKey (void)
 {
-    Goldilocks::Element Kin1[12];
-
-    scalar2fea(fr, publicKey, Kin1[0], Kin1[1], Kin1[2], Kin1[3], Kin1[4], Kin1[5], Kin1[6], Kin1[7]); // TODO: Reuse this result
-    if (!fr.isZero(Kin1[5]) || !fr.isZero(Kin1[6]) || !fr.isZero(Kin1[7]))
-    {
-        zklog.error("Accoung::GetBalanceKey() found non-zero field elements 5, 6 or 7");
-        exitProcess();
-    }
-
-    Kin1[8] = zeroKey[0];
-    Kin1[9] = zeroKey[1];
-    Kin1[10] = zeroKey[2];
-    Kin1[11] = zeroKey[3];
-
-    // Call poseidon and get the hash key
-    poseidon.hash(balanceKey, Kin1);
+    GenerateLeafKey(SMT_KEY_BALANCE, balanceKey);
 
 #ifdef LOG_ACCOUNT
     zklog.info("Account::GenerateBalanceKey() balanceKey=" + fea2string(fr, balanceKey));
@@ -94,24 +72,7 @@ void Account::GenerateBalanceKey (void)
 
 void Account::GenerateNonceKey (void)
 {
-    Goldilocks::Element Kin1[12];
-
-    scalar2fea(fr, publicKey, Kin1[0], Kin1[1], Kin1[2], Kin1[3], Kin1[4], Kin1[5], Kin1[6], Kin1[7]);
-    if (!fr.isZero(Kin1[5]) || !fr.isZero(Kin1[6]) || !fr.isZero(Kin1[7]))
-    {
-        zklog.error("Accoung::GetNonceKey() found non-zero field elements 5, 6 or 7");
-        exitProcess();
-    }
-
-    Kin1[6] = fr.one();
-
-    Kin1[8] = zeroKey[0];
-    Kin1[9] = zeroKey[1];
-    Kin1[10] = zeroKey[2];
-    Kin1[11] = zeroKey[3];
-
-    // Call poseidon and get the hash key
-    poseidon.hash(nonceKey, Kin1);
+    GenerateLeafKey(SMT_KEY_NONCE, nonceKey);
 
 #ifdef LOG_ACCOUNT
     zklog.info("Account::GetNonceKey() nonceKey=" + fea2string(fr, nonceKey));
@@ -211,24 +172,8 @@ void Account::GenerateLocalExitRootKey (void)
 
 void Account::GenerateTxCountKey (void)
 {
-    Goldilocks::Element Kin1[12];
-
-    scalar2fea(fr, publicKey, Kin1[0], Kin1[1], Kin1[2], Kin1[3], Kin1[4], Kin1[5], Kin1[6], Kin1[7]);
-    if (!fr.isZero(Kin1[5]) || !fr.isZero(Kin1[6]) || !fr.isZero(Kin1[7]))
-    {
-        zklog.error("Accoung::GenerateBatchNumberKey() found non-zero field elements 5, 6 or 7");
-        exitProcess();
-    }
-
-    Kin1[6] = fr.fromU64(SMT_KEY_SC_STORAGE);
-
-    Kin1[8] = zeroKey[0];
-    Kin1[9] = zeroKey[1];
-    Kin1[10] = zeroKey[2];
-    Kin1[11] = zeroKey[3];
-
-    // Call poseidon and get the hash key
-    poseidon.hash(txCountKey, Kin1);
+    // The TX count is stored at storage position 0, whose key hash is the zero key
+    GenerateLeafKey(SMT_KEY_SC_STORAGE, txCountKey);
 
 #ifdef LOG_ACCOUNT
     zklog.info("Accoung::GenerateBatchNumberKey() txCountKey=" + fea2string(fr, txCountKey));
@@ -289,6 +234,32 @@ void Account::GenerateStateRootKey (const mpz_class &batchNumber, Goldilocks::El
 #endif
 }
 
+void Account::GenerateLeafKey (uint64_t leafType, Goldilocks::Element (&key)[4])
+{
+    Goldilocks::Element Kin1[12];
+
+    scalar2fea(fr, publicKey, Kin1[0], Kin1[1], Kin1[2], Kin1[3], Kin1[4], Kin1[5], Kin1[6], Kin1[7]);
+    if (!fr.isZero(Kin1[5]) || !fr.isZero(Kin1[6]) || !fr.isZero(Kin1[7]))
+    {
+        zklog.error("Account::GenerateLeafKey() found non-zero field elements 5, 6 or 7");
+        exitProcess();
+    }
+
+    Kin1[6] = fr.fromU64(leafType);
+
+    Kin1[8] = zeroKey[0];
+    Kin1[9] = zeroKey[1];
+    Kin1[10] = zeroKey[2];
+    Kin1[11] = zeroKey[3];
+
+    // Call poseidon and get the hash key
+    poseidon.hash(key, Kin1);
+
+#ifdef LOG_ACCOUNT
+    zklog.info("Account::GenerateLeafKey() leafType=" + to_string(leafType) + " key=" + fea2string(fr, key));
+#endif
+}
+
 zkresult Account::GetBalance (const string &batchUUID, const Goldilocks::Element (&root)[4], mpz_class &balance)
 {
     // Check that balance key has been generated
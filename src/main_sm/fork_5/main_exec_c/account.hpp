@@ -17,6 +17,13 @@ namespace fork_5
 #define ADDRESS_GLOBAL_EXIT_ROOT_MANAGER_L2 "0xa40D5f56745a118D0906a34E69aeC8C0Db1cB8fA"
 #define ADDRESS_SYSTEM "0x000000000000000000000000000000005ca1ab1e"
 
+// SMT STATE-TREE CONSTANT KEYS
+#define SMT_KEY_BALANCE 0
+#define SMT_KEY_NONCE 1
+#define SMT_KEY_SC_CODE 2
+#define SMT_KEY_SC_STORAGE 3
+#define SMT_KEY_SC_LENGTH 4
+
 class Account
 {
 private:
@@ -118,6 +125,10 @@ private:
    
 public:
 
+    // Generate the key of an account leaf that does not depend on a storage position, e.g. SMT_KEY_BALANCE,
+    // or of the storage position 0 when leafType is SMT_KEY_SC_STORAGE
+    void GenerateLeafKey (uint64_t leafType, Goldilocks::Element (&key)[4]);
+
     // Get account balance value
     zkresult GetBalance (const string &batchUUID, const Goldilocks::Element (&root)[4], mpz_class &balance);
 
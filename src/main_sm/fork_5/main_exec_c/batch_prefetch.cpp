@@ -0,0 +1,161 @@
+#include <sys/time.h>
+#include "main_sm/fork_5/main_exec_c/batch_prefetch.hpp"
+#include "main_sm/fork_5/main_exec_c/account.hpp"
+#include "ecrecover.hpp"
+#include "scalar.hpp"
+#include "timer.hpp"
+#include "zklog.hpp"
+#include "zkassert.hpp"
+
+namespace fork_5
+{
+
+void * batchPrefetchThread (void * arg)
+{
+    BatchPrefetch * pBatchPrefetch = (BatchPrefetch *)arg;
+    pBatchPrefetch->prefetch();
+    return NULL;
+}
+
+void BatchPrefetch::start (void)
+{
+    zkassert(!bStarted);
+    int iResult = pthread_create(&thread, NULL, batchPrefetchThread, this);
+    if (iResult != 0)
+    {
+        // The prefetch is an optimization, so the execution can go on without it
+        zklog.warning("BatchPrefetch::start() failed calling pthread_create() result=" + to_string(iResult));
+        return;
+    }
+    bStarted = true;
+}
+
+void BatchPrefetch::start (const BatchData &batch)
+{
+    // Collect the addresses here, so that the thread does not access the batch while the executor uses it
+    collectAddresses(batch);
+    bAddressesCollected = true;
+    start();
+}
+
+void BatchPrefetch::wait (void)
+{
+    if (bStarted)
+    {
+        pthread_join(thread, NULL);
+        bStarted = false;
+    }
+}
+
+void BatchPrefetch::prefetch (void)
+{
+    struct timeval t;
+    gettimeofday(&t, NULL);
+
+    PublicInputs &publicInputs = proverRequest.input.publicInputsExtended.publicInputs;
+    zkresult zkr;
+
+    if (!bAddressesCollected)
+    {
+        // Decode batch L2 data; if it fails, the executor will report it
+        BatchData batch;
+        zkr = BatchDecode(publicInputs.batchL2Data, batch);
+        if (zkr != ZKR_SUCCESS)
+        {
+            return;
+        }
+
+        // Recover the senders of all transactions, in parallel
+#pragma omp parallel for num_threads(BATCH_PREFETCH_ECRECOVER_THREADS)
+        for (uint64_t tx = 0; tx < batch.tx.size(); tx++)
+        {
+            mpz_class signature(batch.tx[tx].signHash());
+            mpz_class v_ = batch.tx[tx].v;
+            batch.tx[tx].ecRecoverResult = ECRecover(signature, batch.tx[tx].r, batch.tx[tx].s, v_, false, batch.tx[tx].fromPublicKey);
+        }
+
+        collectAddresses(batch);
+    }
+
+    // Generate the keys of the account leaves
+    const uint64_t leafTypes[4] = { SMT_KEY_BALANCE, SMT_KEY_NONCE, SMT_KEY_SC_CODE, SMT_KEY_SC_LENGTH };
+    vector<Goldilocks::Element> keys;
+    keys.reserve(addresses.size()*4*4);
+    for (uint64_t a = 0; a < addresses.size(); a++)
+    {
+        Account account(fr, poseidon, hashDB);
+        if (account.Init(addresses[a]) != ZKR_SUCCESS)
+        {
+            continue;
+        }
+        for (uint64_t l = 0; l < 4; l++)
+        {
+            Goldilocks::Element key[4];
+            account.GenerateLeafKey(leafTypes[l], key);
+            keys.insert(keys.end(), key, key + 4);
+            prefetchedKeys.insert(fea2string(fr, key));
+        }
+    }
+
+    // Read them all at once from the old state root
+    Goldilocks::Element oldRoot[4];
+    scalar2fea(fr, publicInputs.oldStateRoot, oldRoot);
+    vector<mpz_class> values;
+    zkr = hashDB.getMany(proverRequest.uuid, oldRoot, keys, values, NULL, NULL);
+    if (zkr != ZKR_SUCCESS)
+    {
+        zklog.warning("BatchPrefetch::prefetch() failed calling hashDB.getMany() result=" + zkresult2string(zkr));
+    }
+
+    prefetchTime = TimeDiff(t);
+}
+
+void BatchPrefetch::collectAddresses (const BatchData &batch)
+{
+    PublicInputs &publicInputs = proverRequest.input.publicInputsExtended.publicInputs;
+    unordered_set<string> addressSet;
+    addresses.push_back(publicInputs.sequencerAddr);
+    addressSet.insert(publicInputs.sequencerAddr.get_str(16));
+    if ((proverRequest.input.from != "") && (proverRequest.input.from != "0x"))
+    {
+        mpz_class from(proverRequest.input.from);
+        if (addressSet.insert(from.get_str(16)).second) addresses.push_back(from);
+    }
+    for (uint64_t tx = 0; tx < batch.tx.size(); tx++)
+    {
+        if ((batch.tx[tx].ecRecoverResult == ECR_NO_ERROR) && addressSet.insert(batch.tx[tx].fromPublicKey.get_str(16)).second)
+        {
+            addresses.push_back(batch.tx[tx].fromPublicKey);
+        }
+        // A zero recipient is a deployment, whose address is not known yet
+        if ((batch.tx[tx].to != 0) && addressSet.insert(batch.tx[tx].to.get_str(16)).second)
+        {
+            addresses.push_back(batch.tx[tx].to);
+        }
+    }
+}
+
+void BatchPrefetch::printStats (void)
+{
+    wait();
+
+    // If the executor does not record its reads, e.g. the C executor, there is no hit rate to report
+    if (readKeys.empty())
+    {
+        zklog.info("BatchPrefetch::printStats() prefetched=" + to_string(prefetchedKeys.size()) +
+            " time=" + to_string(double(prefetchTime)/1000) + "ms");
+        return;
+    }
+
+    uint64_t hits = 0;
+    for (unordered_set<string>::const_iterator it = readKeys.begin(); it != readKeys.end(); it++)
+    {
+        if (prefetchedKeys.find(*it) != prefetchedKeys.end()) hits++;
+    }
+    zklog.info("BatchPrefetch::printStats() prefetched=" + to_string(prefetchedKeys.size()) +
+        " time=" + to_string(double(prefetchTime)/1000) + "ms read=" + to_string(readKeys.size()) +
+        " hits=" + to_string(hits) + " hitRate=" + to_string(readKeys.size() == 0 ? 0 : double(hits)*100/double(readKeys.size())) + "%" +
+        " used=" + to_string(prefetchedKeys.size() == 0 ? 0 : double(hits)*100/double(prefetchedKeys.size())) + "%");
+}
+
+}
@@ -0,0 +1,91 @@
+#ifndef BATCH_PREFETCH_HPP_fork_5
+#define BATCH_PREFETCH_HPP_fork_5
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <pthread.h>
+#include "goldilocks_base_field.hpp"
+#include "poseidon_goldilocks.hpp"
+#include "prover_request.hpp"
+#include "hashdb_interface.hpp"
+#include "scalar.hpp"
+#include "main_sm/fork_5/main_exec_c/batch_decode.hpp"
+
+using namespace std;
+
+namespace fork_5
+{
+
+// Maximum number of threads used by the prefetch thread to recover the senders, so it does not compete with the executor
+#define BATCH_PREFETCH_ECRECOVER_THREADS 4
+
+/*
+    Reads in advance the state of the accounts that a batch is likely to read.
+
+    start() launches a thread that decodes the batch L2 data, recovers the senders of its transactions,
+    and gets the balance, nonce, bytecode hash and bytecode length of the senders, the recipients and the
+    sequencer from the old state root with one HashDB getMany() call.  This brings the SMT nodes of these
+    accounts into the database cache while the executor runs the first steps of the ROM.  The values are
+    discarded, since the executor reads the state root it has at every moment.
+    When the executor has already decoded the batch and recovered its senders, e.g. the C executor, it
+    passes the batch to start() and the thread only reads the accounts.
+*/
+class BatchPrefetch
+{
+private:
+    Goldilocks &fr;
+    PoseidonGoldilocks &poseidon;
+    ProverRequest &proverRequest;
+    HashDBInterface &hashDB; // The executor client, which must not be freed before wait() returns
+
+    pthread_t thread;
+    bool bStarted;
+
+    vector<mpz_class> addresses; // Accounts to prefetch, collected by start() when the batch is provided
+    bool bAddressesCollected;
+    unordered_set<string> prefetchedKeys; // Written by the thread, read only after wait()
+    unordered_set<string> readKeys; // Keys read by the executor
+    uint64_t prefetchTime; // In us
+
+public:
+    BatchPrefetch (Goldilocks &fr, PoseidonGoldilocks &poseidon, ProverRequest &proverRequest, HashDBInterface &hashDB) :
+        fr(fr),
+        poseidon(poseidon),
+        proverRequest(proverRequest),
+        hashDB(hashDB),
+        bStarted(false),
+        bAddressesCollected(false),
+        prefetchTime(0) {};
+    ~BatchPrefetch() { wait(); };
+
+    // Launches the prefetch thread, that decodes the batch and recovers its senders
+    void start (void);
+
+    // Launches the prefetch thread for an already decoded batch, with its senders recovered
+    void start (const BatchData &batch);
+
+    // Waits for the prefetch thread to complete
+    void wait (void);
+
+    // Records a key read by the executor, to calculate the hit rate
+    inline void onRead (const Goldilocks::Element (&key)[4])
+    {
+        readKeys.insert(fea2string(fr, key));
+    }
+
+    // Logs the number of prefetched and read keys, and the hit rate
+    void printStats (void);
+
+    // Thread body
+    void prefetch (void);
+
+private:
+
+    // Collects the accounts involved in the batch, without duplicates
+    void collectAddresses (const BatchData &batch);
+};
+
+}
+
+#endif
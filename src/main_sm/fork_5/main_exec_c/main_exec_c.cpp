@@ -3,6 +3,7 @@
 #include "main_sm/fork_5/main_exec_c/variables_c.hpp"
 #include "main_sm/fork_5/main_exec_c/batch_decode.hpp"
 #include "main_sm/fork_5/main_exec_c/account.hpp"
+#include "main_sm/fork_5/main_exec_c/batch_prefetch.hpp"
 #include "main_sm/fork_5/main/eval_command.hpp"
 #include "main_sm/fork_5/main/context.hpp"
 #include "scalar.hpp"
@@ -63,6 +64,9 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
         }
     }
 
+    // Batch prefetch, started once the transactions senders are recovered
+    BatchPrefetch batchPrefetch(fr, poseidon, proverRequest, *pHashDB);
+
     // Init execution flags
     bool bProcessBatch = (proverRequest.type == prt_processBatch);
     bool bUnsignedTransaction = (proverRequest.input.from != "") && (proverRequest.input.from != "0x");
@@ -73,6 +77,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
     {
         proverRequest.result = ZKR_SM_MAIN_INVALID_UNSIGNED_TX;
         zklog.error("main_exec_c) failed called with bUnsignedTransaction=true but bProcessBatch=false");
+        batchPrefetch.wait();
         HashDBClientFactory::freeHashDBClient(pHashDB);
         return;
     }
@@ -82,6 +87,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
     {
         zklog.error("main_exec_c() called with invalid forkID=" + to_string(proverRequest.input.publicInputsExtended.publicInputs.forkID));
         proverRequest.result = ZKR_SM_MAIN_INVALID_FORK_ID;
+        batchPrefetch.wait();
         HashDBClientFactory::freeHashDBClient(pHashDB);
         return;
     }
@@ -122,6 +128,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
     {
         zklog.error("main_exec_c() failed calling BatchDecode()");
         proverRequest.result = result;
+        batchPrefetch.wait();
         HashDBClientFactory::freeHashDBClient(pHashDB);
         return;
     }
@@ -137,6 +144,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
     {
         zklog.error("main_exec_c() failed calling onStartBatch()");
         proverRequest.result = result;
+        batchPrefetch.wait();
         HashDBClientFactory::freeHashDBClient(pHashDB);
         return;
     }
@@ -152,6 +160,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
     {
         zklog.error("main_exec_c() failed calling globalExitRootManagerL2Account.Init()");
         proverRequest.result = result;
+        batchPrefetch.wait();
         HashDBClientFactory::freeHashDBClient(pHashDB);
         return;
     }
@@ -166,6 +175,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
     {
         zklog.error("main_exec_c() failed calling globalExitRootManagerL2Account.SetGlobalExitRoot()");
         proverRequest.result = result;
+        batchPrefetch.wait();
         HashDBClientFactory::freeHashDBClient(pHashDB);
         return;
     }
@@ -181,6 +191,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
     {
         zklog.error("main_exec_c() failed calling systemAccount.Init()");
         proverRequest.result = result;
+        batchPrefetch.wait();
         HashDBClientFactory::freeHashDBClient(pHashDB);
         return;
     }
@@ -192,6 +203,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
     {
         zklog.error("main_exec_c() failed calling sequencerAccount.Init()");
         proverRequest.result = result;
+        batchPrefetch.wait();
         HashDBClientFactory::freeHashDBClient(pHashDB);
         return;
     }
@@ -220,6 +232,12 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
     mainMetrics.add("ECRecover", TimeDiff(t));
 #endif
 
+    // Read the state of the batch accounts in parallel with the transactions processing, reusing the decoded batch
+    if (config.useBatchPrefetch)
+    {
+        batchPrefetch.start(ctxc.batch);
+    }
+
     // Process all transactions present in parsed batch L2 data
     for (ctxc.tx=0; ctxc.tx<ctxc.batch.tx.size(); ctxc.tx++)
     {
@@ -235,6 +253,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
         {
             zklog.error("main_exec_c() failed calling onProcessTx()");
             proverRequest.result = result;
+            batchPrefetch.wait();
             HashDBClientFactory::freeHashDBClient(pHashDB);
             return;
         }
@@ -246,6 +265,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
         {
             zklog.error("main_exec_c() failed calling ECRecover()");
             proverRequest.result = ZKR_UNSPECIFIED;
+            batchPrefetch.wait();
             HashDBClientFactory::freeHashDBClient(pHashDB);
             return;
         }
@@ -258,6 +278,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
         {
             zklog.error("main_exec_c() failed calling fromAccount.Init()");
             proverRequest.result = result;
+            batchPrefetch.wait();
             HashDBClientFactory::freeHashDBClient(pHashDB);
             return;
         }
@@ -267,6 +288,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
         {
             zklog.error("main_exec_c() failed calling toAccount.Init()");
             proverRequest.result = result;
+            batchPrefetch.wait();
             HashDBClientFactory::freeHashDBClient(pHashDB);
             return;
         }
@@ -285,6 +307,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
         {
             zklog.error("main_exec_c() failed calling toAccount.GetNonce()");
             proverRequest.result = result;
+            batchPrefetch.wait();
             HashDBClientFactory::freeHashDBClient(pHashDB);
             return;
         }
@@ -297,6 +320,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
         {
             zklog.error("main_exec_c() found fromNonce=" + to_string(fromNonce) + " different from batch L2 Datan nonce=" + to_string(ctxc.batch.tx[ctxc.tx].nonce));
             proverRequest.result = ZKR_UNSPECIFIED;
+            batchPrefetch.wait();
             HashDBClientFactory::freeHashDBClient(pHashDB);
             return;
         }
@@ -313,6 +337,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
         {
             zklog.error("main_exec_c() failed calling toAccount.SetNonce()");
             proverRequest.result = result;
+            batchPrefetch.wait();
             HashDBClientFactory::freeHashDBClient(pHashDB);
             return;
         }
@@ -330,6 +355,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
         {
             zklog.error("main_exec_c() failed calling fromAccount.GetBalance()");
             proverRequest.result = result;
+            batchPrefetch.wait();
             HashDBClientFactory::freeHashDBClient(pHashDB);
             return;
         }
@@ -345,6 +371,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
         {
             zklog.error("main_exec_c() failed gas=" + ctxc.batch.tx[ctxc.tx].gas.get_str(10) + " < gasLimit=" + to_string(ctxc.batch.tx[ctxc.tx].gasLimit));
             proverRequest.result = ZKR_UNSPECIFIED; // TODO: Review list of errors
+            batchPrefetch.wait();
             HashDBClientFactory::freeHashDBClient(pHashDB);
             return;
         }
@@ -369,6 +396,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
         {
             zklog.error("main_exec_c() failed fromBalance=" + fromBalance.get_str(10) + " < fromAmount=" + fromAmount.get_str(10));
             proverRequest.result = ZKR_UNSPECIFIED;
+            batchPrefetch.wait();
             HashDBClientFactory::freeHashDBClient(pHashDB);
             return;
         }
@@ -383,6 +411,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
         {
             zklog.error("main_exec_c() failed calling fromAccount.SetBalance()");
             proverRequest.result = result;
+            batchPrefetch.wait();
             HashDBClientFactory::freeHashDBClient(pHashDB);
             return;
         }
@@ -404,6 +433,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
         {
             zklog.error("main_exec_c() failed calling toAccount.GetBalance()");
             proverRequest.result = result;
+            batchPrefetch.wait();
             HashDBClientFactory::freeHashDBClient(pHashDB);
             return;
         }
@@ -423,6 +453,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
         {
             zklog.error("main_exec_c() failed calling toAccount.SetBalance()");
             proverRequest.result = result;
+            batchPrefetch.wait();
             HashDBClientFactory::freeHashDBClient(pHashDB);
             return;
         }
@@ -446,6 +477,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
         {
             zklog.error("main_exec_c() failed calling sequencerAccount.GetBalance()");
             proverRequest.result = result;
+            batchPrefetch.wait();
             HashDBClientFactory::freeHashDBClient(pHashDB);
             return;
         }
@@ -465,6 +497,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
         {
             zklog.error("main_exec_c() failed calling sequencerAccount.SetBalance()");
             proverRequest.result = result;
+            batchPrefetch.wait();
             HashDBClientFactory::freeHashDBClient(pHashDB);
             return;
         }
@@ -486,6 +519,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
         {
             zklog.error("main_exec_c() failed calling systemAccount.SetTxCount()");
             proverRequest.result = result;
+            batchPrefetch.wait();
             HashDBClientFactory::freeHashDBClient(pHashDB);
             return;
         }
@@ -504,6 +538,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
         {
             zklog.error("main_exec_c() failed calling systemAccount.SetStateRoot()");
             proverRequest.result = result;
+            batchPrefetch.wait();
             HashDBClientFactory::freeHashDBClient(pHashDB);
             return;
         }
@@ -519,6 +554,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
         {
             zklog.error("main_exec_c() failed calling onFinishTx()");
             proverRequest.result = result;
+            batchPrefetch.wait();
             HashDBClientFactory::freeHashDBClient(pHashDB);
             return;
         }
@@ -540,6 +576,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
     {
         zklog.error("main_exec_c() failed calling onFinishBatch()");
         proverRequest.result = result;
+        batchPrefetch.wait();
         HashDBClientFactory::freeHashDBClient(pHashDB);
         return;
     }
@@ -547,6 +584,11 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
     mainMetrics.add("FullTracer::onFinishBatch", TimeDiff(t));
 #endif
 
+    if (config.useBatchPrefetch)
+    {
+        batchPrefetch.printStats();
+    }
+
 #ifdef LOG_TIME_STATISTICS_MAIN_EXECUTOR
     gettimeofday(&t, NULL);
 #endif
@@ -555,6 +597,7 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
     {
         proverRequest.result = result;
         zklog.error("Failed calling pHashDB->flush() result=" + zkresult2string(result));
+        batchPrefetch.wait();
         HashDBClientFactory::freeHashDBClient(pHashDB);
         return;
     }
@@ -562,6 +605,8 @@ void MainExecutorC::execute (ProverRequest &proverRequest)
     mainMetrics.add("HashDB::flush", TimeDiff(t));
 #endif
 
+    batchPrefetch.wait();
+
     HashDBClientFactory::freeHashDBClient(pHashDB);
     proverRequest.result = ZKR_SUCCESS;
 
@@ -35,6 +35,7 @@ class Prover
     Starks *starksC12a;
     Starks *starksRecursive1;
     Starks *starksRecursive2;
+    StarkArena starkArena; // Proof temporaries shared by the Starks instances above, which prove one after another
 
     Fflonk::FflonkProver<AltBn128::Engine> *prover;
     std::unique_ptr<Groth16::Prover<AltBn128::Engine>> groth16Prover;
@@ -54,6 +55,7 @@ private:
     pthread_t cleanerPthread; // Garbage collector
     pthread_mutex_t mutex;    // Mutex to protect the requests queues
     void *pAddress = NULL;
+    uint64_t polsSize = 0; // Size of pAddress in bytes
     void *pAddressStarksRecursiveF = NULL;
     int protocolId;
 public:
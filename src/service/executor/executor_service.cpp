@@ -632,9 +632,11 @@ using grpc::Status;
     uint64_t pendingToFlushProgram;
     uint64_t storingNodes;
     uint64_t storingProgram;
+    uint64_t storedBytesPerSecond;
+    uint64_t storedRowsPerSecond;
     string proverId;
 
-    pHashDB->getFlushStatus(storedFlushId, storingFlushId, lastFlushId, pendingToFlushNodes, pendingToFlushProgram, storingNodes, storingProgram, proverId);
+    pHashDB->getFlushStatus(storedFlushId, storingFlushId, lastFlushId, pendingToFlushNodes, pendingToFlushProgram, storingNodes, storingProgram, storedBytesPerSecond, storedRowsPerSecond, proverId);
     
     response->set_stored_flush_id(storedFlushId);
     response->set_storing_flush_id(storingFlushId);
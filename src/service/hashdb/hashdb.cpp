@@ -100,6 +100,60 @@ zkresult HashDB::get (const string &batchUUID, const Goldilocks::Element (&root)
     return zkr;
 }
 
+zkresult HashDB::getMany (const string &batchUUID, const Goldilocks::Element (&root)[4], const vector<Goldilocks::Element> &keys, vector<mpz_class> &values, vector<SmtGetResult> *results, DatabaseMap *dbReadLog)
+{
+#ifdef LOG_TIME_STATISTICS_HASHDB
+    gettimeofday(&t, NULL);
+#endif
+
+#ifdef HASHDB_LOCK
+    lock_guard<recursive_mutex> guard(mlock);
+#endif
+
+    if ((keys.size() % 4) != 0)
+    {
+        zklog.error("HashDB::getMany() called with an invalid keys size=" + to_string(keys.size()));
+        return ZKR_INTERNAL_ERROR;
+    }
+    uint64_t numberOfKeys = keys.size() / 4;
+
+    vector<SmtGetResult> localResults;
+    vector<SmtGetResult> &r = (results == NULL) ? localResults : *results;
+
+    zkresult zkr = ZKR_SUCCESS;
+
+    if (config.hashDB64)
+    {
+        // Database64 does not support reading many nodes at once, so get them one by one
+        r.resize(numberOfKeys);
+        for (uint64_t i=0; i<numberOfKeys; i++)
+        {
+            Goldilocks::Element key[4] = { keys[i*4], keys[i*4 + 1], keys[i*4 + 2], keys[i*4 + 3] };
+            zkr = smt64.get(batchUUID, db64, root, key, r[i], dbReadLog);
+            if (zkr != ZKR_SUCCESS) break;
+        }
+    }
+    else
+    {
+        zkr = smt.getMany(batchUUID, db, root, keys, r, dbReadLog);
+    }
+
+    if (zkr == ZKR_SUCCESS)
+    {
+        values.resize(numberOfKeys);
+        for (uint64_t i=0; i<numberOfKeys; i++)
+        {
+            values[i] = r[i].value;
+        }
+    }
+
+#ifdef LOG_TIME_STATISTICS_HASHDB
+    tms.add("getMany", TimeDiff(t));
+#endif
+
+    return zkr;
+}
+
 zkresult HashDB::setProgram(const Goldilocks::Element (&key)[4], const vector<uint8_t> &data, const bool persistent)
 {
 #ifdef LOG_TIME_STATISTICS_HASHDB
@@ -287,7 +341,7 @@ void HashDB::semiFlush (const string &batchUUID, const string &newStateRoot, con
     }
 }
 
-zkresult HashDB::getFlushStatus(uint64_t &storedFlushId, uint64_t &storingFlushId, uint64_t &lastFlushId, uint64_t &pendingToFlushNodes, uint64_t &pendingToFlushProgram, uint64_t &storingNodes, uint64_t &storingProgram, string &proverId)
+zkresult HashDB::getFlushStatus(uint64_t &storedFlushId, uint64_t &storingFlushId, uint64_t &lastFlushId, uint64_t &pendingToFlushNodes, uint64_t &pendingToFlushProgram, uint64_t &storingNodes, uint64_t &storingProgram, uint64_t &storedBytesPerSecond, uint64_t &storedRowsPerSecond, string &proverId)
 {
 #ifdef LOG_TIME_STATISTICS_HASHDB
     gettimeofday(&t, NULL);
@@ -301,10 +355,15 @@ zkresult HashDB::getFlushStatus(uint64_t &storedFlushId, uint64_t &storingFlushI
     if (config.hashDB64)
     {
         db64.getFlushStatus(storedFlushId, storingFlushId, lastFlushId, pendingToFlushNodes, pendingToFlushProgram, storingNodes, storingProgram);
+        storedBytesPerSecond = 0;
+        storedRowsPerSecond = 0;
     }
     else
     {
-        db.getFlushStatus(storedFlushId, storingFlushId, lastFlushId, pendingToFlushNodes, pendingToFlushProgram, storingNodes, storingProgram);
+        db.getFlushStatus(storedFlushId, storingFlushId, lastFlushId, pendingToFlushNodes, pendingToFlushProgram, storingNodes, storingProgram, storedBytesPerSecond, storedRowsPerSecond);
+#ifdef LOG_DB_FLUSH
+        zklog.info("HashDB::getFlushStatus() storedFlushId=" + to_string(storedFlushId) + " storedBytesPerSecond=" + to_string(storedBytesPerSecond) + " storedRowsPerSecond=" + to_string(storedRowsPerSecond));
+#endif
     }
 
     // Get proces ID from configuration
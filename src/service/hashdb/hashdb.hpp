@@ -39,13 +39,14 @@ public:
     // HashDBInterface methods
     zkresult set            (const string &batchUUID, uint64_t tx, const Goldilocks::Element (&oldRoot)[4], const Goldilocks::Element (&key)[4], const mpz_class &value, const Persistence persistence, Goldilocks::Element (&newRoot)[4], SmtSetResult *result, DatabaseMap *dbReadLog);
     zkresult get            (const string &batchUUID, const Goldilocks::Element (&root)[4], const Goldilocks::Element (&key)[4], mpz_class &value, SmtGetResult *result, DatabaseMap *dbReadLog);
+    zkresult getMany        (const string &batchUUID, const Goldilocks::Element (&root)[4], const vector<Goldilocks::Element> &keys, vector<mpz_class> &values, vector<SmtGetResult> *results, DatabaseMap *dbReadLog);
     zkresult setProgram     (const Goldilocks::Element (&key)[4], const vector<uint8_t> &data, const bool persistent);
     zkresult getProgram     (const Goldilocks::Element (&key)[4], vector<uint8_t> &data, DatabaseMap *dbReadLog);
     void     loadDB         (const DatabaseMap::MTMap &inputDB, const bool persistent);
     void     loadProgramDB  (const DatabaseMap::ProgramMap &inputProgramDB, const bool persistent);
     zkresult flush          (const string &batchUUID, const string &newStateRoot, const Persistence persistence, uint64_t &flushId, uint64_t &storedFlushId);
     void     semiFlush      (const string &batchUUID, const string &newStateRoot, const Persistence persistence);
-    zkresult getFlushStatus (uint64_t &storedFlushId, uint64_t &storingFlushId, uint64_t &lastFlushId, uint64_t &pendingToFlushNodes, uint64_t &pendingToFlushProgram, uint64_t &storingNodes, uint64_t &storingProgram, string &proverId);
+    zkresult getFlushStatus (uint64_t &storedFlushId, uint64_t &storingFlushId, uint64_t &lastFlushId, uint64_t &pendingToFlushNodes, uint64_t &pendingToFlushProgram, uint64_t &storingNodes, uint64_t &storingProgram, uint64_t &storedBytesPerSecond, uint64_t &storedRowsPerSecond, string &proverId);
     zkresult getFlushData   (uint64_t flushId, uint64_t &storedFlushId, unordered_map<string, string> (&nodes), unordered_map<string, string> (&program), string &nodesStateRoot);
     void     clearCache     (void);
 
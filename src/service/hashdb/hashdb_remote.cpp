@@ -133,6 +133,108 @@ zkresult HashDBRemote::get (const string &batchUUID, const Goldilocks::Element (
         return ZKR_HASHDB_GRPC_ERROR;
     }
 
+    parseGetResponse(response, value, result, dbReadLog);
+
+#ifdef LOG_TIME_STATISTICS_HASHDB_REMOTE
+    tms.add("get", TimeDiff(t));
+#endif
+
+    return static_cast<zkresult>(response.result().code());
+}
+
+zkresult HashDBRemote::getMany (const string &batchUUID, const Goldilocks::Element (&root)[4], const vector<Goldilocks::Element> &keys, vector<mpz_class> &values, vector<SmtGetResult> *results, DatabaseMap *dbReadLog)
+{
+#ifdef LOG_TIME_STATISTICS_HASHDB_REMOTE
+    gettimeofday(&t, NULL);
+#endif
+
+    if ((keys.size() % 4) != 0)
+    {
+        zklog.error("HashDBRemote::getMany() called with an invalid keys size=" + to_string(keys.size()));
+        return ZKR_INTERNAL_ERROR;
+    }
+    uint64_t numberOfKeys = keys.size() / 4;
+
+    values.resize(numberOfKeys);
+    if (results != NULL) results->resize(numberOfKeys);
+
+    // The service has no batched get, so pipeline the get requests through a completion queue,
+    // keeping up to HASHDB_REMOTE_GET_MANY_WINDOW of them in flight
+    struct GetCall
+    {
+        ::grpc::ClientContext context;
+        ::hashdb::v1::GetRequest request;
+        ::hashdb::v1::GetResponse response;
+        ::grpc::Status status;
+        std::unique_ptr< ::grpc::ClientAsyncResponseReaderInterface< ::hashdb::v1::GetResponse> > reader;
+    };
+    vector<GetCall> calls(numberOfKeys);
+    ::grpc::CompletionQueue cq;
+
+    zkresult zkr = ZKR_SUCCESS;
+    uint64_t sent = 0;
+    uint64_t received = 0;
+    while (received < numberOfKeys)
+    {
+        // Send as many requests as the window allows
+        while ((sent < numberOfKeys) && (sent - received < HASHDB_REMOTE_GET_MANY_WINDOW))
+        {
+            GetCall &call = calls[sent];
+            Goldilocks::Element key[4] = { keys[sent*4], keys[sent*4 + 1], keys[sent*4 + 2], keys[sent*4 + 3] };
+
+            ::hashdb::v1::Fea* reqRoot = new ::hashdb::v1::Fea();
+            fea2grpc(fr, root, reqRoot);
+            call.request.set_allocated_root(reqRoot);
+
+            ::hashdb::v1::Fea* reqKey = new ::hashdb::v1::Fea();
+            fea2grpc(fr, key, reqKey);
+            call.request.set_allocated_key(reqKey);
+            call.request.set_details(results != NULL);
+            call.request.set_get_db_read_log((dbReadLog != NULL));
+            call.request.set_batch_uuid(batchUUID);
+
+            call.reader = stub->PrepareAsyncGet(&call.context, call.request, &cq);
+            call.reader->StartCall();
+            call.reader->Finish(&call.response, &call.status, (void *)sent);
+            sent++;
+        }
+
+        // Wait for the next response
+        void *tag;
+        bool ok;
+        if (!cq.Next(&tag, &ok))
+        {
+            zklog.error("HashDBRemote::getMany() completion queue shut down unexpectedly");
+            return ZKR_HASHDB_GRPC_ERROR;
+        }
+        received++;
+
+        uint64_t i = (uint64_t)tag;
+        GetCall &call = calls[i];
+        if (!ok || (call.status.error_code() != grpc::StatusCode::OK))
+        {
+            zklog.error("HashDBRemote::getMany() GRPC error(" + to_string(call.status.error_code()) + "): " + call.status.error_message());
+            if (zkr == ZKR_SUCCESS) zkr = ZKR_HASHDB_GRPC_ERROR;
+            continue;
+        }
+
+        parseGetResponse(call.response, values[i], (results != NULL) ? &(*results)[i] : NULL, dbReadLog);
+        zkresult callResult = static_cast<zkresult>(call.response.result().code());
+        if ((callResult != ZKR_SUCCESS) && (zkr == ZKR_SUCCESS))
+        {
+            zkr = callResult;
+        }
+    }
+
+#ifdef LOG_TIME_STATISTICS_HASHDB_REMOTE
+    tms.add("getMany", TimeDiff(t));
+#endif
+
+    return zkr;
+}
+
+void HashDBRemote::parseGetResponse (::hashdb::v1::GetResponse &response, mpz_class &value, SmtGetResult *result, DatabaseMap *dbReadLog)
+{
     value.set_str(response.value(),16);
 
     if (result != NULL) {
@@ -165,12 +267,6 @@ zkresult HashDBRemote::get (const string &batchUUID, const Goldilocks::Element (
         grpc2mtMap(fr, *response.mutable_db_read_log(), mtMap);
         dbReadLog->add(mtMap);
     }
-
-#ifdef LOG_TIME_STATISTICS_HASHDB_REMOTE
-    tms.add("get", TimeDiff(t));
-#endif
-
-    return static_cast<zkresult>(response.result().code());
 }
 
 zkresult HashDBRemote::setProgram (const Goldilocks::Element (&key)[4], const vector<uint8_t> &data, const bool persistent)
@@ -328,7 +424,7 @@ void HashDBRemote::semiFlush (const string &batchUUID, const string &newStateRoo
     grpc::Status s = stub->SemiFlush(&context, request, &response);
 }
 
-zkresult HashDBRemote::getFlushStatus(uint64_t &storedFlushId, uint64_t &storingFlushId, uint64_t &lastFlushId, uint64_t &pendingToFlushNodes, uint64_t &pendingToFlushProgram, uint64_t &storingNodes, uint64_t &storingProgram, string &proverId)
+zkresult HashDBRemote::getFlushStatus(uint64_t &storedFlushId, uint64_t &storingFlushId, uint64_t &lastFlushId, uint64_t &pendingToFlushNodes, uint64_t &pendingToFlushProgram, uint64_t &storingNodes, uint64_t &storingProgram, uint64_t &storedBytesPerSecond, uint64_t &storedRowsPerSecond, string &proverId)
 {
 #ifdef LOG_TIME_STATISTICS_HASHDB_REMOTE
     gettimeofday(&t, NULL);
@@ -351,6 +447,10 @@ zkresult HashDBRemote::getFlushStatus(uint64_t &storedFlushId, uint64_t &storing
     storingProgram = response.storing_program();
     proverId = response.prover_id();
 
+    // The flush throughput is not part of the gRPC GetFlushStatusResponse, so it is only known locally
+    storedBytesPerSecond = 0;
+    storedRowsPerSecond = 0;
+
 #ifdef LOG_TIME_STATISTICS_HASHDB_REMOTE
     tms.add("getFlushStatus", TimeDiff(t));
 #endif
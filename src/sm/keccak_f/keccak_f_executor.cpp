@@ -121,6 +121,25 @@ void KeccakFExecutor::loadScript (json j)
 
     zkassert(j["maxRef"] == Keccak_SlotSize);
 
+    // Collect the gates written by the program, which must belong to the slot
+    vector<bool> written(Keccak_SlotSize + 1, false);
+    for (uint64_t i=0; i<program.size(); i++)
+    {
+        if ( (program[i].refa > Keccak_SlotSize) ||
+             (program[i].refb > Keccak_SlotSize) ||
+             (program[i].refr > Keccak_SlotSize) ||
+             (program[i].refr == ZeroRef) )
+        {
+            zklog.error("KeccakFExecutor::loadScript() found instruction i=" + to_string(i) + " with a reference out of the slot");
+            exitProcess();
+        }
+        written[program[i].refr] = true;
+    }
+    for (uint64_t ref=0; ref<=Keccak_SlotSize; ref++)
+    {
+        if (written[ref]) programRefs.push_back(ref);
+    }
+
     bLoaded = true;
 }
 
@@ -336,71 +355,65 @@ void KeccakFExecutor::execute (const vector<vector<Goldilocks::Element>> &input,
         }
     }
 
-    // Execute the program
-#pragma omp parallel for
-    for (uint64_t slot=0; slot<numberOfSlots; slot++)
+    // Execute the program, one slot per thread.  Every gate holds 44 bits, i.e. it evaluates 44 keccak-f
+    // in parallel, and is split in 4 field elements of 11 bits in the polynomials, so the slot is
+    // evaluated in local arrays of a, b and c values, and they are written to the polynomials at the end
+#pragma omp parallel
     {
-        for (uint64_t i=0; i<program.size(); i++)
+        uint64_t * pValues = new uint64_t[3*(Keccak_SlotSize + 1)];
+        uint64_t * values[3] = { pValues, pValues + (Keccak_SlotSize + 1), pValues + 2*(Keccak_SlotSize + 1) }; // Indexed by PinId
+
+#pragma omp for
+        for (uint64_t slot=0; slot<numberOfSlots; slot++)
         {
-            uint64_t absRefa = relRef2AbsRef(program[i].refa, slot);
-            uint64_t absRefb = relRef2AbsRef(program[i].refb, slot);
-            uint64_t absRefr = relRef2AbsRef(program[i].refr, slot);
-            
-            switch (program[i].pina)
-            {
-                case pin_a:
-                    setPol(pols.a, absRefr, getPol(pols.a, absRefa));
-                    break;
-                case pin_b:
-                    setPol(pols.a, absRefr, getPol(pols.b, absRefa));
-                    break;
-                case pin_r:
-                    setPol(pols.a, absRefr, getPol(pols.c, absRefa));
-                    break;
-                default:
-                    zklog.error("KeccakFExecutor() found invalid program[i].pina=" + to_string(program[i].pina));
-                    exitProcess();
-            }
-            switch (program[i].pinb)
+            memset(pValues, 0, 3*(Keccak_SlotSize + 1)*sizeof(uint64_t));
+            values[pin_a][ZeroRef] = 0;
+            values[pin_b][ZeroRef] = Keccak_Mask;
+            values[pin_r][ZeroRef] = Keccak_Mask;
+            for (uint64_t i=0; i<1600; i++)
             {
-                case pin_a:
-                    setPol(pols.b, absRefr, getPol(pols.a, absRefb));
-                    break;
-                case pin_b:
-                    setPol(pols.b, absRefr, getPol(pols.b, absRefb));
-                    break;
-                case pin_r:
-                    setPol(pols.b, absRefr, getPol(pols.c, absRefb));
-                    break;
-                default:
-                    zklog.error("KeccakFExecutor() found invalid program[i].pinb=" + to_string(program[i].pinb));
-                    exitProcess();
+                values[pin_a][SinRef0 + i*44] = fr.toU64(input[slot][i]);
             }
 
-            /*if (program[i].refr==(3200*44+1) || program[i].refr==((3200*44)+2) || program[i].refr==1 || program[i].refr==Keccak_SlotSize)
+            for (uint64_t i=0; i<program.size(); i++)
             {
-                zklog.info("slot=" + to_string(slot) + " i=" + to_string(i) + "/" + to_string(program.size()) + " refa=" + to_string(program[i].refa) + " absRefa=" + to_string(absRefa) + " refb=" + to_string(program[i].refb) + " absRefb=" + to_string(absRefb) + " refr=" + to_string(program[i].refr) + " absRefr=" + to_string(absRefr));
-            }*/
+                const KeccakInstruction &instruction = program[i];
+                uint64_t a = values[instruction.pina][instruction.refa];
+                uint64_t b = values[instruction.pinb][instruction.refb];
+                values[pin_a][instruction.refr] = a;
+                values[pin_b][instruction.refr] = b;
 
-            switch (program[i].op)
-            {
-                case gop_xor:
-                {
-                    setPol(pols.c, absRefr, (getPol(pols.a, absRefr) ^ getPol(pols.b, absRefr)) & Keccak_Mask );
-                    break;
-                }
-                case gop_andp:
-                {
-                    setPol(pols.c, absRefr, ((~getPol(pols.a, absRefr)) & getPol(pols.b, absRefr)) & Keccak_Mask );
-                    break;
-                }
-                default:
+                switch (instruction.op)
                 {
-                    zklog.error("KeccakFExecutor::execute() found invalid op: " + to_string(program[i].op) + " in evaluation: " + to_string(i));
-                    exitProcess();
+                    case gop_xor:
+                    {
+                        values[pin_r][instruction.refr] = (a ^ b) & Keccak_Mask;
+                        break;
+                    }
+                    case gop_andp:
+                    {
+                        values[pin_r][instruction.refr] = ((~a) & b) & Keccak_Mask;
+                        break;
+                    }
+                    default:
+                    {
+                        zklog.error("KeccakFExecutor::execute() found invalid op: " + to_string(instruction.op) + " in evaluation: " + to_string(i));
+                        exitProcess();
+                    }
                 }
             }
+
+            for (uint64_t i=0; i<programRefs.size(); i++)
+            {
+                uint64_t ref = programRefs[i];
+                uint64_t absRef = relRef2AbsRef(ref, slot);
+                setPol(pols.a, absRef, values[pin_a][ref]);
+                setPol(pols.b, absRef, values[pin_b][ref]);
+                setPol(pols.c, absRef, values[pin_r][ref]);
+            }
         }
+
+        delete[] pValues;
     }
 
     zklog.info("KeccakFExecutor successfully processed " + to_string(numberOfSlots) + " Keccak-F actions (" + to_string((double(input.size())*Keccak_SlotSize*100)/N) + "%)");
@@ -37,6 +37,7 @@ class KeccakFExecutor
     const uint64_t N;
     const uint64_t numberOfSlots;
     vector<KeccakInstruction> program;
+    vector<uint64_t> programRefs; // Gates written by the program, in ascending order
     bool bLoaded;
 public:
 
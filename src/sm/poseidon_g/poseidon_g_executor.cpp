@@ -113,11 +113,11 @@ void PoseidonGExecutor::execute (vector<array<Goldilocks::Element, 17>> &input,
         exitProcess();
     }
 
-    uint64_t p = 0;
-    uint64_t pDone = 0;
-
+    // Every hash fills nRoundsF + nRoundsP + 1 rows, so the hashes can be evaluated in parallel
+#pragma omp parallel for
     for (uint64_t i=0; i<input.size(); i++)
     {
+        uint64_t p = i*(nRoundsF + nRoundsP + 1);
         pols.in0[p] = input[i][0];
         pols.in1[p] = input[i][1];
         pols.in2[p] = input[i][2];
@@ -224,6 +224,9 @@ void PoseidonGExecutor::execute (vector<array<Goldilocks::Element, 17>> &input,
         }
     }
 
+    uint64_t p = input.size()*(nRoundsF + nRoundsP + 1);
+    uint64_t pDone = 0;
+
     vector<array<Goldilocks::Element,12>> st0;
 
     array<Goldilocks::Element, 12> aux;
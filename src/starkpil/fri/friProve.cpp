@@ -1,10 +1,28 @@
 #include "friProve.hpp"
 #include "timer.hpp"
 #include "zklog.hpp"
+#include "zkmax.hpp"
+#include "exit_process.hpp"
+
+// Returns base^exponent
+static Goldilocks::Element friPow(Goldilocks::Element base, uint64_t exponent)
+{
+    Goldilocks::Element result = Goldilocks::one();
+    while (exponent != 0)
+    {
+        if (exponent & 1)
+        {
+            result = result * base;
+        }
+        base = base * base;
+        exponent >>= 1;
+    }
+    return result;
+}
 
 void FRIProve::prove(FRIProof &fproof, MerkleTreeGL **treesGL, Transcript transcript, Polinomial &friPol, uint64_t polBits, StarkInfo starkInfo)
 {
-    //TimerStart(STARK_FRI_PROVE);
+    TimerStart(STARK_FRI_PROVE);
 
     Polinomial polShift(1, 1);
     Polinomial polShiftInv(1, 1);
@@ -16,111 +34,111 @@ void FRIProve::prove(FRIProof &fproof, MerkleTreeGL **treesGL, Transcript transc
 
     std::vector<MerkleTreeGL *> treesFRIGL(starkInfo.starkStruct.steps.size());
 
-    //TimerStart(STARK_FRI_PROVE_STEPS);
+    // All the FRI trees, sources and nodes, are allocated at once and kept until the queries are done
+    uint64_t treesArenaSize = 0;
+    for (uint64_t si = 0; si < starkInfo.starkStruct.steps.size() - 1; si++)
+    {
+        uint64_t nGroups = 1 << starkInfo.starkStruct.steps[si + 1].nBits;
+        uint64_t groupSize = (1 << starkInfo.starkStruct.steps[si].nBits) / nGroups;
+        treesArenaSize += nGroups * groupSize * FIELD_EXTENSION + (2 * nGroups - 1) * HASH_SIZE;
+    }
+    Goldilocks::Element *pTreesArena = (Goldilocks::Element *)malloc(zkmax(treesArenaSize, 1) * sizeof(Goldilocks::Element));
+    if (pTreesArena == NULL)
+    {
+        zklog.error("FRIProve::prove() failed calling malloc() of size=" + to_string(treesArenaSize * sizeof(Goldilocks::Element)));
+        exitProcess();
+    }
+    uint64_t treesArenaOffset = 0;
+
+    TimerStart(STARK_FRI_PROVE_STEPS);
     for (uint64_t si = 0; si < starkInfo.starkStruct.steps.size(); si++)
     {
+#ifdef LOG_TIME
+        struct timeval stepStart;
+        gettimeofday(&stepStart, NULL);
+#endif
         uint64_t reductionBits = polBits - starkInfo.starkStruct.steps[si].nBits;
 
         pol2N = 1 << (polBits - reductionBits);
         uint64_t nX = (1 << polBits) / pol2N;
+        bool bLastStep = (si == starkInfo.starkStruct.steps.size() - 1);
 
         Polinomial pol2_e(pol2N, FIELD_EXTENSION);
 
         Polinomial special_x(1, FIELD_EXTENSION);
         transcript.getField(special_x.address());
 
-        Polinomial sinv(1, 1);
-        Polinomial wi(1, 1);
-
-        *sinv[0] = *polShiftInv[0];
-        *wi[0] = Goldilocks::inv(Goldilocks::w(polBits));
+        Goldilocks::Element wi = Goldilocks::inv(Goldilocks::w(polBits));
 
-        uint64_t nn = ((1 << polBits) / nX);
-        u_int64_t maxth = omp_get_max_threads();
-        if (maxth > nn)
+        // The folded value of g goes to pol2_e[g] and, except in the last step, to element g / nGroups of
+        // leaf g % nGroups of the next tree, which is hashed as soon as all its elements are folded
+        uint64_t nGroups = bLastStep ? pol2N : (1 << starkInfo.starkStruct.steps[si + 1].nBits);
+        uint64_t groupSize = pol2N / nGroups;
+        MerkleTreeGL *pTree = NULL;
+        if (!bLastStep)
         {
-            maxth = nn;
+            Goldilocks::Element *pSource = &pTreesArena[treesArenaOffset];
+            Goldilocks::Element *pNodes = pSource + nGroups * groupSize * FIELD_EXTENSION;
+            treesArenaOffset += nGroups * groupSize * FIELD_EXTENSION + (2 * nGroups - 1) * HASH_SIZE;
+            pTree = new MerkleTreeGL(nGroups, groupSize * FIELD_EXTENSION, pSource, pNodes);
+            treesFRIGL[si + 1] = pTree;
         }
+
+        uint64_t maxth = zkmin((uint64_t)omp_get_max_threads(), nGroups);
+        Goldilocks::Element wiGroups = friPow(wi, nGroups);
 #pragma omp parallel num_threads(maxth)
         {
-            u_int64_t nth = omp_get_num_threads();
-            u_int64_t thid = omp_get_thread_num();
-            u_int64_t chunk = nn / nth;
-            u_int64_t res = nn - nth * chunk;
-
-            // Evaluate bounds of the loop for the thread
-            uint64_t init = chunk * thid;
-            uint64_t end;
-            if (thid < res)
-            {
-                init += thid;
-                end = init + chunk + 1;
-            }
-            else
-            {
-                init += res;
-                end = init + chunk;
-            }
-            //  Evaluate the starting point for the sinv
-            Goldilocks::Element aux = *wi[0];
-            Goldilocks::Element sinv_ = *sinv[0];
-            for (uint64_t i = 0; i < chunk - 1; ++i)
+            uint64_t nth = omp_get_num_threads();
+            uint64_t thid = omp_get_thread_num();
+            uint64_t l0 = (thid * nGroups) / nth;
+            uint64_t l1 = ((thid + 1) * nGroups) / nth;
+
+            // Per thread folding buffers; the coefs of g are multiplied by powers of shiftInv * wi^g
+            Polinomial ppar(si == 0 ? 0 : nX, si == 0 ? 0 : FIELD_EXTENSION);
+            Polinomial ppar_c(si == 0 ? 0 : nX, si == 0 ? 0 : FIELD_EXTENSION);
+            NTT_Goldilocks *pNtt = (si == 0) ? NULL : new NTT_Goldilocks(nX, 1);
+            Goldilocks::Element sinvLeaf = (*polShiftInv[0]) * friPow(wi, l0);
+
+            for (uint64_t leaf = l0; leaf < l1; leaf++)
             {
-                aux = aux * (*wi[0]);
-            }
-            for (u_int64_t i = 0; i < thid; ++i)
-            {
-                sinv_ = sinv_ * aux;
-            }
-            u_int64_t ncor = res;
-            if (thid < res)
-            {
-                ncor = thid;
-            }
-            for (u_int64_t j = 0; j < ncor; ++j)
-            {
-                sinv_ = sinv_ * (*wi[0]);
-            }
-
-            for (uint64_t g = init; g < end; g++)
-            {
-                if (si == 0)
+                Goldilocks::Element sinv_ = sinvLeaf;
+                for (uint64_t j = 0; j < groupSize; j++)
                 {
-                    Polinomial::copyElement(pol2_e, g, friPol, g);
-                }
-                else
-                {
-                    Polinomial ppar(nX, FIELD_EXTENSION);
-                    Polinomial ppar_c(nX, FIELD_EXTENSION);
-
-                    for (uint64_t i = 0; i < nX; i++)
+                    uint64_t g = j * nGroups + leaf;
+                    if (si == 0)
                     {
-                        Polinomial::copyElement(ppar, i, friPol, (i * pol2N) + g);
+                        Polinomial::copyElement(pol2_e, g, friPol, g);
+                    }
+                    else
+                    {
+                        for (uint64_t i = 0; i < nX; i++)
+                        {
+                            Polinomial::copyElement(ppar, i, friPol, (i * pol2N) + g);
+                        }
+                        pNtt->INTT(ppar_c.address(), ppar.address(), nX, FIELD_EXTENSION);
+                        polMulAxi(ppar_c, Goldilocks::one(), sinv_); // Multiplies coefs by 1, shiftInv, shiftInv^2, shiftInv^3, ......
+                        evalPol(pol2_e, g, ppar_c, special_x);
+                        sinv_ = sinv_ * wiGroups;
+                    }
+                    if (pTree != NULL)
+                    {
+                        std::memcpy(&pTree->source[(leaf * groupSize + j) * FIELD_EXTENSION], pol2_e[g], FIELD_EXTENSION * sizeof(Goldilocks::Element));
                     }
-                    NTT_Goldilocks ntt(nX, 1);
-
-                    ntt.INTT(ppar_c.address(), ppar.address(), nX, FIELD_EXTENSION);
-                    polMulAxi(ppar_c, Goldilocks::one(), sinv_); // Multiplies coefs by 1, shiftInv, shiftInv^2, shiftInv^3, ......
-                    evalPol(pol2_e, g, ppar_c, special_x);
-                    sinv_ = sinv_ * (*wi[0]);
                 }
+                if (pTree != NULL)
+                {
+                    PoseidonGoldilocks::linear_hash(&pTree->nodes[leaf * HASH_SIZE], &pTree->source[leaf * pTree->width], pTree->width);
+                }
+                sinvLeaf = sinvLeaf * wi;
             }
+            delete pNtt;
         }
 
-        if (si < starkInfo.starkStruct.steps.size() - 1)
+        if (!bLastStep)
         {
-            uint64_t nGroups = 1 << starkInfo.starkStruct.steps[si + 1].nBits;
-            uint64_t groupSize = (1 << starkInfo.starkStruct.steps[si].nBits) / nGroups;
-
-            // Re-org in groups
-            Polinomial aux(pol2N, FIELD_EXTENSION);
-            getTransposed(aux, pol2_e, starkInfo.starkStruct.steps[si + 1].nBits);
-
             Polinomial rootGL(HASH_SIZE, 1);
-            treesFRIGL[si + 1] = new MerkleTreeGL(nGroups, groupSize * FIELD_EXTENSION, NULL);
-            treesFRIGL[si + 1]->copySource(aux.address());
-            treesFRIGL[si + 1]->merkelize();
-            treesFRIGL[si + 1]->getRoot(rootGL.address());
+            pTree->merkelizeFromLeaves();
+            pTree->getRoot(rootGL.address());
             zklog.info("rootGL[" + to_string(si + 1) + "]: " + rootGL.toString(4));
             transcript.put(rootGL.address(), HASH_SIZE);
             fproof.proofs.fri.trees[si + 1].setRoot(rootGL.address());
@@ -146,27 +164,27 @@ void FRIProve::prove(FRIProof &fproof, MerkleTreeGL **treesGL, Transcript transc
             Goldilocks::mul(*polShiftInv[0], *polShiftInv[0], *polShiftInv[0]);
             Goldilocks::mul(*polShift[0], *polShift[0], *polShift[0]);
         }
+#ifdef LOG_TIME
+        zklog.info("FRIProve::prove() step=" + to_string(si) + " pol2N=" + to_string(pol2N) + " nX=" + to_string(nX) + " nGroups=" + to_string(nGroups) + " time=" + to_string(double(TimeDiff(stepStart)) / 1000000) + " s");
+#endif
     }
-    //TimerStopAndLog(STARK_FRI_PROVE_STEPS);
+    TimerStopAndLog(STARK_FRI_PROVE_STEPS);
     fproof.proofs.fri.setPol(friPol.address());
 
-    //TimerStart(STARK_FRI_QUERIES);
+    TimerStart(STARK_FRI_QUERIES);
 
     uint64_t ys[starkInfo.starkStruct.nQueries];
     transcript.getPermutations(ys, starkInfo.starkStruct.nQueries, starkInfo.starkStruct.steps[0].nBits);
 
     for (uint64_t si = 0; si < starkInfo.starkStruct.steps.size(); si++)
     {
-        for (uint64_t i = 0; i < starkInfo.starkStruct.nQueries; i++)
+        if (si == 0)
         {
-            if (si == 0)
-            {
-                queryPol(fproof, treesGL, ys[i], si);
-            }
-            else
-            {
-                queryPol(fproof, treesFRIGL[si], ys[i], si);
-            }
+            queryPol(fproof, treesGL, 5, ys, starkInfo.starkStruct.nQueries, si);
+        }
+        else
+        {
+            queryPol(fproof, &treesFRIGL[si], 1, ys, starkInfo.starkStruct.nQueries, si);
         }
         if (si < starkInfo.starkStruct.steps.size() - 1)
         {
@@ -183,9 +201,10 @@ void FRIProve::prove(FRIProof &fproof, MerkleTreeGL **treesGL, Transcript transc
         treesFRIGL.pop_back();
         delete mt;
     }
+    free(pTreesArena);
 
-    //TimerStopAndLog(STARK_FRI_QUERIES);
-    //TimerStopAndLog(STARK_FRI_PROVE);
+    TimerStopAndLog(STARK_FRI_QUERIES);
+    TimerStopAndLog(STARK_FRI_PROVE);
     return;
 }
 
@@ -216,56 +235,37 @@ void FRIProve::evalPol(Polinomial &res, uint64_t res_idx, Polinomial &p, Polinom
     }
 }
 
-void FRIProve::queryPol(FRIProof &fproof, MerkleTreeGL *treesGL[5], uint64_t idx, uint64_t treeIdx)
+void FRIProve::queryPol(FRIProof &fproof, MerkleTreeGL **treesGL, uint64_t nTrees, uint64_t *ys, uint64_t nQueries, uint64_t treeIdx)
 {
-    vector<MerkleProof> vMkProof;
-    for (uint i = 0; i < 5; i++)
+    // The proofs of all the queries are generated at once per tree, and then split into MerkleProofs
+    std::vector<Goldilocks::Element *> buffs(nTrees);
+    for (uint64_t i = 0; i < nTrees; i++)
     {
-        MerkleTreeGL *treesGLTmp = treesGL[i];
-        Goldilocks::Element buff[treesGLTmp->width + treesGLTmp->MerkleProofSize() * HASH_SIZE] = {Goldilocks::zero()};
-
-        treesGLTmp->getGroupProof(&buff[0], idx);
-
-        MerkleProof mkProof(treesGLTmp->width, treesGLTmp->MerkleProofSize(), &buff[0]);
-        vMkProof.push_back(mkProof);
+        uint64_t size = nQueries * treesGL[i]->getGroupProofSize();
+        buffs[i] = (Goldilocks::Element *)malloc(size * sizeof(Goldilocks::Element));
+        if (buffs[i] == NULL)
+        {
+            zklog.error("FRIProve::queryPol() failed calling malloc() of size=" + to_string(size * sizeof(Goldilocks::Element)));
+            exitProcess();
+        }
+        treesGL[i]->getGroupProofs(buffs[i], ys, nQueries);
     }
-    fproof.proofs.fri.trees[treeIdx].polQueries.push_back(vMkProof);
-
-    return;
-}
 
-void FRIProve::queryPol(FRIProof &fproof, MerkleTreeGL *treeGL, uint64_t idx, uint64_t treeIdx)
-{
-    vector<MerkleProof> vMkProof;
-
-    Goldilocks::Element buff[treeGL->width * treeGL->width + treeGL->MerkleProofSize() * HASH_SIZE] = {Goldilocks::zero()};
-    treeGL->getGroupProof(&buff[0], idx);
-
-    MerkleProof mkProof(treeGL->width, treeGL->MerkleProofSize(), &buff[0]);
-    vMkProof.push_back(mkProof);
-
-    fproof.proofs.fri.trees[treeIdx].polQueries.push_back(vMkProof);
-
-    return;
-}
-
-void FRIProve::getTransposed(Polinomial &aux, Polinomial &pol, uint64_t trasposeBits)
-{
-    uint64_t w = (1 << trasposeBits);
-    uint64_t h = pol.degree() / w;
-
-#pragma omp parallel for
-    for (uint64_t i = 0; i < w; i++)
+    for (uint64_t q = 0; q < nQueries; q++)
     {
-        for (uint64_t j = 0; j < h; j++)
+        vector<MerkleProof> vMkProof;
+        for (uint64_t i = 0; i < nTrees; i++)
         {
-
-            uint64_t fi = j * w + i;
-            uint64_t di = i * h + j;
-            assert(di < aux.degree());
-            assert(fi < pol.degree());
-
-            Polinomial::copyElement(aux, di, pol, fi);
+            MerkleProof mkProof(treesGL[i]->width, treesGL[i]->MerkleProofSize(), &buffs[i][q * treesGL[i]->getGroupProofSize()]);
+            vMkProof.push_back(mkProof);
         }
+        fproof.proofs.fri.trees[treeIdx].polQueries.push_back(vMkProof);
     }
+
+    for (uint64_t i = 0; i < nTrees; i++)
+    {
+        free(buffs[i]);
+    }
+
+    return;
 }
\ No newline at end of file
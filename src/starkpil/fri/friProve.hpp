@@ -16,9 +16,7 @@ public:
     static void prove(FRIProof &fproof, MerkleTreeGL **treesGL, Transcript transcript, Polinomial &friPol, uint64_t polBits, StarkInfo starkInfo);
     static void polMulAxi(Polinomial &pol, Goldilocks::Element init, Goldilocks::Element acc);
     static void evalPol(Polinomial &res, uint64_t res_idx, Polinomial &p, Polinomial &x);
-    static void queryPol(FRIProof &fproof, MerkleTreeGL **treeGL, uint64_t idx, uint64_t treeIdx);
-    static void queryPol(FRIProof &fproof, MerkleTreeGL *treeGL, uint64_t idx, uint64_t treeIdx);
-    static void getTransposed(Polinomial &aux, Polinomial &pol, uint64_t trasposeBits);
+    static void queryPol(FRIProof &fproof, MerkleTreeGL **treesGL, uint64_t nTrees, uint64_t *ys, uint64_t nQueries, uint64_t treeIdx);
 };
 
 #endif
\ No newline at end of file
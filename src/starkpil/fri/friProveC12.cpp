@@ -194,22 +194,7 @@ void FRIProveC12::prove(FRIProofC12 &fproof, MerkleTreeBN128 **trees, Transcript
 void FRIProveC12::getTransposed(Polinomial &aux, Polinomial &pol, uint64_t trasposeBits)
 {
     uint64_t w = (1 << trasposeBits);
-    uint64_t h = pol.degree() / w;
-
-#pragma omp parallel for
-    for (uint64_t i = 0; i < w; i++)
-    {
-        for (uint64_t j = 0; j < h; j++)
-        {
-
-            uint64_t fi = j * w + i;
-            uint64_t di = i * h + j;
-            assert(di < aux.degree());
-            assert(fi < pol.degree());
-
-            Polinomial::copyElement(aux, di, pol, fi);
-        }
-    }
+    Polinomial::transposeBlocked(aux, pol, w);
 }
 
 void FRIProveC12::polMulAxi(Polinomial &pol, Goldilocks::Element init, Goldilocks::Element acc)
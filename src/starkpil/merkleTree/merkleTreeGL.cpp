@@ -1,6 +1,8 @@
 #include "merkleTreeGL.hpp"
 #include <cassert>
 #include <algorithm> // std::max
+#include <unordered_map>
+#include <vector>
 
 void MerkleTreeGL::getElement(Goldilocks::Element &element, uint64_t idx, uint64_t subIdx)
 {
@@ -21,6 +23,38 @@ void MerkleTreeGL::getGroupProof(Goldilocks::Element *proof, uint64_t idx)
     genMerkleProof(&proof[width], idx, 0, height * HASH_SIZE);
 }
 
+void MerkleTreeGL::getGroupProofs(Goldilocks::Element *proofs, const uint64_t *indices, uint64_t nIndices)
+{
+    uint64_t proofSize = getGroupProofSize();
+
+    // Repeated indices, frequent in the small trees of the last FRI steps, are only walked once
+    std::vector<uint64_t> first(nIndices);
+    std::unordered_map<uint64_t, uint64_t> firstByIdx;
+    for (uint64_t i = 0; i < nIndices; i++)
+    {
+        first[i] = firstByIdx.emplace(indices[i], i).first->second;
+    }
+
+#pragma omp parallel for schedule(dynamic)
+    for (uint64_t i = 0; i < nIndices; i++)
+    {
+        if (first[i] != i)
+            continue;
+        assert(indices[i] < height);
+        std::memcpy(&proofs[i * proofSize], &source[indices[i] * width], width * sizeof(Goldilocks::Element));
+        genMerkleProof(&proofs[i * proofSize + width], indices[i], 0, height * HASH_SIZE);
+    }
+
+#pragma omp parallel for
+    for (uint64_t i = 0; i < nIndices; i++)
+    {
+        if (first[i] != i)
+        {
+            std::memcpy(&proofs[i * proofSize], &proofs[first[i] * proofSize], proofSize * sizeof(Goldilocks::Element));
+        }
+    }
+}
+
 void MerkleTreeGL::genMerkleProof(Goldilocks::Element *proof, uint64_t idx, uint64_t offset, uint64_t n)
 {
     if (n <= HASH_SIZE)
@@ -42,3 +76,27 @@ void MerkleTreeGL::merkelize()
     PoseidonGoldilocks::merkletree_avx(nodes, source, width, height);
 #endif
 }
+
+
+void MerkleTreeGL::merkelizeFromLeaves()
+{
+    // Same level layout as merkletree_avx(): every level is stored right after the previous one,
+    // and every node is the hash of its 2 children plus a zero capacity
+    uint64_t pending = height;
+    uint64_t nextN = ((pending - 1) / 2) + 1;
+    uint64_t nextIndex = 0;
+    while (pending > 1)
+    {
+#pragma omp parallel for
+        for (uint64_t i = 0; i < nextN; i++)
+        {
+            Goldilocks::Element pol_input[SPONGE_WIDTH];
+            std::memset(pol_input, 0, SPONGE_WIDTH * sizeof(Goldilocks::Element));
+            std::memcpy(pol_input, &nodes[nextIndex + i * RATE], RATE * sizeof(Goldilocks::Element));
+            PoseidonGoldilocks::hash((Goldilocks::Element(&)[CAPACITY])(nodes[nextIndex + (pending + i) * CAPACITY]), pol_input);
+        }
+        nextIndex += pending * CAPACITY;
+        pending = pending / 2;
+        nextN = ((pending - 1) / 2) + 1;
+    }
+}
@@ -41,6 +41,7 @@ public:
         nodes = (Goldilocks::Element *)calloc(getTreeNumElements(), sizeof(Goldilocks::Element));
         isNodesAllocated = true;
     };
+    MerkleTreeGL(uint64_t _height, uint64_t _width, Goldilocks::Element *_source, Goldilocks::Element *_nodes) : height(_height), width(_width), source(_source), nodes(_nodes){};
     ~MerkleTreeGL()
     {
         if (isSourceAllocated)
@@ -58,6 +59,7 @@ public:
     }
 
     void merkelize();
+    void merkelizeFromLeaves(); // Builds the upper levels of the tree from the leaves already stored in nodes
     uint64_t getTreeNumElements()
     {
         return height * HASH_SIZE + (height - 1) * HASH_SIZE;
@@ -67,6 +69,7 @@ public:
         std::memcpy(root, &nodes[getTreeNumElements() - HASH_SIZE], HASH_SIZE * sizeof(Goldilocks::Element));
     }
     void getGroupProof(Goldilocks::Element *proof, uint64_t idx);
+    void getGroupProofs(Goldilocks::Element *proofs, const uint64_t *indices, uint64_t nIndices); // One proof of getGroupProofSize() elements per index
 
     uint64_t MerkleProofSize()
     {
@@ -76,6 +79,10 @@ public:
         }
         return 0;
     }
+    uint64_t getGroupProofSize()
+    {
+        return width + MerkleProofSize() * HASH_SIZE;
+    }
 };
 
 #endif
\ No newline at end of file
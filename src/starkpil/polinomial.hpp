@@ -5,9 +5,13 @@
 #include "goldilocks_cubic_extension.hpp"
 #include "compare_fe.hpp"
 #include <math.h> /* log2 */
+#include <algorithm>
 #include "zklog.hpp"
 #include "exit_process.hpp"
 
+#define POLINOMIAL_COPY_BLOCK_ROWS 256 // Rows copied per column and block in copyBlocked()
+#define POLINOMIAL_TRANSPOSE_TILE 32   // Rows and columns of the tiles of transposeBlocked()
+
 class Polinomial
 {
 private:
@@ -125,6 +129,63 @@ public:
         }
     };
 
+    // Copies src[k] into dst[k] for every k, moving all of them one block of rows at a time, so that the
+    // rows of a strided section are loaded into cache once for all its columns instead of once per column
+    static void copyBlocked(std::vector<Polinomial> &dst, std::vector<Polinomial> &src)
+    {
+        assert(dst.size() == src.size());
+        uint64_t degree = 0;
+        for (uint64_t k = 0; k < src.size(); k++)
+        {
+            assert(dst[k].dim() == src[k].dim());
+            assert(dst[k].degree() == src[k].degree());
+            degree = std::max(degree, src[k].degree());
+        }
+        uint64_t nBlocks = (degree + POLINOMIAL_COPY_BLOCK_ROWS - 1) / POLINOMIAL_COPY_BLOCK_ROWS;
+#pragma omp parallel for
+        for (uint64_t b = 0; b < nBlocks; b++)
+        {
+            uint64_t r0 = b * POLINOMIAL_COPY_BLOCK_ROWS;
+            for (uint64_t k = 0; k < src.size(); k++)
+            {
+                uint64_t r1 = std::min(r0 + POLINOMIAL_COPY_BLOCK_ROWS, src[k].degree());
+                uint64_t dim = src[k].dim();
+                for (uint64_t r = r0; r < r1; r++)
+                {
+                    std::memcpy(dst[k][r], src[k][r], dim * sizeof(Goldilocks::Element));
+                }
+            }
+        }
+    };
+
+    // Reads src as a matrix of src.degree() / w rows and w columns and stores its transpose in dst,
+    // i.e. dst[i * h + j] = src[j * w + i], one square tile at a time so that both sides stay in cache
+    static void transposeBlocked(Polinomial &dst, Polinomial &src, uint64_t w)
+    {
+        assert(dst.dim() == src.dim());
+        assert(dst.degree() >= src.degree());
+        uint64_t h = src.degree() / w;
+        uint64_t dim = src.dim();
+        uint64_t nTilesI = (w + POLINOMIAL_TRANSPOSE_TILE - 1) / POLINOMIAL_TRANSPOSE_TILE;
+        uint64_t nTilesJ = (h + POLINOMIAL_TRANSPOSE_TILE - 1) / POLINOMIAL_TRANSPOSE_TILE;
+#pragma omp parallel for collapse(2)
+        for (uint64_t ti = 0; ti < nTilesI; ti++)
+        {
+            for (uint64_t tj = 0; tj < nTilesJ; tj++)
+            {
+                uint64_t i1 = std::min((ti + 1) * POLINOMIAL_TRANSPOSE_TILE, w);
+                uint64_t j1 = std::min((tj + 1) * POLINOMIAL_TRANSPOSE_TILE, h);
+                for (uint64_t i = ti * POLINOMIAL_TRANSPOSE_TILE; i < i1; i++)
+                {
+                    for (uint64_t j = tj * POLINOMIAL_TRANSPOSE_TILE; j < j1; j++)
+                    {
+                        std::memcpy(dst[i * h + j], src[j * w + i], dim * sizeof(Goldilocks::Element));
+                    }
+                }
+            }
+        }
+    };
+
     static void copyElement(Polinomial &a, uint64_t idx_a, Polinomial &b, uint64_t idx_b)
     {
         assert(a.dim() == b.dim());
@@ -583,6 +644,201 @@ public:
         // std::cout << "holu: " << id << " " << pos << " times: " << time2 - time1 << " " << time3 - time2 << " " << time4 - time3 << " " << h2.dim() << std::endl;
     }
 
+    // Hash of a tPol/fPol key, used by calculateH1H2_parallel() both to pick the partition and the table slot
+    static inline uint64_t h1h2Hash(const uint64_t *key, uint64_t dim)
+    {
+        uint64_t h = key[0] * 0x9E3779B97F4A7C15ULL;
+        for (uint64_t k = 1; k < dim; k++)
+        {
+            h = (h ^ (h >> 29)) + key[k] * 0xBF58476D1CE4E5B9ULL;
+        }
+        return h ^ (h >> 32);
+    }
+
+    // Same result as calculateH1H2_opt1/opt3, but a single plookup is computed by nThreads threads.
+    // The tPol and fPol rows are partitioned by key hash (per chunk histograms, prefix sum and scatter), every
+    // partition builds and probes its own open addressing table and increments the counters of its own tPol rows,
+    // and then the counters are prefix-summed and every tPol row is scattered into its h1/h2 positions.
+    // buffer must hold 4 * tPol.degree() + fPol.degree() elements
+    static void calculateH1H2_parallel(Polinomial &h1, Polinomial &h2, Polinomial &fPol, Polinomial &tPol, uint64_t pNumber, uint64_t *buffer, uint64_t nThreads)
+    {
+        assert(fPol.dim() == tPol.dim());
+        uint64_t nT = tPol.degree();
+        uint64_t nF = fPol.degree();
+        uint64_t dim = tPol.dim();
+        uint64_t nParts = nThreads * 4;
+        uint64_t nChunks = nParts;
+
+        uint64_t *counter = buffer;             // nT, number of times every tPol row appears in h1/h2
+        uint64_t *tRows = &buffer[nT];          // nT, tPol rows sorted by partition
+        uint64_t *fRows = &buffer[2 * nT];      // nF, fPol rows sorted by partition
+        uint64_t *table = &buffer[2 * nT + nF]; // 2 * nT, partition p uses the slots [2 * tPartStart[p], 2 * tPartStart[p+1])
+
+        vector<uint64_t> tHist(nChunks * nParts, 0);
+        vector<uint64_t> fHist(nChunks * nParts, 0);
+        vector<uint64_t> tPartStart(nParts + 1, 0);
+        vector<uint64_t> fPartStart(nParts + 1, 0);
+
+        // Count the rows of every chunk that fall into every partition
+#pragma omp parallel for num_threads(nThreads)
+        for (uint64_t c = 0; c < nChunks; c++)
+        {
+            uint64_t key[3];
+            for (uint64_t i = (c * nT) / nChunks; i < ((c + 1) * nT) / nChunks; i++)
+            {
+                counter[i] = 1;
+                tPol.toVectorU64(i, key);
+                tHist[c * nParts + h1h2Hash(key, dim) % nParts]++;
+            }
+            for (uint64_t i = (c * nF) / nChunks; i < ((c + 1) * nF) / nChunks; i++)
+            {
+                fPol.toVectorU64(i, key);
+                fHist[c * nParts + h1h2Hash(key, dim) % nParts]++;
+            }
+        }
+
+        // Partition-major prefix sum: the rows of a partition keep their original order
+        uint64_t tOffset = 0;
+        uint64_t fOffset = 0;
+        for (uint64_t p = 0; p < nParts; p++)
+        {
+            tPartStart[p] = tOffset;
+            fPartStart[p] = fOffset;
+            for (uint64_t c = 0; c < nChunks; c++)
+            {
+                uint64_t tCount = tHist[c * nParts + p];
+                tHist[c * nParts + p] = tOffset;
+                tOffset += tCount;
+                uint64_t fCount = fHist[c * nParts + p];
+                fHist[c * nParts + p] = fOffset;
+                fOffset += fCount;
+            }
+        }
+        tPartStart[nParts] = tOffset;
+        fPartStart[nParts] = fOffset;
+
+#pragma omp parallel for num_threads(nThreads)
+        for (uint64_t c = 0; c < nChunks; c++)
+        {
+            uint64_t key[3];
+            for (uint64_t i = (c * nT) / nChunks; i < ((c + 1) * nT) / nChunks; i++)
+            {
+                tPol.toVectorU64(i, key);
+                tRows[tHist[c * nParts + h1h2Hash(key, dim) % nParts]++] = i;
+            }
+            for (uint64_t i = (c * nF) / nChunks; i < ((c + 1) * nF) / nChunks; i++)
+            {
+                fPol.toVectorU64(i, key);
+                fRows[fHist[c * nParts + h1h2Hash(key, dim) % nParts]++] = i;
+            }
+        }
+
+        // Every partition maps its keys to their last tPol row, and counts the fPol rows that look them up
+#pragma omp parallel for num_threads(nThreads) schedule(dynamic)
+        for (uint64_t p = 0; p < nParts; p++)
+        {
+            uint64_t key[3];
+            uint64_t key_[3];
+            uint64_t *pTable = &table[2 * tPartStart[p]];
+            uint64_t tableSize = 2 * (tPartStart[p + 1] - tPartStart[p]);
+            std::memset(pTable, 0, tableSize * sizeof(uint64_t)); // slots hold row + 1, 0 means empty
+
+            for (uint64_t j = tPartStart[p]; j < tPartStart[p + 1]; j++)
+            {
+                uint64_t i = tRows[j];
+                tPol.toVectorU64(i, key);
+                uint64_t slot = (h1h2Hash(key, dim) / nParts) % tableSize;
+                while (pTable[slot] != 0)
+                {
+                    tPol.toVectorU64(pTable[slot] - 1, key_);
+                    if (std::equal(key, key + dim, key_))
+                    {
+                        break;
+                    }
+                    slot = (slot + 1 == tableSize) ? 0 : slot + 1;
+                }
+                pTable[slot] = i + 1;
+            }
+
+            for (uint64_t j = fPartStart[p]; j < fPartStart[p + 1]; j++)
+            {
+                uint64_t i = fRows[j];
+                fPol.toVectorU64(i, key);
+                bool found = false;
+                if (tableSize > 0)
+                {
+                    uint64_t slot = (h1h2Hash(key, dim) / nParts) % tableSize;
+                    while (pTable[slot] != 0)
+                    {
+                        tPol.toVectorU64(pTable[slot] - 1, key_);
+                        if (std::equal(key, key + dim, key_))
+                        {
+                            found = true;
+                            break;
+                        }
+                        slot = (slot + 1 == tableSize) ? 0 : slot + 1;
+                    }
+                    if (found)
+                    {
+                        ++counter[pTable[slot] - 1];
+                    }
+                }
+                if (!found)
+                {
+                    zklog.error("Polinomial::calculateH1H2() Number not included: w=" + to_string(i) + " plookup_number=" + to_string(pNumber) + "\nPol:" + Goldilocks::toString(fPol[i], 16));
+                    exitProcess();
+                }
+            }
+        }
+
+        // Inclusive prefix sum of the counters: counter[i] becomes the end position of tPol row i in h1/h2
+        vector<uint64_t> chunkOffset(nChunks + 1, 0);
+#pragma omp parallel for num_threads(nThreads)
+        for (uint64_t c = 0; c < nChunks; c++)
+        {
+            uint64_t sum = 0;
+            for (uint64_t i = (c * nT) / nChunks; i < ((c + 1) * nT) / nChunks; i++)
+            {
+                sum += counter[i];
+            }
+            chunkOffset[c + 1] = sum;
+        }
+        for (uint64_t c = 0; c < nChunks; c++)
+        {
+            chunkOffset[c + 1] += chunkOffset[c];
+        }
+#pragma omp parallel for num_threads(nThreads)
+        for (uint64_t c = 0; c < nChunks; c++)
+        {
+            uint64_t sum = chunkOffset[c];
+            for (uint64_t i = (c * nT) / nChunks; i < ((c + 1) * nT) / nChunks; i++)
+            {
+                sum += counter[i];
+                counter[i] = sum;
+            }
+        }
+
+        // Positions are interleaved: even ones go to h1 and odd ones to h2
+#pragma omp parallel for num_threads(nThreads)
+        for (uint64_t c = 0; c < nChunks; c++)
+        {
+            for (uint64_t i = (c * nT) / nChunks; i < ((c + 1) * nT) / nChunks; i++)
+            {
+                for (uint64_t pos = (i == 0) ? 0 : counter[i - 1]; pos < counter[i]; pos++)
+                {
+                    if ((pos & 1) == 0)
+                    {
+                        Polinomial::copyElement(h1, pos / 2, tPol, i);
+                    }
+                    else
+                    {
+                        Polinomial::copyElement(h2, pos / 2, tPol, i);
+                    }
+                }
+            }
+        }
+    }
+
     static void calculateZ(Polinomial &z, Polinomial &num, Polinomial &den)
     {
         uint64_t size = num.degree();
@@ -606,6 +862,70 @@ public:
         zkassert(Goldilocks3::isOne((Goldilocks3::Element &)*checkVal[0]));
     }
 
+    // Same result as calculateZ(), computed by nThreads threads: every thread inverts the den of its chunk of rows
+    // with a single inversion, multiplies by num and accumulates the local running product; then the chunk
+    // products are prefix-multiplied and every chunk is scaled by the product of the chunks before it
+    static void calculateZParallel(Polinomial &z, Polinomial &num, Polinomial &den, uint64_t nThreads)
+    {
+        uint64_t size = num.degree();
+        uint64_t nChunks = std::min(nThreads, size);
+
+        Polinomial acc(size, 3);
+        Polinomial chunkOffset(nChunks, 3);
+        Polinomial checkVal(1, 3);
+
+#pragma omp parallel for num_threads(nThreads)
+        for (uint64_t c = 0; c < nChunks; c++)
+        {
+            uint64_t c0 = (c * size) / nChunks;
+            uint64_t c1 = ((c + 1) * size) / nChunks;
+            Polinomial inv(2, 3);
+
+            // acc[i] = den[c0] * ... * den[i], acc is zero-initialised so a base field den only sets the first element
+            std::memcpy(acc[c0], den[c0], den.dim() * sizeof(Goldilocks::Element));
+            for (uint64_t i = c0 + 1; i < c1; i++)
+            {
+                Polinomial::mulElement(acc, i, acc, i - 1, den, i);
+            }
+
+            // Walk backwards turning every acc[i] into num[i] / den[i], then accumulate forwards
+            Goldilocks3::inv((Goldilocks3::Element *)inv[0], (Goldilocks3::Element *)acc[c1 - 1]);
+            for (uint64_t i = c1 - 1; i > c0; i--)
+            {
+                Polinomial::mulElement(acc, i, acc, i - 1, inv, 0);
+                Polinomial::mulElement(inv, 0, inv, 0, den, i);
+                Polinomial::mulElement(acc, i, acc, i, num, i);
+            }
+            Polinomial::mulElement(acc, c0, inv, 0, num, c0);
+            for (uint64_t i = c0 + 1; i < c1; i++)
+            {
+                Polinomial::mulElement(acc, i, acc, i - 1, acc, i);
+            }
+        }
+
+        // chunkOffset[c] = product of every chunk before c
+        Goldilocks3::copy((Goldilocks3::Element *)chunkOffset[0], &Goldilocks3::one());
+        for (uint64_t c = 1; c < nChunks; c++)
+        {
+            Polinomial::mulElement(chunkOffset, c, chunkOffset, c - 1, acc, (c * size) / nChunks - 1);
+        }
+        Polinomial::mulElement(checkVal, 0, chunkOffset, nChunks - 1, acc, size - 1);
+
+        Goldilocks3::copy((Goldilocks3::Element *)z[0], &Goldilocks3::one());
+#pragma omp parallel for num_threads(nThreads)
+        for (uint64_t c = 0; c < nChunks; c++)
+        {
+            uint64_t c0 = (c * size) / nChunks;
+            uint64_t c1 = std::min(((c + 1) * size) / nChunks, size - 1);
+            for (uint64_t i = c0; i < c1; i++)
+            {
+                Polinomial::mulElement(z, i + 1, acc, i, chunkOffset, c);
+            }
+        }
+
+        zkassert(Goldilocks3::isOne((Goldilocks3::Element &)*checkVal[0]));
+    }
+
     // compute the multiplications of the polynomials in src in parallel with partitions of size partitionSize
     // Every thread computes a partition of size partitionSize / (2 * nThreadsPartition)
     // after every computation the size of the partition is doubled until it reaches partitionSize
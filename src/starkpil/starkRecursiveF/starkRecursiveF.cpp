@@ -45,7 +45,7 @@ StarkRecursiveF::StarkRecursiveF(const Config &config, void *_pAddress) : config
     }
     else
     {
-        pConstPolsAddress = copyFile(config.recursivefConstPols, constPolsSize);
+        pConstPolsAddress = copyFileToLargeBuffer(config, config.recursivefConstPols, constPolsSize);
         zklog.info("StarkRecursiveF::StarkRecursiveF() successfully copied " + to_string(constPolsSize) + " bytes from constant file " + config.recursivefConstPols);
     }
     pConstPols = new ConstantPolsStarks(pConstPolsAddress, constPolsDegree, starkInfo.nConstants);
@@ -68,14 +68,14 @@ StarkRecursiveF::StarkRecursiveF(const Config &config, void *_pAddress) : config
     }
     else
     {
-        pConstTreeAddress = copyFile(config.recursivefConstantsTree, getTreeSize((1 << starkInfo.starkStruct.nBitsExt), starkInfo.nConstants));
+        pConstTreeAddress = copyFileToLargeBuffer(config, config.recursivefConstantsTree, getTreeSize((1 << starkInfo.starkStruct.nBitsExt), starkInfo.nConstants));
         zklog.info("StarkRecursiveF::StarkRecursiveF() successfully copied " + to_string(getTreeSize((1 << starkInfo.starkStruct.nBitsExt), starkInfo.nConstants)) + " bytes from constant file " + config.recursivefConstantsTree);
     }
     TimerStopAndLog(LOAD_RECURSIVE_F_CONST_TREE_TO_MEMORY);
 
     // Initialize and allocate ConstantPols2ns
     TimerStart(LOAD_RECURSIVE_F_CONST_POLS_2NS_TO_MEMORY);
-    pConstPolsAddress2ns = (void *)calloc(starkInfo.nConstants * (1 << starkInfo.starkStruct.nBitsExt), sizeof(Goldilocks::Element));
+    pConstPolsAddress2ns = allocLargeBuffer(config, starkInfo.nConstants * (1 << starkInfo.starkStruct.nBitsExt) * sizeof(Goldilocks::Element));
     pConstPols2ns = new ConstantPolsStarks(pConstPolsAddress2ns, (1 << starkInfo.starkStruct.nBitsExt), starkInfo.nConstants);
     std::memcpy(pConstPolsAddress2ns, (uint8_t *)pConstTreeAddress + 2 * sizeof(Goldilocks::Element), starkInfo.nConstants * (1 << starkInfo.starkStruct.nBitsExt) * sizeof(Goldilocks::Element));
 
@@ -118,7 +118,7 @@ StarkRecursiveF::~StarkRecursiveF()
 
     delete pConstPols;
     delete pConstPols2ns;
-    free(pConstPolsAddress2ns);
+    freeLargeBuffer(pConstPolsAddress2ns, starkInfo.nConstants * (1 << starkInfo.starkStruct.nBitsExt) * sizeof(Goldilocks::Element));
 
     if (config.mapConstPolsFile)
     {
@@ -126,7 +126,7 @@ StarkRecursiveF::~StarkRecursiveF()
     }
     else
     {
-        free(pConstPolsAddress);
+        freeLargeBuffer(pConstPolsAddress, constPolsSize);
     }
 
     if (config.mapConstantsTreeFile)
@@ -135,7 +135,7 @@ StarkRecursiveF::~StarkRecursiveF()
     }
     else
     {
-        free(pConstTreeAddress);
+        freeLargeBuffer(pConstTreeAddress, getTreeSize((1 << starkInfo.starkStruct.nBitsExt), starkInfo.nConstants));
     }
 
     free(pBuffer);
@@ -0,0 +1,46 @@
+#include <sys/mman.h>
+#include "stark_arena.hpp"
+#include "zklog.hpp"
+#include "exit_process.hpp"
+
+StarkArena::~StarkArena()
+{
+    if (pAddress != NULL)
+    {
+        munmap(pAddress, size * sizeof(Goldilocks::Element));
+    }
+}
+
+void StarkArena::reserve(uint64_t nElements)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (nElements > reservedSize)
+    {
+        reservedSize = nElements;
+    }
+}
+
+Goldilocks::Element *StarkArena::get(void)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (reservedSize > size)
+    {
+        if (pAddress != NULL)
+        {
+            munmap(pAddress, size * sizeof(Goldilocks::Element));
+        }
+        uint64_t bytes = reservedSize * sizeof(Goldilocks::Element);
+        void *pMap = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pMap == MAP_FAILED)
+        {
+            zklog.error("StarkArena::get() failed calling mmap() of size=" + to_string(bytes));
+            exitProcess();
+        }
+        // Best effort: transparent huge pages cut the number of page faults and TLB misses of the arena
+        madvise(pMap, bytes, MADV_HUGEPAGE);
+        pAddress = (Goldilocks::Element *)pMap;
+        size = reservedSize;
+        zklog.info("StarkArena::get() successfully allocated " + to_string(bytes) + " bytes");
+    }
+    return pAddress;
+}
@@ -0,0 +1,31 @@
+#ifndef STARK_ARENA_HPP
+#define STARK_ARENA_HPP
+
+#include <mutex>
+#include "goldilocks_base_field.hpp"
+
+// Working memory of the proof temporaries (evals, xDivXSubXi, xDivXSubWXi, LEv and LpEv) shared by Starks
+// instances that never prove at the same time, e.g. zkevm, C12a, recursive1 and recursive2, which the prover
+// thread runs one after another.  Every instance reserves the size it needs when it is created; the arena is
+// allocated once, with the largest reservation, the first time it is used, and it is kept between proofs so
+// that consecutive proofs do not fault its pages in again
+class StarkArena
+{
+private:
+    std::mutex mutex;
+    Goldilocks::Element *pAddress;
+    uint64_t size;         // Allocated number of elements
+    uint64_t reservedSize; // Largest reserved number of elements
+
+public:
+    StarkArena() : pAddress(NULL), size(0), reservedSize(0){};
+    ~StarkArena();
+
+    // Makes sure the arena will have room for nElements
+    void reserve(uint64_t nElements);
+
+    // Returns the arena address, allocating it if needed; only valid until the next reserve() call
+    Goldilocks::Element *get(void);
+};
+
+#endif
@@ -0,0 +1,171 @@
+#include <unistd.h>
+#include <cstdio>
+#include <omp.h>
+#include "stark_domain.hpp"
+#include "goldilocks_cubic_extension.hpp"
+#include "zkassert.hpp"
+#include "utils.hpp"
+#include "timer.hpp"
+#include "zklog.hpp"
+#include "exit_process.hpp"
+
+std::mutex StarkDomain::domainsMutex;
+std::map<std::pair<uint64_t, uint64_t>, std::weak_ptr<StarkDomain>> StarkDomain::domains;
+
+// Returns base^exponent
+static Goldilocks::Element domainPow(Goldilocks::Element base, uint64_t exponent)
+{
+    Goldilocks::Element result = Goldilocks::one();
+    while (exponent != 0)
+    {
+        if (exponent & 1)
+        {
+            Goldilocks::mul(result, result, base);
+        }
+        Goldilocks::square(base, base);
+        exponent >>= 1;
+    }
+    return result;
+}
+
+StarkDomain::StarkDomain(const Config &config, uint64_t nBits, uint64_t nBitsExt) : nBits(nBits),
+                                                                                    nBitsExt(nBitsExt),
+                                                                                    N(1 << nBits),
+                                                                                    NExtended(1 << nBitsExt),
+                                                                                    zhInvSize(1 << (nBitsExt - nBits)),
+                                                                                    pAddress(NULL),
+                                                                                    bMapped(false)
+{
+    zkassert(nBits < nBitsExt);
+    size = (STARK_DOMAIN_HEADER_SIZE + N + NExtended + NExtended * FIELD_EXTENSION + zhInvSize) * sizeof(Goldilocks::Element);
+
+    // Without a cache directory, the tables only live in memory
+    if (config.starkDomainCacheDir.size() == 0)
+    {
+        pAddress = (Goldilocks::Element *)malloc(size);
+        if (pAddress == NULL)
+        {
+            zklog.error("StarkDomain::StarkDomain() failed calling malloc() of size=" + to_string(size));
+            exitProcess();
+        }
+        setPointers();
+        compute();
+        return;
+    }
+
+    string fileName = config.starkDomainCacheDir + "/stark_domain_" + to_string(nBits) + "_" + to_string(nBitsExt) + ".bin";
+    if (fileExists(fileName))
+    {
+        TimerStart(STARK_DOMAIN_MAP);
+        pAddress = (Goldilocks::Element *)mapFile(fileName, size, false);
+        bMapped = true;
+        uint64_t *pHeader = (uint64_t *)pAddress;
+        if ((pHeader[0] != STARK_DOMAIN_MAGIC) || (pHeader[1] != nBits) || (pHeader[2] != nBitsExt) || (pHeader[3] != zhInvSize))
+        {
+            zklog.error("StarkDomain::StarkDomain() found an invalid header in file " + fileName);
+            exitProcess();
+        }
+        setPointers();
+        TimerStopAndLog(STARK_DOMAIN_MAP);
+        zklog.info("StarkDomain::StarkDomain() successfully mapped " + to_string(size) + " bytes from domain file " + fileName);
+        return;
+    }
+
+    // Generate the file under a temporary name and rename it when complete, so that a concurrent process
+    // never maps a partially written file
+    ensureDirectoryExists(config.starkDomainCacheDir);
+    string tmpFileName = fileName + "." + to_string(getpid()) + ".tmp";
+    pAddress = (Goldilocks::Element *)mapFile(tmpFileName, size, true);
+    bMapped = true;
+    setPointers();
+    compute();
+    if (rename(tmpFileName.c_str(), fileName.c_str()) != 0)
+    {
+        zklog.error("StarkDomain::StarkDomain() failed calling rename() from " + tmpFileName + " to " + fileName);
+        exitProcess();
+    }
+    zklog.info("StarkDomain::StarkDomain() successfully generated " + to_string(size) + " bytes into domain file " + fileName);
+}
+
+StarkDomain::~StarkDomain()
+{
+    if (bMapped)
+    {
+        unmapFile(pAddress, size);
+    }
+    else
+    {
+        free(pAddress);
+    }
+}
+
+void StarkDomain::setPointers(void)
+{
+    x_n = pAddress + STARK_DOMAIN_HEADER_SIZE;
+    x_2ns = x_n + N;
+    x = x_2ns + NExtended;
+    zhInv = x + NExtended * FIELD_EXTENSION;
+}
+
+void StarkDomain::compute(void)
+{
+    TimerStart(STARK_DOMAIN_COMPUTE);
+
+    uint64_t *pHeader = (uint64_t *)pAddress;
+    pHeader[0] = STARK_DOMAIN_MAGIC;
+    pHeader[1] = nBits;
+    pHeader[2] = nBitsExt;
+    pHeader[3] = zhInvSize;
+
+    // Every chunk starts from its own power, so the running products can be computed in parallel
+    uint64_t nChunks = omp_get_max_threads();
+    Goldilocks::Element wN = Goldilocks::w(nBits);
+    Goldilocks::Element wExt = Goldilocks::w(nBitsExt);
+#pragma omp parallel for
+    for (uint64_t c = 0; c < nChunks; c++)
+    {
+        uint64_t r0 = (c * N) / nChunks;
+        uint64_t r1 = ((c + 1) * N) / nChunks;
+        Goldilocks::Element xx = domainPow(wN, r0);
+        for (uint64_t i = r0; i < r1; i++)
+        {
+            x_n[i] = xx;
+            Goldilocks::mul(xx, xx, wN);
+        }
+
+        r0 = (c * NExtended) / nChunks;
+        r1 = ((c + 1) * NExtended) / nChunks;
+        xx = Goldilocks::shift() * domainPow(wExt, r0);
+        for (uint64_t i = r0; i < r1; i++)
+        {
+            x_2ns[i] = xx;
+            x[i * FIELD_EXTENSION] = xx;
+            x[i * FIELD_EXTENSION + 1] = Goldilocks::zero();
+            x[i * FIELD_EXTENSION + 2] = Goldilocks::zero();
+            Goldilocks::mul(xx, xx, wExt);
+        }
+    }
+
+    // Same values as ZhInv(nBits, nBitsExt)
+    Goldilocks::Element w = Goldilocks::one();
+    Goldilocks::Element sn = domainPow(Goldilocks::shift(), N);
+    for (uint64_t i = 0; i < zhInvSize; i++)
+    {
+        Goldilocks::inv(zhInv[i], (sn * w) - Goldilocks::one());
+        Goldilocks::mul(w, w, Goldilocks::w(nBitsExt - nBits));
+    }
+
+    TimerStopAndLog(STARK_DOMAIN_COMPUTE);
+}
+
+std::shared_ptr<StarkDomain> StarkDomain::get(const Config &config, uint64_t nBits, uint64_t nBitsExt)
+{
+    std::lock_guard<std::mutex> lock(domainsMutex);
+    std::shared_ptr<StarkDomain> domain = domains[std::make_pair(nBits, nBitsExt)].lock();
+    if (domain == NULL)
+    {
+        domain = std::make_shared<StarkDomain>(config, nBits, nBitsExt);
+        domains[std::make_pair(nBits, nBitsExt)] = domain;
+    }
+    return domain;
+}
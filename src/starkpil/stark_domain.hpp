@@ -0,0 +1,52 @@
+#ifndef STARK_DOMAIN_HPP
+#define STARK_DOMAIN_HPP
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include "config.hpp"
+#include "goldilocks_base_field.hpp"
+
+#define STARK_DOMAIN_MAGIC 0x4e49414d4f44534bULL // "KSDOMAIN"
+#define STARK_DOMAIN_HEADER_SIZE 4               // magic, nBits, nBitsExt, zhInvSize
+
+// Evaluation domain tables of a (nBits, nBitsExt) pair, read-only once built:
+//   x_n:   w(nBits)^i, N elements
+//   x_2ns: shift*w(nBitsExt)^i, NExtended elements
+//   x:     x_2ns as a cubic extension polynomial, NExtended*3 elements
+//   zhInv: 1/Zh over the extended domain, 2^(nBitsExt-nBits) elements
+// Every Starks instance with the same domain shares the same tables.  If config.starkDomainCacheDir is set,
+// the tables are memory mapped from a file of that directory, which is generated the first time it is needed
+class StarkDomain
+{
+public:
+    uint64_t nBits;
+    uint64_t nBitsExt;
+    uint64_t N;
+    uint64_t NExtended;
+    uint64_t zhInvSize;
+    Goldilocks::Element *x_n;
+    Goldilocks::Element *x_2ns;
+    Goldilocks::Element *x;
+    Goldilocks::Element *zhInv;
+
+private:
+    Goldilocks::Element *pAddress;
+    uint64_t size; // In bytes
+    bool bMapped;
+
+    static std::mutex domainsMutex;
+    static std::map<std::pair<uint64_t, uint64_t>, std::weak_ptr<StarkDomain>> domains;
+
+    void setPointers(void);
+    void compute(void);
+
+public:
+    StarkDomain(const Config &config, uint64_t nBits, uint64_t nBitsExt);
+    ~StarkDomain();
+
+    // Returns the domain tables of (nBits, nBitsExt), building them only if no other instance holds them
+    static std::shared_ptr<StarkDomain> get(const Config &config, uint64_t nBits, uint64_t nBitsExt);
+};
+
+#endif
@@ -3,6 +3,9 @@
 #include "sm/pols_generated/commit_pols.hpp"
 #include "zklog.hpp"
 #include "exit_process.hpp"
+#include "zkmax.hpp"
+#include <thread>
+#include <omp.h>
 
 USING_PROVER_FORK_NAMESPACE;
 
@@ -13,9 +16,20 @@ void Starks::genProof(FRIProof &proof, Goldilocks::Element *publicInputs, Steps
 
     uint64_t numCommited = starkInfo.nCm1;
     Transcript transcript;
-    Polinomial evals(N, FIELD_EXTENSION);
-    Polinomial xDivXSubXi(NExtended, FIELD_EXTENSION);
-    Polinomial xDivXSubWXi(NExtended, FIELD_EXTENSION);
+
+    // The big temporaries live in the arena, which is kept between proofs; every one of them is fully
+    // written before being read, except evals, which is small
+    Goldilocks::Element *pArenaAddress = pArena->get();
+    Goldilocks::Element *pEvals = pArenaAddress;
+    Goldilocks::Element *pXDivXSubXi = pEvals + starkInfo.evMap.size() * FIELD_EXTENSION;
+    Goldilocks::Element *pXDivXSubWXi = pXDivXSubXi + NExtended * FIELD_EXTENSION;
+    Goldilocks::Element *pLEv = pXDivXSubWXi + NExtended * FIELD_EXTENSION;
+    Goldilocks::Element *pLpEv = pLEv + N * FIELD_EXTENSION;
+    std::memset(pEvals, 0, starkInfo.evMap.size() * FIELD_EXTENSION * sizeof(Goldilocks::Element));
+
+    Polinomial evals(pEvals, starkInfo.evMap.size(), FIELD_EXTENSION, FIELD_EXTENSION);
+    Polinomial xDivXSubXi(pXDivXSubXi, NExtended, FIELD_EXTENSION, FIELD_EXTENSION);
+    Polinomial xDivXSubWXi(pXDivXSubWXi, NExtended, FIELD_EXTENSION, FIELD_EXTENSION);
     Polinomial challenges(NUM_CHALLENGES, FIELD_EXTENSION);
 
     CommitPols cmPols(pAddress, starkInfo.mapDeg.section[eSection::cm1_n]);
@@ -47,14 +61,23 @@ void Starks::genProof(FRIProof &proof, Goldilocks::Element *publicInputs, Steps
     //--------------------------------
     TimerStart(STARK_STEP_1);
     TimerStart(STARK_STEP_1_LDE_AND_MERKLETREE);
-    TimerStart(STARK_STEP_1_LDE);
-
-    ntt.extendPol(p_cm1_2ns, p_cm1_n, NExtended, N, starkInfo.mapSectionsN.section[eSection::cm1_n], p_cm2_2ns);
-    TimerStopAndLog(STARK_STEP_1_LDE);
-    TimerStart(STARK_STEP_1_MERKLETREE);
-    treesGL[0]->merkelize();
-    treesGL[0]->getRoot(root0.address());
-    TimerStopAndLog(STARK_STEP_1_MERKLETREE);
+    if (config.starkPipelineLdeMerkle)
+    {
+        TimerStart(STARK_STEP_1_LDE_AND_MERKLETREE_PIPELINE);
+        extendAndMerkelize(p_cm1_2ns, p_cm1_n, starkInfo.mapSectionsN.section[eSection::cm1_n], p_cm2_2ns, treesGL[0]);
+        treesGL[0]->getRoot(root0.address());
+        TimerStopAndLog(STARK_STEP_1_LDE_AND_MERKLETREE_PIPELINE);
+    }
+    else
+    {
+        TimerStart(STARK_STEP_1_LDE);
+        ntt.extendPol(p_cm1_2ns, p_cm1_n, NExtended, N, starkInfo.mapSectionsN.section[eSection::cm1_n], p_cm2_2ns);
+        TimerStopAndLog(STARK_STEP_1_LDE);
+        TimerStart(STARK_STEP_1_MERKLETREE);
+        treesGL[0]->merkelize();
+        treesGL[0]->getRoot(root0.address());
+        TimerStopAndLog(STARK_STEP_1_MERKLETREE);
+    }
     zklog.info("MerkleTree rootGL 0: [ " + root0.toString(4) + " ]");
     transcript.put(root0.address(), HASH_SIZE);
     TimerStopAndLog(STARK_STEP_1_LDE_AND_MERKLETREE);
@@ -69,7 +92,10 @@ void Starks::genProof(FRIProof &proof, Goldilocks::Element *publicInputs, Steps
     if (nrowsStepBatch == 4)
     {
         TimerStart(STARK_STEP_2_CALCULATE_EXPS_AVX);
-        steps->step2prev_parser_first_avx(params, N, nrowsStepBatch);
+        if (!calculateExpsGenerated("STEP_2", steps, &Steps::step2prev_generated_first_avx, &Steps::step2prev_parser_first_avx, params, N, {eSection::cm2_n, eSection::cm3_n, eSection::tmpExp_n}))
+        {
+            steps->step2prev_parser_first_avx(params, N, nrowsStepBatch);
+        }
         TimerStopAndLog(STARK_STEP_2_CALCULATE_EXPS_AVX);
     }
     else if (nrowsStepBatch == 8)
@@ -104,22 +130,36 @@ void Starks::genProof(FRIProof &proof, Goldilocks::Element *publicInputs, Steps
     uint64_t *pbufferH = &mam[starkInfo.mapOffsets.section[eSection::cm3_2ns]];
     uint64_t buffSizeThread = buffSize / nthreads;
 
-#pragma omp parallel for num_threads(nthreads)
-    for (uint64_t i = 0; i < starkInfo.puCtx.size(); i++)
+    uint64_t nThreadsH1H2 = omp_get_max_threads();
+    if (starkInfo.puCtx.size() < nThreadsH1H2)
     {
-        int indx1 = 4 * i;
-        if (transPols[indx1 + 2].dim() == 1)
+        // There are not enough plookups to keep every thread busy, so they are computed one after another,
+        // every one of them by all the threads; the whole buffer (5*N needed) is available for each one
+        for (uint64_t i = 0; i < starkInfo.puCtx.size(); i++)
         {
-            uint64_t buffSizeThreadValues = 3 * N;
-            uint64_t buffSizeThreadKeys = buffSizeThread - buffSizeThreadValues;
-            Polinomial::calculateH1H2_opt1(transPols[indx1 + 2], transPols[indx1 + 3], transPols[indx1], transPols[indx1 + 1], i, &pbufferH[omp_get_thread_num() * buffSizeThread], buffSizeThreadKeys, buffSizeThreadValues);
+            int indx1 = 4 * i;
+            Polinomial::calculateH1H2_parallel(transPols[indx1 + 2], transPols[indx1 + 3], transPols[indx1], transPols[indx1 + 1], i, pbufferH, nThreadsH1H2);
         }
-        else
+    }
+    else
+    {
+#pragma omp parallel for num_threads(nthreads)
+        for (uint64_t i = 0; i < starkInfo.puCtx.size(); i++)
         {
-            assert(transPols[indx1 + 2].dim() == 3);
-            uint64_t buffSizeThreadValues = 5 * N;
-            uint64_t buffSizeThreadKeys = buffSizeThread - buffSizeThreadValues;
-            Polinomial::calculateH1H2_opt3(transPols[indx1 + 2], transPols[indx1 + 3], transPols[indx1], transPols[indx1 + 1], i, &pbufferH[omp_get_thread_num() * buffSizeThread], buffSizeThreadKeys, buffSizeThreadValues);
+            int indx1 = 4 * i;
+            if (transPols[indx1 + 2].dim() == 1)
+            {
+                uint64_t buffSizeThreadValues = 3 * N;
+                uint64_t buffSizeThreadKeys = buffSizeThread - buffSizeThreadValues;
+                Polinomial::calculateH1H2_opt1(transPols[indx1 + 2], transPols[indx1 + 3], transPols[indx1], transPols[indx1 + 1], i, &pbufferH[omp_get_thread_num() * buffSizeThread], buffSizeThreadKeys, buffSizeThreadValues);
+            }
+            else
+            {
+                assert(transPols[indx1 + 2].dim() == 3);
+                uint64_t buffSizeThreadValues = 5 * N;
+                uint64_t buffSizeThreadKeys = buffSizeThread - buffSizeThreadValues;
+                Polinomial::calculateH1H2_opt3(transPols[indx1 + 2], transPols[indx1 + 3], transPols[indx1], transPols[indx1 + 1], i, &pbufferH[omp_get_thread_num() * buffSizeThread], buffSizeThreadKeys, buffSizeThreadValues);
+            }
         }
     }
     TimerStopAndLog(STARK_STEP_2_CALCULATEH1H2);
@@ -129,13 +169,23 @@ void Starks::genProof(FRIProof &proof, Goldilocks::Element *publicInputs, Steps
     TimerStopAndLog(STARK_STEP_2_CALCULATEH1H2_TRANSPOSE_2);
 
     TimerStart(STARK_STEP_2_LDE_AND_MERKLETREE);
-    TimerStart(STARK_STEP_2_LDE);
-    ntt.extendPol(p_cm2_2ns, p_cm2_n, NExtended, N, starkInfo.mapSectionsN.section[eSection::cm2_n], pBuffer);
-    TimerStopAndLog(STARK_STEP_2_LDE);
-    TimerStart(STARK_STEP_2_MERKLETREE);
-    treesGL[1]->merkelize();
-    treesGL[1]->getRoot(root1.address());
-    TimerStopAndLog(STARK_STEP_2_MERKLETREE);
+    if (config.starkPipelineLdeMerkle)
+    {
+        TimerStart(STARK_STEP_2_LDE_AND_MERKLETREE_PIPELINE);
+        extendAndMerkelize(p_cm2_2ns, p_cm2_n, starkInfo.mapSectionsN.section[eSection::cm2_n], pBuffer, treesGL[1]);
+        treesGL[1]->getRoot(root1.address());
+        TimerStopAndLog(STARK_STEP_2_LDE_AND_MERKLETREE_PIPELINE);
+    }
+    else
+    {
+        TimerStart(STARK_STEP_2_LDE);
+        ntt.extendPol(p_cm2_2ns, p_cm2_n, NExtended, N, starkInfo.mapSectionsN.section[eSection::cm2_n], pBuffer);
+        TimerStopAndLog(STARK_STEP_2_LDE);
+        TimerStart(STARK_STEP_2_MERKLETREE);
+        treesGL[1]->merkelize();
+        treesGL[1]->getRoot(root1.address());
+        TimerStopAndLog(STARK_STEP_2_MERKLETREE);
+    }
     zklog.info("MerkleTree rootGL 1: [ " + root1.toString(4) + " ]");
     transcript.put(root1.address(), HASH_SIZE);
 
@@ -151,7 +201,10 @@ void Starks::genProof(FRIProof &proof, Goldilocks::Element *publicInputs, Steps
     if (nrowsStepBatch == 4)
     {
         TimerStart(STARK_STEP_3_CALCULATE_EXPS_AVX);
-        steps->step3prev_parser_first_avx(params, N, nrowsStepBatch);
+        if (!calculateExpsGenerated("STEP_3", steps, &Steps::step3prev_generated_first_avx, &Steps::step3prev_parser_first_avx, params, N, {eSection::cm2_n, eSection::cm3_n, eSection::tmpExp_n}))
+        {
+            steps->step3prev_parser_first_avx(params, N, nrowsStepBatch);
+        }
         TimerStopAndLog(STARK_STEP_3_CALCULATE_EXPS_AVX);
     }
     else if (nrowsStepBatch == 8)
@@ -176,11 +229,30 @@ void Starks::genProof(FRIProof &proof, Goldilocks::Element *publicInputs, Steps
 
     TimerStart(STARK_STEP_3_CALCULATE_Z);
     u_int64_t numpols = starkInfo.ciCtx.size() + starkInfo.peCtx.size() + starkInfo.puCtx.size();
-#pragma omp parallel for
-    for (uint64_t i = 0; i < numpols; i++)
+    uint64_t nThreadsZ = omp_get_max_threads();
+    if (numpols > 0 && numpols < nThreadsZ)
+    {
+        // Not enough Z polynomials to keep every thread busy: split the threads among them and compute
+        // every grand product in parallel chunks
+        uint64_t nThreadsPol = nThreadsZ / numpols;
+        int maxActiveLevels = omp_get_max_active_levels();
+        omp_set_max_active_levels(2);
+#pragma omp parallel for num_threads(numpols)
+        for (uint64_t i = 0; i < numpols; i++)
+        {
+            int indx1 = 3 * i;
+            Polinomial::calculateZParallel(newpols_[indx1 + 2], newpols_[indx1], newpols_[indx1 + 1], nThreadsPol);
+        }
+        omp_set_max_active_levels(maxActiveLevels);
+    }
+    else
     {
-        int indx1 = 3 * i;
-        Polinomial::calculateZ(newpols_[indx1 + 2], newpols_[indx1], newpols_[indx1 + 1]);
+#pragma omp parallel for
+        for (uint64_t i = 0; i < numpols; i++)
+        {
+            int indx1 = 3 * i;
+            Polinomial::calculateZ(newpols_[indx1 + 2], newpols_[indx1], newpols_[indx1 + 1]);
+        }
     }
     TimerStopAndLog(STARK_STEP_3_CALCULATE_Z);
     TimerStart(STARK_STEP_3_CALCULATE_Z_TRANSPOSE_2);
@@ -189,7 +261,10 @@ void Starks::genProof(FRIProof &proof, Goldilocks::Element *publicInputs, Steps
     if (nrowsStepBatch == 4)
     {
         TimerStart(STARK_STEP_3_CALCULATE_EXPS_2_AVX);
-        steps->step3_parser_first_avx(params, N, nrowsStepBatch);
+        if (!calculateExpsGenerated("STEP_3_2", steps, &Steps::step3_generated_first_avx, &Steps::step3_parser_first_avx, params, N, {eSection::cm2_n, eSection::cm3_n, eSection::tmpExp_n}))
+        {
+            steps->step3_parser_first_avx(params, N, nrowsStepBatch);
+        }
         TimerStopAndLog(STARK_STEP_3_CALCULATE_EXPS_2_AVX);
     }
     else if (nrowsStepBatch == 8)
@@ -210,13 +285,23 @@ void Starks::genProof(FRIProof &proof, Goldilocks::Element *publicInputs, Steps
     }
 
     TimerStart(STARK_STEP_3_LDE_AND_MERKLETREE);
-    TimerStart(STARK_STEP_3_LDE);
-    ntt.extendPol(p_cm3_2ns, p_cm3_n, NExtended, N, starkInfo.mapSectionsN.section[eSection::cm3_n], pBuffer);
-    TimerStopAndLog(STARK_STEP_3_LDE);
-    TimerStart(STARK_STEP_3_MERKLETREE);
-    treesGL[2]->merkelize();
-    treesGL[2]->getRoot(root2.address());
-    TimerStopAndLog(STARK_STEP_3_MERKLETREE);
+    if (config.starkPipelineLdeMerkle)
+    {
+        TimerStart(STARK_STEP_3_LDE_AND_MERKLETREE_PIPELINE);
+        extendAndMerkelize(p_cm3_2ns, p_cm3_n, starkInfo.mapSectionsN.section[eSection::cm3_n], pBuffer, treesGL[2]);
+        treesGL[2]->getRoot(root2.address());
+        TimerStopAndLog(STARK_STEP_3_LDE_AND_MERKLETREE_PIPELINE);
+    }
+    else
+    {
+        TimerStart(STARK_STEP_3_LDE);
+        ntt.extendPol(p_cm3_2ns, p_cm3_n, NExtended, N, starkInfo.mapSectionsN.section[eSection::cm3_n], pBuffer);
+        TimerStopAndLog(STARK_STEP_3_LDE);
+        TimerStart(STARK_STEP_3_MERKLETREE);
+        treesGL[2]->merkelize();
+        treesGL[2]->getRoot(root2.address());
+        TimerStopAndLog(STARK_STEP_3_MERKLETREE);
+    }
     zklog.info("MerkleTree rootGL 2: [ " + root2.toString(4) + " ]");
     transcript.put(root2.address(), HASH_SIZE);
     TimerStopAndLog(STARK_STEP_3_LDE_AND_MERKLETREE);
@@ -237,7 +322,10 @@ void Starks::genProof(FRIProof &proof, Goldilocks::Element *publicInputs, Steps
     if (nrowsStepBatch == 4)
     {
         TimerStart(STARK_STEP_4_CALCULATE_EXPS_2NS_AVX);
-        steps->step42ns_parser_first_avx(params, NExtended, nrowsStepBatch);
+        if (!calculateExpsGenerated("STEP_4", steps, &Steps::step42ns_generated_first_avx, &Steps::step42ns_parser_first_avx, params, NExtended, {eSection::q_2ns}))
+        {
+            steps->step42ns_parser_first_avx(params, NExtended, nrowsStepBatch);
+        }
         TimerStopAndLog(STARK_STEP_4_CALCULATE_EXPS_2NS_AVX);
     }
     else if (nrowsStepBatch == 8)
@@ -304,8 +392,8 @@ void Starks::genProof(FRIProof &proof, Goldilocks::Element *publicInputs, Steps
     // transcript.getField(challenges[6]); // v2
     transcript.getField(challenges[7]); // xi
 
-    Polinomial LEv(N, 3, "LEv");
-    Polinomial LpEv(N, 3, "LpEv");
+    Polinomial LEv(pLEv, N, 3, 3, "LEv");
+    Polinomial LpEv(pLpEv, N, 3, 3, "LpEv");
     Polinomial xis(1, 3);
     Polinomial wxis(1, 3);
     Polinomial c_w(1, 3);
@@ -328,7 +416,7 @@ void Starks::genProof(FRIProof &proof, Goldilocks::Element *publicInputs, Steps
     TimerStopAndLog(STARK_STEP_5_LEv_LpEv);
 
     TimerStart(STARK_STEP_5_EVMAP);
-    evmap(pAddress, evals, LEv, LpEv);
+    evmap(evals, LEv, LpEv);
     TimerStopAndLog(STARK_STEP_5_EVMAP);
     TimerStart(STARK_STEP_5_XDIVXSUB);
 
@@ -367,7 +455,10 @@ void Starks::genProof(FRIProof &proof, Goldilocks::Element *publicInputs, Steps
     if (nrowsStepBatch == 4)
     {
         TimerStart(STARK_STEP_5_CALCULATE_EXPS_AVX);
-        steps->step52ns_parser_first_avx(params, NExtended, nrowsStepBatch);
+        if (!calculateExpsGenerated("STEP_5", steps, &Steps::step52ns_generated_first_avx, &Steps::step52ns_parser_first_avx, params, NExtended, {eSection::f_2ns}))
+        {
+            steps->step52ns_parser_first_avx(params, NExtended, nrowsStepBatch);
+        }
         TimerStopAndLog(STARK_STEP_5_CALCULATE_EXPS_AVX);
     }
     else if (nrowsStepBatch == 8)
@@ -412,6 +503,10 @@ Polinomial *Starks::transposeH1H2Columns(void *pAddress, uint64_t &numCommited,
 
     assert(starkInfo.mapSectionsN.section[eSection::cm1_n] * NExtended * FIELD_EXTENSION >= 3 * tot_pols0 * N);
 
+    // The f and t columns are gathered here and copied together by row blocks
+    std::vector<Polinomial> dstPols;
+    std::vector<Polinomial> srcPols;
+
     // #pragma omp parallel for
     for (uint64_t i = 0; i < starkInfo.puCtx.size(); i++)
     {
@@ -422,10 +517,12 @@ Polinomial *Starks::transposeH1H2Columns(void *pAddress, uint64_t &numCommited,
 
         uint64_t indx = i * 4;
         transPols[indx].potConstruct(&(pBuffer[indx * stride_pol0]), fPol.degree(), fPol.dim(), fPol.dim());
-        Polinomial::copy(transPols[indx], fPol);
+        dstPols.push_back(transPols[indx]);
+        srcPols.push_back(fPol);
         indx++;
         transPols[indx].potConstruct(&(pBuffer[indx * stride_pol0]), tPol.degree(), tPol.dim(), tPol.dim());
-        Polinomial::copy(transPols[indx], tPol);
+        dstPols.push_back(transPols[indx]);
+        srcPols.push_back(tPol);
         indx++;
 
         transPols[indx].potConstruct(&(pBuffer[indx * stride_pol0]), h1.degree(), h1.dim(), h1.dim());
@@ -433,21 +530,25 @@ Polinomial *Starks::transposeH1H2Columns(void *pAddress, uint64_t &numCommited,
 
         transPols[indx].potConstruct(&(pBuffer[indx * stride_pol0]), h2.degree(), h2.dim(), h2.dim());
     }
+    Polinomial::copyBlocked(dstPols, srcPols);
     return transPols;
 }
 void Starks::transposeH1H2Rows(void *pAddress, uint64_t &numCommited, Polinomial *transPols)
 {
     Goldilocks::Element *mem = (Goldilocks::Element *)pAddress;
 
+    std::vector<Polinomial> dstPols;
+    std::vector<Polinomial> srcPols;
     for (uint64_t i = 0; i < starkInfo.puCtx.size(); i++)
     {
         int indx1 = 4 * i + 2;
         int indx2 = 4 * i + 3;
-        Polinomial h1 = starkInfo.getPolinomial(mem, starkInfo.cm_n[numCommited + i * 2]);
-        Polinomial h2 = starkInfo.getPolinomial(mem, starkInfo.cm_n[numCommited + i * 2 + 1]);
-        Polinomial::copy(h1, transPols[indx1]);
-        Polinomial::copy(h2, transPols[indx2]);
+        dstPols.push_back(starkInfo.getPolinomial(mem, starkInfo.cm_n[numCommited + i * 2]));
+        srcPols.push_back(transPols[indx1]);
+        dstPols.push_back(starkInfo.getPolinomial(mem, starkInfo.cm_n[numCommited + i * 2 + 1]));
+        srcPols.push_back(transPols[indx2]);
     }
+    Polinomial::copyBlocked(dstPols, srcPols);
     if (starkInfo.puCtx.size() > 0)
     {
         delete[] transPols;
@@ -469,6 +570,10 @@ Polinomial *Starks::transposeZColumns(void *pAddress, uint64_t &numCommited, Gol
         exitProcess();
     }
 
+    // The num and den columns are gathered here and copied together by row blocks
+    std::vector<Polinomial> dstPols;
+    std::vector<Polinomial> srcPols;
+
     // #pragma omp parallel for (better without)
     for (uint64_t i = 0; i < starkInfo.puCtx.size(); i++)
     {
@@ -477,12 +582,14 @@ Polinomial *Starks::transposeZColumns(void *pAddress, uint64_t &numCommited, Gol
         Polinomial z = starkInfo.getPolinomial(mem, starkInfo.cm_n[numCommited + i]);
         u_int64_t indx = i * 3;
         newpols_[indx].potConstruct(&(pBuffer[indx * stride_pol_]), pNum.degree(), pNum.dim(), pNum.dim());
-        Polinomial::copy(newpols_[indx], pNum);
+        dstPols.push_back(newpols_[indx]);
+        srcPols.push_back(pNum);
         indx++;
         assert(pNum.degree() <= N);
 
         newpols_[indx].potConstruct(&(pBuffer[indx * stride_pol_]), pDen.degree(), pDen.dim(), pDen.dim());
-        Polinomial::copy(newpols_[indx], pDen);
+        dstPols.push_back(newpols_[indx]);
+        srcPols.push_back(pDen);
         indx++;
         assert(pDen.degree() <= N);
 
@@ -498,12 +605,14 @@ Polinomial *Starks::transposeZColumns(void *pAddress, uint64_t &numCommited, Gol
         Polinomial z = starkInfo.getPolinomial(mem, starkInfo.cm_n[numCommited + i]);
         u_int64_t indx = 3 * i + offset;
         newpols_[indx].potConstruct(&(pBuffer[indx * stride_pol_]), pNum.degree(), pNum.dim(), pNum.dim());
-        Polinomial::copy(newpols_[indx], pNum);
+        dstPols.push_back(newpols_[indx]);
+        srcPols.push_back(pNum);
         indx++;
         assert(pNum.degree() <= N);
 
         newpols_[indx].potConstruct(&(pBuffer[indx * stride_pol_]), pDen.degree(), pDen.dim(), pDen.dim());
-        Polinomial::copy(newpols_[indx], pDen);
+        dstPols.push_back(newpols_[indx]);
+        srcPols.push_back(pDen);
         indx++;
         assert(pDen.degree() <= N);
 
@@ -521,12 +630,14 @@ Polinomial *Starks::transposeZColumns(void *pAddress, uint64_t &numCommited, Gol
         u_int64_t indx = 3 * i + offset;
 
         newpols_[indx].potConstruct(&(pBuffer[indx * stride_pol_]), pNum.degree(), pNum.dim(), pNum.dim());
-        Polinomial::copy(newpols_[indx], pNum);
+        dstPols.push_back(newpols_[indx]);
+        srcPols.push_back(pNum);
         indx++;
         assert(pNum.degree() <= N);
 
         newpols_[indx].potConstruct(&(pBuffer[indx * stride_pol_]), pDen.degree(), pDen.dim(), pDen.dim());
-        Polinomial::copy(newpols_[indx], pDen);
+        dstPols.push_back(newpols_[indx]);
+        srcPols.push_back(pDen);
         indx++;
         assert(pDen.degree() <= N);
 
@@ -535,31 +646,32 @@ Polinomial *Starks::transposeZColumns(void *pAddress, uint64_t &numCommited, Gol
     }
     numCommited += starkInfo.ciCtx.size();
     numCommited -= starkInfo.ciCtx.size() + starkInfo.peCtx.size() + starkInfo.puCtx.size();
+    Polinomial::copyBlocked(dstPols, srcPols);
     return newpols_;
 }
 void Starks::transposeZRows(void *pAddress, uint64_t &numCommited, Polinomial *transPols)
 {
     u_int64_t numpols = starkInfo.ciCtx.size() + starkInfo.peCtx.size() + starkInfo.puCtx.size();
     Goldilocks::Element *mem = (Goldilocks::Element *)pAddress;
+    std::vector<Polinomial> dstPols;
+    std::vector<Polinomial> srcPols;
     for (uint64_t i = 0; i < numpols; i++)
     {
         int indx1 = 3 * i;
-        Polinomial z = starkInfo.getPolinomial(mem, starkInfo.cm_n[numCommited + i]);
-        Polinomial::copy(z, transPols[indx1 + 2]);
+        dstPols.push_back(starkInfo.getPolinomial(mem, starkInfo.cm_n[numCommited + i]));
+        srcPols.push_back(transPols[indx1 + 2]);
     }
+    Polinomial::copyBlocked(dstPols, srcPols);
     if (numpols > 0)
     {
         delete[] transPols;
     }
 }
-void Starks::evmap(void *pAddress, Polinomial &evals, Polinomial &LEv, Polinomial &LpEv)
+void Starks::buildEvmapPlan(void)
 {
-    Goldilocks::Element *mem = (Goldilocks::Element *)pAddress;
-    uint64_t extendBits = starkInfo.starkStruct.nBitsExt - starkInfo.starkStruct.nBits;
-    u_int64_t size_eval = starkInfo.evMap.size();
     // Order polinomials by address, note that there are collisions!
     map<uintptr_t, vector<uint>> map_offsets;
-    for (uint64_t i = 0; i < size_eval; i++)
+    for (uint64_t i = 0; i < starkInfo.evMap.size(); i++)
     {
         EvMap ev = starkInfo.evMap[i];
         if (ev.type == EvMap::eType::_const)
@@ -581,11 +693,11 @@ void Starks::evmap(void *pAddress, Polinomial &evals, Polinomial &LEv, Polinomia
             throw std::invalid_argument("Invalid ev type: " + ev.type);
         }
     }
-    Polinomial *ordPols = new Polinomial[size_eval];
-    vector<bool> isPrime(size_eval);
-    vector<uint> indx(size_eval);
+
     //   build and store ordered polinomials that need to be computed
-    uint kk = 0;
+    evmapPols.clear();
+    evmapIsPrime.clear();
+    evmapIndx.clear();
     for (std::map<uintptr_t, std::vector<uint>>::const_iterator it = map_offsets.begin(); it != map_offsets.end(); ++it)
     {
         for (std::vector<uint>::const_iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2)
@@ -593,78 +705,223 @@ void Starks::evmap(void *pAddress, Polinomial &evals, Polinomial &LEv, Polinomia
             EvMap ev = starkInfo.evMap[*it2];
             if (ev.type == EvMap::eType::_const)
             {
-                ordPols[kk].potConstruct(&((Goldilocks::Element *)pConstPols2ns->address())[ev.id], pConstPols2ns->degree(), 1, pConstPols2ns->numPols());
+                Polinomial pol;
+                pol.potConstruct(&((Goldilocks::Element *)pConstPols2ns->address())[ev.id], pConstPols2ns->degree(), 1, pConstPols2ns->numPols());
+                evmapPols.push_back(pol);
             }
             else if (ev.type == EvMap::eType::cm)
             {
-                ordPols[kk] = starkInfo.getPolinomial(mem, starkInfo.cm_2ns[ev.id]);
+                evmapPols.push_back(starkInfo.getPolinomial(mem, starkInfo.cm_2ns[ev.id]));
             }
             else if (ev.type == EvMap::eType::q)
             {
-                ordPols[kk] = starkInfo.getPolinomial(mem, starkInfo.qs[ev.id]);
+                evmapPols.push_back(starkInfo.getPolinomial(mem, starkInfo.qs[ev.id]));
             }
-            isPrime[kk] = ev.prime;
-            indx[kk] = *it2;
-            ++kk;
+            evmapIsPrime.push_back(ev.prime);
+            evmapIndx.push_back(*it2);
         }
     }
-    assert(kk == size_eval);
-    // Build buffer for partial results of the matrix-vector product (columns distribution)  .
-    int num_threads = omp_get_max_threads();
-    Goldilocks::Element **evals_acc = (Goldilocks::Element **)malloc(num_threads * sizeof(Goldilocks::Element *));
-    for (int i = 0; i < num_threads; ++i)
+    assert(evmapPols.size() == starkInfo.evMap.size());
+}
+
+void Starks::evmap(Polinomial &evals, Polinomial &LEv, Polinomial &LpEv)
+{
+    uint64_t extendBits = starkInfo.starkStruct.nBitsExt - starkInfo.starkStruct.nBits;
+    uint64_t size_eval = evmapPols.size();
+
+    // Every chunk of rows accumulates its partial evaluations in its own cache line aligned slot
+    uint64_t nChunks = zkmin((uint64_t)omp_get_max_threads(), N);
+    uint64_t partialStride = ((size_eval * FIELD_EXTENSION + 7) / 8) * 8;
+    std::vector<Goldilocks::Element> partials(nChunks * partialStride, Goldilocks::zero());
+
+#pragma omp parallel for
+    for (uint64_t c = 0; c < nChunks; c++)
     {
-        evals_acc[i] = (Goldilocks::Element *)malloc(size_eval * FIELD_EXTENSION * sizeof(Goldilocks::Element));
+        Goldilocks::Element *partial = &partials[c * partialStride];
+        uint64_t rowsEnd = ((c + 1) * N) / nChunks;
+        for (uint64_t r0 = (c * N) / nChunks; r0 < rowsEnd; r0 += STARKS_EVMAP_BLOCK_ROWS)
+        {
+            // The rows of the block stay in cache while all the polinomials, ordered by address, are evaluated
+            uint64_t r1 = zkmin(r0 + STARKS_EVMAP_BLOCK_ROWS, rowsEnd);
+            for (uint64_t i = 0; i < size_eval; i++)
+            {
+                Polinomial &L = evmapIsPrime[i] ? LpEv : LEv;
+                Goldilocks::Element acc[FIELD_EXTENSION] = {Goldilocks::zero(), Goldilocks::zero(), Goldilocks::zero()};
+                for (uint64_t k = r0; k < r1; k++)
+                {
+                    Polinomial::mulAddElement_adim3(acc, L[k], evmapPols[i], k << extendBits);
+                }
+                partial[i * FIELD_EXTENSION] = partial[i * FIELD_EXTENSION] + acc[0];
+                partial[i * FIELD_EXTENSION + 1] = partial[i * FIELD_EXTENSION + 1] + acc[1];
+                partial[i * FIELD_EXTENSION + 2] = partial[i * FIELD_EXTENSION + 2] + acc[2];
+            }
+        }
     }
-#pragma omp parallel
+
+#pragma omp parallel for
+    for (uint64_t i = 0; i < size_eval; ++i)
     {
-        int thread_idx = omp_get_thread_num();
-        for (uint64_t i = 0; i < size_eval * FIELD_EXTENSION; ++i)
+        Goldilocks::Element sum0 = Goldilocks::zero();
+        Goldilocks::Element sum1 = Goldilocks::zero();
+        Goldilocks::Element sum2 = Goldilocks::zero();
+        for (uint64_t c = 0; c < nChunks; ++c)
         {
-            evals_acc[thread_idx][i] = Goldilocks::zero();
+            sum0 = sum0 + partials[c * partialStride + i * FIELD_EXTENSION];
+            sum1 = sum1 + partials[c * partialStride + i * FIELD_EXTENSION + 1];
+            sum2 = sum2 + partials[c * partialStride + i * FIELD_EXTENSION + 2];
         }
-#pragma omp for
-        for (uint64_t k = 0; k < N; k++)
+        (evals[evmapIndx[i]])[0] = sum0;
+        (evals[evmapIndx[i]])[1] = sum1;
+        (evals[evmapIndx[i]])[2] = sum2;
+    }
+}
+
+bool Starks::calculateExpsGenerated(const string &stepName, Steps *steps, GeneratedStepFunction generated, ParserStepFunction parser, StepsParams &params, uint64_t nrows, const vector<eSection> &outputs)
+{
+    if (!config.useGeneratedSteps)
+    {
+        return false;
+    }
+
+    // When benchmarking, the AVX parser runs first, and its outputs are kept to check that the generated kernel
+    // computes the same values
+    struct timeval start;
+    uint64_t parserTime = 0;
+    vector<Goldilocks::Element> parserOutputs;
+    if (config.benchmarkGeneratedSteps)
+    {
+        gettimeofday(&start, NULL);
+        (steps->*parser)(params, nrows, 4);
+        parserTime = TimeDiff(start);
+        for (uint64_t s = 0; s < outputs.size(); s++)
         {
-            Goldilocks::Element *LpEv_ = &(LpEv[k][0]);
-            Goldilocks::Element *LEv_ = &(LEv[k][0]);
-            for (uint64_t i = 0; i < size_eval; i++)
+            Goldilocks::Element *pSection = &params.pols[starkInfo.mapOffsets.section[outputs[s]]];
+            parserOutputs.insert(parserOutputs.end(), pSection, pSection + starkInfo.mapSectionsN.section[outputs[s]] * nrows);
+        }
+    }
+
+    // The generated kernels process the rows in batches of 4, as the AVX parser
+    gettimeofday(&start, NULL);
+    if (!(steps->*generated)(params, nrows, 4))
+    {
+        return false;
+    }
+    uint64_t generatedTime = TimeDiff(start);
+
+    if (config.benchmarkGeneratedSteps)
+    {
+        uint64_t p = 0;
+        for (uint64_t s = 0; s < outputs.size(); s++)
+        {
+            Goldilocks::Element *pSection = &params.pols[starkInfo.mapOffsets.section[outputs[s]]];
+            uint64_t size = starkInfo.mapSectionsN.section[outputs[s]] * nrows;
+            for (uint64_t i = 0; i < size; i++, p++)
             {
-                Polinomial::mulAddElement_adim3(&(evals_acc[thread_idx][i * FIELD_EXTENSION]), isPrime[i] ? LpEv_ : LEv_, ordPols[i], k << extendBits);
+                if (Goldilocks::toU64(pSection[i]) != Goldilocks::toU64(parserOutputs[p]))
+                {
+                    zklog.error("Starks::calculateExpsGenerated() " + stepName + " generated kernel differs from the parser at section=" + to_string(outputs[s]) + " i=" + to_string(i) + " generated=" + Goldilocks::toString(pSection[i]) + " parser=" + Goldilocks::toString(parserOutputs[p]));
+                    exitProcess();
+                }
             }
         }
-#pragma omp for
-        for (uint64_t i = 0; i < size_eval; ++i)
+        zklog.info("Starks::calculateExpsGenerated() " + stepName + " nrows=" + to_string(nrows) + " parser=" + to_string(double(parserTime) / 1000000) + " s generated=" + to_string(double(generatedTime) / 1000000) + " s outputs match");
+    }
+    return true;
+}
+
+void Starks::extendAndMerkelize(Goldilocks::Element *p_2ns, Goldilocks::Element *p_n, uint64_t nCols, Goldilocks::Element *pBuffer, MerkleTreeGL *pTree)
+{
+    static_assert(STARKS_PIPELINE_GROUP_COLS == RATE, "STARKS_PIPELINE_GROUP_COLS must match the linear hash rate");
+
+    // With a single group of columns there is nothing to overlap
+    if (nCols <= STARKS_PIPELINE_GROUP_COLS)
+    {
+        ntt.extendPol(p_2ns, p_n, NExtended, N, nCols, pBuffer);
+        pTree->merkelize();
+        return;
+    }
+
+    // Working memory: the columns of a group, 2 extended groups (one being extended while the other one is
+    // being hashed) and the NTT buffer; the provided buffer is used if it is big enough
+    uint64_t nGroups = (nCols + STARKS_PIPELINE_GROUP_COLS - 1) / STARKS_PIPELINE_GROUP_COLS;
+    uint64_t groupSizeN = N * STARKS_PIPELINE_GROUP_COLS;
+    uint64_t groupSize2ns = NExtended * STARKS_PIPELINE_GROUP_COLS;
+    uint64_t workingSize = groupSizeN + 3 * groupSize2ns;
+    Goldilocks::Element *pWorking = pBuffer;
+    bool bWorkingAllocated = false;
+    if (workingSize > NExtended * nCols)
+    {
+        pWorking = (Goldilocks::Element *)malloc(workingSize * sizeof(Goldilocks::Element));
+        if (pWorking == NULL)
         {
-            Goldilocks::Element sum0 = Goldilocks::zero();
-            Goldilocks::Element sum1 = Goldilocks::zero();
-            Goldilocks::Element sum2 = Goldilocks::zero();
-            int offset = i * FIELD_EXTENSION;
-            for (int k = 0; k < num_threads; ++k)
+            zklog.error("Starks::extendAndMerkelize() failed calling malloc() of size=" + to_string(workingSize * sizeof(Goldilocks::Element)));
+            exitProcess();
+        }
+        bWorkingAllocated = true;
+    }
+    Goldilocks::Element *pGroupN = pWorking;
+    Goldilocks::Element *pGroup2ns[2] = {pWorking + groupSizeN, pWorking + groupSizeN + groupSize2ns};
+    Goldilocks::Element *pGroupBuffer = pWorking + groupSizeN + 2 * groupSize2ns;
+
+    // Split the threads between the LDE, run by this thread, and the linear hash, run by the absorb thread
+    uint64_t nThreads = omp_get_max_threads();
+    uint64_t nHashThreads = zkmax(nThreads / 2, 1);
+    uint64_t nLdeThreads = zkmax(nThreads - nHashThreads, 1);
+
+    // Copies an extended group into its columns of p_2ns and absorbs it into the sponge of every row, whose
+    // capacity is kept in the leaves of the tree; after the last group the leaves hold the row linear hashes
+    auto absorb = [&](uint64_t g) {
+        uint64_t c0 = g * STARKS_PIPELINE_GROUP_COLS;
+        uint64_t nc = zkmin(STARKS_PIPELINE_GROUP_COLS, nCols - c0);
+        Goldilocks::Element *pGroup = pGroup2ns[g % 2];
+#pragma omp parallel for num_threads(nHashThreads)
+        for (uint64_t r = 0; r < NExtended; r++)
+        {
+            Goldilocks::Element state[SPONGE_WIDTH];
+            std::memcpy(&p_2ns[r * nCols + c0], &pGroup[r * nc], nc * sizeof(Goldilocks::Element));
+            std::memcpy(state, &pGroup[r * nc], nc * sizeof(Goldilocks::Element));
+            std::memset(&state[nc], 0, (RATE - nc) * sizeof(Goldilocks::Element));
+            if (g == 0)
+            {
+                std::memset(&state[RATE], 0, CAPACITY * sizeof(Goldilocks::Element));
+            }
+            else
             {
-                sum0 = sum0 + evals_acc[k][offset];
-                sum1 = sum1 + evals_acc[k][offset + 1];
-                sum2 = sum2 + evals_acc[k][offset + 2];
+                std::memcpy(&state[RATE], &pTree->nodes[r * CAPACITY], CAPACITY * sizeof(Goldilocks::Element));
             }
-            evals_acc[0][offset] = sum0;
-            evals_acc[0][offset + 1] = sum1;
-            evals_acc[0][offset + 2] = sum2;
+            PoseidonGoldilocks::hash((Goldilocks::Element(&)[CAPACITY])(pTree->nodes[r * CAPACITY]), state);
         }
-#pragma omp single
-        for (uint64_t i = 0; i < size_eval; ++i)
+    };
+
+    std::thread absorbThread;
+    omp_set_num_threads(nLdeThreads);
+    for (uint64_t g = 0; g < nGroups; g++)
+    {
+        uint64_t c0 = g * STARKS_PIPELINE_GROUP_COLS;
+        uint64_t nc = zkmin(STARKS_PIPELINE_GROUP_COLS, nCols - c0);
+#pragma omp parallel for
+        for (uint64_t r = 0; r < N; r++)
+        {
+            std::memcpy(&pGroupN[r * nc], &p_n[r * nCols + c0], nc * sizeof(Goldilocks::Element));
+        }
+        ntt.extendPol(pGroup2ns[g % 2], pGroupN, NExtended, N, nc, pGroupBuffer);
+
+        // The previous group must be absorbed before this one, and before its buffer is extended into again
+        if (absorbThread.joinable())
         {
-            int offset = i * FIELD_EXTENSION;
-            (evals[indx[i]])[0] = evals_acc[0][offset];
-            (evals[indx[i]])[1] = evals_acc[0][offset + 1];
-            (evals[indx[i]])[2] = evals_acc[0][offset + 2];
+            absorbThread.join();
         }
+        absorbThread = std::thread(absorb, g);
     }
-    delete[] ordPols;
-    for (int i = 0; i < num_threads; ++i)
+    absorbThread.join();
+    omp_set_num_threads(nThreads);
+
+    pTree->merkelizeFromLeaves();
+
+    if (bWorkingAllocated)
     {
-        free(evals_acc[i]);
+        free(pWorking);
     }
-    free(evals_acc);
 }
 
 void Starks::merkelizeMemory()
@@ -11,12 +11,16 @@
 #include "friProve.hpp"
 #include "transcript.hpp"
 #include "zhInv.hpp"
+#include "stark_domain.hpp"
+#include "stark_arena.hpp"
 #include "steps.hpp"
 #include "zklog.hpp"
 #include "exit_process.hpp"
 
 #define STARK_C12_A_NUM_TREES 5
 #define NUM_CHALLENGES 8
+#define STARKS_PIPELINE_GROUP_COLS 8 // Columns extended at once by the LDE and Merkle tree pipeline; must match the linear hash rate
+#define STARKS_EVMAP_BLOCK_ROWS 64    // Rows evaluated at once for every polinomial in evmap()
 
 struct StarkFiles
 {
@@ -40,6 +44,9 @@ private:
     ConstantPolsStarks *pConstPols2ns;
     void *pConstTreeAddress;
     StarkFiles starkFiles;
+    std::shared_ptr<StarkDomain> domain;
+    StarkArena *pArena; // Working memory of the proof temporaries, possibly shared with other instances
+    bool bArenaOwned;
     ZhInv zi;
     uint64_t N;
     uint64_t NExtended;
@@ -68,23 +75,36 @@ private:
 
     Polinomial x;
 
+    // evmap() plan, built once since the polinomial addresses do not change: the evaluated polinomials ordered
+    // by address, whether they are evaluated at the shifted point, and their index in evMap
+    std::vector<Polinomial> evmapPols;
+    std::vector<bool> evmapIsPrime;
+    std::vector<uint64_t> evmapIndx;
+    void buildEvmapPlan(void);
+
     void merkelizeMemory(); // function for DBG purposes
 
+    // Extends the nCols columns of p_n into p_2ns and builds their Merkle tree, overlapping the LDE of every group
+    // of columns with the linear hash of the previous one; pBuffer must have room for NExtended*nCols elements
+    void extendAndMerkelize(Goldilocks::Element *p_2ns, Goldilocks::Element *p_n, uint64_t nCols, Goldilocks::Element *pBuffer, MerkleTreeGL *pTree);
+
+    // Computes the expressions of a step with its generated AVX kernel, if enabled by config and available
+    // for these steps; returns false if the caller must compute them; when benchmarking, the kernel is checked
+    // against the parser on the sections the step writes, listed in outputs
+    bool calculateExpsGenerated(const string &stepName, Steps *steps, GeneratedStepFunction generated, ParserStepFunction parser, StepsParams &params, uint64_t nrows, const vector<eSection> &outputs);
+
 public:
-    Starks(const Config &config, StarkFiles starkFiles, void *_pAddress) : config(config),
+    Starks(const Config &config, StarkFiles starkFiles, void *_pAddress, StarkArena *_pArena = NULL) : config(config),
                                                                            starkInfo(config, starkFiles.zkevmStarkInfo),
                                                                            starkFiles(starkFiles),
-                                                                           zi(config.generateProof() ? starkInfo.starkStruct.nBits : 0,
-                                                                              config.generateProof() ? starkInfo.starkStruct.nBitsExt : 0),
                                                                            N(config.generateProof() ? 1 << starkInfo.starkStruct.nBits : 0),
                                                                            NExtended(config.generateProof() ? 1 << starkInfo.starkStruct.nBitsExt : 0),
                                                                            ntt(config.generateProof() ? 1 << starkInfo.starkStruct.nBits : 0),
                                                                            nttExtended(config.generateProof() ? 1 << starkInfo.starkStruct.nBitsExt : 0),
-                                                                           x_n(config.generateProof() ? N : 0, config.generateProof() ? 1 : 0),
-                                                                           x_2ns(config.generateProof() ? NExtended : 0, config.generateProof() ? 1 : 0),
-                                                                           pAddress(_pAddress),
-                                                                           x(config.generateProof() ? N << (starkInfo.starkStruct.nBitsExt - starkInfo.starkStruct.nBits) : 0, config.generateProof() ? FIELD_EXTENSION : 0)
+                                                                           pAddress(_pAddress)
     {
+        pArena = _pArena;
+        bArenaOwned = false;
         nrowsStepBatch = 1;
         // Avoid unnecessary initialization if we are not going to generate any proof
         if (!config.generateProof())
@@ -109,7 +129,7 @@ public:
         }
         else
         {
-            pConstPolsAddress = copyFile(starkFiles.zkevmConstPols, constPolsSize);
+            pConstPolsAddress = copyFileToLargeBuffer(config, starkFiles.zkevmConstPols, constPolsSize);
             zklog.info("Starks::Starks() successfully copied " + to_string(constPolsSize) + " bytes from constant file " + starkFiles.zkevmConstPols);
         }
         pConstPols = new ConstantPolsStarks(pConstPolsAddress, constPolsSize, starkInfo.nConstants);
@@ -131,33 +151,26 @@ public:
         }
         else
         {
-            pConstTreeAddress = copyFile(starkFiles.zkevmConstantsTree, starkInfo.getConstTreeSizeInBytes());
+            pConstTreeAddress = copyFileToLargeBuffer(config, starkFiles.zkevmConstantsTree, starkInfo.getConstTreeSizeInBytes());
             zklog.info("Starks::Starks() successfully copied " + to_string(starkInfo.getConstTreeSizeInBytes()) + " bytes from constant file " + starkFiles.zkevmConstantsTree);
         }
         TimerStopAndLog(LOAD_CONST_TREE_TO_MEMORY);
 
         // Initialize and allocate ConstantPols2ns
         TimerStart(LOAD_CONST_POLS_2NS_TO_MEMORY);
-        pConstPolsAddress2ns = (void *)calloc(starkInfo.nConstants * (1 << starkInfo.starkStruct.nBitsExt), sizeof(Goldilocks::Element));
+        pConstPolsAddress2ns = allocLargeBuffer(config, starkInfo.nConstants * (1 << starkInfo.starkStruct.nBitsExt) * sizeof(Goldilocks::Element));
         pConstPols2ns = new ConstantPolsStarks(pConstPolsAddress2ns, (1 << starkInfo.starkStruct.nBitsExt), starkInfo.nConstants);
         std::memcpy(pConstPolsAddress2ns, (uint8_t *)pConstTreeAddress + 2 * sizeof(Goldilocks::Element), starkInfo.nConstants * (1 << starkInfo.starkStruct.nBitsExt) * sizeof(Goldilocks::Element));
 
         TimerStopAndLog(LOAD_CONST_POLS_2NS_TO_MEMORY);
 
-        // TODO x_n and x_2ns could be precomputed
+        // x_n, x_2ns, x and zhInv are shared with any other instance with the same domain
         TimerStart(COMPUTE_X_N_AND_X_2_NS);
-        Goldilocks::Element xx = Goldilocks::one();
-        for (uint64_t i = 0; i < N; i++)
-        {
-            *x_n[i] = xx;
-            Goldilocks::mul(xx, xx, Goldilocks::w(starkInfo.starkStruct.nBits));
-        }
-        xx = Goldilocks::shift();
-        for (uint64_t i = 0; i < NExtended; i++)
-        {
-            *x_2ns[i] = xx;
-            Goldilocks::mul(xx, xx, Goldilocks::w(starkInfo.starkStruct.nBitsExt));
-        }
+        domain = StarkDomain::get(config, starkInfo.starkStruct.nBits, starkInfo.starkStruct.nBitsExt);
+        x_n.potConstruct(domain->x_n, N, 1, 1);
+        x_2ns.potConstruct(domain->x_2ns, NExtended, 1, 1);
+        x.potConstruct(domain->x, NExtended, FIELD_EXTENSION, FIELD_EXTENSION);
+        zi = ZhInv(domain->zhInv, domain->zhInvSize);
         TimerStopAndLog(COMPUTE_X_N_AND_X_2_NS);
 
         mem = (Goldilocks::Element *)pAddress;
@@ -173,14 +186,15 @@ public:
         p_q_2ns = &mem[starkInfo.mapOffsets.section[eSection::q_2ns]];
         p_f_2ns = &mem[starkInfo.mapOffsets.section[eSection::f_2ns]];
 
-        *x[0] = Goldilocks::shift();
+        buildEvmapPlan();
 
-        uint64_t extendBits = starkInfo.starkStruct.nBitsExt - starkInfo.starkStruct.nBits;
-
-        for (uint64_t k = 1; k < (N << extendBits); k++)
+        // Reserve room for evals, xDivXSubXi, xDivXSubWXi, LEv and LpEv
+        if (pArena == NULL)
         {
-            Polinomial::mulElement(x, k, x, k - 1, (Goldilocks::Element &)Goldilocks::w(starkInfo.starkStruct.nBits + extendBits));
+            pArena = new StarkArena();
+            bArenaOwned = true;
         }
+        pArena->reserve(getArenaSize());
 
         TimerStart(MERKLE_TREE_ALLOCATION);
         treesGL[0] = new MerkleTreeGL(NExtended, starkInfo.mapSectionsN.section[eSection::cm1_n], p_cm1_2ns);
@@ -197,7 +211,7 @@ public:
 
         delete pConstPols;
         delete pConstPols2ns;
-        free(pConstPolsAddress2ns);
+        freeLargeBuffer(pConstPolsAddress2ns, starkInfo.nConstants * (1 << starkInfo.starkStruct.nBitsExt) * sizeof(Goldilocks::Element));
 
         if (config.mapConstPolsFile)
         {
@@ -205,7 +219,7 @@ public:
         }
         else
         {
-            free(pConstPolsAddress);
+            freeLargeBuffer(pConstPolsAddress, constPolsSize);
         }
         if (config.mapConstantsTreeFile)
         {
@@ -213,13 +227,24 @@ public:
         }
         else
         {
-            free(pConstTreeAddress);
+            freeLargeBuffer(pConstTreeAddress, starkInfo.getConstTreeSizeInBytes());
         }
 
         for (uint i = 0; i < 5; i++)
         {
             delete treesGL[i];
         }
+
+        if (bArenaOwned)
+        {
+            delete pArena;
+        }
+    };
+
+    // Number of arena elements used by genProof()
+    uint64_t getArenaSize(void)
+    {
+        return (starkInfo.evMap.size() + 2 * NExtended + 2 * N) * FIELD_EXTENSION;
     };
 
     void genProof(FRIProof &proof, Goldilocks::Element *publicInputs, Steps *steps);
@@ -228,7 +253,7 @@ public:
     void transposeH1H2Rows(void *pAddress, uint64_t &numCommited, Polinomial *transPols);
     Polinomial *transposeZColumns(void *pAddress, uint64_t &numCommited, Goldilocks::Element *pBuffer);
     void transposeZRows(void *pAddress, uint64_t &numCommited, Polinomial *transPols);
-    void evmap(void *pAddress, Polinomial &evals, Polinomial &LEv, Polinomial &LpEv);
+    void evmap(Polinomial &evals, Polinomial &LEv, Polinomial &LpEv);
 };
 
 #endif // STARKS_H
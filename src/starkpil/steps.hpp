@@ -26,12 +26,14 @@ public:
     virtual void step2prev_last(StepsParams &params, uint64_t i) = 0;
     virtual void step2prev_parser_first_avx(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch){};
     virtual void step2prev_parser_first_avx512(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch){};
+    virtual bool step2prev_generated_first_avx(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch) { return false; };
 
     virtual void step3prev_first(StepsParams &params, uint64_t i) = 0;
     virtual void step3prev_i(StepsParams &params, uint64_t i) = 0;
     virtual void step3prev_last(StepsParams &params, uint64_t i) = 0;
     virtual void step3prev_parser_first_avx(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch){};
     virtual void step3prev_parser_first_avx512(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch){};
+    virtual bool step3prev_generated_first_avx(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch) { return false; };
 
     virtual void step3_first(StepsParams &params, uint64_t i) = 0;
     virtual void step3_i(StepsParams &params, uint64_t i) = 0;
@@ -40,6 +42,7 @@ public:
     virtual void step3_parser_first_avx(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch){};
     virtual void step3_parser_first_avx_jump(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch){};
     virtual void step3_parser_first_avx512(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch){};
+    virtual bool step3_generated_first_avx(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch) { return false; };
 
     virtual void step42ns_first(StepsParams &params, uint64_t i) = 0;
     virtual void step42ns_i(StepsParams &params, uint64_t i) = 0;
@@ -48,6 +51,7 @@ public:
     virtual void step42ns_parser_first_avx(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch){};
     virtual void step42ns_parser_first_avx_jump(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch){};
     virtual void step42ns_parser_first_avx512(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch){};
+    virtual bool step42ns_generated_first_avx(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch) { return false; };
 
     virtual void step52ns_first(StepsParams &params, uint64_t i) = 0;
     virtual void step52ns_i(StepsParams &params, uint64_t i) = 0;
@@ -56,6 +60,11 @@ public:
     virtual void step52ns_parser_first(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch){};
     virtual void step52ns_parser_first_avx(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch){};
     virtual void step52ns_parser_first_avx512(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch){};
+    virtual bool step52ns_generated_first_avx(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch) { return false; };
 };
 
+// The generated kernels return false when they are not available for the steps implementation
+typedef bool (Steps::*GeneratedStepFunction)(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch);
+typedef void (Steps::*ParserStepFunction)(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch);
+
 #endif // STEPS
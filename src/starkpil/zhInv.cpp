@@ -2,9 +2,9 @@
 
 // TODO: Pending to review and re-factor
 
-ZhInv::ZhInv(){};
+ZhInv::ZhInv() : pZHInv(NULL), zhInvSize(0){};
 
-ZhInv::ZhInv(uint64_t nBits, uint64_t nBitsExt)
+ZhInv::ZhInv(uint64_t nBits, uint64_t nBitsExt) : pZHInv(NULL), zhInvSize(0)
 {
     if (nBits == 0 || nBitsExt == 0)
         return;
@@ -28,4 +28,6 @@ ZhInv::ZhInv(uint64_t nBits, uint64_t nBitsExt)
         Goldilocks::mul(w, w, Goldilocks::w(extendBits));
     }
     zkassert(ZHInv.size() != 0);
+    pZHInv = ZHInv.data();
+    zhInvSize = ZHInv.size();
 };
@@ -13,15 +13,31 @@ using namespace std;
 class ZhInv
 {
     std::vector<Goldilocks::Element> ZHInv;
+    Goldilocks::Element *pZHInv; // Either ZHInv.data() or a table owned by someone else, e.g. a StarkDomain
+    uint64_t zhInvSize;
 
 public:
     ZhInv();
 
     ZhInv(uint64_t nBits, uint64_t nBitsExt);
 
+    ZhInv(Goldilocks::Element *pZHInv, uint64_t zhInvSize) : pZHInv(pZHInv), zhInvSize(zhInvSize){};
+
+    ZhInv(const ZhInv &other) : ZHInv(other.ZHInv),
+                                pZHInv(other.ZHInv.size() > 0 ? ZHInv.data() : other.pZHInv),
+                                zhInvSize(other.zhInvSize){};
+
+    ZhInv &operator=(const ZhInv &other)
+    {
+        ZHInv = other.ZHInv;
+        pZHInv = (other.ZHInv.size() > 0) ? ZHInv.data() : other.pZHInv;
+        zhInvSize = other.zhInvSize;
+        return *this;
+    };
+
     inline Goldilocks::Element zhInv(int64_t i)
     {
-        return ZHInv[i % ZHInv.size()];
+        return pZHInv[i % zhInvSize];
     };
 };
 #endif
\ No newline at end of file
@@ -17,6 +17,9 @@ public:
 #ifdef __AVX512__
     void step2prev_parser_first_avx512(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch);
 #endif
+#ifdef __ZKEVM_CHELPERS_GENERATED__
+    bool step2prev_generated_first_avx(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch);
+#endif
 
     void step3prev_first(StepsParams &params, uint64_t i);
     void step3prev_i(StepsParams &params, uint64_t i);
@@ -25,6 +28,9 @@ public:
 #ifdef __AVX512__
     void step3prev_parser_first_avx512(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch);
 #endif
+#ifdef __ZKEVM_CHELPERS_GENERATED__
+    bool step3prev_generated_first_avx(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch);
+#endif
 
     void step3_first(StepsParams &params, uint64_t i);
     void step3_i(StepsParams &params, uint64_t i);
@@ -35,6 +41,9 @@ public:
 #ifdef __AVX512__
     void step3_parser_first_avx512(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch);
 #endif
+#ifdef __ZKEVM_CHELPERS_GENERATED__
+    bool step3_generated_first_avx(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch);
+#endif
 
     void step42ns_first(StepsParams &params, uint64_t i);
     void step42ns_i(StepsParams &params, uint64_t i);
@@ -45,6 +54,9 @@ public:
 #ifdef __AVX512__
     void step42ns_parser_first_avx512(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch);
 #endif
+#ifdef __ZKEVM_CHELPERS_GENERATED__
+    bool step42ns_generated_first_avx(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch);
+#endif
 
     void step52ns_first(StepsParams &params, uint64_t i);
     void step52ns_i(StepsParams &params, uint64_t i);
@@ -54,6 +66,9 @@ public:
 #ifdef __AVX512__
     void step52ns_parser_first_avx512(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch);
 #endif
+#ifdef __ZKEVM_CHELPERS_GENERATED__
+    bool step52ns_generated_first_avx(StepsParams &params, uint64_t nrows, uint64_t nrowsBatch);
+#endif
 };
 
 #endif // STARKS_STEPS_HPP
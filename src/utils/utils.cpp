@@ -19,6 +19,9 @@
 #include <net/if.h>
 #include <arpa/inet.h>
 #include "zklog.hpp"
+#include "timer.hpp"
+#include "exit_process.hpp"
+#include <omp.h>
 
 using namespace std;
 using namespace std::filesystem;
@@ -377,6 +380,96 @@ void *copyFile(const string &fileName, uint64_t size)
     return mapFileInternal(fileName, size, false, false);
 }
 
+#define LARGE_BUFFER_ALIGNMENT (2 * 1024 * 1024) // Huge page size; large buffer sizes are rounded up to it
+
+uint64_t largeBufferMapSize(uint64_t size)
+{
+    return ((size + LARGE_BUFFER_ALIGNMENT - 1) / LARGE_BUFFER_ALIGNMENT) * LARGE_BUFFER_ALIGNMENT;
+}
+
+void *allocLargeBuffer(const Config &config, uint64_t size)
+{
+    uint64_t mapSize = largeBufferMapSize(size);
+    void *pAddress = MAP_FAILED;
+
+    if (config.polsHugePages == "hugetlb")
+    {
+        // Needs huge pages reserved in advance, e.g. in /proc/sys/vm/nr_hugepages
+        pAddress = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (pAddress == MAP_FAILED)
+        {
+            zklog.warning("allocLargeBuffer() failed calling mmap() with MAP_HUGETLB of size=" + to_string(mapSize) + ", falling back to transparent huge pages");
+        }
+    }
+    if (pAddress == MAP_FAILED)
+    {
+        pAddress = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pAddress == MAP_FAILED)
+        {
+            zklog.error("allocLargeBuffer() failed calling mmap() of size=" + to_string(mapSize));
+            exitProcess();
+        }
+        if ((config.polsHugePages == "thp") || (config.polsHugePages == "hugetlb"))
+        {
+            if (madvise(pAddress, mapSize, MADV_HUGEPAGE) != 0)
+            {
+                zklog.warning("allocLargeBuffer() failed calling madvise(MADV_HUGEPAGE) of size=" + to_string(mapSize));
+            }
+        }
+    }
+
+    // Touch every page from all the threads, so that the page faults are taken now and not in the first proof
+    if (config.prefaultPols)
+    {
+        TimerStart(ALLOC_LARGE_BUFFER_PREFAULT);
+        uint8_t *pBytes = (uint8_t *)pAddress;
+#pragma omp parallel for
+        for (uint64_t i = 0; i < mapSize; i += 4096)
+        {
+            pBytes[i] = 0;
+        }
+        TimerStopAndLog(ALLOC_LARGE_BUFFER_PREFAULT);
+    }
+
+    if (config.lockPols)
+    {
+        if (mlock(pAddress, mapSize) != 0)
+        {
+            zklog.warning("allocLargeBuffer() failed calling mlock() of size=" + to_string(mapSize) + "; check RLIMIT_MEMLOCK");
+        }
+    }
+
+    return pAddress;
+}
+
+void freeLargeBuffer(void *pAddress, uint64_t size)
+{
+    if (pAddress == NULL)
+    {
+        return;
+    }
+    unmapFile(pAddress, largeBufferMapSize(size));
+}
+
+void *copyFileToLargeBuffer(const Config &config, const string &fileName, uint64_t size)
+{
+    void *pFileAddress = mapFile(fileName, size, false);
+    void *pAddress = allocLargeBuffer(config, size);
+
+    // Copy in parallel chunks; this also faults the destination pages in from all the threads
+    uint64_t nChunks = omp_get_max_threads();
+#pragma omp parallel for
+    for (uint64_t c = 0; c < nChunks; c++)
+    {
+        uint64_t start = (c * size) / nChunks;
+        uint64_t end = ((c + 1) * size) / nChunks;
+        memcpy((uint8_t *)pAddress + start, (uint8_t *)pFileAddress + start, end - start);
+    }
+
+    unmapFile(pFileAddress, size);
+    return pAddress;
+}
+
 void unmapFile(void *pAddress, uint64_t size)
 {
     int err = munmap(pAddress, size);
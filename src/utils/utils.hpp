@@ -61,6 +61,14 @@ void unmapFile (void * pAddress, uint64_t size);
 // Copies file content into memory; use free after use
 void * copyFile (const string &fileName, uint64_t size);
 
+// Allocates zeroed memory for large polynomial buffers, backed by huge pages, pre-faulted and locked as set by
+// config.polsHugePages, config.prefaultPols and config.lockPols; use freeLargeBuffer after use
+void * allocLargeBuffer (const Config &config, uint64_t size);
+void freeLargeBuffer (void * pAddress, uint64_t size);
+
+// Copies file content into a buffer allocated with allocLargeBuffer; use freeLargeBuffer after use
+void * copyFileToLargeBuffer (const Config &config, const string &fileName, uint64_t size);
+
 // Compute the sha256 hash of a string
 string sha256(string str);
 
@@ -1,4 +1,5 @@
 #include "database_cache_test.hpp"
+#include <cstring>
 #include "hashdb/database.hpp"
 #include "timer.hpp"
 #include "scalar.hpp"
@@ -18,6 +19,7 @@ uint64_t DatabaseCacheTest (void)
 
     Goldilocks fr;
     mpz_class keyScalar;
+    Goldilocks::Element key[4];
     string keyString;
     vector<Goldilocks::Element> value;
     bool bResult;
@@ -31,7 +33,8 @@ uint64_t DatabaseCacheTest (void)
             value.push_back(fr.fromU64(j));
         }
         bool update = false;
-        Database::dbMTCache.add(keyString, value, update);
+        scalar2fea(fr, keyScalar, key);
+        Database::dbMTCache.add(key, value, update);
     }
 
     //Database::dbMTCache.print(true);
@@ -40,13 +43,66 @@ uint64_t DatabaseCacheTest (void)
     {
         keyScalar = i;
         keyString = PrependZeros(keyScalar.get_str(16), 64);
-        bResult = Database::dbMTCache.find(keyString, value);
+        scalar2fea(fr, keyScalar, key);
+        bResult = Database::dbMTCache.find(key, value);
         if (!bResult)
         {
             zklog.error("DatabaseCacheTest() failed calling Database::dbMTCache.find() of key=" + keyString);
             numberOfFailed++;
         }
+        else if (value.size() != 12)
+        {
+            zklog.error("DatabaseCacheTest() called Database::dbMTCache.find() of key=" + keyString + " but got value.size()=" + to_string(value.size()));
+            numberOfFailed++;
+        }
+    }
+
+    // Check that the LRU eviction keeps the cache under its max size
+    Database::dbMTCache.setMaxSize(NUMBER_OF_DB_CACHE_ADDS*DatabaseMTCache::recordSize/2);
+    for (uint64_t i=NUMBER_OF_DB_CACHE_ADDS; i<4*NUMBER_OF_DB_CACHE_ADDS; i++)
+    {
+        keyScalar = i;
+        scalar2fea(fr, keyScalar, key);
+        Database::dbMTCache.add(key, value, false);
+    }
+    if (Database::dbMTCache.getCurrentSize() > Database::dbMTCache.getMaxSize())
+    {
+        zklog.error("DatabaseCacheTest() found currentSize=" + to_string(Database::dbMTCache.getCurrentSize()) + " > maxSize=" + to_string(Database::dbMTCache.getMaxSize()));
+        numberOfFailed++;
+    }
+    keyScalar = 4*NUMBER_OF_DB_CACHE_ADDS - 1;
+    scalar2fea(fr, keyScalar, key);
+    if (!Database::dbMTCache.find(key, value))
+    {
+        zklog.error("DatabaseCacheTest() failed calling Database::dbMTCache.find() of the most recently added key");
+        numberOfFailed++;
+    }
+
+    // Check that the hot set snapshot contains the most recently used key among the first records, one per shard,
+    // and that it survives a save and load
+    vector<DatabaseCacheSnapshotRecord> records;
+    Database::dbMTCache.getHotSet(NUMBER_OF_DB_CACHE_ADDS, records);
+    bool bFound = false;
+    for (uint64_t i=0; (i<DATABASE_MT_CACHE_SHARDS) && (i<records.size()); i++)
+    {
+        if (fr.equal(records[i].key[0], key[0]) && fr.equal(records[i].key[1], key[1]) && (records[i].valueSize == 12)) bFound = true;
+    }
+    if (!bFound || (records.size() > NUMBER_OF_DB_CACHE_ADDS))
+    {
+        zklog.error("DatabaseCacheTest() got an invalid hot set of size=" + to_string(records.size()));
+        numberOfFailed++;
+    }
+    string snapshotFile = "/tmp/database_cache_test.snapshot";
+    vector<DatabaseCacheSnapshotRecord> loadedRecords;
+    if ( (saveDbCacheSnapshot(snapshotFile, records) != ZKR_SUCCESS) ||
+         (loadDbCacheSnapshot(snapshotFile, loadedRecords) != ZKR_SUCCESS) ||
+         (loadedRecords.size() != records.size()) ||
+         ((records.size() > 0) && (memcmp(loadedRecords.data(), records.data(), records.size()*sizeof(DatabaseCacheSnapshotRecord)) != 0)) )
+    {
+        zklog.error("DatabaseCacheTest() failed saving and loading the hot set snapshot");
+        numberOfFailed++;
     }
+    remove(snapshotFile.c_str());
     
     Database::dbMTCache.clear();
 
@@ -0,0 +1,103 @@
+#include <unistd.h>
+#include <fcntl.h>
+#include "database_file_store_test.hpp"
+#include "database_file_store.hpp"
+#include "timer.hpp"
+#include "scalar.hpp"
+#include "zklog.hpp"
+
+#define DATABASE_FILE_STORE_TEST_FILE "/tmp/database_file_store_test.db"
+#define NUMBER_OF_DB_FILE_STORE_NODES 1000
+
+uint64_t DatabaseFileStoreTest (void)
+{
+    TimerStart(DATABASE_FILE_STORE_TEST);
+
+    uint64_t numberOfFailed = 0;
+    unlink(DATABASE_FILE_STORE_TEST_FILE);
+
+    string stateRootKey = "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff";
+    unordered_map<string, string> nodes;
+    unordered_map<string, string> program;
+    mpz_class keyScalar;
+    for (uint64_t i=0; i<NUMBER_OF_DB_FILE_STORE_NODES; i++)
+    {
+        keyScalar = i;
+        nodes[PrependZeros(keyScalar.get_str(16), 64)] = PrependZeros(keyScalar.get_str(16), 16*12);
+    }
+    program[PrependZeros("abcd", 64)] = "0102030405";
+
+    // Write two flushes, the second one replacing the state root
+    {
+        DatabaseFileStore store;
+        uint64_t writtenBytes;
+        if ((store.open(DATABASE_FILE_STORE_TEST_FILE, 0, false) != ZKR_SUCCESS) ||
+            (store.writeBatch(nodes, program, stateRootKey, PrependZeros("1", 16*12), 1, writtenBytes) != ZKR_SUCCESS) ||
+            (store.writeBatch(nodes, program, stateRootKey, PrependZeros("2", 16*12), 2, writtenBytes) != ZKR_SUCCESS))
+        {
+            zklog.error("DatabaseFileStoreTest() failed writing file");
+            numberOfFailed++;
+        }
+    }
+
+    // Append a torn record, as if the process crashed in the middle of a flush
+    int fd = open(DATABASE_FILE_STORE_TEST_FILE, O_WRONLY | O_APPEND);
+    if ((fd < 0) || (write(fd, "torn record", 11) != 11))
+    {
+        zklog.error("DatabaseFileStoreTest() failed appending torn record");
+        numberOfFailed++;
+    }
+    if (fd >= 0) close(fd);
+
+    // Reopen, compact the dead state root record, and check all the content
+    {
+        DatabaseFileStore store;
+        string value;
+        if ((store.open(DATABASE_FILE_STORE_TEST_FILE, 0, false) != ZKR_SUCCESS) ||
+            (store.compact() != ZKR_SUCCESS))
+        {
+            zklog.error("DatabaseFileStoreTest() failed reopening and compacting file");
+            numberOfFailed++;
+        }
+        if (store.getLastFlushId() != 2)
+        {
+            zklog.error("DatabaseFileStoreTest() got lastFlushId=" + to_string(store.getLastFlushId()) + " instead of 2");
+            numberOfFailed++;
+        }
+        unordered_map<string, string>::const_iterator it;
+        for (it = nodes.begin(); it != nodes.end(); it++)
+        {
+            if ((store.read(false, it->first, value) != ZKR_SUCCESS) || (value != it->second))
+            {
+                zklog.error("DatabaseFileStoreTest() failed reading node key=" + it->first);
+                numberOfFailed++;
+            }
+        }
+        if ((store.read(true, program.begin()->first, value) != ZKR_SUCCESS) || (value != program.begin()->second))
+        {
+            zklog.error("DatabaseFileStoreTest() failed reading program key=" + program.begin()->first);
+            numberOfFailed++;
+        }
+        if ((store.read(false, stateRootKey, value) != ZKR_SUCCESS) || (value != PrependZeros("2", 16*12)))
+        {
+            zklog.error("DatabaseFileStoreTest() failed reading state root value=" + value);
+            numberOfFailed++;
+        }
+        if (store.read(true, nodes.begin()->first, value) != ZKR_DB_KEY_NOT_FOUND)
+        {
+            zklog.error("DatabaseFileStoreTest() found a node key in program index key=" + nodes.begin()->first);
+            numberOfFailed++;
+        }
+    }
+
+    unlink(DATABASE_FILE_STORE_TEST_FILE);
+
+    TimerStopAndLog(DATABASE_FILE_STORE_TEST);
+
+    if (numberOfFailed != 0)
+    {
+        zklog.error("DatabaseFileStoreTest() failed " + to_string(numberOfFailed) + " times");
+    }
+
+    return numberOfFailed;
+}
@@ -0,0 +1,8 @@
+#ifndef DATABASE_FILE_STORE_TEST_HPP
+#define DATABASE_FILE_STORE_TEST_HPP
+
+#include <cstdint>
+
+uint64_t DatabaseFileStoreTest (void);
+
+#endif
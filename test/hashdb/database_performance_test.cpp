@@ -84,11 +84,13 @@ uint64_t DatabasePerformanceTestSendValues (uint64_t valueSize)
     uint64_t pendingToFlushProgram;
     uint64_t storingNodes;
     uint64_t storingProgram;
+    uint64_t storedBytesPerSecond;
+    uint64_t storedRowsPerSecond;
 
     do
     {
         sleep(1);
-        zkr = db.getFlushStatus(storedFlushId, storingFlushId, lastFlushId, pendingToFlushNodes, pendingToFlushProgram, storingNodes, storingProgram);
+        zkr = db.getFlushStatus(storedFlushId, storingFlushId, lastFlushId, pendingToFlushNodes, pendingToFlushProgram, storingNodes, storingProgram, storedBytesPerSecond, storedRowsPerSecond);
         if (zkr != ZKR_SUCCESS)
         {
             cerr << "Error: failed calling db.getFlushStatus() zkr=" << zkr << "=" << zkresult2string(zkr) << endl;
@@ -96,6 +98,8 @@ uint64_t DatabasePerformanceTestSendValues (uint64_t valueSize)
         }
     } while (storedFlushId < flushId);
 
+    zklog.info("DatabasePerformanceTestSendValues() storedBytesPerSecond=" + to_string(storedBytesPerSecond) + " storedRowsPerSecond=" + to_string(storedRowsPerSecond));
+
     delete[] pKeyString;
     delete[] pValue;
 
@@ -0,0 +1,68 @@
+#include "smt_hash_many_test.hpp"
+#include "smt.hpp"
+#include "timer.hpp"
+#include "zklog.hpp"
+
+#define SMT_HASH_MANY_TEST_NODES 100000
+
+uint64_t SmtHashManyTest (void)
+{
+    TimerStart(SMT_HASH_MANY_TEST);
+
+    uint64_t numberOfFailed = 0;
+    Goldilocks fr;
+    Smt smt(fr);
+    PoseidonGoldilocks poseidon;
+
+    // Build the node inputs, like intermediate nodes: 2 child hashes and capacity zero
+    vector<Goldilocks::Element> inputs(SMT_HASH_MANY_TEST_NODES*12);
+    for (uint64_t i=0; i<SMT_HASH_MANY_TEST_NODES; i++)
+    {
+        for (uint64_t j=0; j<8; j++)
+        {
+            inputs[i*12 + j] = fr.fromU64(i*8 + j + 1);
+        }
+        for (uint64_t j=8; j<12; j++)
+        {
+            inputs[i*12 + j] = fr.zero();
+        }
+    }
+
+    // Hash them one by one
+    vector<Goldilocks::Element> hashes(SMT_HASH_MANY_TEST_NODES*4);
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    for (uint64_t i=0; i<SMT_HASH_MANY_TEST_NODES; i++)
+    {
+        poseidon.hash(*(Goldilocks::Element (*)[4])&hashes[i*4], *(const Goldilocks::Element (*)[12])&inputs[i*12]);
+    }
+    uint64_t perNodeTime = TimeDiff(t);
+
+    // Hash them at once
+    vector<Goldilocks::Element> batchHashes(SMT_HASH_MANY_TEST_NODES*4);
+    gettimeofday(&t, NULL);
+    smt.hashMany(inputs.data(), batchHashes.data(), SMT_HASH_MANY_TEST_NODES);
+    uint64_t batchTime = TimeDiff(t);
+
+    for (uint64_t i=0; i<SMT_HASH_MANY_TEST_NODES*4; i++)
+    {
+        if (!fr.equal(hashes[i], batchHashes[i]))
+        {
+            zklog.error("SmtHashManyTest() found different hashes at node=" + to_string(i/4) + " element=" + to_string(i%4));
+            numberOfFailed++;
+            break;
+        }
+    }
+
+    zklog.info("SmtHashManyTest() nodes=" + to_string(SMT_HASH_MANY_TEST_NODES) +
+        " perNode=" + to_string(perNodeTime) + "us (" + to_string(perNodeTime == 0 ? 0 : uint64_t(SMT_HASH_MANY_TEST_NODES)*1000000/perNodeTime) + " hashes/s)" +
+        " batch=" + to_string(batchTime) + "us (" + to_string(batchTime == 0 ? 0 : uint64_t(SMT_HASH_MANY_TEST_NODES)*1000000/batchTime) + " hashes/s)");
+
+    TimerStopAndLog(SMT_HASH_MANY_TEST);
+
+    if (numberOfFailed != 0)
+    {
+        zklog.error("SmtHashManyTest() failed " + to_string(numberOfFailed) + " times");
+    }
+    return numberOfFailed;
+}
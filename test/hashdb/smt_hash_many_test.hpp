@@ -0,0 +1,8 @@
+#ifndef SMT_HASH_MANY_TEST_HPP
+#define SMT_HASH_MANY_TEST_HPP
+
+#include <cstdint>
+
+uint64_t SmtHashManyTest (void);
+
+#endif
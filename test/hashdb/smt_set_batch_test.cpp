@@ -0,0 +1,201 @@
+#include "smt_set_batch_test.hpp"
+#include "smt.hpp"
+#include "database.hpp"
+#include "state_manager.hpp"
+#include "utils.hpp"
+#include "timer.hpp"
+#include "scalar.hpp"
+#include "zklog.hpp"
+
+#define SMT_SET_BATCH_TEST_INITIAL_KEYS 1000
+#define SMT_SET_BATCH_TEST_BATCH_KEYS 200
+
+// Flushes the state manager batch, if any, so that its nodes can be read from the database
+static uint64_t SmtSetBatchTestFlush (Goldilocks &fr, Database &db, const string &batchUUID, const Goldilocks::Element (&root)[4])
+{
+    if (batchUUID.size() == 0)
+    {
+        return 0;
+    }
+    uint64_t flushId, lastSentFlushId;
+    zkresult zkr = stateManager.flush(batchUUID, fea2string(fr, root), PERSISTENCE_DATABASE, db, flushId, lastSentFlushId);
+    if (zkr != ZKR_SUCCESS)
+    {
+        zklog.error("SmtSetBatchTestFlush() failed calling stateManager.flush() zkr=" + zkresult2string(zkr));
+        return 1;
+    }
+    return 0;
+}
+
+// Sets the same keys one by one and at once, with the state manager or not, and compares the new roots and the per-key results
+static uint64_t SmtSetBatchTestRun (const Config &_config, bool bStateManager)
+{
+    uint64_t numberOfFailed = 0;
+    zkresult zkr;
+
+    // Use a local database, with the state manager or not
+    Config config = _config;
+    config.databaseURL = "local";
+    config.dbMultiWrite = false;
+    config.stateManager = bStateManager;
+
+    Goldilocks fr;
+    Database db(fr, config);
+    db.init();
+    Smt smt(fr);
+    if (bStateManager)
+    {
+        stateManager.init(config);
+    }
+
+    // Local databases share the static cache, so every run uses its own values, i.e. its own nodes
+    uint64_t salt = bStateManager ? 1000000 : 0;
+
+    // The state manager is used only by the sets of a batch, i.e. with a non-empty batch UUID
+    string sequentialBatchUUID = bStateManager ? getUUID() : "";
+    string batchBatchUUID = bStateManager ? getUUID() : "";
+    string resultsBatchUUID = bStateManager ? getUUID() : "";
+
+    // Build an initial tree, directly in the database
+    Goldilocks::Element root[4] = {fr.zero(), fr.zero(), fr.zero(), fr.zero()};
+    Goldilocks::Element key[4];
+    SmtSetResult setResult;
+    for (uint64_t i=0; i<SMT_SET_BATCH_TEST_INITIAL_KEYS; i++)
+    {
+        key[0] = fr.fromU64(i);
+        key[1] = fr.fromU64(i*7 + 1);
+        key[2] = fr.fromU64(i*13 + 2);
+        key[3] = fr.fromU64(i*17 + 3);
+        zkr = smt.set("", 0, db, root, key, salt + i + 1, PERSISTENCE_DATABASE, setResult);
+        if (zkr != ZKR_SUCCESS)
+        {
+            zklog.error("SmtSetBatchTestRun() failed calling smt.set() i=" + to_string(i) + " zkr=" + zkresult2string(zkr));
+            return 1;
+        }
+        for (uint64_t j=0; j<4; j++) root[j] = setResult.newRoot[j];
+    }
+
+    // Build a batch that updates, deletes and inserts keys, some of them more than once, like an account nonce, balance and storage
+    vector<Goldilocks::Element> keys;
+    vector<mpz_class> values;
+    for (uint64_t i=0; i<SMT_SET_BATCH_TEST_BATCH_KEYS; i++)
+    {
+        uint64_t k = (i % 3 == 0) ? (i*5) % SMT_SET_BATCH_TEST_INITIAL_KEYS : SMT_SET_BATCH_TEST_INITIAL_KEYS + i/2;
+        keys.push_back(fr.fromU64(k));
+        keys.push_back(fr.fromU64(k*7 + 1));
+        keys.push_back(fr.fromU64(k*13 + 2));
+        keys.push_back(fr.fromU64(k*17 + 3));
+        values.push_back((i % 4 == 0) ? 0 : salt + i + 1000);
+    }
+
+    // Set the keys at once, first, so that only setBatch() has written the nodes of the new tree
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    Goldilocks::Element batchRoot[4];
+    zkr = smt.setBatch(batchBatchUUID, 0, db, root, keys, values, PERSISTENCE_DATABASE, batchRoot);
+    uint64_t batchTime = TimeDiff(t);
+    if (zkr != ZKR_SUCCESS)
+    {
+        zklog.error("SmtSetBatchTestRun() failed calling smt.setBatch() zkr=" + zkresult2string(zkr));
+        return numberOfFailed + 1;
+    }
+
+    // Flush the state manager batch, so that the new tree is in the database
+    numberOfFailed += SmtSetBatchTestFlush(fr, db, batchBatchUUID, batchRoot);
+
+    // Every key must have its last value in the new tree, read from the nodes saved by setBatch()
+    SmtGetResult getResult;
+    for (uint64_t i=0; i<SMT_SET_BATCH_TEST_BATCH_KEYS; i++)
+    {
+        for (uint64_t j=0; j<4; j++) key[j] = keys[i*4 + j];
+        mpz_class expectedValue = values[i];
+        for (uint64_t k=i+1; k<SMT_SET_BATCH_TEST_BATCH_KEYS; k++)
+        {
+            if (fr.equal(keys[k*4], key[0]) && fr.equal(keys[k*4+1], key[1]) && fr.equal(keys[k*4+2], key[2]) && fr.equal(keys[k*4+3], key[3]))
+            {
+                expectedValue = values[k];
+            }
+        }
+        zkr = smt.get("", db, batchRoot, key, getResult);
+        if ((zkr != ZKR_SUCCESS) || (getResult.value != expectedValue))
+        {
+            zklog.error("SmtSetBatchTestRun() failed calling smt.get() i=" + to_string(i) + " zkr=" + zkresult2string(zkr) + " value=" + getResult.value.get_str(10) + " expected=" + expectedValue.get_str(10));
+            numberOfFailed++;
+            break;
+        }
+    }
+
+    // Set the keys one by one, as reference, keeping their results
+    gettimeofday(&t, NULL);
+    Goldilocks::Element sequentialRoot[4];
+    vector<SmtSetResult> sequentialResults(SMT_SET_BATCH_TEST_BATCH_KEYS);
+    for (uint64_t j=0; j<4; j++) sequentialRoot[j] = root[j];
+    for (uint64_t i=0; i<SMT_SET_BATCH_TEST_BATCH_KEYS; i++)
+    {
+        for (uint64_t j=0; j<4; j++) key[j] = keys[i*4 + j];
+        zkr = smt.set(sequentialBatchUUID, 0, db, sequentialRoot, key, values[i], PERSISTENCE_DATABASE, sequentialResults[i]);
+        if (zkr != ZKR_SUCCESS)
+        {
+            zklog.error("SmtSetBatchTestRun() failed calling smt.set() i=" + to_string(i) + " zkr=" + zkresult2string(zkr));
+            return 1;
+        }
+        for (uint64_t j=0; j<4; j++) sequentialRoot[j] = sequentialResults[i].newRoot[j];
+    }
+    uint64_t sequentialTime = TimeDiff(t);
+
+    // The reference root must be the one of setBatch()
+    numberOfFailed += SmtSetBatchTestFlush(fr, db, sequentialBatchUUID, sequentialRoot);
+    if (fea2string(fr, batchRoot) != fea2string(fr, sequentialRoot))
+    {
+        zklog.error("SmtSetBatchTestRun() got batchRoot=" + fea2string(fr, batchRoot) + " != sequentialRoot=" + fea2string(fr, sequentialRoot));
+        numberOfFailed++;
+    }
+
+    // Set the keys at once, requesting the per-key results, which must match the ones of the sequential sets
+    vector<SmtSetResult> results;
+    Goldilocks::Element resultsRoot[4];
+    zkr = smt.setBatch(resultsBatchUUID, 0, db, root, keys, values, PERSISTENCE_DATABASE, resultsRoot, &results);
+    if ((zkr != ZKR_SUCCESS) || (results.size() != SMT_SET_BATCH_TEST_BATCH_KEYS) || (fea2string(fr, resultsRoot) != fea2string(fr, sequentialRoot)))
+    {
+        zklog.error("SmtSetBatchTestRun() failed calling smt.setBatch() with results zkr=" + zkresult2string(zkr) + " results.size=" + to_string(results.size()) + " resultsRoot=" + fea2string(fr, resultsRoot));
+        return numberOfFailed + 1;
+    }
+    for (uint64_t i=0; i<SMT_SET_BATCH_TEST_BATCH_KEYS; i++)
+    {
+        string batchResult = results[i].toString(fr);
+        string sequentialResult = sequentialResults[i].toString(fr);
+        if (batchResult != sequentialResult)
+        {
+            zklog.error("SmtSetBatchTestRun() got a different result for key i=" + to_string(i) + "\nbatch:\n" + batchResult + "sequential:\n" + sequentialResult);
+            numberOfFailed++;
+            break;
+        }
+    }
+
+    numberOfFailed += SmtSetBatchTestFlush(fr, db, resultsBatchUUID, resultsRoot);
+
+    zklog.info("SmtSetBatchTestRun() stateManager=" + to_string(bStateManager) + " keys=" + to_string(SMT_SET_BATCH_TEST_BATCH_KEYS) + " sequential=" + to_string(sequentialTime) + "us batch=" + to_string(batchTime) + "us");
+
+    return numberOfFailed;
+}
+
+uint64_t SmtSetBatchTest (const Config &config)
+{
+    TimerStart(SMT_SET_BATCH_TEST);
+
+    uint64_t numberOfFailed = 0;
+
+    // Without state manager, the nodes are written to the database
+    numberOfFailed += SmtSetBatchTestRun(config, false);
+
+    // With state manager, the nodes are written to the batch state, and the deleted keys retire their nodes from it
+    numberOfFailed += SmtSetBatchTestRun(config, true);
+
+    TimerStopAndLog(SMT_SET_BATCH_TEST);
+
+    if (numberOfFailed != 0)
+    {
+        zklog.error("SmtSetBatchTest() failed " + to_string(numberOfFailed) + " times");
+    }
+    return numberOfFailed;
+}
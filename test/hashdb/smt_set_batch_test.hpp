@@ -0,0 +1,9 @@
+#ifndef SMT_SET_BATCH_TEST_HPP
+#define SMT_SET_BATCH_TEST_HPP
+
+#include <cstdint>
+#include "config.hpp"
+
+uint64_t SmtSetBatchTest (const Config &config);
+
+#endif
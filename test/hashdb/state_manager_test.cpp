@@ -0,0 +1,150 @@
+#include "state_manager_test.hpp"
+#include "state_manager.hpp"
+#include "smt.hpp"
+#include "database.hpp"
+#include "utils.hpp"
+#include "timer.hpp"
+#include "scalar.hpp"
+#include "zklog.hpp"
+#include "zkmax.hpp"
+
+#define STATE_MANAGER_TEST_NUMBER_OF_SETS 10000
+
+// The arena must save at least this factor of heap allocations
+#define STATE_MANAGER_TEST_MIN_HEAP_ALLOCATIONS_RATIO 100
+
+// Runs the test sets in a new batch, with the batch arena enabled or not, and gets the batch arena statistics
+static uint64_t StateManagerTestSets (Goldilocks &fr, const Config &config, Database &db, Smt &smt, const string &batchUUID, Goldilocks::Element (&root)[4], uint64_t &time, uint64_t &allocations, uint64_t &allocatedBytes, uint64_t &heapAllocations)
+{
+    zkresult zkr;
+    Goldilocks::Element key[4];
+    mpz_class value;
+    SmtSetResult setResult;
+
+    stateManager.init(config);
+
+    for (uint64_t j=0; j<4; j++) root[j] = fr.zero();
+
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    for (uint64_t i=0; i<STATE_MANAGER_TEST_NUMBER_OF_SETS; i++)
+    {
+        key[0] = fr.fromU64(i);
+        key[1] = fr.fromU64(i*7 + 1);
+        key[2] = fr.fromU64(i*13 + 2);
+        key[3] = fr.fromU64(i*17 + 3);
+        value = i + 1;
+        zkr = smt.set(batchUUID, 0, db, root, key, value, PERSISTENCE_DATABASE, setResult);
+        if (zkr != ZKR_SUCCESS)
+        {
+            zklog.error("StateManagerTestSets() failed calling smt.set() i=" + to_string(i) + " zkr=" + zkresult2string(zkr));
+            return 1;
+        }
+        for (uint64_t j=0; j<4; j++) root[j] = setResult.newRoot[j];
+    }
+    time = TimeDiff(t);
+
+    zkr = stateManager.getArenaStatistics(batchUUID, allocations, allocatedBytes, heapAllocations);
+    if (zkr != ZKR_SUCCESS)
+    {
+        zklog.error("StateManagerTestSets() failed calling stateManager.getArenaStatistics() zkr=" + zkresult2string(zkr));
+        return 1;
+    }
+
+    zklog.info("StateManagerTestSets() stateManagerArena=" + to_string(config.stateManagerArena) +
+        " sets=" + to_string(STATE_MANAGER_TEST_NUMBER_OF_SETS) +
+        " time=" + to_string(time) + "us" +
+        " allocations=" + to_string(allocations) +
+        " (" + to_string(double(allocations)/STATE_MANAGER_TEST_NUMBER_OF_SETS) + "/set)" +
+        " allocatedBytes=" + to_string(allocatedBytes) +
+        " heapAllocations=" + to_string(heapAllocations) +
+        " (" + to_string(double(heapAllocations)/STATE_MANAGER_TEST_NUMBER_OF_SETS) + "/set)");
+
+    return 0;
+}
+
+uint64_t StateManagerTest (const Config &_config)
+{
+    TimerStart(STATE_MANAGER_TEST);
+
+    uint64_t numberOfFailed = 0;
+    zkresult zkr;
+
+    // Use a local database and the state manager
+    Config config = _config;
+    config.databaseURL = "local";
+    config.dbMultiWrite = false;
+    config.stateManager = true;
+
+    Goldilocks fr;
+    Database db(fr, config);
+    db.init();
+    Smt smt(fr);
+
+    Goldilocks::Element root[4];
+    Goldilocks::Element key[4];
+    uint64_t time, allocations, allocatedBytes, heapAllocations;
+    uint64_t flushId, lastSentFlushId;
+
+    // Before: run the sets with every allocation served by the heap, as with the default allocator
+    config.stateManagerArena = false;
+    string baselineBatchUUID = getUUID();
+    uint64_t baselineTime = 0;
+    uint64_t baselineHeapAllocations = 0;
+    numberOfFailed += StateManagerTestSets(fr, config, db, smt, baselineBatchUUID, root, baselineTime, allocations, allocatedBytes, baselineHeapAllocations);
+    zkr = stateManager.flush(baselineBatchUUID, fea2string(fr, root), PERSISTENCE_DATABASE, db, flushId, lastSentFlushId);
+    if (zkr != ZKR_SUCCESS)
+    {
+        zklog.error("StateManagerTest() failed calling stateManager.flush() of the baseline batch zkr=" + zkresult2string(zkr));
+        numberOfFailed++;
+    }
+
+    // After: run the same sets with the batch arena
+    config.stateManagerArena = true;
+    string batchUUID = getUUID();
+    numberOfFailed += StateManagerTestSets(fr, config, db, smt, batchUUID, root, time, allocations, allocatedBytes, heapAllocations);
+
+    zklog.info("StateManagerTest() heap allocations per set before=" + to_string(double(baselineHeapAllocations)/STATE_MANAGER_TEST_NUMBER_OF_SETS) +
+        " after=" + to_string(double(heapAllocations)/STATE_MANAGER_TEST_NUMBER_OF_SETS) +
+        " ratio=" + to_string(double(baselineHeapAllocations)/zkmax(heapAllocations, (uint64_t)1)) +
+        " time before=" + to_string(baselineTime) + "us after=" + to_string(time) + "us");
+    if ((numberOfFailed == 0) && (heapAllocations*STATE_MANAGER_TEST_MIN_HEAP_ALLOCATIONS_RATIO > baselineHeapAllocations))
+    {
+        zklog.error("StateManagerTest() found heapAllocations=" + to_string(heapAllocations) + " with the arena, not " + to_string(STATE_MANAGER_TEST_MIN_HEAP_ALLOCATIONS_RATIO) + " times less than heapAllocations=" + to_string(baselineHeapAllocations) + " without it");
+        numberOfFailed++;
+    }
+
+    // Flush the batch, which releases its arena
+    zkr = stateManager.flush(batchUUID, fea2string(fr, root), PERSISTENCE_DATABASE, db, flushId, lastSentFlushId);
+    if (zkr != ZKR_SUCCESS)
+    {
+        zklog.error("StateManagerTest() failed calling stateManager.flush() zkr=" + zkresult2string(zkr));
+        numberOfFailed++;
+    }
+    if (stateManager.getArenaStatistics(batchUUID, allocations, allocatedBytes, heapAllocations) != ZKR_DB_KEY_NOT_FOUND)
+    {
+        zklog.error("StateManagerTest() found batch state after flush");
+        numberOfFailed++;
+    }
+
+    // The flushed tree must be readable from the database
+    SmtGetResult getResult;
+    key[0] = fr.fromU64(0);
+    key[1] = fr.fromU64(1);
+    key[2] = fr.fromU64(2);
+    key[3] = fr.fromU64(3);
+    zkr = smt.get("", db, root, key, getResult);
+    if ((zkr != ZKR_SUCCESS) || (getResult.value != 1))
+    {
+        zklog.error("StateManagerTest() failed calling smt.get() after flush zkr=" + zkresult2string(zkr) + " value=" + getResult.value.get_str(10));
+        numberOfFailed++;
+    }
+
+    TimerStopAndLog(STATE_MANAGER_TEST);
+
+    if (numberOfFailed != 0)
+    {
+        zklog.error("StateManagerTest() failed " + to_string(numberOfFailed) + " times");
+    }
+    return numberOfFailed;
+}
@@ -0,0 +1,149 @@
+#include <unordered_map>
+#include <sys/time.h>
+#include "context_memory_test.hpp"
+#include "main_sm/fork_5/main/context.hpp"
+#include "main_exec_test_utils.hpp"
+#include "zklog.hpp"
+#include "timer.hpp"
+#include "zkmax.hpp"
+
+using namespace fork_5;
+
+#define CONTEXT_MEMORY_TEST_CONTEXTS 64
+#define CONTEXT_MEMORY_TEST_ACCESSES (10*1000*1000)
+
+// Generates a memory access pattern similar to the one of the ROM: global variables, context
+// variables, stack pushes and pops, and reads and writes of the EVM memory of every context
+static void generateAccesses (vector<uint64_t> &addresses, vector<bool> &isWrite)
+{
+    addresses.resize(CONTEXT_MEMORY_TEST_ACCESSES);
+    isWrite.resize(CONTEXT_MEMORY_TEST_ACCESSES);
+    uint64_t seed = 1;
+    uint64_t sp = 0;
+    for (uint64_t i = 0; i < CONTEXT_MEMORY_TEST_ACCESSES; i++)
+    {
+        seed = seed*6364136223846793005ULL + 1442695040888963407ULL;
+        uint64_t r = seed >> 33;
+        uint64_t ctxOffset = ((r >> 8) % CONTEXT_MEMORY_TEST_CONTEXTS)*0x40000;
+        switch (r % 4)
+        {
+            case 0: // Global or context variable
+                addresses[i] = ((r & 0x10) ? 0 : ctxOffset) + ((r >> 16) % 256);
+                isWrite[i] = (r & 0x20) != 0;
+                break;
+            case 1: // Stack push or pop
+                if ((r & 0x10) && (sp < 1024)) { addresses[i] = ctxOffset + 0x10000 + sp; sp++; isWrite[i] = true; }
+                else { if (sp > 0) sp--; addresses[i] = ctxOffset + 0x10000 + sp; isWrite[i] = false; }
+                break;
+            default: // EVM memory
+                addresses[i] = ctxOffset + 0x20000 + ((r >> 16) % 4096);
+                isWrite[i] = (r & 0x20) != 0;
+                break;
+        }
+    }
+}
+
+uint64_t ContextMemoryTest (Goldilocks &fr, PoseidonGoldilocks &poseidon, Config &config)
+{
+    TimerStart(CONTEXT_MEMORY_TEST);
+
+    uint64_t failures = 0;
+
+    vector<uint64_t> addresses;
+    vector<bool> isWrite;
+    generateAccesses(addresses, isWrite);
+
+    // Replay the accesses on the former memory map, as reference, and on the context memory
+    unordered_map<uint64_t, Fea> mapMem;
+    ContextMemory contextMem;
+    vector<uint64_t> mapReads(addresses.size(), 0);
+    vector<uint64_t> contextReads(addresses.size(), 0);
+
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    for (uint64_t i = 0; i < addresses.size(); i++)
+    {
+        if (isWrite[i])
+        {
+            mapMem[addresses[i]].fe0 = fr.fromU64(i);
+        }
+        else
+        {
+            unordered_map<uint64_t, Fea>::iterator it = mapMem.find(addresses[i]);
+            mapReads[i] = (it == mapMem.end()) ? 0 : fr.toU64(it->second.fe0) + 1;
+        }
+    }
+    uint64_t mapTime = TimeDiff(t);
+
+    gettimeofday(&t, NULL);
+    for (uint64_t i = 0; i < addresses.size(); i++)
+    {
+        if (isWrite[i])
+        {
+            contextMem[addresses[i]].fe0 = fr.fromU64(i);
+        }
+        else
+        {
+            Fea * pValue = contextMem.find(addresses[i]);
+            contextReads[i] = (pValue == NULL) ? 0 : fr.toU64(pValue->fe0) + 1;
+        }
+    }
+    uint64_t contextTime = TimeDiff(t);
+
+    for (uint64_t i = 0; i < addresses.size(); i++)
+    {
+        if (mapReads[i] != contextReads[i])
+        {
+            zklog.error("ContextMemoryTest() read mismatch at access " + to_string(i) + " address=" + to_string(addresses[i]) + " map=" + to_string(mapReads[i]) + " context=" + to_string(contextReads[i]));
+            failures++;
+            break;
+        }
+    }
+    if (mapMem.size() != contextMem.size())
+    {
+        zklog.error("ContextMemoryTest() size mismatch map=" + to_string(mapMem.size()) + " context=" + to_string(contextMem.size()));
+        failures++;
+    }
+    vector<uint64_t> written;
+    contextMem.getAddresses(written);
+    for (uint64_t i = 0; i < written.size(); i++)
+    {
+        if ((mapMem.find(written[i]) == mapMem.end()) || ((i > 0) && (written[i] <= written[i-1])))
+        {
+            zklog.error("ContextMemoryTest() unexpected written address=" + to_string(written[i]));
+            failures++;
+            break;
+        }
+    }
+
+    zklog.info("ContextMemoryTest() accesses=" + to_string(addresses.size()) + " slots=" + to_string(contextMem.size()) +
+        " map=" + to_string(double(mapTime)/1000) + "ms context=" + to_string(double(contextTime)/1000) + "ms speedup=" + to_string(double(mapTime)/double(zkmax(contextTime, 1))));
+
+    // Execute the input files, e.g. memory-heavy test vectors, on the context memory; the main executor
+    // checks every memory read against the ROM, so a wrong value stops the execution
+    vector<string> files;
+    getInputFiles(config, files);
+    if (files.size() > 0)
+    {
+        Executor executor(fr, config, poseidon);
+        for (uint64_t i = 0; i < files.size(); i++)
+        {
+            ProverRequest proverRequest(fr, config, prt_processBatch);
+            processInputFile(executor, files[i], proverRequest);
+            zklog.info("ContextMemoryTest() file=" + files[i] + " result=" + zkresult2string(proverRequest.result) + " steps=" + to_string(proverRequest.counters.steps));
+        }
+    }
+
+    TimerStopAndLog(CONTEXT_MEMORY_TEST);
+
+    if (failures == 0)
+    {
+        zklog.info("ContextMemoryTest() succeeded");
+    }
+    else
+    {
+        zklog.error("ContextMemoryTest() failed with " + to_string(failures) + " errors");
+    }
+
+    return failures;
+}
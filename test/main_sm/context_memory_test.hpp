@@ -0,0 +1,11 @@
+#ifndef CONTEXT_MEMORY_TEST_HPP
+#define CONTEXT_MEMORY_TEST_HPP
+
+#include <cstdint>
+#include "goldilocks_base_field.hpp"
+#include "poseidon_goldilocks.hpp"
+#include "config.hpp"
+
+uint64_t ContextMemoryTest (Goldilocks &fr, PoseidonGoldilocks &poseidon, Config &config);
+
+#endif
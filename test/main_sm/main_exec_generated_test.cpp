@@ -0,0 +1,100 @@
+#include "main_exec_generated_test.hpp"
+#include "main_exec_test_utils.hpp"
+#include "zklog.hpp"
+#include "timer.hpp"
+#include "definitions.hpp"
+
+#define MAIN_EXEC_GENERATED_TEST_COMPARE(name, native, generated) \
+    if ((native) != (generated)) \
+    { \
+        zklog.error("MainExecGeneratedTest() file=" + files[i] + " " + name + " native=" + to_string(native) + " generated=" + to_string(generated)); \
+        failures++; \
+    }
+
+#define MAIN_EXEC_GENERATED_TEST_COMPARE_STRING(name, native, generated) \
+    if ((native) != (generated)) \
+    { \
+        zklog.error("MainExecGeneratedTest() file=" + files[i] + " " + name + " native=" + (native) + " generated=" + (generated)); \
+        failures++; \
+    }
+
+uint64_t MainExecGeneratedTest (Goldilocks &fr, PoseidonGoldilocks &poseidon, Config &config)
+{
+    TimerStart(MAIN_EXEC_GENERATED_TEST);
+
+    uint64_t failures = 0;
+
+#ifndef __MAIN_EXEC_GENERATED__
+    zklog.error("MainExecGeneratedTest() the generated main executor is not compiled; run 'make main_exec_generated' and rebuild");
+    failures++;
+#else
+    if (PROVER_FORK_ID != 5)
+    {
+        zklog.error("MainExecGeneratedTest() only fork 5 has a generated main executor, but PROVER_FORK_ID=" + to_string(PROVER_FORK_ID));
+        return 1;
+    }
+
+    // One executor per implementation, since process_batch() selects it by config
+    Config nativeConfig = config;
+    nativeConfig.useMainExecC = false;
+    nativeConfig.useMainExecGenerated = false;
+    Config generatedConfig = config;
+    generatedConfig.useMainExecC = false;
+    generatedConfig.useMainExecGenerated = true;
+    Executor nativeExecutor(fr, nativeConfig, poseidon);
+    Executor generatedExecutor(fr, generatedConfig, poseidon);
+
+    vector<string> files;
+    getInputFiles(config, files);
+    if (files.size() == 0)
+    {
+        zklog.error("MainExecGeneratedTest() found no input file in inputFile=" + config.inputFile);
+        return 1;
+    }
+
+    for (uint64_t i = 0; i < files.size(); i++)
+    {
+        ProverRequest nativeRequest(fr, nativeConfig, prt_processBatch);
+        ProverRequest generatedRequest(fr, generatedConfig, prt_processBatch);
+
+        TimerStart(MAIN_EXEC_GENERATED_TEST_NATIVE);
+        processInputFile(nativeExecutor, files[i], nativeRequest);
+        TimerStopAndLog(MAIN_EXEC_GENERATED_TEST_NATIVE);
+        TimerStart(MAIN_EXEC_GENERATED_TEST_GENERATED);
+        processInputFile(generatedExecutor, files[i], generatedRequest);
+        TimerStopAndLog(MAIN_EXEC_GENERATED_TEST_GENERATED);
+
+        MAIN_EXEC_GENERATED_TEST_COMPARE_STRING("result", zkresult2string(nativeRequest.result), zkresult2string(generatedRequest.result));
+        MAIN_EXEC_GENERATED_TEST_COMPARE("counters.arith", nativeRequest.counters.arith, generatedRequest.counters.arith);
+        MAIN_EXEC_GENERATED_TEST_COMPARE("counters.binary", nativeRequest.counters.binary, generatedRequest.counters.binary);
+        MAIN_EXEC_GENERATED_TEST_COMPARE("counters.keccakF", nativeRequest.counters.keccakF, generatedRequest.counters.keccakF);
+        MAIN_EXEC_GENERATED_TEST_COMPARE("counters.memAlign", nativeRequest.counters.memAlign, generatedRequest.counters.memAlign);
+        MAIN_EXEC_GENERATED_TEST_COMPARE("counters.paddingPG", nativeRequest.counters.paddingPG, generatedRequest.counters.paddingPG);
+        MAIN_EXEC_GENERATED_TEST_COMPARE("counters.poseidonG", nativeRequest.counters.poseidonG, generatedRequest.counters.poseidonG);
+        MAIN_EXEC_GENERATED_TEST_COMPARE("counters.steps", nativeRequest.counters.steps, generatedRequest.counters.steps);
+        if ((nativeRequest.pFullTracer != NULL) && (generatedRequest.pFullTracer != NULL))
+        {
+            MAIN_EXEC_GENERATED_TEST_COMPARE_STRING("newStateRoot", nativeRequest.pFullTracer->get_new_state_root(), generatedRequest.pFullTracer->get_new_state_root());
+            MAIN_EXEC_GENERATED_TEST_COMPARE_STRING("newAccInputHash", nativeRequest.pFullTracer->get_new_acc_input_hash(), generatedRequest.pFullTracer->get_new_acc_input_hash());
+            MAIN_EXEC_GENERATED_TEST_COMPARE_STRING("newLocalExitRoot", nativeRequest.pFullTracer->get_new_local_exit_root(), generatedRequest.pFullTracer->get_new_local_exit_root());
+            MAIN_EXEC_GENERATED_TEST_COMPARE("cumulativeGasUsed", nativeRequest.pFullTracer->get_cumulative_gas_used(), generatedRequest.pFullTracer->get_cumulative_gas_used());
+            MAIN_EXEC_GENERATED_TEST_COMPARE("txNumber", nativeRequest.pFullTracer->get_tx_number(), generatedRequest.pFullTracer->get_tx_number());
+        }
+
+        zklog.info("MainExecGeneratedTest() checked file=" + files[i] + " steps=" + to_string(nativeRequest.counters.steps) + " failures=" + to_string(failures));
+    }
+#endif
+
+    TimerStopAndLog(MAIN_EXEC_GENERATED_TEST);
+
+    if (failures == 0)
+    {
+        zklog.info("MainExecGeneratedTest() succeeded");
+    }
+    else
+    {
+        zklog.error("MainExecGeneratedTest() failed with " + to_string(failures) + " mismatches");
+    }
+
+    return failures;
+}
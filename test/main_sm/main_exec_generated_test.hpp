@@ -0,0 +1,13 @@
+#ifndef MAIN_EXEC_GENERATED_TEST_HPP
+#define MAIN_EXEC_GENERATED_TEST_HPP
+
+#include <cstdint>
+#include "goldilocks_base_field.hpp"
+#include "poseidon_goldilocks.hpp"
+#include "config.hpp"
+
+// Executes every input of config.inputFile (a file, or a folder if it ends with '/') with the main SM
+// interpreter and with the generated executor, and compares their results; returns the number of mismatches
+uint64_t MainExecGeneratedTest (Goldilocks &fr, PoseidonGoldilocks &poseidon, Config &config);
+
+#endif
@@ -0,0 +1,40 @@
+#include "main_exec_test_utils.hpp"
+#include "utils.hpp"
+#include "zklog.hpp"
+#include "exit_process.hpp"
+
+void getInputFiles (const Config &config, vector<string> &files)
+{
+    files.clear();
+    if (config.inputFile.size() > 0 && config.inputFile.back() == '/')
+    {
+        files = getFolderFiles(config.inputFile, true);
+        for (uint64_t i = 0; i < files.size(); i++)
+        {
+            files[i] = config.inputFile + files[i];
+        }
+    }
+    else if (config.inputFile.size() > 0)
+    {
+        files.push_back(config.inputFile);
+    }
+}
+
+void processInputFile (Executor &executor, const string &inputFile, ProverRequest &proverRequest)
+{
+    json inputJson;
+    file2json(inputFile, inputJson);
+    zkresult zkResult = proverRequest.input.load(inputJson);
+    if (zkResult != ZKR_SUCCESS)
+    {
+        zklog.error("processInputFile() failed calling proverRequest.input.load() file=" + inputFile + " zkResult=" + zkresult2string(zkResult));
+        exitProcess();
+    }
+    proverRequest.CreateFullTracer();
+    if (proverRequest.result != ZKR_SUCCESS)
+    {
+        zklog.error("processInputFile() failed calling proverRequest.CreateFullTracer() file=" + inputFile + " zkResult=" + zkresult2string(proverRequest.result));
+        exitProcess();
+    }
+    executor.process_batch(proverRequest);
+}
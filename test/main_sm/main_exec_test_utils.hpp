@@ -0,0 +1,18 @@
+#ifndef MAIN_EXEC_TEST_UTILS_HPP
+#define MAIN_EXEC_TEST_UTILS_HPP
+
+#include <string>
+#include <vector>
+#include "config.hpp"
+#include "executor.hpp"
+#include "prover_request.hpp"
+
+using namespace std;
+
+// Returns the input files of config.inputFile: the file itself, or every file of the folder if it ends with '/'
+void getInputFiles (const Config &config, vector<string> &files);
+
+// Loads the input file into the request and executes it with the given executor, leaving the results in the request
+void processInputFile (Executor &executor, const string &inputFile, ProverRequest &proverRequest);
+
+#endif
@@ -503,6 +503,56 @@ void* hashDBTestClientThread (const Config& config)
         cout << "HashDB client test 12 done" << endl;
     }
 
+    // It should get many elements at once (getMany), matching get() for existing and missing keys
+    {
+        SmtSetResult setResult;
+
+        Goldilocks::Element root[4]={0,0,0,0};
+        Goldilocks::Element newRoot[4]={0,0,0,0};
+        mpz_class value;
+        mpz_class keyScalar;
+
+        vector<Goldilocks::Element> keys;
+        for (uint64_t i=0; i<32; i++)
+        {
+            Goldilocks::Element key[4];
+            keyScalar = i + 1;
+            scalar2key(fr, keyScalar, key);
+            for (uint64_t k=0; k<4; k++) keys.push_back(key[k]);
+
+            // Only even keys are set, so that odd keys are missing
+            if ((i % 2) == 0)
+            {
+                value = i + 100;
+                client->set(uuid, tx, root, key, value, persistence, newRoot, &setResult, NULL);
+                for (uint64_t k=0; k<4; k++) root[k] = setResult.newRoot[k];
+            }
+        }
+
+        vector<mpz_class> values;
+        vector<SmtGetResult> results;
+        zkresult zkr = client->getMany(uuid, root, keys, values, &results, NULL);
+        zkassertpermanent(zkr==ZKR_SUCCESS);
+        zkassertpermanent(values.size()==32);
+        zkassertpermanent(results.size()==32);
+
+        for (uint64_t i=0; i<32; i++)
+        {
+            Goldilocks::Element key[4] = { keys[i*4], keys[i*4 + 1], keys[i*4 + 2], keys[i*4 + 3] };
+            SmtGetResult getResult;
+            zkr = client->get(uuid, root, key, value, &getResult, NULL);
+            zkassertpermanent(zkr==ZKR_SUCCESS);
+            zkassertpermanent(values[i]==(((i % 2) == 0) ? i + 100 : 0));
+            zkassertpermanent(values[i]==value);
+            zkassertpermanent(results[i].isOld0==getResult.isOld0);
+            zkassertpermanent(results[i].insValue==getResult.insValue);
+            zkassertpermanent(results[i].siblings.size()==getResult.siblings.size());
+            zkassertpermanent(results[i].proofHashCounter==getResult.proofHashCounter);
+        }
+
+        cout << "HashDB client test 13 done" << endl;
+    }
+
     delete client;
 
     cout << "HashDB test client done" << endl;
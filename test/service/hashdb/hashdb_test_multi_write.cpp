@@ -100,10 +100,10 @@ uint64_t HashDBTestMultiWrite (const Config& config)
 
     do
     {
-        uint64_t storingFlushId, lastFlushId, pendingToFlushNodes, pendingToFlushProgram, storingNodes, storingProgram;
+        uint64_t storingFlushId, lastFlushId, pendingToFlushNodes, pendingToFlushProgram, storingNodes, storingProgram, storedBytesPerSecond, storedRowsPerSecond;
         string proverId;
-        pHashDB->getFlushStatus(storedFlushId, storingFlushId, lastFlushId, pendingToFlushNodes, pendingToFlushProgram, storingNodes, storingProgram, proverId);
-        zklog.info("HashDBTestMultiWrite() after getFlushStatus() flushId=" + to_string(flushId) + " storedFlushId=" + to_string(storedFlushId));
+        pHashDB->getFlushStatus(storedFlushId, storingFlushId, lastFlushId, pendingToFlushNodes, pendingToFlushProgram, storingNodes, storingProgram, storedBytesPerSecond, storedRowsPerSecond, proverId);
+        zklog.info("HashDBTestMultiWrite() after getFlushStatus() flushId=" + to_string(flushId) + " storedFlushId=" + to_string(storedFlushId) + " storedBytesPerSecond=" + to_string(storedBytesPerSecond) + " storedRowsPerSecond=" + to_string(storedRowsPerSecond));
         sleep(1);
     } while (storedFlushId < flushId);
 